@@ -0,0 +1,300 @@
+/**
+ * \file alarm.cpp
+ * \brief Module compiling and evaluating the alarm rules
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * Errors of load(), reported with the file and line, the first one is returned :
+ * - errOpenAlarmFile : line malformed, condition unknown, limit or
+ *   hysteresis not a number, hysteresis negative, debounce out of range,
+ *   action not none, close or an EG, alarm name too long
+ * - errDependOutsideOfRange : the sensor is not on the board
+ * - errAllocDataAlarm : rows can't be allocated, or more than MAX_ALARMS rules
+ * A missing alarms.csv is not an error, the board has no alarm.
+ *
+ * Results of evaluate() :
+ * - infoNoAlarm : no alarm is active
+ * - errAlarmHigh, errAlarmLow, errAlarmRate : code of the first active rule
+ */
+
+#include "alarm.h"
+#include "csvReader.h"
+#include "logger.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+static_assert(MAX_ALARMS % 32 == 0, "MAX_ALARMS must be a multiple of 32");
+static_assert(2 * MAX_SENSORS <= 256, "the input of a rule is a uint8_t");
+
+AlarmEngine::AlarmEngine()
+    : rules{}, previousNs(0), nbRules(0), nbLines(0), boardId(0), statusSeq(0), status{}, work{}, names{}
+{
+    for (int s = 0; s < MAX_SENSORS; s++)
+        previous[s] = NAN;
+}
+
+/**
+ * \brief function to read alarms.csv and compile the rules of a board,
+ * once, before the control loop starts.
+ *
+ * \param board the sensor slots of the board
+ * \param path the alarm file
+ * \return statusErrDef of the first invalid line, or noError.
+ */
+statusErrDef AlarmEngine::load(const BoardConfig &board, const char *path)
+{
+    nbRules = 0;
+    nbLines = 0;
+    boardId = board.id;
+    previousNs = 0;
+    for (int s = 0; s < MAX_SENSORS; s++)
+        previous[s] = NAN;
+    work = AlarmStatus{};
+    seqlockPublish(&statusSeq, &status, work);
+
+    if (access(path, F_OK) != 0)
+    {
+        logEvent(logSensor, infoNoAlarm, "no alarm file (board)", boardId);
+        return noError;
+    }
+    CsvFile file;
+    if (!file.open(path))
+    {
+        perror(path);
+        return errOpenAlarmFile;
+    }
+
+    CsvArena arena;
+    LigneAlarm *rows = arena.alloc<LigneAlarm>(file.countLines());
+    if (!rows)
+        return errAllocDataAlarm;
+
+    // a malformed line is kept without condition, it is skipped below
+    statusErrDef res = noError;
+    std::string_view line;
+    int nbRows = 0;
+    while (file.nextLine(line, "board"))
+    {
+        std::string_view fields[8];
+        int n = csvSplitFields(line, fields, 8);
+        LigneAlarm &row = rows[nbRows++];
+        row.board = fields[0];
+        row.alarm = n > 1 ? fields[1] : std::string_view();
+        row.sensor = n > 2 ? fields[2] : std::string_view();
+        row.condition = n > 3 ? fields[3] : std::string_view();
+        row.action = n > 7 && !fields[7].empty() ? fields[7] : std::string_view("none");
+        row.limit = 0.0f;
+        row.hysteresis = 0.0f;
+        row.debounce = 1;
+        row.line = file.getLineNumber();
+
+        int eg = 0;
+        const char *msg = nullptr;
+        if (n < 5 || (row.condition != "above" && row.condition != "below" && row.condition != "rise" &&
+                      row.condition != "fall"))
+            msg = "expected board;alarm;sensor;above|below|rise|fall;limit[;hysteresis;debounce;action]";
+        else if (row.alarm.empty() || row.alarm.size() >= PHYS_NAME_LENGTH)
+            msg = "alarm name empty or longer than PHYS_NAME_LENGTH - 1";
+        else if (!csvToFloat(fields[4], row.limit) || !isfinite(row.limit))
+            msg = "limit not a number";
+        else if (n > 5 && !fields[5].empty() && (!csvToFloat(fields[5], row.hysteresis) || !(row.hysteresis >= 0.0f)))
+            msg = "hysteresis not a positive number";
+        else if (n > 6 && !fields[6].empty() &&
+                 (!csvToInt(fields[6], row.debounce) || row.debounce < 1 || row.debounce > UINT16_MAX))
+            msg = "debounce from 1 to 65535 cycles";
+        else if (row.action != "none" && row.action != "close" &&
+                 (!csvToInt(row.action, eg) || eg < EG_MIN || eg > EG_MAX))
+            msg = "action none, close or an EG";
+        if (msg)
+        {
+            csvReport(path, row.line, errOpenAlarmFile, msg);
+            if (res == noError)
+                res = errOpenAlarmFile;
+            row.condition = std::string_view();
+        }
+    }
+
+    std::string_view boardName(board.name);
+    for (int r = 0; r < nbRows; r++)
+    {
+        const LigneAlarm &row = rows[r];
+        if (row.board != boardName)
+            continue;
+        nbLines++;
+
+        int slot = -1;
+        for (int s = 0; s < board.nbSensors && slot < 0; s++)
+            if (row.sensor == board.sensors[s].name)
+                slot = s;
+        statusErrDef err = row.condition.empty() ? errOpenAlarmFile : noError;
+        const char *msg = nullptr;
+        if (err == noError && slot < 0)
+        {
+            err = errDependOutsideOfRange;
+            msg = "sensor not on the board";
+        }
+        else if (err == noError && nbRules >= MAX_ALARMS)
+        {
+            err = errAllocDataAlarm;
+            msg = "more than MAX_ALARMS rules";
+        }
+        if (err != noError)
+        {
+            if (msg)
+                csvReport(path, row.line, err, msg);
+            if (res == noError)
+                res = err;
+            continue;
+        }
+
+        bool rate = row.condition == "rise" || row.condition == "fall";
+        bool up = row.condition == "above" || row.condition == "rise";
+        int eg = 0;
+        AlarmRule &rule = rules[nbRules];
+        rule.sign = up ? 1.0f : -1.0f;
+        rule.trip = rule.sign * row.limit;
+        rule.release = rule.trip - row.hysteresis;
+        rule.debounce = (uint16_t)row.debounce;
+        rule.count = 0;
+        rule.input = (uint8_t)(rate ? MAX_SENSORS + slot : slot);
+        rule.active = 0;
+        rule.code = rate ? errAlarmRate : up ? errAlarmHigh : errAlarmLow;
+        rule.action = row.action == "close" ? infoStateToManualMode
+                      : csvToInt(row.action, eg) ? (uint16_t)eg : 0;
+        rule.reserved = 0;
+        csvCopy(names[nbRules], PHYS_NAME_LENGTH, row.alarm);
+        nbRules++;
+    }
+
+    logEvent(logSensor, res != noError ? res : infoNoAlarm, "alarm rules loaded (board, lines, rules)", boardId,
+             nbLines, nbRules);
+    return res;
+}
+
+/**
+ * \brief function to evaluate every rule on an acquisition. Called by the
+ * control loop after acquire(), without allocation or file access.
+ *
+ * The inputs are the conditioned values, then their rates in unit per
+ * second ; a sample in error is NaN and meets no condition. Each rule is
+ * one comparison and its debounce counter, the raised and cleared alarms
+ * are logged and published after the pass.
+ *
+ * \param frame the acquisition
+ * \param action receives the action of the first rule raised by this
+ * evaluation, 0 when there is none to apply
+ * \return statusErrDef, see the results at the top of the file.
+ */
+statusErrDef AlarmEngine::evaluate(const SensorFrame &frame, uint16_t &action)
+{
+    action = 0;
+    if (!nbRules)
+        return infoNoAlarm;
+
+    float inputs[2 * MAX_SENSORS];
+    float perSecond = previousNs && frame.timestamp > previousNs ? 1e9f / (float)(frame.timestamp - previousNs) : NAN;
+    for (int s = 0; s < MAX_SENSORS; s++)
+    {
+        float v = frame.sensors[s].status == noError ? frame.values[s] : NAN;
+        inputs[s] = v;
+        inputs[MAX_SENSORS + s] = (v - previous[s]) * perSecond;
+        previous[s] = v;
+    }
+    previousNs = frame.timestamp;
+
+    // 32 rules per word, the changes are gathered in a register
+    uint32_t changed[MAX_ALARMS / 32];
+    uint32_t anyChange = 0;
+    for (int w = 0; w * 32 < nbRules; w++)
+    {
+        uint32_t bits = 0;
+        int end = nbRules - w * 32 < 32 ? nbRules - w * 32 : 32;
+        AlarmRule *word = rules + w * 32;
+        for (int k = 0; k < end; k++)
+        {
+            AlarmRule &rule = word[k];
+            float x = rule.sign * inputs[rule.input];
+            // NaN compares false both ways, the counter restarts
+            uint32_t met = rule.active ? x < rule.release : x > rule.trip;
+            uint32_t count = met ? rule.count + 1u : 0u;
+            uint32_t flip = count >= rule.debounce;
+            rule.active ^= (uint8_t)flip;
+            rule.count = (uint16_t)(flip ? 0 : count);
+            bits |= flip << k;
+        }
+        changed[w] = bits;
+        anyChange |= bits;
+    }
+
+    if (anyChange)
+    {
+        for (int w = 0; w * 32 < nbRules; w++)
+        {
+            for (uint32_t bits = changed[w]; bits; bits &= bits - 1)
+            {
+                int r = w * 32 + __builtin_ctz(bits);
+                const AlarmRule &rule = rules[r];
+                work.active[w] ^= 1u << (r & 31);
+                if (rule.active)
+                {
+                    work.nbActive++;
+                    work.nbRaised++;
+                    logEvent(logSensor, (statusErrDef)rule.code, "alarm raised (board, rule, value)", boardId, r,
+                             (int32_t)lrintf(inputs[rule.input]));
+                    if (!action && rule.action)
+                        action = rule.action;
+                }
+                else
+                {
+                    work.nbActive--;
+                    logEvent(logSensor, infoAlarmCleared, "alarm cleared (board, rule, value)", boardId, r,
+                             (int32_t)lrintf(inputs[rule.input]));
+                }
+            }
+        }
+        work.cycle = frame.cycle;
+        seqlockPublish(&statusSeq, &status, work);
+    }
+
+    if (!work.nbActive)
+        return infoNoAlarm;
+    for (int w = 0; w < MAX_ALARMS / 32; w++)
+        if (work.active[w])
+            return (statusErrDef)rules[w * 32 + __builtin_ctz(work.active[w])].code;
+    return infoNoAlarm;
+}
+
+/**
+ * \brief function to copy the state of the alarms, from any thread.
+ *
+ * \return false when no consistent copy could be made.
+ */
+bool AlarmEngine::getStatus(AlarmStatus &out) const
+{
+    return seqlockRead(&statusSeq, &status, out);
+}
+
+void AlarmEngine::printStatus() const
+{
+    AlarmStatus s;
+    if (!getStatus(s))
+        return;
+    printf("  %d rules, %u active, %u raised since start, last change on cycle %llu\n", nbRules, s.nbActive,
+           s.nbRaised, (unsigned long long)s.cycle);
+    for (int r = 0; r < nbRules; r++)
+        if ((s.active[r >> 5] >> (r & 31)) & 1)
+            printf("  %-20s 0x%04X\n", names[r], rules[r].code);
+}
+
+int AlarmEngine::getNbRules() const
+{
+    return nbRules;
+}
+
+const char *AlarmEngine::getName(int rule) const
+{
+    return names[rule];
+}
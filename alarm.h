@@ -0,0 +1,114 @@
+/**
+ * \file alarm.h
+ * \brief header file of the alarm module
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * Contains the alarm rules of a board. alarms.csv is read once at
+ * initialisation and compiled into a flat array of comparator records,
+ * each one holding its limits, its debounce counter and its state, so an
+ * evaluation is one pass over the array without branch on the kind of rule.
+ *
+ * alarms.csv : board;alarm;sensor;condition;limit;hysteresis;debounce;action
+ * - above / below : the conditioned value of the sensor is above / below limit
+ * - rise / fall : the value rises / falls faster than limit per second
+ * - hysteresis : an active alarm clears once the value is back past
+ *   limit by hysteresis, 0 by default
+ * - debounce : cycles in a row the condition must hold to raise the
+ *   alarm, and must fail to clear it, 1 by default
+ * - action : none, close (every valve commanded closed, manual mode) or
+ *   the EG of the safe state in hexadecimal, none by default
+ * The limits are in the unit of the sensor in calibration.csv.
+ *
+ * A sensor whose sample is in error meets no condition : its alarms are
+ * neither raised nor cleared until it reads again. The action of an alarm
+ * is applied once, when it is raised ; the EG can be changed after that.
+ */
+
+#ifndef ALARM_H
+#define ALARM_H
+
+#include "configDefine.h"
+#include "statusErrorDefine.h"
+#include "physicalConfig.h"
+#include "shmLayout.h"
+#include <cstdint>
+#include <string_view>
+
+/**
+ * \brief one line of alarms.csv, the names point into the mapped file
+ */
+struct LigneAlarm
+{
+    std::string_view board;
+    std::string_view alarm;
+    std::string_view sensor;
+    std::string_view condition;
+    std::string_view action;
+    float limit;
+    float hysteresis;
+    int debounce;
+    int line;
+};
+
+/**
+ * \brief compiled alarm rule, the input is multiplied by sign so every
+ * rule is a "greater than" while inactive and a "less than" while active
+ */
+struct AlarmRule
+{
+    float trip;        /**< sign * limit */
+    float release;     /**< sign * limit - hysteresis */
+    float sign;        /**< 1 for above and rise, -1 for below and fall */
+    uint16_t debounce; /**< cycles in a row to raise or clear */
+    uint16_t count;    /**< cycles in a row the rule has met the condition to change */
+    uint8_t input;     /**< sensor slot, + MAX_SENSORS for its rate */
+    uint8_t active;
+    uint16_t code;     /**< errAlarmHigh, errAlarmLow or errAlarmRate */
+    uint16_t action;   /**< EG applied when raised, infoStateToManualMode to close every valve, 0 for none */
+    uint16_t reserved;
+};
+
+/**
+ * \brief state of the alarms of a board, published at every change
+ */
+struct AlarmStatus
+{
+    uint64_t cycle;                    /**< acquisition of the last change */
+    uint32_t active[MAX_ALARMS / 32];  /**< bit r of word r / 32 set when rule r is active */
+    uint32_t nbActive;
+    uint32_t nbRaised;                 /**< alarms raised since load() */
+};
+
+/**
+ * \brief compiled alarm rules of one board.
+ *
+ * evaluate() is called by the cycle thread, the status can be read from
+ * any other thread with getStatus().
+ */
+class AlarmEngine
+{
+private:
+    AlarmRule rules[MAX_ALARMS];
+    float previous[MAX_SENSORS]; /**< values of the last evaluation, NaN when in error */
+    uint64_t previousNs;         /**< timestamp of the last evaluation */
+    int nbRules;
+    int nbLines;                 /**< lines of the board in alarms.csv */
+    uint8_t boardId;
+    uint32_t statusSeq;          /**< sequence lock of status */
+    AlarmStatus status;
+    AlarmStatus work;            /**< status updated by the cycle thread */
+    char names[MAX_ALARMS][PHYS_NAME_LENGTH];
+
+public:
+    AlarmEngine();
+    statusErrDef load(const BoardConfig &board, const char *path = ALARM_FILE);
+    statusErrDef evaluate(const SensorFrame &frame, uint16_t &action);
+    bool getStatus(AlarmStatus &out) const;
+    void printStatus() const;
+    int getNbRules() const;
+    const char *getName(int rule) const;
+};
+
+#endif // ALARM_H
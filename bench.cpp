@@ -0,0 +1,3891 @@
+/* compilation :
+g++ -std=c++20 -O2 bench.cpp histogram.cpp sensor.cpp valve.cpp iioBuffer.cpp modbusBus.cpp csvReader.cpp hal.cpp sequencer.cpp interlock.cpp conditioning.cpp sensorHealth.cpp alarm.cpp processImage.cpp cac.cpp valveBank.cpp physicalConfig.cpp orchestrator.cpp cycle.cpp logger.cpp telemetry.cpp telemServer.cpp commandQueue.cpp valveScheduler.cpp -o bench_exe $(pkg-config --cflags --libs libgpiod)
+*/
+
+/**
+ * \file bench.cpp
+ * \brief Benchmarks of the CAC acquisition and actuation paths
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * Every scenario runs against fake files in a temporary directory so it
+ * can be executed on any Linux machine, without the MCP3008 or the GPIO chip.
+ * usage : ./bench_exe [scenario] [json]   (no scenario runs all of them,
+ * json receives the figures of the e2e scenario)
+ */
+
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdarg>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <semaphore>
+#include <latch>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "sensor.h"
+#include "iioBuffer.h"
+#include "shmLayout.h"
+#include "cycle.h"
+#include "logger.h"
+#include "telemetry.h"
+#include "modbusBus.h"
+#include "configCAC.h"
+#include "sequencer.h"
+#include "csvReader.h"
+#include "interlock.h"
+#include "processImage.h"
+#include "orchestrator.h"
+#include "hal.h"
+#include "histogram.h"
+#include "conditioning.h"
+#include "sensorHealth.h"
+#include "alarm.h"
+#include "telemServer.h"
+#include "commandQueue.h"
+#include "valveScheduler.h"
+#include <pthread.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+//------------------------------------------------------------------------------
+// syscall counters
+//------------------------------------------------------------------------------
+
+/**
+ * \brief number of syscalls issued through the wrappers below
+ *
+ * The bench executable interposes the libc wrappers used by the modules :
+ * files, sockets, ioctl and sleeps, so every call made by the program goes
+ * through these counters. The calls made inside the libc itself (stdio
+ * flushing its buffer, usleep) don't go through the PLT and aren't counted.
+ * The counter is per thread so feeder threads don't pollute the figures.
+ */
+static thread_local unsigned long nbSyscalls = 0;
+
+/**
+ * \brief mode of the board, defined by main.cpp in the application
+ */
+Mode mode = manual;
+
+extern "C" int open(const char *path, int flags, ...)
+{
+    mode_t mode = 0;
+    if (flags & O_CREAT)
+    {
+        va_list ap;
+        va_start(ap, flags);
+        mode = va_arg(ap, mode_t);
+        va_end(ap);
+    }
+    nbSyscalls++;
+    return syscall(SYS_openat, AT_FDCWD, path, flags, mode);
+}
+
+extern "C" ssize_t read(int fd, void *buf, size_t count)
+{
+    nbSyscalls++;
+    return syscall(SYS_read, fd, buf, count);
+}
+
+extern "C" ssize_t pread(int fd, void *buf, size_t count, off_t offset)
+{
+    nbSyscalls++;
+    return syscall(SYS_pread64, fd, buf, count, offset);
+}
+
+extern "C" ssize_t readv(int fd, const struct iovec *iov, int iovcnt)
+{
+    nbSyscalls++;
+    return syscall(SYS_readv, fd, iov, iovcnt);
+}
+
+extern "C" ssize_t writev(int fd, const struct iovec *iov, int iovcnt)
+{
+    nbSyscalls++;
+    return syscall(SYS_writev, fd, iov, iovcnt);
+}
+
+extern "C" ssize_t write(int fd, const void *buf, size_t count)
+{
+    nbSyscalls++;
+    return syscall(SYS_write, fd, buf, count);
+}
+
+extern "C" int ioctl(int fd, unsigned long request, ...)
+{
+    va_list ap;
+    va_start(ap, request);
+    void *arg = va_arg(ap, void *);
+    va_end(ap);
+    nbSyscalls++;
+    return syscall(SYS_ioctl, fd, request, arg);
+}
+
+extern "C" ssize_t send(int fd, const void *buf, size_t len, int flags)
+{
+    nbSyscalls++;
+    return syscall(SYS_sendto, fd, buf, len, flags, nullptr, 0);
+}
+
+extern "C" ssize_t sendto(int fd, const void *buf, size_t len, int flags, const struct sockaddr *addr,
+                          socklen_t addrlen)
+{
+    nbSyscalls++;
+    return syscall(SYS_sendto, fd, buf, len, flags, addr, addrlen);
+}
+
+extern "C" ssize_t sendmsg(int fd, const struct msghdr *msg, int flags)
+{
+    nbSyscalls++;
+    return syscall(SYS_sendmsg, fd, msg, flags);
+}
+
+extern "C" ssize_t recv(int fd, void *buf, size_t len, int flags)
+{
+    nbSyscalls++;
+    return syscall(SYS_recvfrom, fd, buf, len, flags, nullptr, nullptr);
+}
+
+extern "C" ssize_t recvfrom(int fd, void *buf, size_t len, int flags, struct sockaddr *addr, socklen_t *addrlen)
+{
+    nbSyscalls++;
+    return syscall(SYS_recvfrom, fd, buf, len, flags, addr, addrlen);
+}
+
+extern "C" ssize_t recvmsg(int fd, struct msghdr *msg, int flags)
+{
+    nbSyscalls++;
+    return syscall(SYS_recvmsg, fd, msg, flags);
+}
+
+extern "C" int clock_nanosleep(clockid_t clock, int flags, const struct timespec *request, struct timespec *remain)
+{
+    nbSyscalls++;
+    // clock_nanosleep() returns the error number instead of setting errno
+    if (syscall(SYS_clock_nanosleep, clock, flags, request, remain) == -1)
+        return errno;
+    return 0;
+}
+
+extern "C" int nanosleep(const struct timespec *request, struct timespec *remain)
+{
+    nbSyscalls++;
+    return syscall(SYS_nanosleep, request, remain);
+}
+
+extern "C" off_t lseek(int fd, off_t offset, int whence)
+{
+    nbSyscalls++;
+    return syscall(SYS_lseek, fd, offset, whence);
+}
+
+extern "C" int close(int fd)
+{
+    nbSyscalls++;
+    return syscall(SYS_close, fd);
+}
+
+//------------------------------------------------------------------------------
+// allocation counters
+//------------------------------------------------------------------------------
+
+/**
+ * \brief number of heap allocations made by the thread, operator new
+ * included since it calls malloc(), or aligned_alloc() for the
+ * over-aligned types
+ */
+static thread_local unsigned long nbAllocs = 0;
+
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t nmemb, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+extern "C" void *__libc_memalign(size_t alignment, size_t size);
+
+extern "C" void *malloc(size_t size)
+{
+    nbAllocs++;
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t nmemb, size_t size)
+{
+    nbAllocs++;
+    return __libc_calloc(nmemb, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+    nbAllocs++;
+    return __libc_realloc(ptr, size);
+}
+
+extern "C" void *memalign(size_t alignment, size_t size)
+{
+    nbAllocs++;
+    return __libc_memalign(alignment, size);
+}
+
+extern "C" void *aligned_alloc(size_t alignment, size_t size)
+{
+    nbAllocs++;
+    return __libc_memalign(alignment, size);
+}
+
+extern "C" int posix_memalign(void **ptr, size_t alignment, size_t size)
+{
+    nbAllocs++;
+    if (alignment % sizeof(void *) != 0 || (alignment & (alignment - 1)) != 0)
+        return EINVAL;
+    void *mem = __libc_memalign(alignment, size);
+    if (mem == nullptr)
+        return ENOMEM;
+    *ptr = mem;
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+// helpers
+//------------------------------------------------------------------------------
+
+static uint64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/**
+ * \brief creates a fake iio:device0 directory holding one
+ * in_voltageN_raw file per MCP3008 channel.
+ *
+ * \param dir buffer receiving the directory path, with a trailing '/'
+ * \param len size of dir
+ * \return false when the directory can't be created.
+ */
+static bool makeFakeSysfs(char *dir, size_t len)
+{
+    snprintf(dir, len, "/tmp/cac_bench_XXXXXX");
+    if (!mkdtemp(dir))
+    {
+        perror("mkdtemp()");
+        return false;
+    }
+    strncat(dir, "/", len - strlen(dir) - 1);
+
+    for (int ch = 0; ch < MAX_ADC; ch++)
+    {
+        char path[MAX_PATH_LENGTH];
+        snprintf(path, sizeof(path), "%sin_voltage%d_raw", dir, ch);
+        FILE *f = fopen(path, "w");
+        if (!f)
+        {
+            perror("fopen()");
+            return false;
+        }
+        fprintf(f, "%d\n", 100 * ch + 23);
+        fclose(f);
+    }
+    return true;
+}
+
+static void removeFakeSysfs(const char *dir)
+{
+    for (int ch = 0; ch < MAX_ADC; ch++)
+    {
+        char path[MAX_PATH_LENGTH];
+        snprintf(path, sizeof(path), "%sin_voltage%d_raw", dir, ch);
+        unlink(path);
+    }
+    rmdir(dir);
+}
+
+/**
+ * \brief builds the path of a file of a fake tree : the directory, with
+ * its trailing '/', followed by the name.
+ *
+ * \return false when the path doesn't fit in len.
+ */
+static bool fakePath(char *path, size_t len, const char *dir, const char *name)
+{
+    int n = snprintf(path, len, "%s%s", dir, name);
+    return n >= 0 && n < (int)len;
+}
+
+static void report(const char *label, unsigned long samples, unsigned long syscalls, uint64_t ns)
+{
+    printf("%-28s %8.2f syscalls/sample %10.1f ns/sample\n", label,
+           (double)syscalls / samples, (double)ns / samples);
+}
+
+//------------------------------------------------------------------------------
+// scenarios
+//------------------------------------------------------------------------------
+
+/**
+ * \brief the former Sensor::readChannel() path : path formatting,
+ * open(), read(), lseek() and close() for every sample.
+ */
+static int legacyRead(const char *dir, int channel)
+{
+    char path[128];
+    char buff[8];
+    int len = snprintf(path, sizeof(path), "%sin_voltage%d_raw", dir, channel);
+    if (len < 0 || len >= (int)sizeof(path))
+        return ADC_READ_ERROR;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return ADC_READ_ERROR;
+    memset(buff, 0, sizeof(buff));
+    int val = ADC_READ_ERROR;
+    if (read(fd, buff, 8) >= 0)
+        val = atoi(buff);
+    lseek(fd, 0, SEEK_SET);
+    close(fd);
+    return val;
+}
+
+/**
+ * \brief sysfs acquisition of the 8 MCP3008 channels :
+ * open/read/close per sample against pread on persistent descriptors.
+ */
+static int benchSysfs(unsigned long cycles)
+{
+    char dir[MAX_PATH_LENGTH];
+    if (!makeFakeSysfs(dir, sizeof(dir)))
+        return EXIT_FAILURE;
+
+    const unsigned long samples = cycles * MAX_ADC;
+    volatile int sink = 0;
+
+    nbSyscalls = 0;
+    uint64_t t0 = nowNs();
+    for (unsigned long c = 0; c < cycles; c++)
+        for (int ch = 0; ch < MAX_ADC; ch++)
+            sink = legacyRead(dir, ch);
+    uint64_t legacyNs = nowNs() - t0;
+    unsigned long legacySyscalls = nbSyscalls;
+
+    Sensor::setIioPath(dir);
+    Sensor *sensors[MAX_ADC];
+    for (int ch = 0; ch < MAX_ADC; ch++)
+    {
+        sensors[ch] = new Sensor("CH" + std::to_string(ch), ch, 1, ch);
+        if (sensors[ch]->initSensor() != noError)
+        {
+            std::cerr << "initSensor failed on channel " << ch << std::endl;
+            for (int k = 0; k <= ch; k++)
+            {
+                sensors[k]->extinctSensor();
+                delete sensors[k];
+            }
+            removeFakeSysfs(dir);
+            return EXIT_FAILURE;
+        }
+    }
+
+    nbSyscalls = 0;
+    t0 = nowNs();
+    for (unsigned long c = 0; c < cycles; c++)
+        for (int ch = 0; ch < MAX_ADC; ch++)
+            sink = sensors[ch]->readChannel();
+    uint64_t preadNs = nowNs() - t0;
+    unsigned long preadSyscalls = nbSyscalls;
+    (void)sink;
+
+    for (int ch = 0; ch < MAX_ADC; ch++)
+    {
+        sensors[ch]->extinctSensor();
+        delete sensors[ch];
+    }
+    removeFakeSysfs(dir);
+
+    printf("== sysfs : %d channels, %lu cycles\n", MAX_ADC, cycles);
+    report("open/read/lseek/close", samples, legacySyscalls, legacyNs);
+    report("persistent fd + pread", samples, preadSyscalls, preadNs);
+    printf("%-28s %10.1f us/cycle (before) %10.1f us/cycle (after), budget %d us\n",
+           "8-channel cycle", (double)legacyNs / cycles / 1000.0,
+           (double)preadNs / cycles / 1000.0, CYCLE_LEN);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * \brief writes a sysfs attribute of the fake device.
+ */
+static void writeFakeAttr(const char *dir, const char *attr, const char *value)
+{
+    char path[MAX_PATH_LENGTH];
+    FILE *f = fakePath(path, sizeof(path), dir, attr) ? fopen(path, "w") : nullptr;
+    if (f)
+    {
+        fputs(value, f);
+        fclose(f);
+    }
+}
+
+/**
+ * \brief IIO buffered capture of the 8 MCP3008 channels : a feeder thread
+ * writes big endian u10/16 scan records in a FIFO standing for /dev/iio:device0.
+ */
+static int benchIio(unsigned long nbScans)
+{
+    char dir[MAX_PATH_LENGTH];
+    if (!makeFakeSysfs(dir, sizeof(dir)))
+        return EXIT_FAILURE;
+
+    char path[MAX_PATH_LENGTH];
+    if (fakePath(path, sizeof(path), dir, "scan_elements"))
+        mkdir(path, 0755);
+    if (fakePath(path, sizeof(path), dir, "buffer"))
+        mkdir(path, 0755);
+    writeFakeAttr(dir, "buffer/length", "0\n");
+    writeFakeAttr(dir, "buffer/enable", "0\n");
+    writeFakeAttr(dir, "scan_elements/in_timestamp_en", "1\n");
+    for (int ch = 0; ch < MAX_ADC; ch++)
+    {
+        char attr[64];
+        char value[16];
+        snprintf(attr, sizeof(attr), "scan_elements/in_voltage%d_en", ch);
+        writeFakeAttr(dir, attr, "0\n");
+        snprintf(attr, sizeof(attr), "scan_elements/in_voltage%d_index", ch);
+        snprintf(value, sizeof(value), "%d\n", ch);
+        writeFakeAttr(dir, attr, value);
+        snprintf(attr, sizeof(attr), "scan_elements/in_voltage%d_type", ch);
+        writeFakeAttr(dir, attr, "be:u10/16>>0\n");
+    }
+    char dev[MAX_PATH_LENGTH];
+    if (!fakePath(dev, sizeof(dev), dir, "dev") || mkfifo(dev, 0600) < 0)
+    {
+        perror("mkfifo()");
+        return EXIT_FAILURE;
+    }
+
+    Sensor *sensors[MAX_ADC];
+    IioBuffer *iio = new IioBuffer(dir, dev);
+    for (int ch = 0; ch < MAX_ADC; ch++)
+    {
+        sensors[ch] = new Sensor("CH" + std::to_string(ch), ch, 3, ch);
+        sensors[ch]->initSensor();
+        iio->addSensor(sensors[ch]);
+    }
+    if (iio->enable() != noError)
+    {
+        std::cerr << "IioBuffer::enable failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::thread feeder([&]()
+                       {
+        int fd = open(dev, O_WRONLY);
+        uint8_t chunk[64 * MAX_ADC * 2];
+        unsigned long sent = 0;
+        while (sent < nbScans)
+        {
+            unsigned long n = std::min<unsigned long>(64, nbScans - sent);
+            for (unsigned long s = 0; s < n; s++)
+                for (int ch = 0; ch < MAX_ADC; ch++)
+                {
+                    uint16_t v = (uint16_t)((sent + s + ch) & 0x3FF);
+                    chunk[(s * MAX_ADC + ch) * 2] = v >> 8;
+                    chunk[(s * MAX_ADC + ch) * 2 + 1] = v & 0xFF;
+                }
+            if (write(fd, chunk, n * MAX_ADC * 2) < 0)
+                break;
+            sent += n;
+        }
+        close(fd); });
+
+    unsigned long received = 0;
+    unsigned long reads = 0;
+    nbSyscalls = 0;
+    uint64_t t0 = nowNs();
+    while (received < nbScans)
+    {
+        int n = iio->readScans();
+        reads++;
+        if (n < 0)
+            break;
+        received += n;
+    }
+    uint64_t ns = nowNs() - t0;
+    unsigned long syscalls = nbSyscalls;
+    feeder.join();
+
+    bool ok = (sensors[MAX_ADC - 1]->getValue() == (int16_t)((nbScans - 1 + MAX_ADC - 1) & 0x3FF));
+
+    delete iio;
+    for (int ch = 0; ch < MAX_ADC; ch++)
+        delete sensors[ch];
+    unlink(dev);
+    for (const char *attr : {"buffer/length", "buffer/enable", "scan_elements/in_timestamp_en"})
+        if (fakePath(path, sizeof(path), dir, attr))
+            unlink(path);
+    for (int ch = 0; ch < MAX_ADC; ch++)
+        for (const char *suffix : {"en", "index", "type"})
+        {
+            int len = snprintf(path, sizeof(path), "%sscan_elements/in_voltage%d_%s", dir, ch, suffix);
+            if (len >= 0 && len < (int)sizeof(path))
+                unlink(path);
+        }
+    if (fakePath(path, sizeof(path), dir, "scan_elements"))
+        rmdir(path);
+    if (fakePath(path, sizeof(path), dir, "buffer"))
+        rmdir(path);
+    removeFakeSysfs(dir);
+
+    printf("== iio : %d channels, %lu scans, %.1f scans per read() (%lu reads)\n",
+           MAX_ADC, received, (double)received / reads, reads);
+    report("buffered scans", received * MAX_ADC, syscalls, ns);
+    if (!ok)
+    {
+        std::cerr << "iio : demultiplexed values don't match the feeder" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * \brief one writer publishing channel vectors under the sequence lock and
+ * nbReaders readers checking every snapshot for torn values, compared to
+ * the semaphore round-trip previously used between the console and
+ * process_sensor().
+ */
+static int benchSeqlock(unsigned long nbFrames, int nbReaders)
+{
+    static SensorData data = {};
+    std::atomic<bool> done(false);
+    std::vector<unsigned long> snapshots(nbReaders, 0);
+    std::vector<unsigned long> torn(nbReaders, 0);
+    std::vector<uint64_t> readNs(nbReaders, 0);
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < nbReaders; r++)
+        readers.emplace_back([&, r]()
+                             {
+            SensorFrame frame;
+            uint64_t t0 = nowNs();
+            while (!done.load(std::memory_order_relaxed))
+            {
+                if (!seqlockRead(&data.seq, &data.frame, frame, 1))
+                    continue;
+                snapshots[r]++;
+                for (int i = 0; i < MAX_SENSORS; i++)
+                    if (frame.sensors[i].value != (int16_t)(frame.cycle & 0x7FFF) || frame.sensors[i].seq != (uint32_t)frame.cycle)
+                    {
+                        torn[r]++;
+                        break;
+                    }
+            }
+            readNs[r] = nowNs() - t0; });
+
+    SensorFrame frame = {};
+    uint64_t t0 = nowNs();
+    for (unsigned long c = 1; c <= nbFrames; c++)
+    {
+        frame.cycle = c;
+        for (int i = 0; i < MAX_SENSORS; i++)
+        {
+            frame.sensors[i].value = (int16_t)(c & 0x7FFF);
+            frame.sensors[i].seq = (uint32_t)c;
+        }
+        seqlockPublish(&data.seq, &data.frame, frame);
+    }
+    uint64_t writeNs = nowNs() - t0;
+    done = true;
+    for (std::thread &t : readers)
+        t.join();
+
+    unsigned long totalSnapshots = 0, totalTorn = 0;
+    uint64_t totalReadNs = 0;
+    for (int r = 0; r < nbReaders; r++)
+    {
+        totalSnapshots += snapshots[r];
+        totalTorn += torn[r];
+        totalReadNs += readNs[r];
+    }
+
+    // semaphore handshake : release / acquire in both directions
+    std::counting_semaphore<1> request(0), ready(0);
+    const unsigned long nbRoundTrips = 20000;
+    std::thread peer([&]()
+                     {
+        for (unsigned long i = 0; i < nbRoundTrips; i++)
+        {
+            request.acquire();
+            ready.release();
+        } });
+    t0 = nowNs();
+    for (unsigned long i = 0; i < nbRoundTrips; i++)
+    {
+        request.release();
+        ready.acquire();
+    }
+    uint64_t semNs = nowNs() - t0;
+    peer.join();
+
+    printf("== seqlock : 1 writer, %d readers, %lu frames of %d channels\n", nbReaders, nbFrames, MAX_SENSORS);
+    printf("%-28s %10.1f ns/frame\n", "writer publish", (double)writeNs / nbFrames);
+    printf("%-28s %10.1f ns/snapshot, %lu snapshots, %lu torn\n", "reader snapshot",
+           totalSnapshots ? (double)totalReadNs / totalSnapshots : 0.0, totalSnapshots, totalTorn);
+    printf("%-28s %10.1f ns/round-trip\n", "semaphore handshake", (double)semNs / nbRoundTrips);
+    return totalTorn ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/**
+ * \brief cycle executive holding a 1 ms period while the body reads
+ * the 8 fake channels, with a background thread loading the CPU.
+ */
+static int benchCycle(unsigned long nbCycles)
+{
+    char dir[MAX_PATH_LENGTH];
+    if (!makeFakeSysfs(dir, sizeof(dir)))
+        return EXIT_FAILURE;
+    Sensor::setIioPath(dir);
+    Sensor *sensors[MAX_ADC];
+    for (int ch = 0; ch < MAX_ADC; ch++)
+    {
+        sensors[ch] = new Sensor("CH" + std::to_string(ch), ch, 1, ch);
+        sensors[ch]->initSensor();
+    }
+
+    std::atomic<bool> done(false);
+    std::thread load([&]()
+                     {
+        volatile unsigned long x = 0;
+        while (!done.load(std::memory_order_relaxed))
+            x = x + 1; });
+
+    // the real-time settings only apply to the thread of the executive,
+    // the memory is unlocked after it so the next scenarios run as before
+    CycleConfig config;
+    config.periodUs = 1000;
+    CycleExecutive executive(config);
+    std::thread cycle([&]()
+                      { executive.run([&](uint64_t cycle)
+                                      {
+        for (int ch = 0; ch < MAX_ADC; ch++)
+            sensors[ch]->readChannel();
+        if (cycle + 1 >= nbCycles)
+            executive.stop(); }); });
+    cycle.join();
+    if (config.lockMemory)
+        munlockall();
+    done = true;
+    load.join();
+
+    for (int ch = 0; ch < MAX_ADC; ch++)
+    {
+        sensors[ch]->extinctSensor();
+        delete sensors[ch];
+    }
+    removeFakeSysfs(dir);
+
+    printf("== cycle : %lu cycles of %ld us with a CPU hog\n", nbCycles, config.periodUs);
+    executive.printStats();
+    return EXIT_SUCCESS;
+}
+
+/**
+ * \brief producer-side cost of logEvent() : bursts of half a ring with
+ * the writer thread draining to /dev/null, then a ring that stays full
+ * because the writer is stopped, where the records are dropped. Last,
+ * short-lived threads, many more than LOG_MAX_THREADS, each log once :
+ * the slot of an exited thread is reused, nothing is dropped.
+ */
+static int benchLog(int nbBursts, unsigned long nbRecordsFull)
+{
+    FILE *devNull = fopen("/dev/null", "w");
+    if (!devNull)
+        return EXIT_FAILURE;
+    logRegisterThread();
+
+    const int burst = LOG_RING_SIZE / 2;
+    logStart(devNull);
+    uint64_t worst = 0;
+    uint64_t total = 0;
+    for (int b = 0; b < nbBursts; b++)
+    {
+        uint64_t t0 = nowNs();
+        for (int j = 0; j < burst; j++)
+            logEvent(logSensor, errReadAdc, "bench (burst, j)", b, j);
+        uint64_t ns = nowNs() - t0;
+        total += ns;
+        if (ns > worst)
+            worst = ns;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2 * LOG_FLUSH_MS));
+    }
+    logStop();
+    uint64_t droppedDrained = logDropped();
+
+    uint64_t t0 = nowNs();
+    for (unsigned long i = 0; i < nbRecordsFull; i++)
+        logEvent(logSensor, errReadAdc, "bench (i)", (int32_t)i);
+    uint64_t fullNs = nowNs() - t0;
+    uint64_t droppedFull = logDropped() - droppedDrained;
+    // writes the records kept and frees the rings
+    logStop();
+
+    const int nbShort = 4 * LOG_MAX_THREADS;
+    logStart(devNull);
+    uint64_t droppedBefore = logDropped();
+    for (int t = 0; t < nbShort; t++)
+        std::thread([t]() { logEvent(logMain, noError, "bench short-lived thread (t)", t); }).join();
+    uint64_t droppedShort = logDropped() - droppedBefore;
+    logStop();
+    fclose(devNull);
+
+    printf("== log : ring of %d records\n", LOG_RING_SIZE);
+    printf("%-28s %10.1f ns/record, worst burst %.1f ns/record, %llu dropped of %d\n", "writer draining",
+           (double)total / (nbBursts * burst), (double)worst / burst,
+           (unsigned long long)droppedDrained, nbBursts * burst);
+    printf("%-28s %10.1f ns/record, %llu dropped of %lu\n", "ring full",
+           (double)fullNs / nbRecordsFull, (unsigned long long)droppedFull, nbRecordsFull);
+    printf("%-28s %10d threads of one record, %llu dropped, %d slots\n", "short-lived threads", nbShort,
+           (unsigned long long)droppedShort, LOG_MAX_THREADS);
+    return droppedShort == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * \brief cost of TelemetryRecorder::record() over several segment
+ * rotations, against a write() and fdatasync() per cycle.
+ * Records are written in bursts of 3/4 of a segment with a pause
+ * letting the sync thread prepare the next one.
+ */
+static int benchTelem(int nbBursts, unsigned long nbNaive)
+{
+    char dir[MAX_PATH_LENGTH];
+    snprintf(dir, sizeof(dir), "/tmp/cac_telem_XXXXXX");
+    if (!mkdtemp(dir))
+        return EXIT_FAILURE;
+    strcat(dir, "/");
+
+    SensorFrame frame = {};
+    for (int i = 0; i < MAX_SENSORS; i++)
+        frame.sensors[i].value = (int16_t)(100 * i);
+
+    TelemetryRecorder telem("BENCH", MAX_SENSORS, MAX_VALVES, dir);
+    if (telem.start() != noError)
+        return EXIT_FAILURE;
+
+    const unsigned long burst = TELEM_SEGMENT_RECORDS * 3 / 4;
+    uint64_t total = 0;
+    uint64_t worst = 0;
+    for (int b = 0; b < nbBursts; b++)
+    {
+        for (unsigned long j = 0; j < burst; j++)
+        {
+            frame.cycle++;
+            frame.timestamp = nowNs();
+            uint64_t t0 = nowNs();
+            telem.record(frame, (uint32_t)j);
+            uint64_t ns = nowNs() - t0;
+            total += ns;
+            if (ns > worst)
+                worst = ns;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(3 * TELEM_SYNC_MS));
+    }
+    telem.stop();
+
+    // naive recorder : one write and one fdatasync per cycle
+    std::string naivePath = std::string(dir) + "naive.bin";
+    int fd = open(naivePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    uint64_t naiveWorst = 0;
+    uint64_t t0 = nowNs();
+    for (unsigned long i = 0; i < nbNaive && fd >= 0; i++)
+    {
+        TelemRecord rec = {};
+        uint64_t t1 = nowNs();
+        if (write(fd, &rec, sizeof(rec)) < 0 || fdatasync(fd) < 0)
+            break;
+        uint64_t ns = nowNs() - t1;
+        if (ns > naiveWorst)
+            naiveWorst = ns;
+    }
+    uint64_t naiveNs = nowNs() - t0;
+    if (fd >= 0)
+        close(fd);
+
+    std::string cmd = std::string("rm -rf ") + dir;
+    if (system(cmd.c_str()) != 0)
+        perror(cmd.c_str());
+
+    unsigned long nbRecords = nbBursts * burst;
+    printf("== telem : %lu records of %zu bytes, segments of %d records\n", nbRecords, sizeof(TelemRecord),
+           TELEM_SEGMENT_RECORDS);
+    printf("%-28s %10.1f ns/record, worst %.1f us, %llu dropped\n", "mmap segments",
+           (double)total / nbRecords, worst / 1000.0, (unsigned long long)telem.getDropped());
+    printf("%-28s %10.1f ns/record, worst %.1f us\n", "write + fdatasync",
+           (double)naiveNs / nbNaive, naiveWorst / 1000.0);
+    return telem.getDropped() ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/**
+ * \brief Modbus RTU slave simulator on the master side of a pty :
+ * answers every read request with register value = slave * 100 + register.
+ */
+static void modbusSlave(int fd, std::atomic<bool> &done)
+{
+    uint8_t req[8];
+    size_t len = 0;
+    while (!done.load(std::memory_order_relaxed))
+    {
+        struct pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, 10) <= 0)
+            continue;
+        ssize_t n = read(fd, req + len, sizeof(req) - len);
+        if (n <= 0)
+            continue;
+        len += n;
+        if (len < sizeof(req))
+            continue;
+        len = 0;
+
+        uint16_t crc = ModbusBus::crc16(req, 6);
+        if (req[6] != (crc & 0xFF) || req[7] != (crc >> 8))
+            continue;
+        int first = (req[2] << 8) | req[3];
+        int count = (req[4] << 8) | req[5];
+        uint8_t ans[5 + 2 * MODBUS_MAX_REGS];
+        ans[0] = req[0];
+        ans[1] = req[1];
+        ans[2] = 2 * count;
+        for (int r = 0; r < count; r++)
+        {
+            int value = req[0] * 100 + first + r;
+            ans[3 + 2 * r] = value >> 8;
+            ans[4 + 2 * r] = value & 0xFF;
+        }
+        crc = ModbusBus::crc16(ans, 3 + 2 * count);
+        ans[3 + 2 * count] = crc & 0xFF;
+        ans[4 + 2 * count] = crc >> 8;
+        if (write(fd, ans, 5 + 2 * count) < 0)
+            perror("write()");
+    }
+}
+
+/**
+ * \brief 6 modbus sensors on 2 slaves read through a pty pair, one
+ * poll() per 1 ms cycle, with coalesced requests then one request per sensor.
+ */
+static int benchModbus(unsigned long nbCycles)
+{
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0)
+    {
+        perror("posix_openpt()");
+        return EXIT_FAILURE;
+    }
+    const char *slavePath = ptsname(master);
+    std::atomic<bool> done(false);
+    std::thread simulator(modbusSlave, master, std::ref(done));
+
+    const int channels[] = {1 * MODBUS_SLAVE_STRIDE + 0, 1 * MODBUS_SLAVE_STRIDE + 1, 1 * MODBUS_SLAVE_STRIDE + 2,
+                            1 * MODBUS_SLAVE_STRIDE + 5, 2 * MODBUS_SLAVE_STRIDE + 10, 2 * MODBUS_SLAVE_STRIDE + 11};
+    const int nbSensors = sizeof(channels) / sizeof(channels[0]);
+    int res = EXIT_SUCCESS;
+
+    printf("== modbus : %d sensors on 2 slaves through a pty, %lu cycles of 1 ms\n", nbSensors, nbCycles);
+    for (bool coalesce : {true, false})
+    {
+        std::vector<Sensor> sensors;
+        for (int i = 0; i < nbSensors; i++)
+            sensors.emplace_back("MB" + std::to_string(i), i, 2, channels[i]);
+        ModbusBus bus(slavePath, 115200, coalesce);
+        for (Sensor &sensor : sensors)
+            bus.addSensor(&sensor);
+        if (bus.open() != noError)
+        {
+            res = EXIT_FAILURE;
+            break;
+        }
+
+        uint64_t total = 0;
+        uint64_t worst = 0;
+        for (unsigned long c = 0; c < nbCycles; c++)
+        {
+            uint64_t t0 = nowNs();
+            bus.poll();
+            uint64_t ns = nowNs() - t0;
+            total += ns;
+            if (ns > worst)
+                worst = ns;
+            std::this_thread::sleep_for(std::chrono::microseconds(1000));
+        }
+
+        int wrong = 0;
+        for (Sensor &sensor : sensors)
+        {
+            int slave = sensor.getChannel() / MODBUS_SLAVE_STRIDE;
+            if (sensor.getValue() != slave * 100 + sensor.getChannel() % MODBUS_SLAVE_STRIDE)
+                wrong++;
+        }
+        if (wrong || bus.getNbErrors())
+            res = EXIT_FAILURE;
+
+        double transactions = (double)bus.getNbTransactions();
+        double bytes = (double)(bus.getBytesTx() + bus.getBytesRx());
+        printf("%-28s %d requests, %.3f transactions/cycle, %.1f bytes/cycle\n",
+               coalesce ? "coalesced" : "one request per sensor", bus.getNbRequests(),
+               transactions / nbCycles, bytes / nbCycles);
+        printf("%-28s %.1f bytes/refresh, %.1f cycles/refresh of every sensor\n", "",
+               transactions ? bytes / transactions * bus.getNbRequests() : 0.0,
+               transactions ? (double)nbCycles * bus.getNbRequests() / transactions : 0.0);
+        printf("%-28s %10.1f ns/poll, worst %.1f us, %llu errors, %d wrong values\n", "",
+               (double)total / nbCycles, worst / 1000.0, (unsigned long long)bus.getNbErrors(), wrong);
+    }
+
+    done = true;
+    simulator.join();
+    close(master);
+    return res;
+}
+
+/**
+ * \brief acquisition of the CACMO sensors on the fake sysfs tree :
+ * map/variant walk and Sensor vector loop.
+ */
+static int benchStatic(unsigned long nbCycles, int nbRounds)
+{
+    char dir[MAX_PATH_LENGTH];
+    if (!makeFakeSysfs(dir, sizeof(dir)))
+        return EXIT_FAILURE;
+    Sensor::setIioPath(dir);
+    SensorFrame frames[2] = {};
+
+    // the map walk of the first CAC::init() / process_sensor() version
+    std::map<int, std::variant<Sensor, Valve>> dict = makeDict<BoardCACMO>();
+    for (auto &[id, value] : dict)
+        if (std::holds_alternative<Sensor>(value))
+            std::get<Sensor>(value).initSensor();
+    auto mapWalk = [&]()
+    {
+        int i = 0;
+        for (auto &[id, value] : dict)
+        {
+            if (id % 10 < 5 || !std::holds_alternative<Sensor>(value))
+                continue;
+            Sensor &sensor = std::get<Sensor>(value);
+            frames[0].sensors[i].status = sensor.readChannel();
+            frames[0].sensors[i++].value = sensor.getValue();
+        }
+    };
+
+    // the dense vector of the runtime CAC
+    std::vector<Sensor> sensors;
+    sensors.reserve(BoardCACMO::sensors.size());
+    for (const SensorDef &def : BoardCACMO::sensors)
+        sensors.emplace_back(def.name, def.id, def.type, def.channel);
+    for (Sensor &sensor : sensors)
+        sensor.initSensor();
+    auto vectorLoop = [&]()
+    {
+        for (size_t i = 0; i < sensors.size(); i++)
+        {
+            frames[1].sensors[i].status = sensors[i].readChannel();
+            frames[1].sensors[i].value = sensors[i].getValue();
+        }
+    };
+
+    // interleaved rounds, the best round of each path is kept
+    uint64_t best[2] = {UINT64_MAX, UINT64_MAX};
+    for (int r = 0; r < nbRounds; r++)
+    {
+        uint64_t t0 = nowNs();
+        for (unsigned long c = 0; c < nbCycles; c++)
+            mapWalk();
+        uint64_t t1 = nowNs();
+        for (unsigned long c = 0; c < nbCycles; c++)
+            vectorLoop();
+        uint64_t t2 = nowNs();
+        best[0] = std::min(best[0], t1 - t0);
+        best[1] = std::min(best[1], t2 - t1);
+    }
+
+    for (auto &[id, value] : dict)
+        if (std::holds_alternative<Sensor>(value))
+            std::get<Sensor>(value).extinctSensor();
+    for (Sensor &sensor : sensors)
+        sensor.extinctSensor();
+    removeFakeSysfs(dir);
+
+    printf("== static : %zu CACMO sensors, best of %d rounds of %lu cycles\n", BoardCACMO::sensors.size(),
+           nbRounds, nbCycles);
+    printf("%-28s %10.1f ns/cycle\n", "map/variant walk", (double)best[0] / nbCycles);
+    printf("%-28s %10.1f ns/cycle\n", "Sensor vector loop", (double)best[1] / nbCycles);
+    bool same = true;
+    for (size_t i = 0; i < BoardCACMO::sensors.size(); i++)
+        same = same && frames[0].sensors[i].value == frames[1].sensors[i].value;
+    if (!same)
+        printf("the two paths read different values\n");
+    return same ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * \brief naive transition : look the EG up in liaisonEGEtat.csv and parse
+ * its state file, as a sequencer reading the files in the loop would do.
+ */
+static bool naiveTransition(const char *dir, const BoardConfig &board, int eg, uint32_t &mask)
+{
+    char path[MAX_PATH_LENGTH];
+    char line[512];
+    snprintf(path, sizeof(path), "%s%s", dir, EG_LINK_FILE);
+    FILE *link = fopen(path, "r");
+    if (!link)
+        return false;
+    char file[MAX_PATH_LENGTH] = "";
+    while (fgets(line, sizeof(line), link))
+    {
+        unsigned int code;
+        char name[256];
+        if (sscanf(line, "%x;%255s", &code, name) == 2 && (int)code == eg)
+        {
+            snprintf(file, sizeof(file), "%s%s", dir, name);
+            break;
+        }
+    }
+    fclose(link);
+    FILE *state = file[0] ? fopen(file, "r") : nullptr;
+    if (!state)
+        return false;
+    mask = 0;
+    while (fgets(line, sizeof(line), state))
+    {
+        char b[64], v[64];
+        int value;
+        if (sscanf(line, "%63[^;];%63[^;];%d", b, v, &value) != 3 || strcmp(b, board.name) != 0)
+            continue;
+        for (int i = 0; i < board.nbValves; i++)
+            if (strcmp(board.valves[i].name, v) == 0 && value)
+                mask |= 1u << i;
+    }
+    fclose(state);
+    return true;
+}
+
+/**
+ * \brief general state transitions of a 12 valve board over nbStates
+ * state files : load time, table lookup and naive file lookup.
+ */
+static int benchSequence(int nbStates, unsigned long nbTransitions)
+{
+    char dir[MAX_PATH_LENGTH];
+    snprintf(dir, sizeof(dir), "/tmp/cac_seq_XXXXXX");
+    if (!mkdtemp(dir))
+        return EXIT_FAILURE;
+    strcat(dir, "/");
+
+    BoardConfig board = {};
+    strcpy(board.name, "BENCH");
+    board.nbValves = MAX_VALVES;
+    for (int v = 0; v < MAX_VALVES; v++)
+        snprintf(board.valves[v].name, PHYS_NAME_LENGTH, "V%02d", v);
+
+    // state s opens the valves of the bits of s * 2654435761
+    char path[MAX_PATH_LENGTH];
+    snprintf(path, sizeof(path), "%s%s", dir, EG_LINK_FILE);
+    FILE *link = fopen(path, "w");
+    for (int st = 0; st < nbStates && link; st++)
+    {
+        fprintf(link, "0x%04X;etat_%d.csv\n", EG_MIN + st, st);
+        snprintf(path, sizeof(path), "%setat_%d.csv", dir, st);
+        FILE *f = fopen(path, "w");
+        if (!f)
+            break;
+        uint32_t bits = (uint32_t)st * 2654435761u;
+        fprintf(f, "board;valve;value\n");
+        for (int v = 0; v < MAX_VALVES; v++)
+            fprintf(f, "BENCH;V%02d;%u\n", v, (bits >> v) & 1);
+        fclose(f);
+    }
+    if (link)
+        fclose(link);
+
+    Sequencer sequencer;
+    uint64_t t0 = nowNs();
+    statusErrDef res = sequencer.load(board, dir);
+    uint64_t loadNs = nowNs() - t0;
+
+    // transition : lookup, then the commands of every valve as CAC::setCommands() does
+    uint8_t commands[MAX_VALVES];
+    uint64_t worst = 0;
+    uint64_t total = 0;
+    unsigned long wrong = 0;
+    uint32_t x = 12345;
+    for (unsigned long i = 0; i < nbTransitions; i++)
+    {
+        x = x * 1103515245u + 12345u;
+        int st = (x >> 8) % nbStates;
+        uint32_t mask = 0;
+        uint64_t t1 = nowNs();
+        statusErrDef sel = sequencer.select((uint16_t)(EG_MIN + st), mask);
+        for (int v = 0; v < MAX_VALVES; v++)
+            commands[v] = (mask >> v) & 1;
+        uint64_t ns = nowNs() - t1;
+        total += ns;
+        if (ns > worst)
+            worst = ns;
+        uint32_t expected = ((uint32_t)st * 2654435761u) & ((1u << MAX_VALVES) - 1);
+        if ((sel != infoCSVChanged && sel != infoEGNotChanged) || mask != expected || commands[0] != (expected & 1))
+            wrong++;
+    }
+
+    unsigned long nbNaive = nbTransitions / 100;
+    uint64_t naiveTotal = 0;
+    for (unsigned long i = 0; i < nbNaive; i++)
+    {
+        x = x * 1103515245u + 12345u;
+        int st = (x >> 8) % nbStates;
+        uint32_t mask = 0;
+        uint64_t t1 = nowNs();
+        if (!naiveTransition(dir, board, EG_MIN + st, mask))
+            wrong++;
+        naiveTotal += nowNs() - t1;
+    }
+
+    std::string cmd = std::string("rm -rf ") + dir;
+    if (system(cmd.c_str()) != 0)
+        perror(cmd.c_str());
+
+    printf("== sequence : %d general states, %d valves\n", nbStates, MAX_VALVES);
+    printf("%-28s %10.1f ms for %d states\n", "load", loadNs / 1e6, sequencer.getNbStates());
+    printf("%-28s %10.1f ns/transition, worst %.1f us, %lu wrong\n", "table lookup",
+           (double)total / nbTransitions, worst / 1000.0, wrong);
+    printf("%-28s %10.1f ns/transition\n", "files read per transition", nbNaive ? (double)naiveTotal / nbNaive : 0.0);
+    return (res == noError && !wrong) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * \brief previous reader : fgets in a fixed line buffer, strtok_r and strtol.
+ * Returns the number of rows and the sum of the value fields.
+ */
+static long legacyParse(const char *path, long &sum)
+{
+    FILE *file = fopen(path, "r");
+    if (!file)
+        return -1;
+    char line[512];
+    long nbRows = 0;
+    sum = 0;
+    while (fgets(line, sizeof(line), file))
+    {
+        line[strcspn(line, "\r\n")] = 0;
+        if (line[0] == 0 || line[0] == '#' || strncmp(line, "board", 5) == 0)
+            continue;
+        char *fields[4];
+        char *save = nullptr;
+        int n = 0;
+        for (char *tok = strtok_r(line, ";,", &save); tok && n < 4; tok = strtok_r(nullptr, ";,", &save))
+            fields[n++] = tok;
+        char *end;
+        long v = n == 3 ? strtol(fields[2], &end, 10) : 0;
+        if (n != 3 || *end != 0)
+            continue;
+        char board[SHM_NAME_LENGTH], valve[PHYS_NAME_LENGTH];
+        strncpy(board, fields[0], sizeof(board) - 1);
+        strncpy(valve, fields[1], sizeof(valve) - 1);
+        sum += v;
+        nbRows++;
+    }
+    fclose(file);
+    return nbRows;
+}
+
+/**
+ * \brief mapped reader of csvReader : string_view fields and from_chars.
+ */
+static long mappedParse(const char *path, long &sum)
+{
+    CsvFile file;
+    if (!file.open(path))
+        return -1;
+    CsvArena arena;
+    LigneCSV *rows = arena.alloc<LigneCSV>(file.countLines());
+    if (!rows)
+        return -1;
+    std::string_view line;
+    long nbRows = 0;
+    sum = 0;
+    while (file.nextLine(line, "board"))
+    {
+        std::string_view fields[3];
+        LigneCSV &row = rows[nbRows];
+        if (csvSplitFields(line, fields, 3) != 3 || !csvToInt(fields[2], row.value))
+            continue;
+        row.board = fields[0];
+        row.valve = fields[1];
+        sum += row.value;
+        nbRows++;
+    }
+    return nbRows;
+}
+
+/**
+ * \brief parse throughput on generated general state files of megaBytes
+ * each : previous fgets reader, mapped reader, and Sequencer::load of
+ * nbFiles of them. Best of nbRounds, the files are in the page cache.
+ */
+static int benchCsv(int megaBytes, int nbFiles, int nbRounds)
+{
+    char dir[MAX_PATH_LENGTH];
+    snprintf(dir, sizeof(dir), "/tmp/cac_csv_XXXXXX");
+    if (!mkdtemp(dir))
+        return EXIT_FAILURE;
+    strcat(dir, "/");
+
+    BoardConfig board = {};
+    strcpy(board.name, "BENCH");
+    board.nbValves = MAX_VALVES;
+    for (int v = 0; v < MAX_VALVES; v++)
+        snprintf(board.valves[v].name, PHYS_NAME_LENGTH, "V%02d", v);
+
+    // every file repeats the 12 valves, the last occurrence of a valve wins
+    char path[MAX_PATH_LENGTH];
+    snprintf(path, sizeof(path), "%s%s", dir, EG_LINK_FILE);
+    FILE *link = fopen(path, "w");
+    size_t fileBytes = 0;
+    long expectedSum = 0;
+    for (int f = 0; f < nbFiles && link; f++)
+    {
+        fprintf(link, "0x%04X;etat_%d.csv\n", EG_MIN + f, f);
+        snprintf(path, sizeof(path), "%setat_%d.csv", dir, f);
+        FILE *out = fopen(path, "w");
+        if (!out)
+            break;
+        fileBytes = (size_t)fprintf(out, "board;valve;value\n");
+        long sum = 0;
+        for (uint32_t x = (uint32_t)f + 1; fileBytes < (size_t)megaBytes << 20;)
+        {
+            for (int v = 0; v < MAX_VALVES; v++)
+            {
+                x = x * 1103515245u + 12345u;
+                int value = (x >> 16) & 1;
+                fileBytes += (size_t)fprintf(out, "BENCH;V%02d;%d\n", v, value);
+                sum += value;
+            }
+        }
+        fclose(out);
+        if (f == 0)
+            expectedSum = sum;
+    }
+    if (link)
+        fclose(link);
+    snprintf(path, sizeof(path), "%setat_0.csv", dir);
+
+    uint64_t legacyBest = UINT64_MAX, mappedBest = UINT64_MAX, loadBest = UINT64_MAX;
+    long legacyRows = 0, mappedRows = 0, legacySum = 0, mappedSum = 0;
+    statusErrDef res = noError;
+    int nbStates = 0;
+    for (int round = 0; round < nbRounds; round++)
+    {
+        uint64_t t0 = nowNs();
+        legacyRows = legacyParse(path, legacySum);
+        uint64_t t1 = nowNs();
+        mappedRows = mappedParse(path, mappedSum);
+        uint64_t t2 = nowNs();
+        Sequencer sequencer;
+        res = sequencer.load(board, dir);
+        uint64_t t3 = nowNs();
+        nbStates = sequencer.getNbStates();
+        legacyBest = std::min(legacyBest, t1 - t0);
+        mappedBest = std::min(mappedBest, t2 - t1);
+        loadBest = std::min(loadBest, t3 - t2);
+    }
+
+    std::string cmd = std::string("rm -rf ") + dir;
+    if (system(cmd.c_str()) != 0)
+        perror(cmd.c_str());
+
+    double mb = fileBytes / 1048576.0;
+    printf("== csv : %.1f MB state file, %ld rows, best of %d\n", mb, mappedRows, nbRounds);
+    printf("%-28s %10.1f ms, %7.1f MB/s\n", "fgets + strtok + strtol", legacyBest / 1e6, mb / (legacyBest / 1e9));
+    printf("%-28s %10.1f ms, %7.1f MB/s\n", "mmap + string_view", mappedBest / 1e6, mb / (mappedBest / 1e9));
+    printf("%-28s %10.1f ms, %7.1f MB/s for %d files\n", "Sequencer::load", loadBest / 1e6,
+           nbFiles * mb / (loadBest / 1e9), nbStates);
+    bool same = legacyRows == mappedRows && legacySum == expectedSum && mappedSum == expectedSum;
+    if (!same)
+        printf("mismatch : %ld/%ld rows, sums %ld/%ld expected %ld\n", legacyRows, mappedRows, legacySum, mappedSum,
+               expectedSum);
+    return (res == noError && same && nbStates == nbFiles) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * \brief interlock rule as written in activation.csv, for the reference evaluator
+ */
+struct BenchRule
+{
+    int valve;
+    char kind; /**< 'o' open, 'c' closed, 'b' below, 'a' above */
+    int target;
+    int threshold;
+};
+
+/**
+ * \brief reference evaluator : every rule read one by one, the same
+ * simultaneous passes as Interlock::filter() until the mask is stable.
+ */
+static uint32_t referenceFilter(const std::vector<BenchRule> &rules, uint32_t commanded, uint32_t applied,
+                                const SensorFrame &frame)
+{
+    uint32_t allowed = commanded;
+    while (true)
+    {
+        uint32_t next = allowed;
+        for (const BenchRule &r : rules)
+        {
+            const SensorSample &s = frame.sensors[r.target];
+            bool holds = true;
+            if (r.kind == 'o')
+                holds = (applied & allowed) >> r.target & 1;
+            else if (r.kind == 'c')
+                holds = !((applied | allowed) >> r.target & 1);
+            else
+                holds = s.status == noError && (r.kind == 'b' ? s.value < r.threshold : s.value > r.threshold);
+            if (!holds)
+                next &= ~(1u << r.valve);
+        }
+        if (next == allowed)
+            return allowed;
+        allowed = next;
+    }
+}
+
+/**
+ * \brief interlock of a 12 valve board : random commands, valve states
+ * and sensor values checked against the reference evaluator and the
+ * rules themselves, then the cost of Interlock::filter() per cycle.
+ */
+static int benchInterlock(unsigned long nbChecks, unsigned long nbCycles)
+{
+    char dir[MAX_PATH_LENGTH];
+    snprintf(dir, sizeof(dir), "/tmp/cac_lock_XXXXXX");
+    if (!mkdtemp(dir))
+        return EXIT_FAILURE;
+
+    BoardConfig board = {};
+    strcpy(board.name, "BENCH");
+    board.nbValves = MAX_VALVES;
+    board.nbSensors = MAX_SENSORS;
+    for (int v = 0; v < MAX_VALVES; v++)
+        snprintf(board.valves[v].name, PHYS_NAME_LENGTH, "V%02d", v);
+    for (int i = 0; i < MAX_SENSORS; i++)
+        snprintf(board.sensors[i].name, PHYS_NAME_LENGTH, "S%02d", i);
+
+    // chains, exclusions and thresholds over every valve but V00
+    const std::vector<BenchRule> rules = {
+        {1, 'o', 0, 0}, {2, 'o', 1, 0}, {2, 'b', 0, 600}, {3, 'c', 2, 0}, {4, 'a', 1, 200},
+        {5, 'o', 4, 0}, {5, 'c', 3, 0}, {6, 'b', 2, 800}, {7, 'o', 6, 0}, {7, 'a', 3, 100},
+        {8, 'o', 0, 0}, {8, 'o', 7, 0}, {9, 'c', 8, 0}, {10, 'b', 4, 512}, {10, 'o', 9, 0},
+        {11, 'o', 10, 0}, {11, 'b', 0, 600},
+    };
+    char path[MAX_PATH_LENGTH];
+    FILE *f = fakePath(path, sizeof(path), dir, "/" ACTIVATION_FILE) ? fopen(path, "w") : nullptr;
+    if (!f)
+        return EXIT_FAILURE;
+    fprintf(f, "board;valve;condition;target;threshold\n");
+    for (const BenchRule &r : rules)
+    {
+        if (r.kind == 'o' || r.kind == 'c')
+            fprintf(f, "BENCH;V%02d;%s;V%02d;\n", r.valve, r.kind == 'o' ? "open" : "closed", r.target);
+        else
+            fprintf(f, "BENCH;V%02d;%s;S%02d;%d\n", r.valve, r.kind == 'b' ? "below" : "above", r.target, r.threshold);
+    }
+    fclose(f);
+
+    Interlock interlock;
+    statusErrDef res = interlock.load(board, path);
+    std::string cmd = std::string("rm -rf ") + dir;
+    if (system(cmd.c_str()) != 0)
+        perror(cmd.c_str());
+
+    // properties : allowed within commanded, every rule of an allowed
+    // valve holds, same mask as the reference, status consistent
+    const uint32_t all = (1u << MAX_VALVES) - 1;
+    uint32_t x = 2463534242u;
+    auto next = [&x]()
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        return x;
+    };
+    unsigned long wrong = 0, refusedChecks = 0;
+    SensorFrame frame = {};
+    for (unsigned long i = 0; i < nbChecks; i++)
+    {
+        uint32_t commanded = next() & all;
+        uint32_t applied = next() & all;
+        for (int s = 0; s < MAX_SENSORS; s++)
+        {
+            frame.sensors[s].value = (int16_t)(next() % 1024);
+            frame.sensors[s].status = (next() % 64) ? noError : errReadAdc;
+        }
+        uint32_t allowed;
+        statusErrDef st = interlock.filter(commanded, applied, frame, allowed);
+        uint32_t expected = referenceFilter(rules, commanded, applied, frame);
+        bool ok = allowed == expected && (allowed & ~commanded) == 0;
+        for (const BenchRule &r : rules)
+            if ((allowed >> r.valve) & 1 && referenceFilter({r}, 1u << r.valve | allowed, applied, frame) != (1u << r.valve | allowed))
+                ok = false;
+        bool refused = allowed != commanded;
+        ok = ok && (refused ? (st == infoAllDependNotActivated || st == errGPIODependValue) : st == infoVerifDependSucess);
+        ok = ok && interlock.getRefusedMask() == (commanded & ~allowed);
+        refusedChecks += refused;
+        wrong += !ok;
+    }
+
+    // cost per cycle over precomputed inputs
+    const int nbInputs = 256;
+    std::vector<uint32_t> commands(nbInputs), states(nbInputs);
+    std::vector<SensorFrame> frames(nbInputs);
+    for (int i = 0; i < nbInputs; i++)
+    {
+        commands[i] = next() & all;
+        states[i] = next() & all;
+        frames[i] = {};
+        for (int s = 0; s < MAX_SENSORS; s++)
+            frames[i].sensors[s].value = (int16_t)(next() % 1024);
+    }
+    uint32_t sink = 0;
+    uint64_t t0 = nowNs();
+    for (unsigned long i = 0; i < nbCycles; i++)
+    {
+        uint32_t allowed;
+        int k = i & (nbInputs - 1);
+        interlock.filter(commands[k], states[k], frames[k], allowed);
+        sink += allowed;
+    }
+    uint64_t filterNs = nowNs() - t0;
+
+    // steady cycles : the commands already applied and allowed
+    for (int i = 0; i < nbInputs; i++)
+    {
+        interlock.filter(commands[i], states[i], frames[i], commands[i]);
+        states[i] = commands[i];
+    }
+    t0 = nowNs();
+    for (unsigned long i = 0; i < nbCycles; i++)
+    {
+        uint32_t allowed;
+        int k = i & (nbInputs - 1);
+        interlock.filter(commands[k], states[k], frames[k], allowed);
+        sink += allowed;
+    }
+    uint64_t steadyNs = nowNs() - t0;
+
+    Interlock empty;
+    t0 = nowNs();
+    for (unsigned long i = 0; i < nbCycles; i++)
+    {
+        uint32_t allowed;
+        int k = i & (nbInputs - 1);
+        empty.filter(commands[k], states[k], frames[k], allowed);
+        sink += allowed;
+    }
+    uint64_t emptyNs = nowNs() - t0;
+
+    printf("== interlock : %d valves, %d rules, sink %u\n", MAX_VALVES, interlock.getNbRules(), sink & 1);
+    printf("%-28s %10lu checks, %lu with refused valves, %lu wrong\n", "properties", nbChecks, refusedChecks, wrong);
+    printf("%-28s %10.1f ns/cycle\n", "filter, random commands", (double)filterNs / nbCycles);
+    printf("%-28s %10.1f ns/cycle\n", "filter, steady commands", (double)steadyNs / nbCycles);
+    printf("%-28s %10.1f ns/cycle\n", "filter, no rule", (double)emptyNs / nbCycles);
+    return (res == noError && !wrong) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * \brief stand-in MN of the opl scenario : answers every TPDO with an
+ * RPDO, the valve bits being the first sensor value, and checks that
+ * every TPDO carries the pattern published by the CN.
+ */
+static void udpMn(int fd, uint8_t node, std::atomic<bool> &done, std::atomic<unsigned long> &wrong)
+{
+    uint32_t seq = 0;
+    while (!done.load())
+    {
+        pollfd p = {fd, POLLIN, 0};
+        if (poll(&p, 1, 10) <= 0)
+            continue;
+        OplFrameHeader header;
+        PiIn in;
+        iovec rx[2] = {{&header, sizeof(header)}, {&in, sizeof(in)}};
+        msghdr msg = {};
+        sockaddr_in from = {};
+        msg.msg_name = &from;
+        msg.msg_namelen = sizeof(from);
+        msg.msg_iov = rx;
+        msg.msg_iovlen = 2;
+        if (recvmsg(fd, &msg, 0) != (ssize_t)(sizeof(header) + sizeof(in)) || header.node != node)
+        {
+            wrong++;
+            continue;
+        }
+        for (int i = 1; i < MAX_SENSORS; i++)
+            if (in.sensors[i] != (int16_t)(in.sensors[0] + i))
+                wrong++;
+
+        PiOut out = {};
+        out.generalState = EG_MIN;
+        out.valveCommands = (uint16_t)in.sensors[0] & ((1u << MAX_VALVES) - 1);
+        OplFrameHeader reply = {OPL_FRAME_MAGIC, node, OPL_FRAME_OUT, OPL_PI_OUT_WORDS, ++seq};
+        iovec tx[2] = {{&reply, sizeof(reply)}, {&out, sizeof(out)}};
+        msg.msg_iov = tx;
+        if (sendmsg(fd, &msg, 0) < 0)
+            wrong++;
+    }
+}
+
+/**
+ * \brief process image exchange of a 12 sensor, 12 valve board : cost of
+ * sync() with the loopback MN, then with a stand-in MN over UDP on the
+ * loopback interface. Every image is checked against the tables.
+ */
+static int benchOpl(unsigned long nbCycles, unsigned long nbUdpCycles)
+{
+    SensorData *sensors = new SensorData();
+    VanneData *vannes = new VanneData();
+    mode = manual;
+
+    // loopback : the MN sends every cycle and changes its image every 100 cycles
+    LoopbackTransport loopback;
+    ProcessImage image;
+    statusErrDef res = image.link(sensors, MAX_SENSORS, vannes, MAX_VALVES, &loopback);
+    unsigned long wrong = 0;
+    uint64_t total = 0;
+    for (unsigned long c = 0; c < nbCycles; c++)
+    {
+        for (int i = 0; i < MAX_SENSORS; i++)
+            sensors->frame.sensors[i].value = (int16_t)(c + i);
+        for (int i = 0; i < MAX_VALVES; i++)
+            vannes->frame.vannes[i].state = (uint8_t)((c >> i) & 1);
+        uint16_t bits = (uint16_t)((c / 100 * 2654435761u) & ((1u << MAX_VALVES) - 1));
+        PiOut out = {};
+        out.generalState = (uint16_t)(EG_MIN + c / 100 % 16);
+        out.valveCommands = bits;
+        loopback.setOut(out);
+        uint64_t t0 = nowNs();
+        image.sync();
+        total += nowNs() - t0;
+
+        const PiIn &in = loopback.getIn();
+        bool ok = in.valveStates == (uint16_t)(c & ((1u << MAX_VALVES) - 1));
+        for (int i = 0; i < MAX_SENSORS; i++)
+            ok = ok && in.sensors[i] == (int16_t)(c + i);
+        for (int i = 0; i < MAX_VALVES; i++)
+            ok = ok && vannes->commands[i] == ((bits >> i) & 1);
+        ok = ok && vannes->generalState == EG_MIN + c / 100 % 16;
+        wrong += !ok;
+    }
+
+    // UDP : the MN answers each TPDO, the CN runs a cycle every 200 us
+    int mnFd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (mnFd < 0 || bind(mnFd, (const sockaddr *)&addr, sizeof(addr)) < 0 ||
+        getsockname(mnFd, (sockaddr *)&addr, &len) < 0)
+        return EXIT_FAILURE;
+    std::atomic<bool> done(false);
+    std::atomic<unsigned long> mnWrong(0);
+    std::thread mn(udpMn, mnFd, 1, std::ref(done), std::ref(mnWrong));
+
+    UdpTransport udp(1, "127.0.0.1", ntohs(addr.sin_port));
+    ProcessImage udpImage;
+    statusErrDef udpRes = udpImage.link(sensors, MAX_SENSORS, vannes, MAX_VALVES, &udp);
+    uint64_t udpTotal = 0, udpWorst = 0;
+    unsigned long udpSyscalls = 0, stale = 0;
+    for (unsigned long c = 0; c < nbUdpCycles && udpRes == noError; c++)
+    {
+        for (int i = 0; i < MAX_SENSORS; i++)
+            sensors->frame.sensors[i].value = (int16_t)(c + i);
+        unsigned long s0 = nbSyscalls;
+        uint64_t t0 = nowNs();
+        udpImage.sync();
+        uint64_t ns = nowNs() - t0;
+        udpSyscalls += nbSyscalls - s0;
+        udpTotal += ns;
+        udpWorst = std::max(udpWorst, ns);
+        // the answer to the previous TPDO drives the commands
+        uint16_t expected = (uint16_t)((c - 1) & ((1u << MAX_VALVES) - 1));
+        if (c > 0)
+        {
+            uint16_t got = 0;
+            for (int i = 0; i < MAX_VALVES; i++)
+                got |= (uint16_t)(vannes->commands[i] << i);
+            stale += got != expected;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    done = true;
+    mn.join();
+    ::close(mnFd);
+
+    printf("== opl : PI_IN %zu bytes, PI_OUT %zu bytes, %d sensors, %d valves\n", sizeof(PiIn), sizeof(PiOut),
+           MAX_SENSORS, MAX_VALVES);
+    printf("%-28s %10.1f ns/cycle, %lu wrong\n", "sync, loopback MN", (double)total / nbCycles, wrong);
+    printf("%-28s %10.1f us/cycle, worst %.1f us, %.1f syscalls/cycle\n", "sync, UDP MN",
+           udpTotal / 1000.0 / nbUdpCycles, udpWorst / 1000.0, (double)udpSyscalls / nbUdpCycles);
+    printf("%-28s %10lu/%lu cycles without the previous answer, %lu wrong at the MN, %lu invalid\n",
+           "UDP exchange", stale, nbUdpCycles, mnWrong.load(), (unsigned long)udp.getNbInvalid());
+    delete sensors;
+    delete vannes;
+    return (res == noError && udpRes == noError && !wrong && !mnWrong) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * \brief board RIG<b> of the multi-board bench : the 8 MCP3008 channels
+ * of the fake sysfs tree and 8 valves on the GPIO chip.
+ */
+static BoardConfig rigBoard(int b)
+{
+    BoardConfig board = {};
+    snprintf(board.name, SHM_NAME_LENGTH, "RIG%d", b);
+    board.id = (uint8_t)(b + 1);
+    board.nbSensors = MAX_ADC;
+    for (int c = 0; c < MAX_ADC; c++)
+    {
+        SensorSlot &slot = board.sensors[c];
+        snprintf(slot.name, PHYS_NAME_LENGTH, "PR-%02d", c);
+        slot.id = (uint8_t)(board.id * 10 + 5 + c);
+        slot.type = 1;
+        slot.channel = c;
+    }
+    board.nbValves = 8;
+    for (int v = 0; v < board.nbValves; v++)
+    {
+        ValveSlot &slot = board.valves[v];
+        snprintf(slot.name, PHYS_NAME_LENGTH, "V%02d", v);
+        slot.id = (uint8_t)(board.id * 10 + v % 5);
+        slot.pin = 8 * b + v;
+    }
+    return board;
+}
+
+/**
+ * \brief reader process of the shm scenario : maps the sensor segment of
+ * a board by its name, checks its header then reads frames until nbFrames
+ * new cycles were seen.
+ *
+ * \return exit code, 0 when every check passed
+ */
+static int shmReader(const BoardConfig &board, unsigned long nbFrames, unsigned long &torn)
+{
+    std::string shmName = std::string(SHM_Sensor) + "_" + board.name;
+    int fd = shm_open(shmName.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+        return 1;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size != (off_t)sizeof(SensorData))
+        return 2;
+    const SensorData *data = (const SensorData *)mmap(0, sizeof(SensorData), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return 1;
+
+    const ShmHeader &header = data->header;
+    if (__atomic_load_n(&header.magic, __ATOMIC_ACQUIRE) != SHM_LAYOUT_MAGIC || header.version != SHM_LAYOUT_VERSION ||
+        header.headerSize != sizeof(ShmHeader) || header.totalSize != sizeof(SensorData) ||
+        header.boardId != board.id || header.count != board.nbSensors || strcmp(header.boardName, board.name) != 0)
+        return 2;
+
+    // a frame is consistent when every sample was produced by its cycle
+    SensorFrame frame;
+    uint64_t last = 0;
+    unsigned long seen = 0;
+    uint64_t deadline = nowNs() + 5000000000ull;
+    while (seen < nbFrames && nowNs() < deadline)
+    {
+        if (!seqlockRead(&data->seq, &data->frame, frame) || frame.cycle == last)
+            continue;
+        if (frame.cycle < last)
+            torn++;
+        for (int s = 0; s < board.nbSensors; s++)
+            if (frame.sensors[s].seq != (uint32_t)frame.cycle || frame.sensors[s].timestamp > frame.timestamp)
+            {
+                torn++;
+                break;
+            }
+        last = frame.cycle;
+        seen++;
+    }
+    return seen < nbFrames ? 4 : torn ? 3 : 0;
+}
+
+/**
+ * \brief sensor segment read by another process, as a client of the
+ * board does : header, size and seqlock-consistent frames. A board whose
+ * segments can't be created reports it and publishes nothing.
+ */
+static int benchShm(unsigned long nbFrames)
+{
+    BoardConfig board = rigBoard(0);
+    strcpy(board.name, "SHMB");
+    HalConfig hal;
+    statusErrDef halRes = halParse("adc=sim,noise=3,gpio=sim", hal);
+    if (halRes == noError)
+        halRes = halSelect(hal);
+
+    int status = -1;
+    unsigned long nbAcq = 0, wrong = 0;
+    statusErrDef initRes = noError;
+    if (halRes == noError)
+    {
+        CAC cac(board.name, board.id);
+        initRes = cac.init(board);
+        pid_t child = initRes == noError ? fork() : -1;
+        if (child == 0)
+        {
+            unsigned long torn = 0;
+            _exit(shmReader(board, nbFrames, torn));
+        }
+        while (child > 0 && waitpid(child, &status, WNOHANG) == 0)
+        {
+            cac.acquire();
+            nbAcq++;
+            usleep(100);
+        }
+    }
+
+    // a name the segments can't take : errors, never a null dereference
+    statusErrDef badInit = errOpenValveShm, badAcq = errOpenSensorShm, badAct = errOpenValveShm;
+    if (halRes == noError)
+    {
+        CAC bad("BAD/NAME", 9);
+        BoardConfig badBoard = board;
+        strcpy(badBoard.name, "BAD/NAME");
+        badInit = bad.init(badBoard);
+        badAcq = bad.acquire();
+        badAct = bad.actuate();
+        wrong += bad.tab_sensors != nullptr || bad.tab_vannes != nullptr;
+    }
+    halSelect(HalConfig());
+    wrong += badInit != errOpenValveShm || badAcq != errOpenSensorShm || badAct != errOpenValveShm;
+
+    int code = (status >= 0 && WIFEXITED(status)) ? WEXITSTATUS(status) : -1;
+    const char *verdict[] = {"ok", "segment not opened", "wrong header or size", "torn frames", "timeout"};
+    printf("== shm : sensor segment of %s read by another process, %lu frames\n", board.name, nbFrames);
+    printf("%-28s %10lu acquisitions, reader %s\n", "reader process", nbAcq,
+           code >= 0 && code <= 4 ? verdict[code] : "killed");
+    printf("%-28s %10s init 0x%x, acquire 0x%x, actuate 0x%x\n", "segments not created", "", badInit, badAcq,
+           badAct);
+    printf("%-28s %10lu wrong\n", "checks", wrong);
+    return (halRes == noError && initRes == noError && code == 0 && !wrong) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * \brief function to pin the calling thread, as the executive of a worker does.
+ */
+static void pinThread(int cpu)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+/**
+ * \brief whole-rig throughput : nbBoards boards of the orchestrator on the
+ * fake sysfs tree and the simulated GPIO lines, stepped by one thread, then by one
+ * thread per board pinned to its own CPU, then run on the common cycle
+ * clock by their executives.
+ */
+static int benchMulti(int nbBoards, unsigned long nbSteps, long periodUs, int runMs)
+{
+    // the valves of every board on the simulated lines, the sensors on the fake sysfs tree
+    HalConfig hal;
+    statusErrDef res = halParse("gpio=sim", hal);
+    if (res == noError)
+        res = halSelect(hal);
+    if (res != noError)
+        return EXIT_FAILURE;
+
+    char dir[MAX_PATH_LENGTH];
+    if (!makeFakeSysfs(dir, sizeof(dir)))
+    {
+        halSelect(HalConfig());
+        return EXIT_FAILURE;
+    }
+    Sensor::setIioPath(dir);
+
+    // the general states and the interlock rules of every board, next to the fake sysfs files
+    char path[MAX_PATH_LENGTH];
+    FILE *link = fakePath(path, sizeof(path), dir, EG_LINK_FILE) ? fopen(path, "w") : nullptr;
+    FILE *rest = fakePath(path, sizeof(path), dir, "etat_0.csv") ? fopen(path, "w") : nullptr;
+    FILE *open = fakePath(path, sizeof(path), dir, "etat_1.csv") ? fopen(path, "w") : nullptr;
+    FILE *rules = fakePath(path, sizeof(path), dir, ACTIVATION_FILE) ? fopen(path, "w") : nullptr;
+    if (!link || !rest || !open || !rules)
+        return EXIT_FAILURE;
+    fprintf(link, "0x%04X;etat_0.csv\n0x%04X;etat_1.csv\n", EG_MIN, EG_MIN + 1);
+    for (int b = 0; b < nbBoards; b++)
+    {
+        for (int v = 0; v < 8; v++)
+        {
+            fprintf(rest, "RIG%d;V%02d;0\n", b, v);
+            fprintf(open, "RIG%d;V%02d;%d\n", b, v, v % 2);
+        }
+        fprintf(rules, "RIG%d;V03;open;V01;\nRIG%d;V05;below;PR-07;1000\n", b, b);
+    }
+    fclose(link);
+    fclose(rest);
+    fclose(open);
+    fclose(rules);
+
+    int nbCpus = (int)std::thread::hardware_concurrency();
+    if (nbCpus < 1)
+        nbCpus = 1;
+    WorkerConfig worker;
+    worker.periodUs = periodUs;
+    worker.priority = 0;
+    worker.lockMemory = false;
+    worker.csvDir = dir;
+    worker.telemetry = false;
+    Orchestrator rig;
+    for (int b = 0; b < nbBoards; b++)
+    {
+        BoardConfig board = rigBoard(b);
+        worker.cpu = b % nbCpus;
+        statusErrDef add = rig.add(board.name, board.id, &board, worker);
+        if (add != noError)
+            res = add;
+    }
+
+    // the segments are named after the boards
+    bool named = true;
+    for (int b = 0; b < nbBoards; b++)
+    {
+        snprintf(path, sizeof(path), "/dev/shm/sensor_shm_RIG%d", b);
+        named = named && access(path, F_OK) == 0;
+        snprintf(path, sizeof(path), "/dev/shm/vanne_shm_RIG%d", b);
+        named = named && access(path, F_OK) == 0;
+    }
+
+    // the general state of every board alternates every 1000 cycles
+    auto stepBoard = [&](int b, unsigned long c)
+    {
+        BoardWorker &board = rig.getBoard(b);
+        if (c % 1000 == 0)
+            __atomic_store_n(&board.getCac().tab_vannes->generalState, (uint16_t)(EG_MIN + c / 1000 % 2),
+                             __ATOMIC_RELEASE);
+        board.step();
+    };
+
+    uint64_t t0 = nowNs();
+    for (unsigned long c = 0; c < nbSteps; c++)
+        for (int b = 0; b < nbBoards; b++)
+            stepBoard(b, c);
+    uint64_t serialNs = nowNs() - t0;
+
+    // the threads wait on a latch, none of them spins while another is still being pinned
+    std::vector<std::thread> threads;
+    std::latch ready(nbBoards);
+    std::latch go(1);
+    for (int b = 0; b < nbBoards; b++)
+        threads.emplace_back([&, b]()
+                             {
+            pinThread(b % nbCpus);
+            ready.count_down();
+            go.wait();
+            for (unsigned long c = 0; c < nbSteps; c++)
+                stepBoard(b, c); });
+    ready.wait();
+    t0 = nowNs();
+    go.count_down();
+    for (std::thread &t : threads)
+        t.join();
+    uint64_t parallelNs = nowNs() - t0;
+
+    // every board of the rig on its executive, EG 0x1001 : the odd valves open but V03 waits for V01
+    unsigned long wrong = 0;
+    for (int b = 0; b < nbBoards; b++)
+        __atomic_store_n(&rig.getBoard(b).getCac().tab_vannes->generalState, (uint16_t)(EG_MIN + 1),
+                         __ATOMIC_RELEASE);
+    rig.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(runMs));
+    rig.stop();
+    for (int b = 0; b < nbBoards; b++)
+        wrong += rig.getBoard(b).getCac().getValveMask() != 0xAA || rig.getBoard(b).getMode() != automatic;
+
+    printf("== multi : %d boards of %d sensors and 8 valves, %d CPUs\n", nbBoards, MAX_ADC, nbCpus);
+    double serialRate = (double)nbSteps * nbBoards / (serialNs / 1e9);
+    double parallelRate = (double)nbSteps * nbBoards / (parallelNs / 1e9);
+    printf("%-28s %10.0f board cycles/s, %.1f us/board cycle\n", "one thread", serialRate,
+           serialNs / 1000.0 / nbSteps / nbBoards);
+    printf("%-28s %10.0f board cycles/s, x%.2f (at most x%d)\n", "one pinned thread per board", parallelRate,
+           parallelRate / serialRate, std::min(nbBoards, nbCpus));
+    int64_t worstJitter = 0;
+    for (int b = 0; b < nbBoards; b++)
+    {
+        CycleStats stats;
+        if (!rig.getBoard(b).getExecutive().getStats(stats) || stats.cycles == 0)
+        {
+            wrong++;
+            continue;
+        }
+        printf("%-28s %10llu cycles of %ld us, %llu overruns, jitter mean %.1f us max %.1f us\n",
+               ("executive " + rig.getBoard(b).getName()).c_str(), (unsigned long long)stats.cycles, periodUs,
+               (unsigned long long)stats.overruns, (double)stats.sumJitterNs / stats.cycles / 1000.0,
+               stats.maxJitterNs / 1000.0);
+        worstJitter = std::max(worstJitter, stats.maxJitterNs);
+    }
+    printf("%-28s %10s, %lu boards with wrong valves\n", "segments", named ? "per board" : "missing", wrong);
+
+    halSelect(HalConfig());
+    std::string cmd = std::string("rm -rf ") + dir;
+    if (system(cmd.c_str()) != 0)
+        perror(cmd.c_str());
+    return (res == noError && named && !wrong) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * \brief backends : cost of a sample on the fake sysfs tree and on the
+ * simulated ADC, accuracy of the simulated latency, fault rate and noise
+ * bounds, waveform playback, then three boards of the orchestrator at a
+ * high cycle rate on the simulated ADC and GPIO lines.
+ */
+static int benchHal(unsigned long nbReads, long periodUs, int runMs)
+{
+    char dir[MAX_PATH_LENGTH];
+    if (!makeFakeSysfs(dir, sizeof(dir)))
+        return EXIT_FAILURE;
+    Sensor::setIioPath(dir);
+    unsigned long wrong = 0;
+
+    // one channel of each backend, read through the Sensor driver
+    auto perSample = [&](const char *spec, uint64_t &ns, unsigned long &syscalls, unsigned long &errors)
+    {
+        HalConfig config;
+        if (halParse(spec, config) != noError || halSelect(config) != noError)
+            return false;
+        Sensor sensor("PR-07", 22, 1, 7);
+        if (sensor.initSensor() != noError)
+            return false;
+        errors = 0;
+        unsigned long s0 = nbSyscalls;
+        uint64_t t0 = nowNs();
+        for (unsigned long i = 0; i < nbReads; i++)
+            errors += sensor.readChannel() != noError;
+        ns = nowNs() - t0;
+        syscalls = nbSyscalls - s0;
+        sensor.extinctSensor();
+        return true;
+    };
+    uint64_t sysfsNs = 0, simNs = 0, latencyNs = 0, faultNs = 0;
+    unsigned long sysfsCalls = 0, simCalls = 0, latencyCalls = 0, faultCalls = 0;
+    unsigned long sysfsErrors = 0, simErrors = 0, latencyErrors = 0, faultErrors = 0;
+    bool ok = perSample("", sysfsNs, sysfsCalls, sysfsErrors) &&
+              perSample("adc=sim", simNs, simCalls, simErrors) &&
+              perSample("adc=sim,latency=20,jitter=4", latencyNs, latencyCalls, latencyErrors) &&
+              perSample("adc=sim,fault=10000,seed=7", faultNs, faultCalls, faultErrors);
+    double faultRate = (double)faultErrors / nbReads;
+    wrong += !ok || sysfsErrors || simErrors || latencyErrors || faultRate < 0.008 || faultRate > 0.012;
+
+    // noise bounds and waveform playback, values checked sample by sample
+    SimAdcConfig noisy;
+    noisy.noise = 5;
+    SimAdc noise(noisy);
+    int h = noise.open(3);
+    int lo = INT32_MAX, hi = INT32_MIN;
+    for (int i = 0; i < 100000; i++)
+    {
+        int v = noise.read(h);
+        lo = std::min(lo, v);
+        hi = std::max(hi, v);
+    }
+    wrong += lo != 512 + 64 * 3 - 5 || hi != 512 + 64 * 3 + 5;
+
+    char path[MAX_PATH_LENGTH];
+    FILE *f = fakePath(path, sizeof(path), dir, "wave.csv") ? fopen(path, "w") : nullptr;
+    if (!f)
+        return EXIT_FAILURE;
+    fprintf(f, "ch0;ch1;ch2;ch3;ch4;ch5;ch6;ch7\n");
+    for (int i = 0; i < 1000; i++)
+        fprintf(f, "%d;%d;%d;%d;%d;%d;%d;%d\n", i, i + 1, i + 2, i + 3, i % 7, 1000 - i, 0, 1023);
+    fclose(f);
+    SimAdc playback;
+    statusErrDef waveRes = playback.loadWaveform(path);
+    int h5 = playback.open(5);
+    for (int i = 0; i < 2500 && waveRes == noError; i++)
+        wrong += playback.read(h5) != 1000 - i % 1000;
+    unlink(path);
+
+    SimAdcConfig stuckConfig;
+    stuckConfig.stuckPpm = 1000;
+    stuckConfig.noise = 20;
+    SimAdc stuck(stuckConfig);
+    int hs = stuck.open(0);
+    unsigned long repeats = 0;
+    int previous = -1;
+    for (int i = 0; i < 200000; i++)
+    {
+        int v = stuck.read(hs);
+        repeats += v == previous;
+        previous = v;
+    }
+
+    // the whole loop on the simulated backends, no file or GPIO chip
+    HalConfig loop;
+    statusErrDef loopRes = halParse("adc=sim,noise=3,fault=100,gpio=sim,gpiolatency=2", loop);
+    if (loopRes == noError)
+        loopRes = halSelect(loop);
+    removeFakeSysfs(dir);
+    char csvDir[MAX_PATH_LENGTH];
+    snprintf(csvDir, sizeof(csvDir), "/tmp/cac_hal_XXXXXX");
+    if (!mkdtemp(csvDir))
+        return EXIT_FAILURE;
+    strcat(csvDir, "/");
+    const int nbBoards = 3;
+    snprintf(path, sizeof(path), "%s%s", csvDir, EG_LINK_FILE);
+    FILE *link = fopen(path, "w");
+    snprintf(path, sizeof(path), "%setat.csv", csvDir);
+    FILE *state = fopen(path, "w");
+    snprintf(path, sizeof(path), "%s%s", csvDir, ACTIVATION_FILE);
+    FILE *rules = fopen(path, "w");
+    if (!link || !state || !rules)
+        return EXIT_FAILURE;
+    fprintf(link, "0x%04X;etat.csv\n", EG_MIN);
+    for (int b = 0; b < nbBoards; b++)
+        for (int v = 0; v < 8; v++)
+            fprintf(state, "RIG%d;V%02d;%d\n", b, v, v < 4);
+    fclose(link);
+    fclose(state);
+    fclose(rules);
+
+    WorkerConfig worker;
+    worker.periodUs = periodUs;
+    worker.priority = 0;
+    worker.lockMemory = false;
+    worker.csvDir = csvDir;
+    worker.telemetry = false;
+    int nbCpus = std::max(1, (int)std::thread::hardware_concurrency());
+    Orchestrator rig;
+    for (int b = 0; b < nbBoards && loopRes == noError; b++)
+    {
+        BoardConfig board = rigBoard(b);
+        worker.cpu = b % nbCpus;
+        if (rig.add(board.name, board.id, &board, worker) != noError)
+            loopRes = errHalConfig;
+        __atomic_store_n(&rig.getBoard(b).getCac().tab_vannes->generalState, (uint16_t)EG_MIN, __ATOMIC_RELEASE);
+    }
+    unsigned long s0 = nbSyscalls;
+    rig.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(runMs));
+    rig.stop();
+    unsigned long loopCalls = nbSyscalls - s0;
+
+    uint64_t cycles = 0, overruns = 0, gpioWrites = 0;
+    for (int b = 0; b < rig.getNbBoards(); b++)
+    {
+        CycleStats stats;
+        if (rig.getBoard(b).getExecutive().getStats(stats))
+        {
+            cycles += stats.cycles;
+            overruns += stats.overruns;
+        }
+        SimGpio *gpio = dynamic_cast<SimGpio *>(rig.getBoard(b).getCac().getValveBank().getBackend());
+        if (!gpio)
+        {
+            wrong++;
+            continue;
+        }
+        gpioWrites += gpio->getNbWrites();
+        for (int v = 0; v < 8; v++)
+            wrong += gpio->getValue(v) != (v < 4);
+    }
+    SimAdc &sim = static_cast<SimAdc &>(halAdc());
+    std::string cmd = std::string("rm -rf ") + csvDir;
+    if (system(cmd.c_str()) != 0)
+        perror(cmd.c_str());
+
+    printf("== hal : %lu reads per backend, %d boards at %ld us\n", nbReads, nbBoards, periodUs);
+    printf("%-28s %10.1f ns/sample, %.2f syscalls/sample\n", "sysfs (fake tree)", (double)sysfsNs / nbReads,
+           (double)sysfsCalls / nbReads);
+    printf("%-28s %10.1f ns/sample, %.2f syscalls/sample\n", "sim", (double)simNs / nbReads,
+           (double)simCalls / nbReads);
+    printf("%-28s %10.1f ns/sample (20 us + [0, 4[ us asked)\n", "sim latency", (double)latencyNs / nbReads);
+    printf("%-28s %10.2f %% read errors (1 %% asked)\n", "sim faults", faultRate * 100);
+    printf("%-28s %10d..%d around %d (noise 5)\n", "sim noise", lo, hi, 512 + 64 * 3);
+    printf("%-28s %10lu repeated samples of 200000 (stuck faults), %s waveform\n", "sim stuck", repeats,
+           waveRes == noError ? "played" : "missing");
+    printf("%-28s %10llu cycles, %llu overruns, %llu GPIO writes, %.2f syscalls/cycle, %llu ADC faults\n",
+           "rig on sim backends", (unsigned long long)cycles, (unsigned long long)overruns,
+           (unsigned long long)gpioWrites, cycles ? (double)loopCalls / cycles : 0.0,
+           (unsigned long long)sim.getNbFaults());
+    printf("%-28s %10lu wrong\n", "checks", wrong);
+
+    // the next scenarios run on the real backends again
+    halSelect(HalConfig());
+    return (loopRes == noError && waveRes == noError && !wrong && cycles) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * \brief ValveBank on the simulated lines : one bulk request of every
+ * line, no write and no syscall while the commands don't change, one
+ * bulk write per cycle where at least one command changed.
+ */
+static int benchBank(unsigned long nbIdle, unsigned long nbChanges)
+{
+    HalConfig hal;
+    statusErrDef res = halParse("gpio=sim", hal);
+    if (res == noError)
+        res = halSelect(hal);
+
+    unsigned long wrong = 0, nbChanged = 0;
+    unsigned long idleSyscalls = 0, idleWrites = 0, toggleWrites = 0, changeWrites = 0;
+    uint64_t idleNs = 0;
+    int nbLines = 0;
+    const int nbValves = 8;
+    if (res == noError)
+    {
+        std::vector<Valve> valves;
+        valves.reserve(nbValves);
+        ValveBank bank;
+        for (int v = 0; v < nbValves; v++)
+        {
+            char name[8];
+            snprintf(name, sizeof(name), "V%02d", v);
+            valves.emplace_back(name, v, 8 + v);
+            bank.addValve(&valves.back());
+        }
+        res = bank.init();
+        SimGpio *gpio = dynamic_cast<SimGpio *>(bank.getBackend());
+        if (res == noError && gpio)
+        {
+            nbLines = gpio->getNbLines();
+
+            // idle : the commands are the applied states
+            uint64_t writes = gpio->getNbWrites();
+            unsigned long syscalls = nbSyscalls;
+            uint64_t t0 = nowNs();
+            for (unsigned long i = 0; i < nbIdle; i++)
+                wrong += bank.apply() != noError;
+            idleNs = nowNs() - t0;
+            idleSyscalls = nbSyscalls - syscalls;
+            idleWrites = gpio->getNbWrites() - writes;
+
+            // one toggle : a single bulk write, then idle again
+            writes = gpio->getNbWrites();
+            valves[3].state = 1;
+            for (int k = 0; k < 3; k++)
+                wrong += bank.apply() != noError;
+            toggleWrites = gpio->getNbWrites() - writes;
+            wrong += gpio->getValue(3) != 1 || bank.getAppliedMask() != 1u << 3;
+
+            // random commands : the cycles where one changed are written once, every line at once
+            uint32_t seed = 1, mask = bank.getAppliedMask();
+            writes = gpio->getNbWrites();
+            for (unsigned long i = 0; i < nbChanges; i++)
+            {
+                seed = seed * 1103515245u + 12345u;
+                uint32_t next = (seed >> 16) & 1 ? mask : (seed >> 8) & 0xFF;
+                nbChanged += next != mask;
+                mask = next;
+                for (int v = 0; v < nbValves; v++)
+                    valves[v].state = (mask >> v) & 1;
+                wrong += bank.apply() != noError;
+                for (int v = 0; v < nbValves; v++)
+                    wrong += gpio->getValue(v) != (int)((mask >> v) & 1);
+            }
+            changeWrites = gpio->getNbWrites() - writes;
+        }
+        else if (res == noError)
+            res = errOpenGPIO;
+    }
+    halSelect(HalConfig());
+    wrong += idleSyscalls != 0 || idleWrites != 0 || toggleWrites != 1 || changeWrites != nbChanged;
+    wrong += nbLines != nbValves;
+
+    printf("== bank : %d valves on the simulated lines\n", nbValves);
+    printf("%-28s %10d lines in 1 bulk request\n", "init", nbLines);
+    printf("%-28s %10.1f ns/apply, %lu writes, %lu syscalls in %lu cycles\n", "unchanged commands",
+           nbIdle ? (double)idleNs / nbIdle : 0.0, idleWrites, idleSyscalls, nbIdle);
+    printf("%-28s %10lu bulk writes for 1 toggle and 2 idle cycles\n", "one toggle", toggleWrites);
+    printf("%-28s %10lu bulk writes for %lu changed cycles out of %lu\n", "random commands", changeWrites,
+           nbChanged, nbChanges);
+    printf("%-28s %10lu wrong\n", "checks", wrong);
+    return (res == noError && !wrong) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * \brief per-sensor conditioning as a loop over sensor records, a switch
+ * on the filter of each one, the reference of the structure of arrays.
+ */
+struct NaiveStage
+{
+    float coefs[4];
+    int filter; /**< 0 none, 1 mean, 2 iir */
+    int window;
+    float alpha;
+    float ring[COND_MAX_WINDOW];
+    int pos;
+    float state;
+};
+
+static void naiveApply(NaiveStage *stages, int n, const float *raw, float *values)
+{
+    for (int s = 0; s < n; s++)
+    {
+        NaiveStage &st = stages[s];
+        float x = raw[s];
+        if (st.filter == 1)
+        {
+            st.ring[st.pos] = x;
+            st.pos = (st.pos + 1) % st.window;
+            float sum = 0;
+            for (int r = 0; r < st.window; r++)
+                sum += st.ring[r];
+            x = sum / st.window;
+        }
+        else if (st.filter == 2)
+            x = st.state += st.alpha * (x - st.state);
+        values[s] = st.coefs[0] + st.coefs[1] * x + st.coefs[2] * x * x + st.coefs[3] * x * x * x;
+    }
+}
+
+/**
+ * \brief conditioning : the stages checked against their definition
+ * (polynomial, moving average, IIR, NaN before the first sample, hold on
+ * error, invalid lines), cost of a conditioned channel vector against a
+ * per-sensor loop, and the noise of an oversampled channel read through
+ * the CAC on the simulated ADC.
+ */
+static int benchCondition(unsigned long nbCycles)
+{
+    char dir[MAX_PATH_LENGTH];
+    snprintf(dir, sizeof(dir), "/tmp/cac_cond_XXXXXX");
+    if (!mkdtemp(dir))
+        return EXIT_FAILURE;
+    char path[MAX_PATH_LENGTH];
+    FILE *f = fakePath(path, sizeof(path), dir, "/" CALIBRATION_FILE) ? fopen(path, "w") : nullptr;
+    if (!f)
+        return EXIT_FAILURE;
+    // PR-00 keeps its counts
+    fprintf(f, "board;sensor;unit;c0;c1;c2;c3;oversampling;filter;param\n");
+    fprintf(f, "RIG0;PR-01;bar;1;2;0.5;0.001\n");
+    fprintf(f, "RIG0;PR-02;degC;0;1;0;0;1;mean;4\n");
+    fprintf(f, "RIG0;PR-03;degC;0;1;0;0;1;iir;0.5\n");
+    fprintf(f, "RIG0;PR-04;mbar;0;1000\n");
+    fprintf(f, "RIG0;PR-05;V;0;1;0;0;1;mean;4\n");
+    fprintf(f, "RIG0;PR-06;V;0;1;0;0;16;none\n");
+    fclose(f);
+
+    BoardConfig board = rigBoard(0);
+    Conditioner cond;
+    statusErrDef res = cond.load(board, path);
+    unsigned long wrong = 0;
+    auto near = [](float a, float b) { return fabsf(a - b) <= 1e-3f * std::max(1.0f, fabsf(b)); };
+
+    // PR-04 fails its first cycle, PR-05 fails from cycle 6 on, 0 to 100 step on cycle 2
+    float raw[MAX_SENSORS] = {};
+    float values[MAX_SENSORS];
+    float mean4[] = {0, 25, 50, 75, 100, 100, 100};
+    float iir[] = {0, 50, 75, 87.5f, 93.75f, 96.875f, 98.4375f};
+    for (int c = 0; c < 8; c++)
+    {
+        for (int s = 0; s < MAX_ADC; s++)
+            raw[s] = c < 2 ? 0.0f : 100.0f;
+        raw[5] = c < 6 ? 200.0f : 999.0f;
+        uint32_t valid = 0xFF & ~(c == 0 ? 1u << 4 : 0) & ~(c >= 6 ? 1u << 5 : 0);
+        cond.apply(raw, valid, values);
+        int k = std::max(c - 1, 0);
+        wrong += !near(values[0], raw[0]);
+        wrong += !near(values[1], 1 + 2 * raw[1] + 0.5f * raw[1] * raw[1] + 0.001f * raw[1] * raw[1] * raw[1]);
+        wrong += !near(values[2], mean4[k]);
+        wrong += !near(values[3], iir[k]);
+        wrong += c == 0 ? !std::isnan(values[4]) : !near(values[4], 1000 * raw[4]);
+        wrong += !near(values[5], 200.0f);
+    }
+    wrong += strcmp(cond.getUnit(0), "counts") != 0 || strcmp(cond.getUnit(1), "bar") != 0 ||
+             cond.getOversampling(6) != 16 || cond.getOversampling(1) != 1;
+
+    // an invalid line is reported, its sensor keeps its counts
+    f = fopen(path, "w");
+    if (!f)
+        return EXIT_FAILURE;
+    fprintf(f, "RIG0;PR-01;bar;1;x\nRIG0;PR-02;kilopascal;0;1\nRIG0;PR-03;V;0;1;0;0;1;mean;3.5\nRIG0;PR-99;V;0;1\n");
+    fclose(f);
+    Conditioner invalid;
+    statusErrDef invalidRes = invalid.load(board, path);
+    wrong += invalidRes != errOpenCalibrationFile || strcmp(invalid.getUnit(1), "counts") != 0 ||
+             strcmp(invalid.getUnit(3), "counts") != 0;
+
+    // cost of one channel vector, MAX_SENSORS lanes, every kind of stage
+    Conditioner lanes;
+    NaiveStage stages[MAX_SENSORS] = {};
+    f = fopen(path, "w");
+    if (!f)
+        return EXIT_FAILURE;
+    BoardConfig full = board;
+    full.nbSensors = MAX_SENSORS;
+    for (int s = 0; s < MAX_SENSORS; s++)
+    {
+        snprintf(full.sensors[s].name, PHYS_NAME_LENGTH, "PR-%02d", s);
+        const char *filter = s % 3 == 0 ? "none;1" : s % 3 == 1 ? "mean;8" : "iir;0.1";
+        fprintf(f, "RIG0;PR-%02d;bar;-1.25;0.0122;1e-6;1e-9;1;%s\n", s, filter);
+        stages[s] = NaiveStage{{-1.25f, 0.0122f, 1e-6f, 1e-9f}, s % 3, 8, 0.1f, {}, 0, 0};
+    }
+    fclose(f);
+    res = res != noError ? res : lanes.load(full, path);
+    for (int s = 0; s < MAX_SENSORS; s++)
+        raw[s] = 500.0f + s;
+    // best of 5 rounds, the host is shared
+    float sink = 0;
+    uint64_t soaNs = UINT64_MAX, naiveNs = UINT64_MAX, t0;
+    for (int round = 0; round < 5; round++)
+    {
+        uint32_t seed = 1;
+        t0 = nowNs();
+        for (unsigned long i = 0; i < nbCycles; i++)
+        {
+            raw[i % MAX_SENSORS] = (float)((seed = seed * 1103515245u + 12345u) >> 22);
+            lanes.apply(raw, (1u << MAX_SENSORS) - 1, values);
+            sink += values[i % MAX_SENSORS];
+        }
+        soaNs = std::min(soaNs, nowNs() - t0);
+        seed = 1;
+        t0 = nowNs();
+        for (unsigned long i = 0; i < nbCycles; i++)
+        {
+            raw[i % MAX_SENSORS] = (float)((seed = seed * 1103515245u + 12345u) >> 22);
+            naiveApply(stages, MAX_SENSORS, raw, values);
+            sink += values[i % MAX_SENSORS];
+        }
+        naiveNs = std::min(naiveNs, nowNs() - t0);
+    }
+
+    // oversampling through the CAC : 16 reads divide the noise by 4
+    f = fopen(path, "w");
+    if (!f)
+        return EXIT_FAILURE;
+    fprintf(f, "RIG0;PR-01;counts;0;1;0;0;1\nRIG0;PR-02;counts;0;1;0;0;16\n");
+    fclose(f);
+    HalConfig hal;
+    statusErrDef halRes = halParse("adc=sim,noise=40,gpio=sim", hal);
+    if (halRes == noError)
+        halRes = halSelect(hal);
+    double sd[2] = {};
+    uint64_t acquireNs = 0;
+    const unsigned long nbAcq = 20000;
+    if (halRes == noError)
+    {
+        CAC cac("COND", 1);
+        Conditioner oversampled;
+        statusErrDef initRes = cac.init(board);
+        res = res != noError ? res : initRes != noError ? initRes : oversampled.load(board, path);
+        cac.setConditioner(&oversampled);
+        double sum[2] = {}, sq[2] = {};
+        t0 = nowNs();
+        for (unsigned long i = 0; i < nbAcq; i++)
+        {
+            cac.acquire();
+            for (int k = 0; k < 2; k++)
+            {
+                double v = cac.tab_sensors->frame.values[1 + k];
+                sum[k] += v;
+                sq[k] += v * v;
+            }
+        }
+        acquireNs = nowNs() - t0;
+        for (int k = 0; k < 2; k++)
+            sd[k] = sqrt(sq[k] / nbAcq - (sum[k] / nbAcq) * (sum[k] / nbAcq));
+        wrong += strcmp(cac.tab_sensors->units[2], "counts") != 0;
+    }
+    halSelect(HalConfig());
+    double ratio = sd[1] > 0 ? sd[0] / sd[1] : 0;
+    wrong += ratio < 3.5 || ratio > 4.5;
+
+    std::string cmd = std::string("rm -rf ") + dir;
+    if (system(cmd.c_str()) != 0)
+        perror(cmd.c_str());
+
+    printf("== condition : %d lanes, %lu channel vectors\n", MAX_SENSORS, nbCycles);
+    printf("%-28s %10.1f ns/vector (structure of arrays)\n", "conditioner", (double)soaNs / nbCycles);
+    printf("%-28s %10.1f ns/vector (loop over sensor records)\n", "per-sensor loop", (double)naiveNs / nbCycles);
+    printf("%-28s %10.2f counts rms x1, %.2f x16 (ratio %.2f, 4 expected)\n", "oversampling, noise 40", sd[0],
+           sd[1], ratio);
+    printf("%-28s %10.1f us/acquire, 8 channels, one of them read 16 times\n", "acquire", acquireNs / 1000.0 / nbAcq);
+    printf("%-28s %10lu wrong%s\n", "checks", wrong, sink == 0 ? " " : "");
+    return (res == noError && halRes == noError && !wrong) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * \brief sensor health : every detector driven by a scripted channel
+ * (stuck, rail, step, noise, failed reads, ADC_READ_ERROR values), the
+ * Welford statistics checked against a two pass computation, the cost of
+ * one update, and the faults published by the CAC on the simulated ADC.
+ */
+static int benchHealth(unsigned long nbCycles)
+{
+    BoardConfig board = rigBoard(0);
+    SensorHealth health;
+    health.init(board);
+    unsigned long wrong = 0, leaked = 0;
+    std::vector<int16_t> good[MAX_ADC];
+    uint16_t seen[MAX_ADC] = {};
+    int16_t lastGood[MAX_ADC] = {};
+    uint32_t seed = 1;
+
+    // 0 quiet noise, 1 held level, 2 on the high rail, 3 step on cycle 500,
+    // 4 noisy until cycle 1500, 5 unread from cycle 100 to 110, 6 returns
+    // ADC_READ_ERROR on cycle 50, 7 slow sine
+    const int nbScript = 3000;
+    for (int c = 0; c < nbScript; c++)
+    {
+        int16_t values[MAX_SENSORS];
+        uint16_t words[MAX_SENSORS];
+        seed = seed * 1103515245u + 12345u;
+        values[0] = (int16_t)(500 + (int)((seed >> 16) % 11) - 5);
+        values[1] = 300;
+        values[2] = ADC_MAX_COUNT;
+        values[3] = c < 500 ? 100 : 600;
+        values[4] = c < 1500 ? (c & 1 ? 480 : 400) : (int16_t)(400 + (c / 8) % 2);
+        values[5] = (int16_t)(200 + c % 3);
+        values[6] = c == 50 ? ADC_READ_ERROR : (int16_t)(700 + c % 5);
+        values[7] = (int16_t)lrint(512 + 400 * sin(c / 100.0));
+        uint32_t readMask = 0xFF & ~(c >= 100 && c <= 110 ? 1u << 5 : 0);
+        uint32_t valid = readMask;
+        int16_t in[MAX_ADC];
+        memcpy(in, values, sizeof(in));
+        uint32_t faulty = health.update(values, valid, words);
+
+        for (int s = 0; s < MAX_ADC; s++)
+        {
+            bool read = ((readMask >> s) & 1) && in[s] != ADC_READ_ERROR;
+            if (read)
+            {
+                good[s].push_back(in[s]);
+                lastGood[s] = in[s];
+            }
+            leaked += values[s] == ADC_READ_ERROR;
+            wrong += values[s] != (read ? in[s] : lastGood[s]);
+            wrong += ((faulty >> s) & 1) != (words[s] != 0);
+            wrong += (((valid >> s) & 1) != 0) != ((words[s] & SENSOR_HEALTH_UNUSABLE) == 0);
+            seen[s] |= words[s];
+        }
+        wrong += words[0] != 0 || words[7] != 0;
+        wrong += ((words[1] & SENSOR_HEALTH_STUCK) != 0) != (c >= HEALTH_STUCK_SAMPLES - 1);
+        wrong += ((words[2] & SENSOR_HEALTH_SATURATED) != 0) != (c >= HEALTH_SATURATED_SAMPLES - 1);
+        wrong += ((words[3] & SENSOR_HEALTH_STEP) != 0) != (c == 500);
+        wrong += c >= 200 && c < 1500 && !(words[4] & SENSOR_HEALTH_NOISY);
+        wrong += c >= 2000 && (words[4] & SENSOR_HEALTH_NOISY);
+        wrong += ((words[5] & SENSOR_HEALTH_ERROR) != 0) != (c >= 100 && c <= 110);
+        wrong += ((words[5] & SENSOR_HEALTH_DISCONNECTED) != 0) != (c >= 100 + HEALTH_DISCONNECT_ERRORS - 1 && c <= 110);
+        wrong += ((words[6] & SENSOR_HEALTH_ERROR) != 0) != (c == 50);
+    }
+    wrong += !(seen[4] & SENSOR_HEALTH_NOISY);
+
+    // Welford against two passes over the good samples
+    HealthStats stats;
+    double worst = 0;
+    if (!health.getStats(stats))
+        wrong++;
+    for (int s = 0; s < MAX_ADC; s++)
+    {
+        double sum = 0, dev = 0;
+        int16_t lo = INT16_MAX, hi = INT16_MIN;
+        for (int16_t v : good[s])
+        {
+            sum += v;
+            lo = std::min(lo, v);
+            hi = std::max(hi, v);
+        }
+        double mean = sum / good[s].size();
+        for (int16_t v : good[s])
+            dev += (v - mean) * (v - mean);
+        double errMean = fabs(stats.mean[s] - mean) / std::max(1.0, fabs(mean));
+        double errM2 = fabs(stats.m2[s] - dev) / std::max(1.0, dev);
+        worst = std::max(worst, std::max(errMean, errM2));
+        wrong += stats.count[s] != good[s].size() || stats.min[s] != lo || stats.max[s] != hi;
+        wrong += stats.errors[s] != nbScript - good[s].size();
+    }
+    wrong += worst > 1e-9;
+
+    // cost of one update, MAX_SENSORS lanes of noise, best of 5 rounds
+    BoardConfig full = board;
+    full.nbSensors = MAX_SENSORS;
+    for (int s = 0; s < MAX_SENSORS; s++)
+        full.sensors[s].type = 1;
+    SensorHealth lanes;
+    lanes.init(full);
+    uint64_t bestNs = UINT64_MAX;
+    unsigned long allocs = nbAllocs, sink = 0;
+    for (int round = 0; round < 5; round++)
+    {
+        uint64_t t0 = nowNs();
+        for (unsigned long i = 0; i < nbCycles; i++)
+        {
+            int16_t values[MAX_SENSORS];
+            uint16_t words[MAX_SENSORS];
+            for (int s = 0; s < MAX_SENSORS; s++)
+            {
+                seed = seed * 1103515245u + 12345u;
+                values[s] = (int16_t)(512 + (int)((seed >> 16) % 9) - 4);
+            }
+            uint32_t valid = (1u << MAX_SENSORS) - 1;
+            sink += lanes.update(values, valid, words);
+        }
+        bestNs = std::min(bestNs, nowNs() - t0);
+    }
+    allocs = nbAllocs - allocs;
+    wrong += allocs != 0;
+
+    // through the CAC : a failing simulated ADC never publishes ADC_READ_ERROR,
+    // a failed read or a fault is in the status and the health word
+    HalConfig hal;
+    statusErrDef halRes = halParse("adc=sim,noise=3,fault=100000,gpio=sim", hal);
+    if (halRes == noError)
+        halRes = halSelect(hal);
+    unsigned long nbFaulty = 0, nbAcq = 20000;
+    statusErrDef initRes = noError;
+    if (halRes == noError)
+    {
+        CAC cac("HEALTH", 1);
+        initRes = cac.init(board);
+        for (unsigned long i = 0; i < nbAcq; i++)
+        {
+            cac.acquire();
+            const SensorFrame &frame = cac.tab_sensors->frame;
+            nbFaulty += frame.faulty != 0;
+            for (int s = 0; s < board.nbSensors; s++)
+            {
+                leaked += frame.sensors[s].value == ADC_READ_ERROR;
+                wrong += (frame.sensors[s].status == noError) != ((frame.health[s] & SENSOR_HEALTH_UNUSABLE) == 0);
+            }
+        }
+    }
+    halSelect(HalConfig());
+    wrong += nbFaulty == 0;
+
+    printf("== health : %d lanes, %lu updates\n", MAX_SENSORS, nbCycles);
+    printf("%-28s %10.1f ns/update, %lu allocations\n", "update", (double)bestNs / nbCycles, allocs);
+    printf("%-28s %10.2e relative error against two passes\n", "welford", worst);
+    printf("%-28s %10lu faulty frames out of %lu, fault rate 10%%\n", "sim adc", nbFaulty, nbAcq);
+    printf("%-28s %10lu ADC_READ_ERROR published\n", "leaks", leaked);
+    printf("%-28s %10lu wrong%s\n", "checks", wrong, sink == 1 ? " " : "");
+    return (halRes == noError && initRes == noError && !wrong && !leaked) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * \brief alarm rule as a per-rule record with a switch on its kind, the
+ * reference of the compiled comparators.
+ */
+struct NaiveAlarm
+{
+    int slot;
+    int kind; /**< 0 above, 1 below, 2 rise, 3 fall */
+    float limit;
+    float hysteresis;
+    int debounce;
+    bool active;
+    int count;
+};
+
+static void naiveEvaluate(std::vector<NaiveAlarm> &rules, const SensorFrame &frame, float *previous,
+                          uint64_t &previousNs, uint32_t *active)
+{
+    float perSecond = previousNs && frame.timestamp > previousNs ? 1e9f / (float)(frame.timestamp - previousNs) : NAN;
+    float values[MAX_SENSORS], rates[MAX_SENSORS];
+    for (int s = 0; s < MAX_SENSORS; s++)
+    {
+        values[s] = frame.sensors[s].status == noError ? frame.values[s] : NAN;
+        rates[s] = (values[s] - previous[s]) * perSecond;
+        previous[s] = values[s];
+    }
+    previousNs = frame.timestamp;
+    for (size_t r = 0; r < rules.size(); r++)
+    {
+        NaiveAlarm &a = rules[r];
+        bool met = false;
+        switch (a.kind)
+        {
+        case 0:
+            met = a.active ? values[a.slot] < a.limit - a.hysteresis : values[a.slot] > a.limit;
+            break;
+        case 1:
+            met = a.active ? values[a.slot] > a.limit + a.hysteresis : values[a.slot] < a.limit;
+            break;
+        case 2:
+            met = a.active ? rates[a.slot] < a.limit - a.hysteresis : rates[a.slot] > a.limit;
+            break;
+        case 3:
+            met = a.active ? rates[a.slot] > a.limit + a.hysteresis : rates[a.slot] < a.limit;
+            break;
+        }
+        a.count = met ? a.count + 1 : 0;
+        if (a.count >= a.debounce)
+        {
+            a.active = !a.active;
+            a.count = 0;
+        }
+        if (a.active)
+            active[r >> 5] |= 1u << (r & 31);
+    }
+}
+
+/**
+ * \brief function to build the frame of cycle i of the synthetic streams :
+ * a sine per channel, noise, a spike every 997 cycles, a read error on
+ * about one sample in a thousand, and a period of 1 ms with jitter.
+ */
+static void alarmStream(unsigned long i, uint32_t &seed, SensorFrame &frame)
+{
+    frame.cycle = i + 1;
+    seed = seed * 1103515245u + 12345u;
+    frame.timestamp = 1000000ull * (i + 1) + (seed >> 16) % 100000;
+    for (int s = 0; s < MAX_SENSORS; s++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        float v = 500.0f + 300.0f * sinf(6.2831853f * (float)i / (200.0f + 150.0f * s));
+        v += (float)((seed >> 16) % 41) - 20.0f;
+        if ((i + 61 * s) % 997 < 3)
+            v += 400.0f;
+        frame.values[s] = v;
+        frame.sensors[s].value = (int16_t)v;
+        frame.sensors[s].status = (seed >> 8) % 1000 == 0 ? errReadAdc : noError;
+    }
+}
+
+/**
+ * \brief alarms : the semantics of the rules on scripted frames (limit,
+ * hysteresis, debounce, rate, sample in error, action), the compiled
+ * comparators against a per-rule evaluation on synthetic streams, the
+ * cost of an evaluation of MAX_ALARMS rules, and the safe state written
+ * to the valves in the cycle the alarm is raised.
+ */
+static int benchAlarm(unsigned long nbCycles)
+{
+    char dir[MAX_PATH_LENGTH];
+    snprintf(dir, sizeof(dir), "/tmp/cac_alarm_XXXXXX");
+    if (!mkdtemp(dir))
+        return EXIT_FAILURE;
+    strcat(dir, "/");
+    char path[MAX_PATH_LENGTH];
+    snprintf(path, sizeof(path), "%s%s", dir, ALARM_FILE);
+    FILE *f = fopen(path, "w");
+    if (!f)
+        return EXIT_FAILURE;
+    fprintf(f, "board;alarm;sensor;condition;limit;hysteresis;debounce;action\n");
+    fprintf(f, "RIG0;HIGH;PR-00;above;10;2;3;close\n");
+    fprintf(f, "RIG0;LOW;PR-01;below;-5;1\n");
+    fprintf(f, "RIG0;RISE;PR-02;rise;1000;0;2;0x%04X\n", EG_MIN + 1);
+    fprintf(f, "RIG0;UNREAD;PR-03;above;0\n");
+    fclose(f);
+
+    BoardConfig board = rigBoard(0);
+    AlarmEngine engine;
+    statusErrDef res = engine.load(board, path);
+    unsigned long wrong = engine.getNbRules() != 4;
+
+    // PR-00 : 11 from cycle 2 to 8, 9 on cycle 9, 7 from cycle 10 ; PR-01 : -6 on cycles 3 and 4 ;
+    // PR-02 : +2 per cycle (2000 / s) from cycle 5 ; PR-03 : 100, always in error
+    const int nbScript = 20;
+    for (int c = 0; c < nbScript; c++)
+    {
+        SensorFrame frame = {};
+        frame.cycle = c + 1;
+        frame.timestamp = 1000000ull * (c + 1);
+        frame.values[0] = c < 2 ? 0.0f : c < 9 ? 11.0f : c == 9 ? 9.0f : 7.0f;
+        frame.values[1] = c == 3 || c == 4 ? -6.0f : 0.0f;
+        frame.values[2] = c < 5 ? 0.0f : 2.0f * (c - 4);
+        frame.values[3] = 100.0f;
+        frame.sensors[3].status = errReadAdc;
+        uint16_t action;
+        statusErrDef code = engine.evaluate(frame, action);
+        AlarmStatus st;
+        if (!engine.getStatus(st))
+            wrong++;
+        bool high = c >= 4 && c < 12;   // 3 cycles above 10, 3 cycles below 8
+        bool low = c == 3 || c == 4;    // no debounce, cleared above -4
+        bool rise = c >= 6;             // second cycle of the ramp, never below 1000 / s again
+        uint32_t expected = high | low << 1 | rise << 2;
+        wrong += st.active[0] != expected;
+        wrong += action != (c == 4 ? infoStateToManualMode : c == 6 ? EG_MIN + 1 : 0);
+        wrong += code != (high ? errAlarmHigh : low ? errAlarmLow : rise ? errAlarmRate : infoNoAlarm);
+    }
+
+    // an invalid line is reported and skipped
+    f = fopen(path, "w");
+    if (!f)
+        return EXIT_FAILURE;
+    fprintf(f, "RIG0;A;PR-00;over;1\nRIG0;B;PR-00;above;x\nRIG0;C;PR-00;above;1;-1\nRIG0;D;PR-00;above;1;0;0\n"
+               "RIG0;E;PR-00;above;1;0;1;0x9999\nRIG0;F;PR-99;above;1\nRIG0;G;PR-00;above;1\n");
+    fclose(f);
+    AlarmEngine invalid;
+    wrong += invalid.load(board, path) != errOpenAlarmFile || invalid.getNbRules() != 1 ||
+             strcmp(invalid.getName(0), "G") != 0;
+
+    // MAX_ALARMS random rules over MAX_SENSORS channels, against the reference
+    BoardConfig full = board;
+    full.nbSensors = MAX_SENSORS;
+    for (int s = 0; s < MAX_SENSORS; s++)
+        snprintf(full.sensors[s].name, PHYS_NAME_LENGTH, "PR-%02d", s);
+    f = fopen(path, "w");
+    if (!f)
+        return EXIT_FAILURE;
+    std::vector<NaiveAlarm> naive;
+    const char *kinds[] = {"above", "below", "rise", "fall"};
+    uint32_t seed = 7;
+    for (int r = 0; r < MAX_ALARMS; r++)
+    {
+        NaiveAlarm a = {};
+        seed = seed * 1103515245u + 12345u;
+        a.slot = (seed >> 16) % MAX_SENSORS;
+        a.kind = (seed >> 8) % 4;
+        seed = seed * 1103515245u + 12345u;
+        int level = (seed >> 16) % 600;
+        a.limit = a.kind < 2 ? 200.0f + level : (a.kind == 2 ? 1.0f : -1.0f) * (10000.0f + 100.0f * level);
+        a.hysteresis = a.kind < 2 ? (float)(level % 50) : 100.0f * (level % 50);
+        a.debounce = 1 + level % 5;
+        fprintf(f, "RIG0;R%03d;PR-%02d;%s;%g;%g;%d\n", r, a.slot, kinds[a.kind], a.limit, a.hysteresis, a.debounce);
+        naive.push_back(a);
+    }
+    fclose(f);
+    AlarmEngine lanes;
+    statusErrDef lanesRes = lanes.load(full, path);
+    res = res != noError ? res : lanesRes;
+    wrong += lanes.getNbRules() != MAX_ALARMS;
+    float previous[MAX_SENSORS];
+    for (int s = 0; s < MAX_SENSORS; s++)
+        previous[s] = NAN;
+    uint64_t previousNs = 0;
+    unsigned long mismatches = 0, transitions = 0;
+    uint32_t lastActive[MAX_ALARMS / 32] = {};
+    seed = 1;
+    for (unsigned long i = 0; i < nbCycles / 10; i++)
+    {
+        SensorFrame frame = {};
+        alarmStream(i, seed, frame);
+        uint16_t action;
+        lanes.evaluate(frame, action);
+        uint32_t active[MAX_ALARMS / 32] = {};
+        naiveEvaluate(naive, frame, previous, previousNs, active);
+        AlarmStatus st;
+        lanes.getStatus(st);
+        for (int w = 0; w < MAX_ALARMS / 32; w++)
+        {
+            mismatches += st.active[w] != active[w];
+            transitions += __builtin_popcount(active[w] ^ lastActive[w]);
+            lastActive[w] = active[w];
+        }
+    }
+    wrong += mismatches != 0 || transitions == 0;
+
+    // cost of an evaluation, frames prepared beforehand, best of 5 rounds
+    const int nbFrames = 4096;
+    std::vector<SensorFrame> frames(nbFrames);
+    seed = 3;
+    for (int i = 0; i < nbFrames; i++)
+        alarmStream(i, seed, frames[i]);
+    uint64_t compiledNs = UINT64_MAX, naiveNs = UINT64_MAX;
+    unsigned long allocs = nbAllocs, sink = 0;
+    for (int round = 0; round < 5; round++)
+    {
+        uint64_t t0 = nowNs();
+        for (unsigned long i = 0; i < nbCycles; i++)
+        {
+            SensorFrame &frame = frames[i % nbFrames];
+            frame.timestamp = 1000000ull * (round * nbCycles + i + 1);
+            uint16_t action;
+            sink += lanes.evaluate(frame, action);
+        }
+        compiledNs = std::min(compiledNs, nowNs() - t0);
+        t0 = nowNs();
+        for (unsigned long i = 0; i < nbCycles; i++)
+        {
+            SensorFrame &frame = frames[i % nbFrames];
+            frame.timestamp = 1000000ull * (round * nbCycles + i + 1);
+            uint32_t active[MAX_ALARMS / 32] = {};
+            naiveEvaluate(naive, frame, previous, previousNs, active);
+            sink += active[0];
+        }
+        naiveNs = std::min(naiveNs, nowNs() - t0);
+    }
+    allocs = nbAllocs - allocs;
+
+    // through a board : the valves are open in manual mode, PR-02 (640
+    // counts on the simulated ADC) goes above 600 for 50 cycles, the
+    // valves are closed by the step that raises the alarm
+    FILE *link = nullptr, *state = nullptr, *rules = nullptr;
+    snprintf(path, sizeof(path), "%s%s", dir, EG_LINK_FILE);
+    link = fopen(path, "w");
+    snprintf(path, sizeof(path), "%setat0.csv", dir);
+    state = fopen(path, "w");
+    snprintf(path, sizeof(path), "%s%s", dir, ACTIVATION_FILE);
+    rules = fopen(path, "w");
+    snprintf(path, sizeof(path), "%s%s", dir, ALARM_FILE);
+    f = fopen(path, "w");
+    if (!link || !state || !rules || !f)
+        return EXIT_FAILURE;
+    fprintf(link, "0x%04X;etat0.csv\n", EG_MIN);
+    for (int v = 0; v < 8; v++)
+        fprintf(state, "RIG0;V%02d;0\n", v);
+    fprintf(rules, "board;valve;condition;target;threshold\n");
+    fprintf(f, "RIG0;PR-02-HIGH;PR-02;above;600;10;50;close\n");
+    fclose(link);
+    fclose(state);
+    fclose(rules);
+    fclose(f);
+    HalConfig hal;
+    statusErrDef halRes = halParse("adc=sim,gpio=sim", hal);
+    if (halRes == noError)
+        halRes = halSelect(hal);
+    int raisedAt = -1;
+    uint64_t raiseNs = 0;
+    if (halRes == noError)
+    {
+        WorkerConfig config;
+        config.priority = 0;
+        config.cpu = -1;
+        config.lockMemory = false;
+        config.csvDir = dir;
+        config.telemetry = false;
+        config.phaseTiming = true;
+        BoardWorker worker(board.name, board.id, config);
+        statusErrDef initRes = worker.init(&board);
+        res = res != noError ? res : initRes;
+        CAC &cac = worker.getCac();
+        SimGpio *gpio = dynamic_cast<SimGpio *>(cac.getValveBank().getBackend());
+        cac.setCommands(0xFF);
+        for (int c = 0; c < 60 && gpio; c++)
+        {
+            worker.step();
+            int open = 0;
+            for (int v = 0; v < 8; v++)
+                open += gpio->getValue(v);
+            if (raisedAt < 0 && open == 0)
+            {
+                raisedAt = c;
+                const CyclePhases &p = worker.getPhases();
+                raiseNs = (uint64_t)p.acquireNs + p.exchangeNs + p.decideNs + p.actuateNs;
+            }
+            wrong += c < 49 && open != 8;
+        }
+        wrong += !gpio || raisedAt != 49 || worker.getMode() != manual ||
+                 cac.tab_vannes->generalState != infoStateToManualMode;
+    }
+    halSelect(HalConfig());
+
+    std::string cmd = std::string("rm -rf ") + dir;
+    if (system(cmd.c_str()) != 0)
+        perror(cmd.c_str());
+
+    printf("== alarm : %d rules, %d channels, %lu evaluations\n", MAX_ALARMS, MAX_SENSORS, nbCycles);
+    printf("%-28s %10.1f ns/evaluation, %.2f ns/rule, %lu allocations\n", "compiled comparators",
+           (double)compiledNs / nbCycles, (double)compiledNs / nbCycles / MAX_ALARMS, allocs);
+    printf("%-28s %10.1f ns/evaluation (switch per rule)\n", "per-rule records", (double)naiveNs / nbCycles);
+    printf("%-28s %10lu transitions, %lu cycles disagree\n", "against the reference", transitions, mismatches);
+    printf("%-28s %10d cycles to raise, valves closed by that step (%.1f us)\n", "safe state", raisedAt + 1,
+           raiseNs / 1000.0);
+    printf("%-28s %10lu wrong%s\n", "checks", wrong, sink == 1 ? " " : "");
+    return (res == noError && halRes == noError && !wrong) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * \brief function to open a subscriber of the telemetry server and send
+ * its subscription.
+ */
+static int streamConnect(const char *path, uint16_t decimation)
+{
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    StreamSubscribe msg = {STREAM_MAGIC, decimation, 0, 0};
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && (connect(fd, (const sockaddr *)&addr, sizeof(addr)) < 0 || send(fd, &msg, sizeof(msg), 0) < 0))
+    {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+/**
+ * \brief figures of one subscriber of the stream bench
+ */
+struct StreamReader
+{
+    int fd;
+    uint16_t decimation;
+    uint32_t nextCycle; /**< next cycle expected */
+    unsigned long records;
+    unsigned long gaps;  /**< records missing or out of order */
+};
+
+/**
+ * \brief telemetry server : publish() on its own (cost, ring full), then
+ * a cycle thread publishing at 1 kHz to 1, 16 and 63 subscribers read by
+ * one thread plus a subscriber that never reads. Every record must reach
+ * the subscribers that read, with their decimation, and the stalled one
+ * must be dropped without a record lost by the ring.
+ */
+static int benchStream(unsigned long nbRecords)
+{
+    char path[MAX_PATH_LENGTH];
+    snprintf(path, sizeof(path), "/tmp/cac_stream_%d.sock", (int)getpid());
+    BoardConfig board = rigBoard(0);
+    SensorFrame frame = {};
+    for (int s = 0; s < MAX_SENSORS; s++)
+    {
+        frame.values[s] = 1.5f * s;
+        frame.sensors[s].value = (int16_t)(100 * s);
+    }
+    unsigned long wrong = 0;
+
+    // publish() alone : the ring takes STREAM_RING_RECORDS records, then drops without waiting
+    double publishNs;
+    unsigned long publishSyscalls, publishAllocs;
+    {
+        TelemetryServer idle(path);
+        int ring = idle.addBoard(board.id, board.nbSensors, board.nbValves);
+        unsigned long syscalls = nbSyscalls, allocs = nbAllocs;
+        uint64_t t0 = nowNs();
+        unsigned long accepted = 0;
+        for (unsigned long i = 0; i < STREAM_RING_RECORDS + 100; i++)
+        {
+            frame.cycle = i;
+            accepted += idle.publish(ring, frame, 0x5A);
+        }
+        publishNs = (double)(nowNs() - t0) / (STREAM_RING_RECORDS + 100);
+        publishSyscalls = nbSyscalls - syscalls;
+        publishAllocs = nbAllocs - allocs;
+        StreamStats st;
+        idle.getStats(st);
+        wrong += accepted != STREAM_RING_RECORDS || st.ringDropped != 100;
+    }
+
+    printf("== stream : %lu records at 1 kHz, %d ms batches, %d records per frame at most, %zu bytes per record\n",
+           nbRecords, STREAM_BATCH_MS, STREAM_BATCH_RECORDS, sizeof(StreamRecord));
+    printf("%-28s %10.1f ns/record, %lu syscalls, %lu allocations, ring full : dropped, not waited\n", "publish()",
+           publishNs, publishSyscalls, publishAllocs);
+
+    statusErrDef res = noError;
+    for (int nbReaders : {1, 16, STREAM_MAX_SUBSCRIBERS - 1})
+    {
+        TelemetryServer server(path);
+        int ring = server.addBoard(board.id, board.nbSensors, board.nbValves);
+        statusErrDef startRes = server.start();
+        res = res != noError ? res : startRes;
+        if (startRes != noError)
+            break;
+
+        // the first reader of several takes one cycle out of 4
+        std::vector<StreamReader> readers;
+        std::vector<pollfd> fds;
+        for (int r = 0; r < nbReaders; r++)
+        {
+            uint16_t decimation = r == 0 && nbReaders > 1 ? 4 : 1;
+            int fd = streamConnect(path, decimation);
+            wrong += fd < 0;
+            readers.push_back(StreamReader{fd, decimation, 0, 0, 0});
+            fds.push_back(pollfd{fd, POLLIN, 0});
+        }
+        int stalled = streamConnect(path, 1);
+        wrong += stalled < 0;
+        StreamStats st = {};
+        for (int t = 0; t < 200 && st.subscribers != (uint32_t)nbReaders + 1; t++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            server.getStats(st);
+        }
+
+        // the cycle thread, its publish() timed
+        std::atomic<bool> done(false);
+        LatencyHisto publishCost;
+        unsigned long cycleSyscalls = 0, cycleAllocs = 0;
+        std::thread cycle([&]
+        {
+            SensorFrame f = frame;
+            auto next = std::chrono::steady_clock::now();
+            for (unsigned long i = 0; i < nbRecords; i++)
+            {
+                next += std::chrono::microseconds(1000);
+                std::this_thread::sleep_until(next);
+                f.cycle = i;
+                f.timestamp = nowNs();
+                // the sleep of the period is a syscall, only publish() is counted
+                unsigned long syscalls = nbSyscalls, allocs = nbAllocs;
+                server.publish(ring, f, (uint32_t)i & 0xFF);
+                cycleSyscalls += nbSyscalls - syscalls;
+                cycleAllocs += nbAllocs - allocs;
+                publishCost.record(nowNs() - f.timestamp);
+            }
+            done = true;
+        });
+
+        // every reader in one thread, until 200 ms after the last record
+        LatencyHisto latency;
+        static uint8_t buf[sizeof(StreamFrameHeader) + STREAM_BATCH_RECORDS * sizeof(StreamRecord)];
+        const StreamFrameHeader *h = (const StreamFrameHeader *)buf;
+        const StreamRecord *recs = (const StreamRecord *)(buf + sizeof(StreamFrameHeader));
+        unsigned long frames = 0;
+        uint64_t doneNs = 0;
+        uint64_t t0 = nowNs();
+        while (!doneNs || nowNs() - doneNs < 200000000ull)
+        {
+            if (!doneNs && done)
+                doneNs = nowNs();
+            if (poll(fds.data(), fds.size(), 20) <= 0)
+                continue;
+            uint64_t now = nowNs();
+            for (size_t r = 0; r < fds.size(); r++)
+            {
+                if (!fds[r].revents)
+                    continue;
+                StreamReader &reader = readers[r];
+                ssize_t n = recv(reader.fd, buf, sizeof(buf), MSG_DONTWAIT);
+                if (n < (ssize_t)sizeof(StreamFrameHeader) || h->magic != STREAM_MAGIC)
+                    continue;
+                frames++;
+                for (int k = 0; k < h->nbRecords; k++)
+                {
+                    reader.gaps += recs[k].cycle != reader.nextCycle;
+                    reader.nextCycle = recs[k].cycle + reader.decimation;
+                    reader.records++;
+                    latency.record(now - recs[k].timestamp);
+                }
+            }
+        }
+        double elapsed = (nowNs() - t0) / 1e9;
+        cycle.join();
+        server.getStats(st);
+        server.stop();
+
+        unsigned long received = 0, gaps = 0;
+        for (const StreamReader &reader : readers)
+        {
+            unsigned long expected = (nbRecords + reader.decimation - 1) / reader.decimation;
+            wrong += reader.records != expected;
+            received += reader.records;
+            gaps += reader.gaps;
+            close(reader.fd);
+        }
+        close(stalled);
+        wrong += gaps != 0 || st.clientsDropped != 1 || st.ringDropped != 0 || cycleSyscalls != 0 || cycleAllocs != 0;
+
+        char label[64];
+        snprintf(label, sizeof(label), "%d subscribers + 1 stalled", nbReaders);
+        printf("%-28s %10.0f frames/s, %.0f records/s, %lu gaps, stalled dropped : %s\n", label, frames / elapsed,
+               received / elapsed, gaps, st.clientsDropped == 1 ? "yes" : "no");
+        printf("%-28s %10.2f ms p50, %.2f p99, %.2f max ; publish() %.2f us p99, %.2f max, %lu syscalls, %lu allocations\n",
+               "  cycle to subscriber", latency.percentile(50) / 1e6, latency.percentile(99) / 1e6,
+               latency.getMax() / 1e6, publishCost.percentile(99) / 1e3, publishCost.getMax() / 1e3, cycleSyscalls,
+               cycleAllocs);
+    }
+    unlink(path);
+
+    printf("%-28s %10lu wrong\n", "checks", wrong);
+    return (res == noError && !wrong) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * \brief states of the valves 2 k and 2 k + 1 commanded by the command i
+ * of the client k of the command bench
+ */
+static uint32_t commandValues(int k, unsigned long i)
+{
+    uint32_t x = (uint32_t)(k * 7919 + i) * 2654435761u;
+    return (x >> 13) & 3;
+}
+
+/**
+ * \brief valve commands : the queue alone (cost of a submission and of a
+ * drained command, queue and pending commands full, invalid commands),
+ * then a board stepped at 1 kHz on the simulated GPIO lines with three
+ * client threads and a client process, each one driving its pair of
+ * valves with immediate and scheduled commands. Every command must be
+ * acknowledged once, on its cycle for the scheduled ones, and the GPIO
+ * lines must end in the states of the last acknowledgements.
+ */
+static int benchCommand(unsigned long nbCommands)
+{
+    unsigned long wrong = 0;
+    statusErrDef res = noError;
+
+    // the queue alone, no board behind it
+    double submitNs = 0, drainNs = 0;
+    unsigned long drainSyscalls = 0, drainAllocs = 0;
+    {
+        CommandQueue queue;
+        res = queue.create("BENCHCMD", 99, 8);
+        const int nbRounds = 20;
+        for (int round = 0; round < nbRounds && res == noError; round++)
+        {
+            uint64_t t0 = nowNs();
+            for (uint32_t i = 0; i < CMD_QUEUE_RECORDS; i++)
+                wrong += !queue.submit(0, i, CMD_VALVES, 0x0F, i & 0x0F);
+            uint64_t t1 = nowNs();
+            wrong += queue.submit(0, 0, CMD_VALVES, 1, 1);
+            unsigned long syscalls = nbSyscalls, allocs = nbAllocs;
+            uint64_t t2 = nowNs();
+            int n = queue.drain(round + 1);
+            queue.acknowledge(round + 1, t2, 0x0F, 0, noError);
+            uint64_t t3 = nowNs();
+            drainSyscalls += nbSyscalls - syscalls;
+            drainAllocs += nbAllocs - allocs;
+            wrong += n != CMD_QUEUE_RECORDS;
+            submitNs += (double)(t1 - t0) / CMD_QUEUE_RECORDS / nbRounds;
+            drainNs += (double)(t3 - t2) / CMD_QUEUE_RECORDS / nbRounds;
+        }
+
+        // a valve that is not on the board, then more scheduled commands than CMD_MAX_PENDING
+        uint32_t position = queue.getAckHead();
+        queue.submit(0, 1, CMD_VALVES, 1u << 8, 0);
+        queue.submit(0, 2, 7, 1, 1);
+        for (uint32_t i = 0; i < CMD_MAX_PENDING + 6; i++)
+            queue.submit(0, 100 + i, CMD_VALVES, 1, 1, 1000);
+        wrong += queue.drain(100) != 0 || queue.getStats().pending != CMD_MAX_PENDING;
+        unsigned long invalid = 0, full = 0;
+        CommandAck ack;
+        while (queue.readAck(position, ack))
+        {
+            invalid += ack.status == errCommandInvalid;
+            full += ack.status == errCommandQueueFull;
+        }
+        wrong += invalid != 2 || full != 6;
+        // the pending commands are applied on their cycle
+        wrong += queue.drain(999) != 0 || queue.drain(1000) != CMD_MAX_PENDING;
+    }
+
+    // through a board : EG_MIN opens every valve
+    char dir[MAX_PATH_LENGTH];
+    snprintf(dir, sizeof(dir), "/tmp/cac_command_XXXXXX");
+    if (!mkdtemp(dir))
+        return EXIT_FAILURE;
+    strcat(dir, "/");
+    char path[MAX_PATH_LENGTH];
+    snprintf(path, sizeof(path), "%s%s", dir, EG_LINK_FILE);
+    FILE *link = fopen(path, "w");
+    snprintf(path, sizeof(path), "%setat0.csv", dir);
+    FILE *state = fopen(path, "w");
+    snprintf(path, sizeof(path), "%s%s", dir, ACTIVATION_FILE);
+    FILE *rules = fopen(path, "w");
+    if (!link || !state || !rules)
+        return EXIT_FAILURE;
+    fprintf(link, "0x%04X;etat0.csv\n", EG_MIN);
+    for (int v = 0; v < 8; v++)
+        fprintf(state, "RIG0;V%02d;1\n", v);
+    fprintf(rules, "board;valve;condition;target;threshold\n");
+    fclose(link);
+    fclose(state);
+    fclose(rules);
+
+    HalConfig hal;
+    statusErrDef halRes = halParse("adc=sim,gpio=sim", hal);
+    if (halRes == noError)
+        halRes = halSelect(hal);
+    const int nbClients = 4; // client 3 is a process
+    const int nbScheduled = 8; // one command out of nbScheduled is scheduled 5 cycles ahead
+    std::vector<uint64_t> requested(nbClients * nbCommands, 0);
+    std::vector<uint8_t> acked(nbClients * nbCommands, 0);
+    LatencyHisto latency;
+    unsigned long fulls = 0, superseded = 0, late = 0, stateWrong = 0, finalWrong = 0;
+    uint64_t lastCycle = 0;
+    CommandStats cmdStats = {};
+    BoardConfig board = rigBoard(0);
+    if (halRes == noError && res == noError)
+    {
+        WorkerConfig config;
+        config.priority = 0;
+        config.cpu = -1;
+        config.lockMemory = false;
+        config.csvDir = dir;
+        config.telemetry = false;
+        BoardWorker worker(board.name, board.id, config);
+        statusErrDef initRes = worker.init(&board);
+        res = initRes;
+        CAC &cac = worker.getCac();
+        SimGpio *gpio = dynamic_cast<SimGpio *>(cac.getValveBank().getBackend());
+
+        // the client process, started before any thread
+        pid_t child = fork();
+        if (child == 0)
+        {
+            CommandQueue queue;
+            uint16_t client;
+            if (queue.attach(board.name, client) != noError)
+                _exit(1);
+            for (unsigned long i = 0; i < nbCommands; i++)
+            {
+                while (!queue.submit(client, (3u << 24) | (uint32_t)i, CMD_VALVES, 3u << 6,
+                                     commandValues(3, i) << 6))
+                    usleep(100);
+                usleep(50 + (i * 37) % 400);
+            }
+            _exit(0);
+        }
+
+        std::atomic<bool> stop(false);
+        std::thread cycle([&]
+        {
+            auto next = std::chrono::steady_clock::now();
+            while (!stop)
+            {
+                next += std::chrono::microseconds(1000);
+                std::this_thread::sleep_until(next);
+                worker.step();
+            }
+        });
+
+        std::atomic<unsigned long> fullCount(0);
+        std::vector<std::thread> clients;
+        for (int k = 0; k < nbClients - 1; k++)
+            clients.emplace_back([&, k]
+            {
+                CommandQueue queue;
+                uint16_t client;
+                if (queue.attach(board.name, client) != noError)
+                    return;
+                for (unsigned long i = 0; i < nbCommands; i++)
+                {
+                    uint64_t at = 0;
+                    ValveFrame frame;
+                    if (i % nbScheduled == nbScheduled - 1 && seqlockRead(&cac.tab_vannes->seq, &cac.tab_vannes->frame, frame))
+                        at = frame.cycle + 5;
+                    requested[k * nbCommands + i] = at;
+                    while (!queue.submit(client, ((uint32_t)k << 24) | (uint32_t)i, CMD_VALVES, 3u << (2 * k),
+                                         commandValues(k, i) << (2 * k), at))
+                    {
+                        fullCount++;
+                        std::this_thread::sleep_for(std::chrono::microseconds(100));
+                    }
+                    std::this_thread::sleep_for(std::chrono::microseconds(50 + (i * 37 + k * 101) % 400));
+                }
+            });
+
+        // every acknowledgement, the last one of each pair gives its final states
+        CommandQueue reader;
+        uint16_t readerId;
+        res = res != noError ? res : reader.attach(board.name, readerId);
+        uint32_t position = 0;
+        unsigned long nbAcked = 0;
+        uint32_t lastValues[nbClients] = {};
+        uint16_t lastStatus[nbClients] = {};
+        uint64_t deadline = nowNs() + 60000000000ull;
+        while (res == noError && nbAcked < nbClients * nbCommands && nowNs() < deadline)
+        {
+            CommandAck ack;
+            if (!reader.readAck(position, ack))
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+                continue;
+            }
+            int k = ack.id >> 24;
+            unsigned long i = ack.id & 0xFFFFFF;
+            if (k >= nbClients || i >= nbCommands || acked[k * nbCommands + i]++)
+            {
+                wrong++;
+                continue;
+            }
+            nbAcked++;
+            uint32_t values = commandValues(k, i);
+            uint64_t at = requested[k * nbCommands + i];
+            late += at && ack.cycle != at;
+            if (!at)
+                latency.record(ack.appliedNs - ack.submitNs);
+            if (ack.status == infoCommandApplied)
+                stateWrong += ((ack.applied >> (2 * k)) & 3) != values;
+            else if (ack.status == errCommandOverridden)
+                superseded++;
+            else
+                wrong++;
+            lastValues[k] = values;
+            lastStatus[k] = ack.status;
+            lastCycle = std::max(lastCycle, ack.cycle);
+        }
+        for (std::thread &t : clients)
+            t.join();
+        int status = 0;
+        waitpid(child, &status, 0);
+        wrong += !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+
+        // every command is acknowledged : the lines hold the last states of every pair
+        ValveFrame before = {};
+        finalWrong += !seqlockRead(&cac.tab_vannes->seq, &cac.tab_vannes->frame, before);
+        for (int k = 0; k < nbClients; k++)
+        {
+            uint32_t pair = (uint32_t)before.vannes[2 * k].state | (uint32_t)before.vannes[2 * k + 1].state << 1;
+            finalWrong += lastStatus[k] != infoCommandApplied || pair != lastValues[k];
+        }
+
+        // a general state through the queue opens every valve
+        uint32_t statePosition = reader.getAckHead();
+        reader.submit(readerId, 1, CMD_STATE, 0, EG_MIN);
+        CommandAck stateAck = {};
+        for (int t = 0; t < 1000 && !reader.readAck(statePosition, stateAck); t++)
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        stop = true;
+        cycle.join();
+        wrong += stateAck.status != infoCommandApplied || stateAck.applied != 0xFF;
+        for (int v = 0; v < 8 && gpio; v++)
+            wrong += gpio->getValue(v) != 1;
+
+        wrong += !gpio || nbAcked != nbClients * nbCommands || late || stateWrong || finalWrong;
+        fulls = fullCount;
+        cmdStats = worker.getCommands().getStats();
+    }
+    halSelect(HalConfig());
+    std::string cmd = std::string("rm -rf ") + dir;
+    if (system(cmd.c_str()) != 0)
+        perror(cmd.c_str());
+
+    printf("== command : %d clients (one process) x %lu commands, board stepped at 1 kHz\n", nbClients, nbCommands);
+    printf("%-28s %10.1f ns/command, queue full refused without waiting\n", "submit()", submitNs);
+    printf("%-28s %10.1f ns/command, %lu syscalls, %lu allocations\n", "drain() + acknowledge()", drainNs,
+           drainSyscalls, drainAllocs);
+    printf("%-28s %10.2f us p50, %.2f p99, %.2f p99.9, %.2f max\n", "command to GPIO",
+           latency.percentile(50) / 1000.0, latency.percentile(99) / 1000.0, latency.percentile(99.9) / 1000.0,
+           latency.getMax() / 1000.0);
+    printf("%-28s %10lu applied, %lu superseded in their batch, %u largest batch, %lu submissions retried\n",
+           "acknowledgements", (unsigned long)cmdStats.applied, superseded, cmdStats.maxBatch, fulls);
+    printf("%-28s %10lu not on their cycle, %lu wrong states, last cycle %llu\n", "scheduled", late, stateWrong,
+           (unsigned long long)lastCycle);
+    printf("%-28s %10lu wrong\n", "checks", wrong);
+    return (res == noError && halRes == noError && !wrong) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * \brief time errors of one run of the schedule bench
+ */
+struct ScheduleRun
+{
+    LatencyHisto error; /**< write minus deadline, the early writes of a batch count 0 */
+    int64_t minErrorNs;
+    uint64_t writes;    /**< bulk writes reaching the lines */
+    uint32_t batches;
+    uint32_t late;
+};
+
+/**
+ * \brief function to record the time errors of a finished sequence and
+ * check its batches : every action written, none before its batch
+ * opened, none in a batch it wasn't due in, the lines in the states of
+ * the actions applied one by one in deadline order.
+ */
+static unsigned long scheduleCheck(const ValveScheduler &scheduler, const std::vector<ValveAction> &sorted,
+                                   int64_t coalesceNs, SimGpio *gpio, ScheduleRun &run)
+{
+    unsigned long wrong = 0;
+    const SchedulerStats &s = scheduler.getStats();
+    std::vector<int64_t> first(s.nbBatches, INT64_MAX), written(s.nbBatches, 0);
+    for (int i = 0; i < scheduler.getNbActions(); i++)
+    {
+        const ActionReport &r = scheduler.getReport(i);
+        if (r.status != noError && r.status != errActionLate)
+        {
+            wrong++;
+            continue;
+        }
+        first[r.batch] = std::min(first[r.batch], (int64_t)r.deadlineNs);
+        written[r.batch] = (int64_t)r.deadlineNs + r.errorNs;
+        run.error.record(r.errorNs > 0 ? (uint64_t)r.errorNs : 0);
+        run.minErrorNs = std::min(run.minErrorNs, r.errorNs);
+    }
+    for (int i = 0; i < scheduler.getNbActions(); i++)
+    {
+        const ActionReport &r = scheduler.getReport(i);
+        if (r.batch < s.nbBatches)
+            wrong += written[r.batch] < first[r.batch] ||
+                     (int64_t)r.deadlineNs > std::max(first[r.batch] + coalesceNs, written[r.batch]);
+    }
+    uint32_t reference = 0;
+    for (const ValveAction &a : sorted)
+        reference = (reference & ~a.mask) | a.values;
+    for (int v = 0; v < 8; v++)
+        wrong += !gpio || gpio->getValue(v) != (int)((reference >> v) & 1);
+    wrong += s.nbWritten != s.nbActions;
+    run.batches = s.nbBatches;
+    run.late = s.nbLate;
+    return wrong;
+}
+
+/**
+ * \brief valve sequences : thousands of actions on a 100 us grid, a
+ * quarter of them a few microseconds off it, on a bank of 8 simulated
+ * lines, run by the scheduler without and with spinning, against a
+ * thread sleeping with relative sleeps and writing each action alone.
+ * Then a board stepped at 1 kHz : the cycle must not revert the valves of
+ * the sequence, takes them back with their last states when it is done,
+ * and at once when it is aborted.
+ */
+static int benchSchedule(int nbActions)
+{
+    unsigned long wrong = 0;
+    HalConfig hal;
+    statusErrDef res = halParse("adc=sim,gpio=sim", hal);
+    if (res == noError)
+        res = halSelect(hal);
+
+    // the actions, on a grid of 100 us over a second
+    std::vector<ValveAction> actions;
+    uint32_t seed = 12345;
+    for (int i = 0; i < nbActions; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        uint64_t offset = 20000000ull + (uint64_t)(seed >> 8) % 10000 * 100000;
+        if ((seed & 3) == 0)
+            offset += (seed >> 4) % 10 * 1000;
+        uint32_t mask = (seed & 0x80) ? 3u << ((seed >> 28) & 6) : 1u << ((seed >> 28) & 7);
+        actions.push_back(ValveAction{offset, mask, (seed >> 20) & mask, (uint32_t)i});
+    }
+    std::vector<ValveAction> sorted = actions;
+    std::sort(sorted.begin(), sorted.end(), [](const ValveAction &a, const ValveAction &b)
+              { return a.deadlineNs != b.deadlineNs ? a.deadlineNs < b.deadlineNs : a.index < b.index; });
+    size_t distinct = 0;
+    for (size_t i = 0; i < sorted.size(); i++)
+        distinct += i == 0 || sorted[i].deadlineNs != sorted[i - 1].deadlineNs;
+
+    const char *labels[3] = {"sleep only", "sleep + 200 us spin", "relative sleeps, 1 write each"};
+    ScheduleRun runs[3];
+    for (int c = 0; c < 3 && res == noError; c++)
+    {
+        ScheduleRun &run = runs[c];
+        run.minErrorNs = INT64_MAX;
+        std::vector<Valve> valves;
+        valves.reserve(8);
+        ValveBank bank;
+        for (int v = 0; v < 8; v++)
+        {
+            char name[8];
+            snprintf(name, sizeof(name), "V%02d", v);
+            valves.emplace_back(name, v, 8 + v);
+            bank.addValve(&valves.back());
+        }
+        res = bank.init();
+        SimGpio *gpio = dynamic_cast<SimGpio *>(bank.getBackend());
+        if (res != noError || !gpio)
+            break;
+        uint64_t writes = bank.getNbWrites();
+
+        if (c < 2)
+        {
+            SchedulerConfig config;
+            config.priority = 0;
+            config.cpu = -1;
+            config.spinNs = c == 0 ? 0 : 200000;
+            ValveScheduler scheduler(bank, config);
+            for (const ValveAction &a : actions)
+                wrong += scheduler.schedule(a.deadlineNs, a.mask, a.values) != noError;
+            wrong += scheduler.start(nowNs()) != noError || scheduler.schedule(0, 1, 1) != errSchedulerRunning;
+            res = scheduler.wait();
+            bank.unreserve();
+            wrong += scheduleCheck(scheduler, sorted, config.coalesceNs, gpio, run);
+            wrong += scheduler.getStats().nbBatches > distinct;
+        }
+        else
+        {
+            // the baseline : sleep from now to the next deadline, write each action alone
+            bank.reserve(0xFF);
+            uint64_t t0 = nowNs();
+            uint32_t late = 0;
+            for (const ValveAction &a : sorted)
+            {
+                uint64_t deadline = t0 + a.deadlineNs;
+                uint64_t now = nowNs();
+                if (now < deadline)
+                    std::this_thread::sleep_for(std::chrono::nanoseconds(deadline - now));
+                int64_t error = (int64_t)(nowNs() - deadline);
+                wrong += bank.write(a.mask, a.values) != noError;
+                run.error.record(error > 0 ? (uint64_t)error : 0);
+                run.minErrorNs = std::min(run.minErrorNs, error);
+                late += error > SCHED_LATE_NS;
+            }
+            bank.unreserve();
+            run.batches = (uint32_t)sorted.size();
+            run.late = late;
+            uint32_t reference = 0;
+            for (const ValveAction &a : sorted)
+                reference = (reference & ~a.mask) | a.values;
+            for (int v = 0; v < 8; v++)
+                wrong += gpio->getValue(v) != (int)((reference >> v) & 1);
+        }
+        run.writes = bank.getNbWrites() - writes;
+        wrong += run.writes > run.batches;
+    }
+
+    // through a board : EG_MIN opens every valve, the sequence closes some
+    char dir[MAX_PATH_LENGTH];
+    snprintf(dir, sizeof(dir), "/tmp/cac_schedule_XXXXXX");
+    if (!mkdtemp(dir))
+        return EXIT_FAILURE;
+    strcat(dir, "/");
+    char path[MAX_PATH_LENGTH];
+    snprintf(path, sizeof(path), "%s%s", dir, EG_LINK_FILE);
+    FILE *link = fopen(path, "w");
+    snprintf(path, sizeof(path), "%setat0.csv", dir);
+    FILE *state = fopen(path, "w");
+    snprintf(path, sizeof(path), "%s%s", dir, ACTIVATION_FILE);
+    FILE *rules = fopen(path, "w");
+    snprintf(path, sizeof(path), "%s%s", dir, SEQUENCE_FILE);
+    FILE *sequence = fopen(path, "w");
+    if (!link || !state || !rules || !sequence)
+        return EXIT_FAILURE;
+    fprintf(link, "0x%04X;etat0.csv\n", EG_MIN);
+    for (int v = 0; v < 8; v++)
+        fprintf(state, "RIG0;V%02d;1\n", v);
+    // V05 is never allowed, V06 needs V07 open
+    fprintf(rules, "board;valve;condition;target;threshold\nRIG0;V05;above;PR-00;30000\nRIG0;V06;open;V07;\n");
+    // V00 and V01 closed together, V01 opened again 5 us later in the same write ; at 30 ms the
+    // opening of V05 is held closed and closing V07 closes V06 in the same write
+    fprintf(sequence, "board;time;valve;state\nRIG0;20;V00;0\nRIG0;20;V01;0\nRIG0;20.005;V01;1\n"
+                      "RIG0;x;V02;0\nRIG0;30;V99;0\nRIG0;45.25;V03;0\nRIG0;25;V06;1\nRIG0;30;V05;1\n"
+                      "RIG0;30;V07;0\n");
+    fclose(link);
+    fclose(state);
+    fclose(rules);
+    fclose(sequence);
+
+    bool boardOk = false;
+    unsigned long reverted = 0;
+    double abortMs = 0;
+    BoardConfig board = rigBoard(0);
+    if (res == noError)
+    {
+        WorkerConfig config;
+        config.priority = 0;
+        config.cpu = -1;
+        config.lockMemory = false;
+        config.csvDir = dir;
+        config.telemetry = false;
+        BoardWorker worker(board.name, board.id, config);
+        // the two invalid lines are reported, the others scheduled
+        statusErrDef initRes = worker.init(&board);
+        ValveScheduler &scheduler = worker.getScheduler();
+        wrong += initRes != errOpenSequenceFile || scheduler.getNbActions() != 7;
+        CAC &cac = worker.getCac();
+        SimGpio *gpio = dynamic_cast<SimGpio *>(cac.getValveBank().getBackend());
+        __atomic_store_n(&cac.tab_vannes->generalState, (uint16_t)EG_MIN, __ATOMIC_RELEASE);
+
+        std::atomic<bool> stop(false);
+        std::thread cycle([&]
+        {
+            auto next = std::chrono::steady_clock::now();
+            while (!stop)
+            {
+                next += std::chrono::microseconds(1000);
+                std::this_thread::sleep_until(next);
+                worker.step();
+            }
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        wrong += !gpio || cac.getValveMask() != 0xDF;
+
+        if (gpio)
+        {
+            uint64_t t0 = nowNs();
+            wrong += scheduler.start(t0) != noError;
+            // between the writes the cycle keeps commanding them open
+            while (nowNs() < t0 + 70000000ull)
+            {
+                uint64_t at = nowNs() - t0;
+                if (at > 21000000ull)
+                    reverted += gpio->getValue(0) != 0 || gpio->getValue(1) != 1;
+                if (at > 30000000ull)
+                    reverted += gpio->getValue(5) != 0 || (at > 31000000ull && gpio->getValue(6) != 0);
+                if (at > 46250000ull && !scheduler.isDone())
+                    reverted += gpio->getValue(3) != 0;
+                std::this_thread::sleep_for(std::chrono::microseconds(300));
+            }
+            wrong += !scheduler.isDone() || scheduler.wait() != noError;
+            const SchedulerStats &s = scheduler.getStats();
+            wrong += s.nbBatches != 4 || s.nbWritten != 7 || s.nbInterlocked != 1 || s.nbDropped != 0 ||
+                     scheduler.getReport(5).status != errActionInterlocked;
+            // handed back : commanded closed, in manual mode
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            wrong += cac.getValveBank().getReservedMask() != 0 || cac.getValveMask() != 0x16 ||
+                     cac.tab_vannes->commands[0] != 0 || cac.tab_vannes->commands[3] != 0;
+
+            // aborted : the valves go back to their commands on the next cycle
+            scheduler.clear();
+            scheduler.schedule(10000000ull, 1u << 4, 0);
+            scheduler.schedule(5000000000ull, 1u << 4, 1u << 4);
+            t0 = nowNs();
+            scheduler.start(t0);
+            wrong += scheduler.getReport(1).status != infoActionPending;
+            std::this_thread::sleep_for(std::chrono::milliseconds(30));
+            wrong += gpio->getValue(4) != 0;
+            uint64_t a0 = nowNs();
+            scheduler.abort();
+            while (gpio->getValue(4) != 1 && nowNs() < a0 + 1000000000ull)
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            abortMs = (nowNs() - a0) / 1e6;
+            wrong += scheduler.wait() != noError || gpio->getValue(4) != 1 ||
+                     scheduler.getReport(0).status != noError ||
+                     scheduler.getReport(1).status != infoSequenceAborted || scheduler.getStats().nbDropped != 1 ||
+                     nowNs() > t0 + 1000000000ull;
+
+            // done but aborted before it is handed back : nothing dropped
+            scheduler.clear();
+            scheduler.schedule(0, 1u << 4, 0);
+            scheduler.start(nowNs());
+            scheduler.wait();
+            scheduler.abort();
+            wrong += scheduler.getStats().nbDropped != 0 || scheduler.getReport(0).status != noError;
+            boardOk = true;
+        }
+        stop = true;
+        cycle.join();
+    }
+    halSelect(HalConfig());
+    std::string cmd = std::string("rm -rf ") + dir;
+    if (system(cmd.c_str()) != 0)
+        perror(cmd.c_str());
+    wrong += !boardOk || reverted;
+
+    printf("== schedule : %d actions on 8 simulated lines over 1 s, %zu distinct deadlines\n", nbActions, distinct);
+    for (int c = 0; c < 3; c++)
+        printf("%-30s %8.1f us p50, %.1f p99, %.1f p99.9, %.1f max, %.1f min ; %u batches, %llu writes, %u late\n",
+               labels[c], runs[c].error.percentile(50) / 1e3, runs[c].error.percentile(99) / 1e3,
+               runs[c].error.percentile(99.9) / 1e3, runs[c].error.getMax() / 1e3,
+               runs[c].minErrorNs == INT64_MAX ? 0.0 : runs[c].minErrorNs / 1e3, runs[c].batches,
+               (unsigned long long)runs[c].writes, runs[c].late);
+    printf("%-30s %8lu samples reverted by the cycle, abort to GPIO %.2f ms\n", "board", reverted, abortMs);
+    printf("%-30s %8lu wrong\n", "checks", wrong);
+    return (res == noError && !wrong) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * \brief figures of one e2e case
+ */
+struct E2eCase
+{
+    const char *name;
+    const char *spec;
+    unsigned long cycles;
+    LatencyHisto acquire;
+    LatencyHisto decide;   /**< exchange and decide */
+    LatencyHisto actuate;
+    LatencyHisto cycle;    /**< from the first read to the last record */
+    unsigned long syscalls;
+    unsigned long allocs;
+    unsigned long maxAllocs; /**< largest number of allocations of one cycle */
+    unsigned long wrong;
+    bool ok;
+};
+
+/**
+ * \brief function to run one case : a board of 8 sensors and 8 valves
+ * on the simulated backends, its general state switched every 100
+ * cycles so decide and actuate have work, driven by step() without
+ * executive so only the code of the cycle is measured.
+ */
+static void e2eRun(E2eCase &c, const char *csvDir)
+{
+    c.ok = false;
+    HalConfig hal;
+    if (halParse(c.spec, hal) != noError || halSelect(hal) != noError)
+        return;
+    WorkerConfig config;
+    config.priority = 0;
+    config.cpu = -1;
+    config.lockMemory = false;
+    config.csvDir = csvDir;
+    config.telemetry = false;
+    config.phaseTiming = true;
+    BoardConfig board = rigBoard(0);
+    BoardWorker worker(board.name, board.id, config);
+    if (worker.init(&board) != noError)
+        return;
+    uint16_t *eg = &worker.getCac().tab_vannes->generalState;
+
+    const unsigned long warmup = 1000;
+    for (unsigned long i = 0; i < warmup + c.cycles; i++)
+    {
+        __atomic_store_n(eg, (uint16_t)(EG_MIN + (i / 100) % 2), __ATOMIC_RELEASE);
+        unsigned long s0 = nbSyscalls, a0 = nbAllocs;
+        worker.step();
+        if (i < warmup)
+            continue;
+        unsigned long allocs = nbAllocs - a0;
+        c.syscalls += nbSyscalls - s0;
+        c.allocs += allocs;
+        c.maxAllocs = std::max(c.maxAllocs, allocs);
+        const CyclePhases &p = worker.getPhases();
+        c.acquire.record(p.acquireNs);
+        c.decide.record(p.exchangeNs + p.decideNs);
+        c.actuate.record(p.actuateNs);
+        c.cycle.record((uint64_t)p.acquireNs + p.exchangeNs + p.decideNs + p.actuateNs + p.recordNs);
+    }
+
+    // the last state applied is EG_MIN + ((warmup + cycles - 1) / 100) % 2
+    SimGpio *gpio = dynamic_cast<SimGpio *>(worker.getCac().getValveBank().getBackend());
+    bool high = ((warmup + c.cycles - 1) / 100) % 2;
+    if (!gpio)
+        c.wrong++;
+    for (int v = 0; v < 8 && gpio; v++)
+        c.wrong += gpio->getValue(v) != ((v >= 4) == high);
+    c.ok = true;
+}
+
+static void e2ePrintHisto(const char *label, const LatencyHisto &h)
+{
+    printf("%-28s %9.2f us p50, %.2f p99, %.2f p99.9, %.2f max\n", label, h.percentile(50) / 1000.0,
+           h.percentile(99) / 1000.0, h.percentile(99.9) / 1000.0, h.getMax() / 1000.0);
+}
+
+/**
+ * \brief end to end : the real Sensor, Valve, Sequencer, Interlock and
+ * CAC code of a board cycle on the simulated ADC and GPIO lines, latency
+ * of each phase and of the whole cycle, syscalls and allocations per
+ * cycle. The figures are written as JSON to jsonPath, to compare commits.
+ */
+static int benchE2e(unsigned long nbCycles, const char *jsonPath)
+{
+    char csvDir[MAX_PATH_LENGTH];
+    snprintf(csvDir, sizeof(csvDir), "/tmp/cac_e2e_XXXXXX");
+    if (!mkdtemp(csvDir))
+        return EXIT_FAILURE;
+    strcat(csvDir, "/");
+    char path[MAX_PATH_LENGTH];
+    snprintf(path, sizeof(path), "%s%s", csvDir, EG_LINK_FILE);
+    FILE *link = fopen(path, "w");
+    snprintf(path, sizeof(path), "%setat0.csv", csvDir);
+    FILE *low = fopen(path, "w");
+    snprintf(path, sizeof(path), "%setat1.csv", csvDir);
+    FILE *high = fopen(path, "w");
+    snprintf(path, sizeof(path), "%s%s", csvDir, ACTIVATION_FILE);
+    FILE *rules = fopen(path, "w");
+    if (!link || !low || !high || !rules)
+        return EXIT_FAILURE;
+    fprintf(link, "0x%04X;etat0.csv\n0x%04X;etat1.csv\n", EG_MIN, EG_MIN + 1);
+    for (int v = 0; v < 8; v++)
+    {
+        fprintf(low, "RIG0;V%02d;%d\n", v, v < 4);
+        fprintf(high, "RIG0;V%02d;%d\n", v, v >= 4);
+    }
+    fclose(link);
+    fclose(low);
+    fclose(high);
+    fclose(rules);
+
+    // the acquisition dominates with a SPI-like read time, not without
+    static E2eCase cases[] = {
+        {"sim", "adc=sim,noise=3,gpio=sim", nbCycles, {}, {}, {}, {}, 0, 0, 0, 0, false},
+        {"sim latency", "adc=sim,noise=3,latency=10,jitter=2,gpio=sim,gpiolatency=2", nbCycles / 10, {}, {}, {}, {},
+         0, 0, 0, 0, false},
+    };
+    bool ok = true;
+    unsigned long wrong = 0;
+    printf("== e2e : one board of 8 sensors and 8 valves, EG switched every 100 cycles\n");
+    for (E2eCase &c : cases)
+    {
+        e2eRun(c, csvDir);
+        ok &= c.ok;
+        wrong += c.wrong;
+        printf("-- %s (%s), %lu cycles\n", c.name, c.spec, c.cycles);
+        e2ePrintHisto("acquire", c.acquire);
+        e2ePrintHisto("decide", c.decide);
+        e2ePrintHisto("actuate", c.actuate);
+        e2ePrintHisto("cycle", c.cycle);
+        printf("%-28s %9.2f syscalls/cycle, %.2f allocations/cycle (max %lu), %lu wrong valves\n", "per cycle",
+               c.cycles ? (double)c.syscalls / c.cycles : 0.0, c.cycles ? (double)c.allocs / c.cycles : 0.0,
+               c.maxAllocs, c.wrong);
+    }
+    std::string cmd = std::string("rm -rf ") + csvDir;
+    if (system(cmd.c_str()) != 0)
+        perror(cmd.c_str());
+
+    if (jsonPath)
+    {
+        FILE *json = fopen(jsonPath, "w");
+        if (!json)
+        {
+            perror(jsonPath);
+            return EXIT_FAILURE;
+        }
+        fprintf(json, "{\"bench\": \"e2e\", \"unit\": \"ns\", \"cases\": [\n");
+        for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+        {
+            const E2eCase &c = cases[i];
+            fprintf(json, "  {\"name\": \"%s\", \"hal\": \"%s\", \"cycles\": %lu,\n", c.name, c.spec, c.cycles);
+            const char *labels[] = {"acquire", "decide", "actuate", "cycle"};
+            const LatencyHisto *histos[] = {&c.acquire, &c.decide, &c.actuate, &c.cycle};
+            for (int h = 0; h < 4; h++)
+            {
+                fprintf(json, "   \"%s\": ", labels[h]);
+                histos[h]->printJson(json);
+                fprintf(json, ",\n");
+            }
+            fprintf(json,
+                    "   \"syscallsPerCycle\": %.3f, \"allocsPerCycle\": %.3f, \"maxAllocsPerCycle\": %lu, "
+                    "\"wrongValves\": %lu}%s\n",
+                    c.cycles ? (double)c.syscalls / c.cycles : 0.0, c.cycles ? (double)c.allocs / c.cycles : 0.0,
+                    c.maxAllocs, c.wrong, i + 1 < sizeof(cases) / sizeof(cases[0]) ? "," : "");
+        }
+        fprintf(json, "]}\n");
+        fclose(json);
+        printf("%-28s %s\n", "json", jsonPath);
+    }
+
+    // the next scenarios run on the real backends again
+    halSelect(HalConfig());
+    return (ok && !wrong) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char *argv[])
+{
+    std::string scenario = (argc > 1) ? argv[1] : "all";
+    int res = EXIT_SUCCESS;
+
+    if (scenario == "all" || scenario == "sysfs")
+        res |= benchSysfs(20000);
+    if (scenario == "all" || scenario == "iio")
+        res |= benchIio(200000);
+    if (scenario == "all" || scenario == "seqlock")
+        res |= benchSeqlock(2000000, 3);
+    if (scenario == "all" || scenario == "shm")
+        res |= benchShm(2000);
+    if (scenario == "all" || scenario == "cycle")
+        res |= benchCycle(2000);
+    if (scenario == "all" || scenario == "log")
+        res |= benchLog(25, 1000000);
+    if (scenario == "all" || scenario == "telem")
+        res |= benchTelem(4, 2000);
+    if (scenario == "all" || scenario == "modbus")
+        res |= benchModbus(2000);
+    if (scenario == "all" || scenario == "static")
+        res |= benchStatic(50000, 5);
+    if (scenario == "all" || scenario == "sequence")
+        res |= benchSequence(500, 1000000);
+    if (scenario == "all" || scenario == "csv")
+        res |= benchCsv(8, 4, 5);
+    if (scenario == "all" || scenario == "interlock")
+        res |= benchInterlock(200000, 10000000);
+    if (scenario == "all" || scenario == "opl")
+        res |= benchOpl(1000000, 2000);
+    if (scenario == "all" || scenario == "multi")
+        res |= benchMulti(4, 20000, 1000, 1000);
+    if (scenario == "all" || scenario == "hal")
+        res |= benchHal(200000, 250, 1000);
+    if (scenario == "all" || scenario == "bank")
+        res |= benchBank(1000000, 10000);
+    if (scenario == "all" || scenario == "condition")
+        res |= benchCondition(1000000);
+    if (scenario == "all" || scenario == "health")
+        res |= benchHealth(1000000);
+    if (scenario == "all" || scenario == "alarm")
+        res |= benchAlarm(1000000);
+    if (scenario == "all" || scenario == "stream")
+        res |= benchStream(2000);
+    if (scenario == "all" || scenario == "command")
+        res |= benchCommand(2000);
+    if (scenario == "all" || scenario == "schedule")
+        res |= benchSchedule(5000);
+    if (scenario == "all" || scenario == "e2e")
+        res |= benchE2e(200000, (argc > 2) ? argv[2] : nullptr);
+
+    return res;
+}
@@ -27,77 +27,500 @@
 #include "configCAC.h"
 */
 #include "cac.h"
+#include "monotonicClock.h"
 
-CAC::CAC(const std::string &name, uint8_t id) : name(name), id(id), tab_sensors(nullptr), tab_vannes(nullptr)
+#include <math.h>
+#include <time.h>
+
+/**
+ * \brief function to get the applied valve states, bit i for vannes[i].
+ */
+uint32_t CAC::getValveMask() const
+{
+    return bank.getAppliedMask();
+}
+
+/**
+ * \brief function to set the commands of every valve from a bitmask,
+ * applied together by the next actuate().
+ *
+ * \param mask bit i set to open vannes[i]
+ */
+void CAC::setCommands(uint32_t mask)
+{
+    for (size_t i = 0; i < vannes.size(); i++)
+        __atomic_store_n(&tab_vannes->commands[i], (uint8_t)((mask >> i) & 1), __ATOMIC_RELAXED);
+}
+
+/**
+ * \brief function to set the commands of some valves from a bitmask, the
+ * others keep their commands.
+ *
+ * \param mask bit i set to open vannes[i]
+ * \param select bit i set to change the command of vannes[i]
+ */
+void CAC::setCommands(uint32_t mask, uint32_t select)
+{
+    for (size_t i = 0; i < vannes.size(); i++)
+        if ((select >> i) & 1)
+            __atomic_store_n(&tab_vannes->commands[i], (uint8_t)((mask >> i) & 1), __ATOMIC_RELAXED);
+}
+
+/**
+ * \brief function to set the interlock rules checked by actuate().
+ *
+ * \param rules rules loaded for this board, nullptr to drive the valves unchecked
+ */
+void CAC::setInterlock(Interlock *rules)
+{
+    interlock = rules;
+}
+
+/**
+ * \brief function to set the conditioning applied by acquire(), and
+ * publish the unit of each sensor. Called before the first cycle.
+ *
+ * \param stages stages loaded for this board, nullptr to publish the counts
+ */
+void CAC::setConditioner(Conditioner *stages)
+{
+    conditioner = stages;
+    if (!tab_sensors)
+        return;
+    for (size_t i = 0; i < sensors.size(); i++)
+        strncpy(tab_sensors->units[i], stages ? stages->getUnit((int)i) : "counts", COND_UNIT_LENGTH - 1);
+}
+
+/**
+ * \brief function to get the health engine of the sensors, its statistics
+ * can be read from any thread.
+ */
+const SensorHealth &CAC::getHealth() const
+{
+    return health;
+}
+
+uint8_t CAC::getId() const
+{
+    return id;
+}
+
+/**
+ * \brief function to get the component table of the board.
+ */
+const BoardConfig &CAC::getConfig() const
+{
+    return config;
+}
+
+/**
+ * \brief function to get the name of the board.
+ */
+const std::string &CAC::getName() const
+{
+    return name;
+}
+
+/**
+ * \brief function to get the valve bank of the board, e.g. its GPIO backend.
+ */
+const ValveBank &CAC::getValveBank() const
+{
+    return bank;
+}
+
+ValveBank &CAC::getValveBank()
+{
+    return bank;
+}
+
+/**
+ * \brief function to get the name of the sensor segment of the board.
+ */
+const std::string &CAC::getShmSensorName() const
+{
+    return shmSensorName;
+}
+
+/**
+ * \brief function to get the name of the valve segment of the board.
+ */
+const std::string &CAC::getShmVanneName() const
+{
+    return shmVanneName;
+}
+
+CAC::CAC(const std::string &name, uint8_t id)
+    : id(id), name(name), iioEnabled(false), modbusEnabled(false), cycleSensor(0), cycleVanne(0), config{}, interlock(nullptr), conditioner(nullptr), lastRefused(0), sensorFrame{},
+      shmSensorName(std::string(SHM_Sensor) + "_" + name), shmVanneName(std::string(SHM_Vanne) + "_" + name), tab_sensors(nullptr), tab_vannes(nullptr)
 {
 }
 
 CAC::~CAC()
 {
+    // the sysfs channels are kept open from init(), closed with the board
+    for (Sensor &sensor : sensors)
+        sensor.extinctSensor();
+
+    // each segment of the board is unmapped and removed, a reader keeps its mapping
+    if (tab_sensors)
+        munmap(tab_sensors, sizeof(SensorData));
+    shm_unlink(shmSensorName.c_str());
 
-    munmap(tab_sensors, sizeof(SensorData));
-    // close(shm_fd_sensor);
-    shm_unlink(SHM_Sensor);
+    if (tab_vannes)
+        munmap(tab_vannes, sizeof(VanneData));
+    shm_unlink(shmVanneName.c_str());
+}
+
+/**
+ * \brief function to fill the header of a segment, the magic is
+ * written last so a reader only accepts a complete header.
+ */
+void CAC::initHeader(ShmHeader &header, uint32_t size, uint8_t count)
+{
+    header.version = SHM_LAYOUT_VERSION;
+    header.headerSize = sizeof(ShmHeader);
+    header.totalSize = size;
+    header.boardId = id;
+    header.count = count;
+    strncpy(header.boardName, name.c_str(), SHM_NAME_LENGTH - 1);
+    header.boardName[SHM_NAME_LENGTH - 1] = 0;
+    __atomic_store_n(&header.magic, SHM_LAYOUT_MAGIC, __ATOMIC_RELEASE);
+}
+
+/**
+ * \brief function to initialise the board from a compiled-in component map.
+ * The ids are decoded once here : below id * 10 + 5 a component is a valve,
+ * above it is a sensor.
+ *
+ * \param dict the components of the board, e.g. dict_CACMO
+ * \return statusErrDef of init(const BoardConfig &).
+ */
+statusErrDef CAC::init(std::map<int, std::variant<Sensor, Valve>> dict)
+{
+    BoardConfig board = {};
+    strncpy(board.name, name.c_str(), SHM_NAME_LENGTH - 1);
+    board.id = id;
+    for (const auto &[id_composant, value] : dict)
+    {
+        if (id_composant < id * 10 + 5)
+        {
+            if (std::holds_alternative<Valve>(value) && board.nbValves < NVanne)
+            {
+                const Valve &valve = std::get<Valve>(value);
+                ValveSlot &slot = board.valves[board.nbValves++];
+                strncpy(slot.name, valve.getName().c_str(), PHYS_NAME_LENGTH - 1);
+                slot.id = (uint8_t)id_composant;
+                slot.pin = valve.getPin();
+            }
+            else
+                std::cerr << "Error: Expected Valve but found Sensor for id " << id_composant << std::endl;
+        }
+        else
+        {
+            if (std::holds_alternative<Sensor>(value) && board.nbSensors < NCapteur)
+            {
+                const Sensor &sensor = std::get<Sensor>(value);
+                SensorSlot &slot = board.sensors[board.nbSensors++];
+                strncpy(slot.name, sensor.getName().c_str(), PHYS_NAME_LENGTH - 1);
+                slot.id = (uint8_t)id_composant;
+                slot.type = sensor.getType();
+                slot.channel = sensor.getChannel();
+            }
+            else
+                std::cerr << "Error: Expected Sensor but found Valve for id " << id_composant << std::endl;
+        }
+    }
+    return init(board);
+}
 
-    munmap(tab_vannes, sizeof(VanneData));
-    // close(shm_fd_sensor);
-    shm_unlink(SHM_Sensor);
+/**
+ * \brief function to create, size and map a shared memory segment.
+ * The descriptor is closed on every path.
+ *
+ * \return the mapping, nullptr on failure with errno set.
+ */
+static void *mapSegment(const std::string &shmName, size_t size)
+{
+    int fd = shm_open(shmName.c_str(), O_CREAT | O_RDWR, 0666);
+    if (fd < 0)
+    {
+        perror("shm_open failed");
+        return nullptr;
+    }
+    if (ftruncate(fd, size) == -1)
+    {
+        perror("ftruncate failed");
+        close(fd);
+        return nullptr;
+    }
+    void *map = mmap(0, size, PROT_WRITE | PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        perror("mmap failed");
+        return nullptr;
+    }
+    return map;
 }
 
-statusErrDef CAC::init(std::map<int, std::variant<Sensor, Valve>>)
+/**
+ * \brief function to create the shared memory segments and the drivers
+ * of the board, one per slot of its component table. Without its
+ * segments the board has no component and acquire() and actuate() fail.
+ *
+ * \param board the valves and sensors of the board, from PhysicalConfig
+ * \return statusErrDef that values errOpenValveShm or errOpenSensorShm
+ * when a segment can't be created or mapped, otherwise the first error of
+ * the valve bank, the modbus bus or the IIO buffer.
+ */
+statusErrDef CAC::init(const BoardConfig &board)
 {
-    shm_unlink(SHM_Vanne);
-    shm_unlink(SHM_Sensor);
+    config = board;
+    shm_unlink(shmVanneName.c_str());
+    shm_unlink(shmSensorName.c_str());
 
     statusErrDef res = noError;
-    int shm_fd_vanne = shm_open(SHM_Vanne, O_CREAT | O_RDWR, 0666);
-    if (shm_fd_vanne < 0)
+    tab_vannes = (VanneData *)mapSegment(shmVanneName, sizeof(VanneData));
+    if (!tab_vannes)
     {
-        perror("shm_open Vanne failed");
-        // res=...
-        return res;
+        logEvent(logValve, errOpenValveShm, "valve segment not mapped (board, errno)", id, errno);
+        return errOpenValveShm;
     }
-    if (ftruncate(shm_fd_vanne, sizeof(VanneData)) == -1)
+    tab_sensors = (SensorData *)mapSegment(shmSensorName, sizeof(SensorData));
+    if (!tab_sensors)
     {
-        perror("ftruncate Vanne failed");
-        return res;
+        logEvent(logSensor, errOpenSensorShm, "sensor segment not mapped (board, errno)", id, errno);
+        munmap(tab_vannes, sizeof(VanneData));
+        tab_vannes = nullptr;
+        return errOpenSensorShm;
     }
-    tab_vannes = (VanneData *)mmap(0, sizeof(VanneData), PROT_WRITE | PROT_READ, MAP_SHARED, shm_fd_vanne, 0);
-    if (tab_vannes == MAP_FAILED)
+    memset(tab_vannes, 0, sizeof(VanneData));
+    memset(tab_sensors, 0, sizeof(SensorData));
+
+    // the drivers must not move once initialised (gpiod lines, IioBuffer)
+    vannes.reserve(board.nbValves);
+    sensors.reserve(board.nbSensors);
+    for (int v = 0; v < board.nbValves; v++)
+        vannes.emplace_back(board.valves[v].name, (int8_t)board.valves[v].id, board.valves[v].pin);
+    for (int c = 0; c < board.nbSensors; c++)
+        sensors.emplace_back(board.sensors[c].name, board.sensors[c].id, board.sensors[c].type, board.sensors[c].channel);
+
+    // one chip handle and one bulk request for all the valves
+    for (Valve &vanne : vannes)
+        bank.addValve(&vanne);
+    statusErrDef bankRes = bank.init();
+    res = bankRes;
+    for (size_t i = 0; i < vannes.size(); i++)
     {
-        perror("mmap Vanne failed");
-        return res;
+        tab_vannes->frame.vannes[i].status = bankRes;
+        tab_vannes->frame.vannes[i].state = vannes[i].getstate();
+        tab_vannes->commands[i] = vannes[i].getstate();
     }
 
-    int shm_fd_sensor = shm_open(SHM_Sensor, O_CREAT | O_RDWR, 0666);
-    ftruncate(shm_fd_sensor, sizeof(SensorData));
-    tab_sensors = (SensorData *)mmap(0, sizeof(SensorData), PROT_WRITE | PROT_READ, MAP_SHARED, shm_fd_sensor, 0);
+    health.init(board);
+    for (size_t i = 0; i < sensors.size(); i++)
+    {
+        Sensor &sensor = sensors[i];
+        tab_sensors->frame.sensors[i].status = sensor.initSensor();
+        tab_sensors->frame.sensors[i].value = sensor.getValue();
+        tab_sensors->frame.values[i] = NAN;
+        strcpy(tab_sensors->units[i], "counts");
+        // the buffered channels are all read by one IioBuffer
+        if (sensor.getType() == 3 && iio.addSensor(&sensor) == noError)
+            iioEnabled = true;
+        // and the modbus sensors by one ModbusBus
+        if (sensor.getType() == 2 && modbus.addSensor(&sensor) == noError)
+            modbusEnabled = true;
+    }
 
-    // Verification nb capteur ...
+    // the first error is returned, the next steps still run
+    if (modbusEnabled)
+    {
+        statusErrDef busRes = modbus.open();
+        if (busRes != noError)
+        {
+            modbusEnabled = false;
+            if (res == noError)
+                res = busRes;
+        }
+    }
 
-    for (const auto &[id_composant, value] : dict_CACMO)
+    if (iioEnabled)
     {
-        if (id_composant < id * 10 + 5)
+        statusErrDef bufferRes = iio.enable();
+        if (bufferRes != noError)
         {
-            if (std::holds_alternative<Valve>(value))
-            {
-                tab_vannes->vannes[id_composant % 10] = std::get<Valve>(value);
-                tab_vannes->vannes[id_composant % 10].init();
-            }
-            else
-                std::cerr << "Error: Expected Valve but found Valve for id " << id_composant << std::endl;
+            iioEnabled = false;
+            if (res == noError)
+                res = bufferRes;
         }
-        else
+    }
+
+    initHeader(tab_vannes->header, sizeof(VanneData), (uint8_t)vannes.size());
+    initHeader(tab_sensors->header, sizeof(SensorData), (uint8_t)sensors.size());
+
+    return res;
+}
+
+/**
+ * \brief function to read every sensor of the board once
+ * and publish the samples in SHM_Sensor.
+ *
+ * The channel vector is built locally and published as a whole
+ * under the sequence lock of the segment.
+ *
+ * The type 3 sensors are all updated by a single read of the IIO buffer,
+ * the other ones are read channel by channel, several times when the
+ * conditioner oversamples them. The channel vector then goes through
+ * the health engine, is conditioned and published with the raw counts.
+ * A sample never holds ADC_READ_ERROR, the faults of the health engine
+ * are published in the frame and not returned.
+ *
+ * \return statusErrDef that values errOpenSensorShm when the board has
+ * no sensor segment, errReadAdc when the IIO buffer read fails, errOpenAdc
+ * or errOpenModbus when the buffer or the bus failed to open, the first
+ * error of Sensor::readChannel(), or noError.
+ */
+statusErrDef CAC::acquire()
+{
+    if (!tab_sensors)
+        return errOpenSensorShm;
+
+    statusErrDef res = noError;
+    statusErrDef iioRes = noError;
+
+    if (iioEnabled && iio.readScans() < 0)
+        iioRes = res = errReadAdc;
+    // never waits for the slaves, the values are the last answered ones
+    statusErrDef modbusRes = modbusEnabled ? modbus.poll() : noError;
+    if (modbusRes != noError && res == noError)
+        res = modbusRes;
+
+    SensorFrame frame = {};
+    frame.cycle = ++cycleSensor;
+    float raw[MAX_SENSORS] = {};
+    uint32_t valid = 0;
+    for (size_t i = 0; i < sensors.size(); i++)
+    {
+        statusErrDef ret = sensors[i].readChannel();
+        int sum = ret == noError ? sensors[i].getValue() : 0;
+        int nbValid = ret == noError;
+        if (sensors[i].getType() == 3)
+            // errOpenAdc when the buffer failed to enable, as errReadAdc when its read fails
+            ret = iioEnabled ? iioRes : errOpenAdc;
+        else if (sensors[i].getType() == 2)
+            // errOpenModbus when the bus failed to open, the last answer of its slave otherwise
+            ret = modbus.getStatus(&sensors[i]);
+        else if (conditioner)
         {
-            if (std::holds_alternative<Sensor>(value))
+            // oversampling : the mean of the reads that succeeded, an error only when they all failed
+            for (int k = 1; k < conditioner->getOversampling((int)i); k++)
             {
-                tab_sensors->sensors[id_composant % 10 - 5] = std::get<Sensor>(value);
-                tab_sensors->sensors[id_composant % 10 - 5].initSensor();
+                statusErrDef again = sensors[i].readChannel();
+                if (again == noError)
+                {
+                    sum += sensors[i].getValue();
+                    nbValid++;
+                }
             }
-            else
-                std::cerr << "Error: Expected Valve but found Sensor for id " << id_composant << std::endl;
+            if (nbValid)
+                ret = noError;
         }
+        if (ret != noError && res == noError)
+            res = ret;
+
+        SensorSample &sample = frame.sensors[i];
+        raw[i] = nbValid > 1 ? (float)sum / nbValid : sensors[i].getValue();
+        sample.value = nbValid > 1 ? (int16_t)lrintf(raw[i]) : sensors[i].getValue();
+        sample.status = ret;
+        sample.seq = (uint32_t)cycleSensor;
+        sample.timestamp = monotonicNs();
+        valid |= (uint32_t)(ret == noError) << i;
     }
 
+    // a failed read or an ADC_READ_ERROR value is replaced by the last good
+    // value, a channel disconnected or saturated gets the fault status
+    int16_t counts[MAX_SENSORS];
+    for (size_t i = 0; i < sensors.size(); i++)
+        counts[i] = frame.sensors[i].value;
+    frame.faulty = health.update(counts, valid, frame.health);
+    for (size_t i = 0; i < sensors.size(); i++)
+    {
+        SensorSample &sample = frame.sensors[i];
+        if (frame.health[i] & SENSOR_HEALTH_ERROR)
+            raw[i] = sample.value = counts[i];
+        if (sample.status == noError && (frame.health[i] & SENSOR_HEALTH_UNUSABLE))
+            sample.status = SensorHealth::faultCode(frame.health[i]);
+    }
+    if (conditioner)
+        conditioner->apply(raw, valid, frame.values);
+    else
+        for (size_t i = 0; i < sensors.size(); i++)
+            frame.values[i] = ((valid >> i) & 1) ? raw[i] : NAN;
+    frame.timestamp = monotonicNs();
+    seqlockPublish(&tab_sensors->seq, &tab_sensors->frame, frame);
+    sensorFrame = frame;
+    return res;
+}
+
+/**
+ * \brief function to apply the valve commands of SHM_Vanne
+ * with a single bulk GPIO write and publish the applied states.
+ * The GPIO lines are only written when a command changed.
+ *
+ * The commands are filtered by the interlock rules first, the valves
+ * held closed are published with the status of Interlock::filter().
+ * The commands themselves are kept, such a valve opens once its
+ * dependencies are met.
+ *
+ * \return statusErrDef that values errOpenValveShm when the board has no
+ * valve segment, the statusErrDef of ValveBank::apply() otherwise.
+ */
+statusErrDef CAC::actuate()
+{
+    if (!tab_vannes)
+        return errOpenValveShm;
+
+    uint32_t commanded = 0;
+    for (size_t i = 0; i < vannes.size(); i++)
+        commanded |= (uint32_t)(__atomic_load_n(&tab_vannes->commands[i], __ATOMIC_RELAXED) != 0) << i;
+
+    // the valves of a running sequence are checked in their written state
+    uint32_t reserved = bank.getReservedMask();
+    commanded = (commanded & ~reserved) | (bank.getAppliedMask() & reserved);
+    uint32_t allowed = commanded;
+    statusErrDef lockRes = infoNoDepend;
+    if (interlock)
+        lockRes = interlock->filter(commanded, bank.getAppliedMask(), sensorFrame, allowed);
+    // and closed by the cycle when their dependencies are lost between two writes of the sequence
+    if (reserved & ~allowed & bank.getAppliedMask())
+        bank.write(reserved & ~allowed, 0);
+    uint32_t refused = commanded & ~allowed;
+    if (refused != lastRefused)
+    {
+        logEvent(logValve, refused ? lockRes : infoVerifDependSucess, "interlock held valves closed (mask)",
+                 (int32_t)refused);
+        lastRefused = refused;
+    }
+    for (size_t i = 0; i < vannes.size(); i++)
+        vannes[i].state = (allowed >> i) & 1;
+
+    statusErrDef res = bank.apply();
+    uint64_t now = monotonicNs();
+
+    ValveFrame frame = {};
+    frame.cycle = ++cycleVanne;
+    frame.timestamp = now;
+    for (size_t i = 0; i < vannes.size(); i++)
+    {
+        ValveSample &sample = frame.vannes[i];
+        sample.state = (uint8_t)((bank.getAppliedMask() >> i) & 1);
+        sample.status = ((refused >> i) & 1) ? lockRes : res;
+        sample.seq = (uint32_t)cycleVanne;
+        sample.timestamp = now;
+        sample.transitions = bank.getTransitions((int)i);
+    }
+    seqlockPublish(&tab_vannes->seq, &tab_vannes->frame, frame);
     return res;
 }
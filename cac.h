@@ -31,34 +31,72 @@
 #include <iostream>
 #include "sensor.h"
 #include "valve.h"
+#include "valveBank.h"
+#include "iioBuffer.h"
+#include "modbusBus.h"
 #include "configCAC.h"
+#include "physicalConfig.h"
+#include "interlock.h"
+#include "conditioning.h"
+#include "sensorHealth.h"
+#include "shmLayout.h"
+#include <vector>
 #include <sys/mman.h> // For shared memory
 
+/**
+ * \brief prefix of the shared memory segments, the board name is appended
+ * so several boards run on one host : /sensor_shm_CACMO, /vanne_shm_CACMO
+ */
 #define SHM_Sensor "/sensor_shm"
 #define SHM_Vanne "/vanne_shm"
 
-struct SensorData
-{
-    Sensor sensors[NCapteur];
-};
-
-struct VanneData
-{
-    Valve vannes[NVanne];
-};
-
 class CAC
 {
 private:
     uint8_t id;
     std::string name;
+    IioBuffer iio;    /**< buffered capture of the type 3 sensors */
+    ValveBank bank;   /**< GPIO lines of every valve, written at once */
+    bool iioEnabled;
+    ModbusBus modbus; /**< coalesced reads of the type 2 sensors */
+    bool modbusEnabled;
+    uint64_t cycleSensor; /**< number of acquisitions published */
+    uint64_t cycleVanne;  /**< number of actuations published */
+    BoardConfig config;   /**< component table the drivers were built from */
+    Interlock *interlock; /**< rules filtering the commands, nullptr without rules */
+    Conditioner *conditioner; /**< calibration and filters, nullptr to publish the counts */
+    SensorHealth health;      /**< statistics and faults of the channels */
+    uint32_t lastRefused; /**< valves held closed by the interlock at the last actuation */
+    SensorFrame sensorFrame; /**< last acquisition, read by the interlock */
+    std::string shmSensorName; /**< SHM_Sensor of this board */
+    std::string shmVanneName;  /**< SHM_Vanne of this board */
+
+    void initHeader(ShmHeader &header, uint32_t size, uint8_t count);
 
 public:
-    SensorData *tab_sensors;
-    VanneData *tab_vannes;
+    std::vector<Sensor> sensors; /**< sensor drivers, local to this process */
+    std::vector<Valve> vannes;   /**< valve descriptors, driven through bank */
+    SensorData *tab_sensors;     /**< published sensor samples */
+    VanneData *tab_vannes;       /**< valve commands and published states */
     CAC(const std::string &name, uint8_t id);
     ~CAC();
-    statusErrDef init(std::map<int, std::variant<Sensor, Valve>>);
+    statusErrDef init(std::map<int, std::variant<Sensor, Valve>> dict);
+    statusErrDef init(const BoardConfig &board);
+    statusErrDef acquire();
+    statusErrDef actuate();
+    uint32_t getValveMask() const;
+    void setCommands(uint32_t mask);
+    void setCommands(uint32_t mask, uint32_t select);
+    void setInterlock(Interlock *rules);
+    void setConditioner(Conditioner *stages);
+    const BoardConfig &getConfig() const;
+    uint8_t getId() const;
+    const std::string &getName() const;
+    const std::string &getShmSensorName() const;
+    const std::string &getShmVanneName() const;
+    const ValveBank &getValveBank() const;
+    ValveBank &getValveBank();
+    const SensorHealth &getHealth() const;
 };
 
 #endif
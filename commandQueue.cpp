@@ -0,0 +1,346 @@
+/**
+ * \file commandQueue.cpp
+ * \brief Module carrying the valve commands of the clients to the cycle thread
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * The queue is a bounded multi-producer single-consumer ring : each slot
+ * holds a turn number, a client claims the slot whose turn is its
+ * position by moving the enqueue index with a compare and swap, fills it
+ * and publishes it with turn = position + 1 ; the cycle thread frees it
+ * with turn = position + CMD_QUEUE_RECORDS once copied. No lock, no
+ * system call on either side.
+ *
+ * The acknowledgements ring has one writer, the cycle thread. A client
+ * copies an entry then checks it was not overwritten meanwhile, like a
+ * sequence lock.
+ *
+ * Results of create() and attach() :
+ * - errOpenCommandShm : the segment can't be created, opened or mapped,
+ *   or its layout is not SHM_LAYOUT_VERSION
+ * Acknowledgements :
+ * - infoCommandApplied : the valves have the commanded states, or the EG is applied
+ * - errCommandOverridden : applied, but the interlock or an alarm holds other states
+ * - errCommandInvalid : unknown operation, no valve or valves not on the board
+ * - errCommandQueueFull : scheduled while CMD_MAX_PENDING commands are waiting
+ * - errEGNotFoundInFile : the EG requested is not in liaisonEGEtat.csv
+ */
+
+#include "commandQueue.h"
+#include "monotonicClock.h"
+#include "logger.h"
+#include <stdio.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cstring>
+
+CommandQueue::CommandQueue() : data(nullptr), owner(false), nbPending(0), nbBatch(0), nbValves(0), stats{}
+{
+}
+
+CommandQueue::~CommandQueue()
+{
+    if (data)
+        munmap(data, sizeof(CommandData));
+    if (owner)
+        shm_unlink(shmName.c_str());
+}
+
+/**
+ * \brief function to create the command segment of a board, by the
+ * process running its cycle thread, before the first cycle.
+ *
+ * \param board the board name
+ * \param id the board id
+ * \param nbValves valves of the board, a command on another one is invalid
+ * \return errOpenCommandShm when the segment can't be created.
+ */
+statusErrDef CommandQueue::create(const std::string &board, uint8_t id, int nbValves)
+{
+    shmName = std::string(SHM_Command) + "_" + board;
+    this->nbValves = (uint32_t)nbValves;
+    shm_unlink(shmName.c_str());
+    int fd = shm_open(shmName.c_str(), O_CREAT | O_RDWR, 0666);
+    if (fd < 0 || ftruncate(fd, sizeof(CommandData)) == -1)
+    {
+        perror("shm_open Command failed");
+        if (fd >= 0)
+            close(fd);
+        return errOpenCommandShm;
+    }
+    void *map = mmap(0, sizeof(CommandData), PROT_WRITE | PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        perror("mmap Command failed");
+        return errOpenCommandShm;
+    }
+    data = (CommandData *)map;
+    owner = true;
+    memset(data, 0, sizeof(CommandData));
+    for (uint32_t i = 0; i < CMD_QUEUE_RECORDS; i++)
+        data->commands[i].turn = i;
+    // client 0 is the process owning the board
+    data->nextClient = 1;
+
+    ShmHeader &header = data->header;
+    header.version = SHM_LAYOUT_VERSION;
+    header.headerSize = sizeof(ShmHeader);
+    header.totalSize = sizeof(CommandData);
+    header.boardId = id;
+    header.count = (uint8_t)nbValves;
+    strncpy(header.boardName, board.c_str(), SHM_NAME_LENGTH - 1);
+    __atomic_store_n(&header.magic, SHM_LAYOUT_MAGIC, __ATOMIC_RELEASE);
+    return noError;
+}
+
+/**
+ * \brief function to map the command segment of a running board, by a
+ * client in any process.
+ *
+ * \param board the board name
+ * \param client receives the id of this client, to submit and to find its acknowledgements
+ * \return errOpenCommandShm when the board doesn't run or its layout differs.
+ */
+statusErrDef CommandQueue::attach(const std::string &board, uint16_t &client)
+{
+    shmName = std::string(SHM_Command) + "_" + board;
+    int fd = shm_open(shmName.c_str(), O_RDWR, 0);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(CommandData))
+    {
+        perror(shmName.c_str());
+        if (fd >= 0)
+            close(fd);
+        return errOpenCommandShm;
+    }
+    void *map = mmap(0, sizeof(CommandData), PROT_WRITE | PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        perror("mmap Command failed");
+        return errOpenCommandShm;
+    }
+    data = (CommandData *)map;
+    if (__atomic_load_n(&data->header.magic, __ATOMIC_ACQUIRE) != SHM_LAYOUT_MAGIC ||
+        data->header.version != SHM_LAYOUT_VERSION)
+    {
+        fprintf(stderr, "%s : layout not version %d\n", shmName.c_str(), SHM_LAYOUT_VERSION);
+        return errOpenCommandShm;
+    }
+    nbValves = data->header.count;
+    client = (uint16_t)__atomic_fetch_add(&data->nextClient, 1, __ATOMIC_RELAXED);
+    return noError;
+}
+
+/**
+ * \brief function to submit a command, from any thread of any process,
+ * without waiting.
+ *
+ * \param client id given by attach(), 0 in the process owning the board
+ * \param id number returned in the acknowledgement
+ * \param op CMD_VALVES or CMD_STATE
+ * \param mask valves concerned by CMD_VALVES
+ * \param values states of the valves of mask, or the EG of CMD_STATE
+ * \param cycle actuation cycle to take effect on, 0 for the next one
+ * \return false when the queue is full, the command is not submitted.
+ */
+bool CommandQueue::submit(uint16_t client, uint32_t id, uint8_t op, uint32_t mask, uint32_t values, uint64_t cycle)
+{
+    uint32_t pos = __atomic_load_n(&data->enqueue, __ATOMIC_RELAXED);
+    ValveCommand *slot;
+    for (;;)
+    {
+        slot = &data->commands[pos & (CMD_QUEUE_RECORDS - 1)];
+        int32_t diff = (int32_t)(__atomic_load_n(&slot->turn, __ATOMIC_ACQUIRE) - pos);
+        if (diff == 0)
+        {
+            // on failure pos receives the current index
+            if (__atomic_compare_exchange_n(&data->enqueue, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+        else if (diff < 0)
+            return false;
+        else
+            pos = __atomic_load_n(&data->enqueue, __ATOMIC_RELAXED);
+    }
+
+    slot->client = client;
+    slot->op = op;
+    slot->id = id;
+    slot->mask = mask;
+    slot->values = values;
+    slot->submitNs = monotonicNs();
+    slot->cycle = cycle;
+    __atomic_store_n(&slot->turn, pos + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+ * \brief function to copy the next acknowledgement, from any thread of
+ * any process. The acknowledgements of every client are in the ring, a
+ * client keeps those with its id.
+ *
+ * \param position position of the next acknowledgement to read, start
+ * from getAckHead() ; it jumps forward when the ring has been overwritten
+ * \param ack receives the acknowledgement
+ * \return false when there is no new acknowledgement.
+ */
+bool CommandQueue::readAck(uint32_t &position, CommandAck &ack) const
+{
+    for (int retry = 0; retry < 100; retry++)
+    {
+        uint32_t head = __atomic_load_n(&data->ackHead, __ATOMIC_ACQUIRE);
+        if (position == head)
+            return false;
+        // the entry at head - CMD_ACK_RECORDS is the one being rewritten
+        if (head - position >= CMD_ACK_RECORDS)
+            position = head - CMD_ACK_RECORDS + 1;
+        memcpy(&ack, (const void *)&data->acks[position & (CMD_ACK_RECORDS - 1)], sizeof(CommandAck));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&data->ackHead, __ATOMIC_RELAXED) - position < CMD_ACK_RECORDS)
+        {
+            position++;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * \brief function to get the position of the next acknowledgement written.
+ */
+uint32_t CommandQueue::getAckHead() const
+{
+    return __atomic_load_n(&data->ackHead, __ATOMIC_ACQUIRE);
+}
+
+void CommandQueue::writeAck(const ValveCommand &cmd, statusErrDef status, uint64_t cycle, uint64_t appliedNs,
+                            uint32_t applied)
+{
+    uint32_t head = __atomic_load_n(&data->ackHead, __ATOMIC_RELAXED);
+    CommandAck &ack = data->acks[head & (CMD_ACK_RECORDS - 1)];
+    ack.client = cmd.client;
+    ack.status = (uint16_t)status;
+    ack.id = cmd.id;
+    ack.cycle = cycle;
+    ack.submitNs = cmd.submitNs;
+    ack.appliedNs = appliedNs;
+    ack.applied = applied;
+    ack.reserved = 0;
+    __atomic_store_n(&data->ackHead, head + 1, __ATOMIC_RELEASE);
+
+    if (status == infoCommandApplied)
+        stats.applied++;
+    else if (status == errCommandInvalid || status == errCommandQueueFull)
+        stats.refused++;
+    else
+        stats.overridden++;
+}
+
+/**
+ * \brief function to take the commands due on an actuation, once per
+ * cycle by the cycle thread, without allocation or system call.
+ *
+ * The commands scheduled for a later actuation are kept, the invalid ones
+ * are acknowledged at once. At most CMD_QUEUE_RECORDS commands are taken
+ * from the queue, the others wait for the next cycle.
+ *
+ * \param cycle the actuation cycle about to be published
+ * \return the number of commands to apply, read with getCommand().
+ */
+int CommandQueue::drain(uint64_t cycle)
+{
+    nbBatch = 0;
+    int kept = 0;
+    for (int k = 0; k < nbPending; k++)
+    {
+        if (pending[k].cycle <= cycle)
+            batch[nbBatch++] = pending[k];
+        else
+            pending[kept++] = pending[k];
+    }
+    nbPending = kept;
+
+    uint32_t pos = data->dequeue;
+    for (int n = 0; n < CMD_QUEUE_RECORDS; n++)
+    {
+        ValveCommand &slot = data->commands[pos & (CMD_QUEUE_RECORDS - 1)];
+        if (__atomic_load_n(&slot.turn, __ATOMIC_ACQUIRE) != pos + 1)
+            break;
+        ValveCommand cmd = slot;
+        __atomic_store_n(&slot.turn, pos + CMD_QUEUE_RECORDS, __ATOMIC_RELEASE);
+        pos++;
+
+        bool valid = cmd.op == CMD_STATE ||
+                     (cmd.op == CMD_VALVES && cmd.mask && (nbValves >= 32 || !(cmd.mask >> nbValves)));
+        if (!valid)
+        {
+            writeAck(cmd, errCommandInvalid, cycle, 0, 0);
+            logEvent(logValve, errCommandInvalid, "valve command refused (client, id, op)", cmd.client,
+                     (int32_t)cmd.id, cmd.op);
+        }
+        else if (cmd.cycle <= cycle)
+            batch[nbBatch++] = cmd;
+        else if (nbPending < CMD_MAX_PENDING)
+            pending[nbPending++] = cmd;
+        else
+        {
+            writeAck(cmd, errCommandQueueFull, cycle, 0, 0);
+            logEvent(logValve, errCommandQueueFull, "valve command refused, CMD_MAX_PENDING waiting (client, id)",
+                     cmd.client, (int32_t)cmd.id);
+        }
+    }
+    __atomic_store_n(&data->dequeue, pos, __ATOMIC_RELAXED);
+
+    stats.pending = (uint32_t)nbPending;
+    if ((uint32_t)nbBatch > stats.maxBatch)
+        stats.maxBatch = (uint32_t)nbBatch;
+    return nbBatch;
+}
+
+const ValveCommand &CommandQueue::getCommand(int index) const
+{
+    return batch[index];
+}
+
+/**
+ * \brief function to acknowledge the commands of the last drain(), once
+ * the actuation that applied them is published.
+ *
+ * \param cycle the actuation cycle, as ValveFrame::cycle
+ * \param appliedNs end of the GPIO write of that actuation
+ * \param applied valve states after that actuation
+ * \param eg general state applied by that cycle
+ * \param stateRes result of the selection of that EG, noError when it was already applied
+ */
+void CommandQueue::acknowledge(uint64_t cycle, uint64_t appliedNs, uint32_t applied, uint16_t eg,
+                               statusErrDef stateRes)
+{
+    for (int k = 0; k < nbBatch; k++)
+    {
+        const ValveCommand &cmd = batch[k];
+        statusErrDef status;
+        if (cmd.op == CMD_VALVES)
+            status = ((applied ^ cmd.values) & cmd.mask) ? errCommandOverridden : infoCommandApplied;
+        else if (eg != cmd.values)
+            status = errCommandOverridden;
+        else
+            status = stateRes == errEGNotFoundInFile ? errEGNotFoundInFile : infoCommandApplied;
+        writeAck(cmd, status, cycle, appliedNs, applied);
+    }
+    nbBatch = 0;
+}
+
+/**
+ * \brief function to get the counters of the queue, from the cycle thread
+ * or once it is stopped.
+ */
+const CommandStats &CommandQueue::getStats() const
+{
+    return stats;
+}
@@ -0,0 +1,85 @@
+/**
+ * \file commandQueue.h
+ * \brief header file of the valve command queue
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * Contains the queue carrying the valve commands of any number of
+ * clients, in this process or others, to the cycle thread of a board.
+ * It lives in the segment SHM_Command "_" name (e.g. /command_shm_CACMO),
+ * laid out in shmLayout.h :
+ * - the clients claim a slot with a compare and swap and fill it, they
+ *   never wait : submit() returns false when the queue is full
+ * - the cycle thread drains the queue once per cycle, keeps the commands
+ *   scheduled for a later actuation, and applies every due command in
+ *   the actuation of that cycle
+ * - each command is acknowledged with the actuation cycle it took effect
+ *   on, the time its GPIO lines were written and the resulting valve
+ *   states ; the clients read the acknowledgements ring at their pace
+ *
+ * The commands of one client are applied in the order of submission. A
+ * client stopped in the middle of submit() holds the queue from that slot
+ * on, the cycle itself never waits.
+ */
+
+#ifndef COMMANDQUEUE_H
+#define COMMANDQUEUE_H
+
+#include "configDefine.h"
+#include "statusErrorDefine.h"
+#include "shmLayout.h"
+#include <cstdint>
+#include <string>
+
+/**
+ * \brief name of the command segment of a board, followed by "_" and the board name
+ */
+#define SHM_Command "/command_shm"
+
+/**
+ * \brief counters of the queue, written by the cycle thread
+ */
+struct CommandStats
+{
+    uint64_t applied;    /**< commands acknowledged infoCommandApplied */
+    uint64_t overridden; /**< commands acknowledged errCommandOverridden */
+    uint64_t refused;    /**< commands acknowledged errCommandInvalid or errCommandQueueFull */
+    uint32_t pending;    /**< commands waiting for their cycle */
+    uint32_t maxBatch;   /**< largest number of commands applied by one actuation */
+};
+
+/**
+ * \brief the command segment of a board, seen by its cycle thread
+ * (create) or by a client (attach).
+ */
+class CommandQueue
+{
+private:
+    std::string shmName;
+    CommandData *data;
+    bool owner;                                          /**< the segment is removed with this object */
+    ValveCommand pending[CMD_MAX_PENDING];               /**< commands scheduled for a later actuation */
+    int nbPending;
+    ValveCommand batch[CMD_QUEUE_RECORDS + CMD_MAX_PENDING]; /**< commands of the current actuation */
+    int nbBatch;
+    uint32_t nbValves;
+    CommandStats stats;
+
+    void writeAck(const ValveCommand &cmd, statusErrDef status, uint64_t cycle, uint64_t appliedNs, uint32_t applied);
+
+public:
+    CommandQueue();
+    ~CommandQueue();
+    statusErrDef create(const std::string &board, uint8_t id, int nbValves);
+    statusErrDef attach(const std::string &board, uint16_t &client);
+    bool submit(uint16_t client, uint32_t id, uint8_t op, uint32_t mask, uint32_t values, uint64_t cycle = 0);
+    bool readAck(uint32_t &position, CommandAck &ack) const;
+    uint32_t getAckHead() const;
+    int drain(uint64_t cycle);
+    const ValveCommand &getCommand(int index) const;
+    void acknowledge(uint64_t cycle, uint64_t appliedNs, uint32_t applied, uint16_t eg, statusErrDef stateRes);
+    const CommandStats &getStats() const;
+};
+
+#endif // COMMANDQUEUE_H
@@ -0,0 +1,274 @@
+/**
+ * \file conditioning.cpp
+ * \brief Module of the signal conditioning of the sensors
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * Errors of load(), reported with the file and line, the first one is returned :
+ * - errOpenCalibrationFile : line malformed, coefficient not a number,
+ *   unit too long, oversampling, filter or parameter out of range, sensor
+ *   calibrated twice
+ * - errDependOutsideOfRange : the sensor is not on the board
+ * - errAllocDataCalibration : rows can't be allocated
+ * A missing calibration.csv is not an error, every sensor keeps its counts.
+ * A sensor with an invalid line keeps its counts too.
+ */
+
+#include "conditioning.h"
+#include "csvReader.h"
+#include "logger.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+
+static_assert((COND_MAX_WINDOW & (COND_MAX_WINDOW - 1)) == 0 && COND_MAX_WINDOW >= 4,
+              "COND_MAX_WINDOW must be a power of 2, 4 at least");
+
+Conditioner::Conditioner()
+    : primed(0), head(0), maxWindow(1), nbSensors(0), nbLines(0)
+{
+    memset(history, 0, sizeof(history));
+    memset(filtered, 0, sizeof(filtered));
+    for (int s = 0; s < MAX_SENSORS; s++)
+    {
+        setIdentity(s);
+        pending[s] = NAN;
+    }
+}
+
+/**
+ * \brief function to give a slot its counts : no oversampling, no filter
+ * and the identity polynomial.
+ */
+void Conditioner::setIdentity(int slot)
+{
+    c0[slot] = 0.0f;
+    c1[slot] = 1.0f;
+    c2[slot] = 0.0f;
+    c3[slot] = 0.0f;
+    alpha[slot] = 1.0f;
+    for (int r = 0; r < COND_MAX_WINDOW; r++)
+        weight[r][slot] = r == 0 ? 1.0f : 0.0f;
+    oversampling[slot] = 1;
+    strcpy(units[slot], "counts");
+}
+
+/**
+ * \brief function to read calibration.csv and set the stages of the
+ * sensors of a board, once, before the control loop starts.
+ *
+ * \param board the sensor slots of the board
+ * \param path the calibration file
+ * \return statusErrDef of the first invalid line, or noError.
+ */
+statusErrDef Conditioner::load(const BoardConfig &board, const char *path)
+{
+    for (int s = 0; s < MAX_SENSORS; s++)
+        setIdentity(s);
+    nbSensors = board.nbSensors;
+    nbLines = 0;
+    maxWindow = 1;
+    primed = 0;
+    for (int s = 0; s < MAX_SENSORS; s++)
+        pending[s] = NAN;
+
+    if (access(path, F_OK) != 0)
+    {
+        logEvent(logSensor, infoInitSensor, "no calibration file, raw counts published (sensors)", nbSensors);
+        return noError;
+    }
+    CsvFile file;
+    if (!file.open(path))
+    {
+        perror(path);
+        return errOpenCalibrationFile;
+    }
+
+    CsvArena arena;
+    LigneCalibration *rows = arena.alloc<LigneCalibration>(file.countLines());
+    if (!rows)
+        return errAllocDataCalibration;
+
+    // a malformed line is kept without unit, its sensor keeps its counts below
+    statusErrDef res = noError;
+    std::string_view line;
+    int nbRows = 0;
+    while (file.nextLine(line, "board"))
+    {
+        std::string_view fields[10];
+        int n = csvSplitFields(line, fields, 10);
+        LigneCalibration &row = rows[nbRows++];
+        row.board = fields[0];
+        row.sensor = n > 1 ? fields[1] : std::string_view();
+        row.unit = n > 2 ? fields[2] : std::string_view();
+        row.filter = n > 8 ? fields[8] : std::string_view("none");
+        row.coefs[0] = row.coefs[1] = row.coefs[2] = row.coefs[3] = 0.0f;
+        row.oversampling = 1;
+        row.param = 1.0f;
+        row.line = file.getLineNumber();
+
+        const char *msg = nullptr;
+        if (n < 5 || n > 10 || row.unit.empty())
+            msg = "expected board;sensor;unit;c0;c1[;c2;c3;oversampling;filter;param]";
+        else if (row.unit.size() >= COND_UNIT_LENGTH)
+            msg = "unit longer than COND_UNIT_LENGTH - 1";
+        for (int c = 0; c < 4 && !msg; c++)
+            if (n > 3 + c && !fields[3 + c].empty() && !csvToFloat(fields[3 + c], row.coefs[c]))
+                msg = "coefficient not a number";
+        if (!msg && n > 7 && !fields[7].empty() &&
+            (!csvToInt(fields[7], row.oversampling) || row.oversampling < 1 ||
+             row.oversampling > COND_MAX_OVERSAMPLING))
+            msg = "oversampling from 1 to COND_MAX_OVERSAMPLING reads";
+        if (!msg && (row.filter == "mean" || row.filter == "iir") && (n != 10 || !csvToFloat(fields[9], row.param)))
+            msg = "mean and iir need a parameter";
+        else if (!msg && row.filter == "mean" &&
+                 (row.param != (int)row.param || row.param < 1 || row.param > COND_MAX_WINDOW))
+            msg = "mean window from 1 to COND_MAX_WINDOW cycles";
+        else if (!msg && row.filter == "iir" && !(row.param > 0.0f && row.param <= 1.0f))
+            msg = "iir smoothing factor in ]0, 1]";
+        else if (!msg && row.filter != "mean" && row.filter != "iir" && row.filter != "none" && !row.filter.empty())
+            msg = "filter none, mean or iir";
+        if (msg)
+        {
+            csvReport(path, row.line, errOpenCalibrationFile, msg);
+            if (res == noError)
+                res = errOpenCalibrationFile;
+            row.unit = std::string_view();
+        }
+    }
+
+    std::string_view boardName(board.name);
+    uint32_t seen = 0;
+    for (int r = 0; r < nbRows; r++)
+    {
+        const LigneCalibration &row = rows[r];
+        if (row.board != boardName)
+            continue;
+        nbLines++;
+
+        int slot = -1;
+        for (int s = 0; s < board.nbSensors && slot < 0; s++)
+            if (row.sensor == board.sensors[s].name)
+                slot = s;
+        statusErrDef err = row.unit.empty() ? errOpenCalibrationFile : noError;
+        const char *msg = nullptr;
+        if (slot < 0)
+        {
+            err = errDependOutsideOfRange;
+            msg = "sensor not on the board";
+        }
+        else if ((seen >> slot) & 1)
+        {
+            err = errOpenCalibrationFile;
+            msg = "sensor calibrated twice, first line kept";
+        }
+        if (err != noError)
+        {
+            if (msg)
+                csvReport(path, row.line, err, msg);
+            if (res == noError)
+                res = err;
+            continue;
+        }
+
+        seen |= 1u << slot;
+        c0[slot] = row.coefs[0];
+        c1[slot] = row.coefs[1];
+        c2[slot] = row.coefs[2];
+        c3[slot] = row.coefs[3];
+        oversampling[slot] = (uint8_t)row.oversampling;
+        int window = row.filter == "mean" ? (int)row.param : 1;
+        maxWindow = std::max(maxWindow, window);
+        for (int w = 0; w < COND_MAX_WINDOW; w++)
+            weight[w][slot] = w < window ? 1.0f / window : 0.0f;
+        alpha[slot] = row.filter == "iir" ? row.param : 1.0f;
+        csvCopy(units[slot], COND_UNIT_LENGTH, row.unit);
+    }
+
+    logEvent(logSensor, res != noError ? res : infoInitSensor, "calibration loaded (lines, sensors calibrated)",
+             nbLines, __builtin_popcount(seen));
+    return res;
+}
+
+/**
+ * \brief function to condition the channel vector of a cycle. Called by
+ * the control loop after the acquisition, without allocation.
+ *
+ * A slot without valid input repeats its last input, so its filters hold.
+ * The first valid input of a slot fills its window and its filter state.
+ *
+ * \param raw the counts of each slot, the mean of the oversampled reads
+ * \param valid bit i set when raw[i] was read without error
+ * \param values receives the value of each slot in its unit, NaN before its first valid input
+ */
+void Conditioner::apply(const float *__restrict raw, uint32_t valid, float *__restrict values)
+{
+    uint32_t first = valid & ~primed & ((1u << MAX_SENSORS) - 1);
+    if (first)
+    {
+        for (int s = 0; s < MAX_SENSORS; s++)
+        {
+            if (!((first >> s) & 1))
+                continue;
+            for (int r = 0; r < COND_MAX_WINDOW; r++)
+                history[r][s] = raw[s];
+            filtered[s] = raw[s];
+        }
+        primed |= first;
+        for (int s = 0; s < MAX_SENSORS; s++)
+            pending[s] = ((primed >> s) & 1) ? 0.0f : NAN;
+    }
+
+    // the newest row becomes the oldest one, a slot in error repeats its input
+    const float *newest = history[head];
+    head = (head - 1) & (COND_MAX_WINDOW - 1);
+    float *row = history[head];
+    for (int s = 0; s < MAX_SENSORS; s++)
+        row[s] = ((valid >> s) & 1) ? raw[s] : newest[s];
+
+    // moving average, the rows past the window of a slot weigh 0. Four
+    // rows per pass, the partial sums stay in registers between the rows.
+    float mean[MAX_SENSORS] = {};
+    for (int r = 0; r < maxWindow; r += 4)
+    {
+        const float *in0 = history[(head + r) & (COND_MAX_WINDOW - 1)];
+        const float *in1 = history[(head + r + 1) & (COND_MAX_WINDOW - 1)];
+        const float *in2 = history[(head + r + 2) & (COND_MAX_WINDOW - 1)];
+        const float *in3 = history[(head + r + 3) & (COND_MAX_WINDOW - 1)];
+        for (int s = 0; s < MAX_SENSORS; s++)
+            mean[s] += (weight[r][s] * in0[s] + weight[r + 1][s] * in1[s]) +
+                       (weight[r + 2][s] * in2[s] + weight[r + 3][s] * in3[s]);
+    }
+
+    // first order IIR, alpha = 1 passes the mean through
+    for (int s = 0; s < MAX_SENSORS; s++)
+        filtered[s] += alpha[s] * (mean[s] - filtered[s]);
+
+    // calibration polynomial, Horner form
+    for (int s = 0; s < MAX_SENSORS; s++)
+    {
+        float x = filtered[s];
+        values[s] = c0[s] + x * (c1[s] + x * (c2[s] + x * c3[s])) + pending[s];
+    }
+}
+
+/**
+ * \brief function to get the reads per cycle of a type 1 slot.
+ */
+int Conditioner::getOversampling(int slot) const
+{
+    return oversampling[slot];
+}
+
+const char *Conditioner::getUnit(int slot) const
+{
+    return units[slot];
+}
+
+int Conditioner::getNbLines() const
+{
+    return nbLines;
+}
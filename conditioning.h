@@ -0,0 +1,89 @@
+/**
+ * \file conditioning.h
+ * \brief header file of the signal conditioning module
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * Contains the conditioning of the sensors of a board, applied to the
+ * channel vector after each acquisition :
+ * - oversampling : a type 1 channel is read several times per cycle and
+ *   the reads are averaged, the mean keeps the extra resolution
+ * - moving average over a window of cycles, or first order IIR filter
+ * - calibration : a polynomial of degree 3 of the filtered counts gives
+ *   the value in the unit of the sensor (degC, bar, ...)
+ *
+ * calibration.csv : board;sensor;unit;c0;c1;c2;c3;oversampling;filter;param
+ * - value = c0 + c1 * x + c2 * x^2 + c3 * x^3, x in ADC counts
+ * - c2, c3 and the fields after them can be left out
+ * - oversampling : reads per cycle, 1 to COND_MAX_OVERSAMPLING (type 1 only)
+ * - filter : none, mean (param = window, 1 to COND_MAX_WINDOW cycles)
+ *   or iir (param = smoothing factor, 0 < param <= 1)
+ * A sensor without line keeps its counts, in the unit "counts".
+ *
+ * The coefficients and the filter states are kept in structure of arrays,
+ * one lane per slot over MAX_SENSORS, so every stage is a loop over all
+ * the channels that the compiler vectorises (NEON, SSE), without branch
+ * on the slot.
+ */
+
+#ifndef CONDITIONING_H
+#define CONDITIONING_H
+
+#include "configDefine.h"
+#include "statusErrorDefine.h"
+#include "physicalConfig.h"
+#include "shmLayout.h"
+#include <cstdint>
+#include <string_view>
+
+/**
+ * \brief one line of calibration.csv, the names point into the mapped file
+ */
+struct LigneCalibration
+{
+    std::string_view board;
+    std::string_view sensor;
+    std::string_view unit;
+    std::string_view filter;
+    float coefs[4];
+    int oversampling;
+    float param;
+    int line;
+};
+
+/**
+ * \brief conditioning stages of the sensors of one board.
+ */
+class Conditioner
+{
+private:
+    alignas(CACHE_LINE_SIZE) float c0[MAX_SENSORS]; /**< calibration polynomial, one lane per slot */
+    alignas(CACHE_LINE_SIZE) float c1[MAX_SENSORS];
+    alignas(CACHE_LINE_SIZE) float c2[MAX_SENSORS];
+    alignas(CACHE_LINE_SIZE) float c3[MAX_SENSORS];
+    alignas(CACHE_LINE_SIZE) float alpha[MAX_SENSORS];   /**< IIR smoothing factor, 1 without IIR */
+    alignas(CACHE_LINE_SIZE) float weight[COND_MAX_WINDOW][MAX_SENSORS]; /**< 1 / window for the rows inside the window of the slot, 0 after */
+    alignas(CACHE_LINE_SIZE) float history[COND_MAX_WINDOW][MAX_SENSORS]; /**< last inputs, a ring whose row head is the newest */
+    alignas(CACHE_LINE_SIZE) float filtered[MAX_SENSORS]; /**< output of the filters, in counts */
+    alignas(CACHE_LINE_SIZE) float pending[MAX_SENSORS];  /**< NaN until the first valid input of the slot, 0 after */
+    uint8_t oversampling[MAX_SENSORS];
+    char units[MAX_SENSORS][COND_UNIT_LENGTH];
+    uint32_t primed; /**< slots with a first valid input, the others are published as NaN */
+    unsigned int head; /**< row of history holding the newest input */
+    int maxWindow; /**< largest window of the board, the rows after it weigh 0 for every slot */
+    int nbSensors;
+    int nbLines; /**< lines of the board in calibration.csv */
+
+    void setIdentity(int slot);
+
+public:
+    Conditioner();
+    statusErrDef load(const BoardConfig &board, const char *path = CALIBRATION_FILE);
+    void apply(const float *raw, uint32_t valid, float *values);
+    int getOversampling(int slot) const;
+    const char *getUnit(int slot) const;
+    int getNbLines() const;
+};
+
+#endif // CONDITIONING_H
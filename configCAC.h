@@ -8,6 +8,9 @@
  * Contains all of the program defines from each module.
  * The defines are set at compile time so they can't be changed
  * at runtime.
+ *
+ * The components of a board are constexpr tables, checked at compile
+ * time. dict_CACMO is built from them for the runtime CAC.
  */
 
 #ifndef CONFIG_CAC
@@ -17,27 +20,128 @@
 #include <map>
 #include <array>
 #include <variant>
+#include <cstddef>
 #include "sensor.h"
 #include "valve.h"
 
 #define CAC_name "CACMO"
 #define NCapteur 4
 #define NVanne 4
+
+/**
+ * \brief a valve of a compile-time board table
+ */
+struct ValveDef
+{
+    const char *name;
+    uint8_t id;
+    int pin; /**< GPIO line offset */
+};
+
+/**
+ * \brief a sensor of a compile-time board table
+ */
+struct SensorDef
+{
+    const char *name;
+    uint8_t id;
+    int type;    /**< 1 sysfs, 2 modbus, 3 IIO buffer */
+    int channel; /**< MCP3008 channel, or modbus address */
+};
+
 /*
 std::array<const char *, 3> CAC_Name = {"CACMO", "CACEHP", "CACOE"};
-std::array<const char *, 4> CACMO_Vanne_name = {"VCE", "VCO", "Vanne3", "Vanne4"};
-std::array<int, 4> CACMO_Vanne_pin = {5, 6, 19, 26};
-std::array<const char *, 4> CACMO_Sensor_name = {"TP-01", "PR-01", "PR-02", "PR-03"};
-std::array<int, 4> CACMO_Sensor_channel = {5, 6, 7, 2};
 */
-inline std::map<int, std::variant<Sensor, Valve>> dict_CACMO = {
-    {10, Valve("VCE", 10, 5)},
-    {11, Valve("VCo", 11, 6)},
-    {12, Valve("Vanne3", 12, 19)},
-    {13, Valve("Vanne4", 13, 26)},
-    {15, Sensor("TP-01", 15, 1, 5)},
-    {16, Sensor("PR-01", 16, 1, 6)},
-    {17, Sensor("PR-02", 17, 1, 7)},
-    {18, Sensor("PR-03", 18, 1, 2)}};
+/**
+ * \brief components of the CACMO board
+ */
+struct BoardCACMO
+{
+    static constexpr const char *name = "CACMO";
+    static constexpr uint8_t id = 1;
+    static constexpr std::array<ValveDef, 4> valves = {{
+        {"VCE", 10, 5},
+        {"VCo", 11, 6},
+        {"Vanne3", 12, 19},
+        {"Vanne4", 13, 26},
+    }};
+    static constexpr std::array<SensorDef, 4> sensors = {{
+        {"TP-01", 15, 1, 5},
+        {"PR-01", 16, 1, 6},
+        {"PR-02", 17, 1, 7},
+        {"PR-03", 18, 1, 2},
+    }};
+};
+
+/**
+ * \brief true when no GPIO line is used by two valves of the board
+ */
+template <typename Board>
+constexpr bool uniquePins()
+{
+    for (size_t i = 0; i < Board::valves.size(); i++)
+        for (size_t j = i + 1; j < Board::valves.size(); j++)
+            if (Board::valves[i].pin == Board::valves[j].pin)
+                return false;
+    return true;
+}
+
+/**
+ * \brief true when every MCP3008 sensor (type 1 or 3) has a channel below MAX_ADC
+ */
+template <typename Board>
+constexpr bool channelsInRange()
+{
+    for (const SensorDef &s : Board::sensors)
+        if (s.type != 2 && (s.channel < 0 || s.channel >= MAX_ADC))
+            return false;
+    return true;
+}
+
+/**
+ * \brief true when no MCP3008 channel is read by two sensors of the board
+ */
+template <typename Board>
+constexpr bool uniqueChannels()
+{
+    for (size_t i = 0; i < Board::sensors.size(); i++)
+        for (size_t j = i + 1; j < Board::sensors.size(); j++)
+            if (Board::sensors[i].type != 2 && Board::sensors[j].type != 2 &&
+                Board::sensors[i].channel == Board::sensors[j].channel)
+                return false;
+    return true;
+}
+
+/**
+ * \brief true when the board tables fit in the shared memory frames
+ * and pass every check above
+ */
+template <typename Board>
+constexpr bool validBoard()
+{
+    return Board::valves.size() <= MAX_VALVES && Board::sensors.size() <= MAX_SENSORS &&
+           uniquePins<Board>() && channelsInRange<Board>() && uniqueChannels<Board>();
+}
+
+static_assert(uniquePins<BoardCACMO>(), "CACMO : a GPIO line is used by two valves");
+static_assert(channelsInRange<BoardCACMO>(), "CACMO : a sensor channel is outside of the MCP3008");
+static_assert(uniqueChannels<BoardCACMO>(), "CACMO : an ADC channel is read by two sensors");
+
+/**
+ * \brief function to build the runtime component map of a board,
+ * with the ids used by CAC::init(map).
+ */
+template <typename Board>
+inline std::map<int, std::variant<Sensor, Valve>> makeDict()
+{
+    std::map<int, std::variant<Sensor, Valve>> dict;
+    for (const ValveDef &v : Board::valves)
+        dict.emplace(v.id, Valve(v.name, v.id, v.pin));
+    for (const SensorDef &s : Board::sensors)
+        dict.emplace(s.id, Sensor(s.name, s.id, s.type, s.channel));
+    return dict;
+}
+
+inline std::map<int, std::variant<Sensor, Valve>> dict_CACMO = makeDict<BoardCACMO>();
 
 #endif
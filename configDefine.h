@@ -36,6 +36,10 @@
 #define DEVNAME				"eth0"
 
 // xapOpl
+/**
+ * \brief Number of CAC boards (CNs) on the POWERLINK network
+ */
+#define NB_NODES    3
 /**
  * \brief Total size of RPDOs coming into every CNs
  */
@@ -52,12 +56,36 @@
  * \brief Total size in bytes for every TPDOs (int16_t is 2 bytes)
  */
 #define COMPUTED_PI_IN_SIZE    ((SIZE_IN + 1) * 2)
+/**
+ * \brief int16 words of the RPDO of one CN (MN to CN)
+ */
+#define OPL_PI_OUT_WORDS    (SIZE_OUT / NB_NODES)
+/**
+ * \brief int16 words of the TPDO of one CN (CN to MN)
+ */
+#define OPL_PI_IN_WORDS     (SIZE_IN / NB_NODES)
+/**
+ * \brief UDP port of the stand-in MN, the POWERLINK UDP port
+ */
+#define OPL_UDP_PORT        3819
+/**
+ * \brief cycles without RPDO before the MN is considered lost
+ */
+#define OPL_MN_TIMEOUT_CYCLES  10
 
 // Sensor
 /**
  * \brief sysfs MCP3008 files path
  */
 #define IIOSYSPATH "/sys/bus/iio/devices/iio:device0/"
+/**
+ * \brief MCP3008 IIO buffered capture character device
+ */
+#define IIODEVPATH "/dev/iio:device0"
+/**
+ * \brief number of scans held by the IIO kernel buffer
+ */
+#define IIO_BUFFER_LENGTH 128
 /**
  * \brief rs485 to USB serial device location
  */
@@ -66,6 +94,26 @@
  * \brief number of modbus serial registers to read
  */
 #define MODBUS_NBREG 1
+/**
+ * \brief serial speed of the rs485 bus, 8 data bits, no parity, 1 stop bit
+ */
+#define MODBUS_BAUDRATE 9600
+/**
+ * \brief channel of a type 2 sensor : slave address * MODBUS_SLAVE_STRIDE + register
+ */
+#define MODBUS_SLAVE_STRIDE 1000
+/**
+ * \brief modbus function used to read the sensors (0x04 read input registers)
+ */
+#define MODBUS_FUNCTION 0x04
+/**
+ * \brief maximum number of registers of one read request
+ */
+#define MODBUS_MAX_REGS 125
+/**
+ * \brief time in milliseconds before an unanswered request is abandoned
+ */
+#define MODBUS_TIMEOUT_MS 100
 /**
  * \brief maximum number of sensors allowed
  */
@@ -78,6 +126,36 @@
  * \brief channel read error code in 2 bytes signed
  */
 #define ADC_READ_ERROR -32768
+/**
+ * \brief largest count of the MCP3008, a 10 bit converter
+ */
+#define ADC_MAX_COUNT 1023
+
+// Sensor health
+/**
+ * \brief failed reads in a row after which a channel is disconnected
+ */
+#define HEALTH_DISCONNECT_ERRORS 5
+/**
+ * \brief identical values in a row after which a channel is stuck
+ */
+#define HEALTH_STUCK_SAMPLES 1000
+/**
+ * \brief values in a row on 0 or ADC_MAX_COUNT after which a channel is saturated
+ */
+#define HEALTH_SATURATED_SAMPLES 10
+/**
+ * \brief largest plausible change between two samples, in counts
+ */
+#define HEALTH_MAX_STEP 256
+/**
+ * \brief largest rms noise of a channel, in counts
+ */
+#define HEALTH_NOISE_COUNTS 16
+/**
+ * \brief samples over which the noise is averaged
+ */
+#define HEALTH_NOISE_SAMPLES 64
 
 // Valve
 /**
@@ -89,26 +167,208 @@
  */
 #define MAX_VALVES 12
 
+// Hardware backends
+/**
+ * \brief environment variable selecting the ADC and GPIO backends at startup,
+ * e.g. CAC_HAL="adc=sim,noise=4,gpio=sim", real hardware when unset
+ */
+#define HAL_ENV "CAC_HAL"
+/**
+ * \brief channels a simulated ADC can open, every sensor of every board
+ */
+#define HAL_SIM_MAX_HANDLES (MAX_BOARDS * MAX_SENSORS)
+/**
+ * \brief reads a simulated channel stays stuck once a stuck fault starts
+ */
+#define HAL_SIM_STUCK_READS 1000
+/**
+ * \brief samples of a recorded waveform played by the simulated ADC
+ */
+#define HAL_SIM_MAX_SAMPLES 65536
+
 // CSV
 /**
  * \brief maximum path length for a general state CSV file
  */
 #define MAX_PATH_LENGTH 1024
 /**
- * \brief maximum line size for every common CSV file
+ * \brief directory of liaisonEGEtat.csv and of the general state CSV files
+ */
+#define CSV_DIR "./"
+/**
+ * \brief link between the general state codes and their CSV file
+ */
+#define EG_LINK_FILE "liaisonEGEtat.csv"
+/**
+ * \brief first general state code
+ */
+#define EG_MIN 0x1000
+/**
+ * \brief last general state code
+ */
+#define EG_MAX 0x6FFF
+/**
+ * \brief physical configuration of the valves of every board
+ */
+#define PHYS_VALVES_FILE "physicalCONFIG_valves.csv"
+/**
+ * \brief physical configuration of the sensors of every board
+ */
+#define PHYS_SENSORS_FILE "physicalCONFIG_sensors.csv"
+/**
+ * \brief maximum length of a component name in the physical CSV files
+ */
+#define PHYS_NAME_LENGTH 32
+/**
+ * \brief maximum number of boards in the physical CSV files
+ */
+#define MAX_BOARDS 8
+/**
+ * \brief interlock rules of the valves of every board
  */
-#define MAX_LINE_SIZE 2832
+#define ACTIVATION_FILE "activation.csv"
 /**
- * \brief maximum line size for every physical CSV file
+ * \brief maximum number of distinct sensor conditions of the interlock rules of a board
  */
-#define MAX_PHYSICAL_LINE_SIZE 512
+#define MAX_INTERLOCK_CONDS 32
+/**
+ * \brief calibration and filters of the sensors of every board
+ */
+#define CALIBRATION_FILE "calibration.csv"
+/**
+ * \brief maximum number of ADC reads averaged into one sample
+ */
+#define COND_MAX_OVERSAMPLING 16
+/**
+ * \brief maximum window of the moving average, in cycles, a power of 2
+ */
+#define COND_MAX_WINDOW 16
+/**
+ * \brief maximum length of a sensor unit, '\0' included
+ */
+#define COND_UNIT_LENGTH 8
+/**
+ * \brief alarm rules of the sensors of every board
+ */
+#define ALARM_FILE "alarms.csv"
+/**
+ * \brief maximum number of alarm rules of a board, a multiple of 32
+ */
+#define MAX_ALARMS 128
 // TelemFiles
 /**
  * \brief maximum length of telemetry status or error message
  */
 #define EVENTLOG_MAX_LENGTH 1024
+/**
+ * \brief directory of the telemetry segment files
+ */
+#define TELEM_DIR "./telemetry/"
+/**
+ * \brief number of records of a telemetry segment (65 s at 1 kHz)
+ */
+#define TELEM_SEGMENT_RECORDS 65536
+/**
+ * \brief number of segment files reused in turn, the oldest is overwritten
+ */
+#define TELEM_MAX_SEGMENTS 64
+/**
+ * \brief period in milliseconds of the telemetry sync thread
+ */
+#define TELEM_SYNC_MS 500
+/**
+ * \brief Unix domain socket of the telemetry server (SOCK_SEQPACKET)
+ */
+#define STREAM_SOCKET_PATH "/tmp/cac_telem.sock"
+/**
+ * \brief environment variable giving the localhost UDP port of the
+ * telemetry server, UDP disabled when unset
+ */
+#define STREAM_UDP_ENV "CAC_STREAM_UDP"
+/**
+ * \brief records of the ring between a cycle thread and the server, a power of 2
+ */
+#define STREAM_RING_RECORDS 1024
+/**
+ * \brief maximum number of records of a frame sent to a subscriber
+ */
+#define STREAM_BATCH_RECORDS 32
+/**
+ * \brief period in milliseconds of the publisher thread
+ */
+#define STREAM_BATCH_MS 10
+/**
+ * \brief maximum number of subscribers of the telemetry server
+ */
+#define STREAM_MAX_SUBSCRIBERS 64
+/**
+ * \brief frames in a row a subscriber could not take before it is dropped
+ */
+#define STREAM_MAX_MISSED 50
+/**
+ * \brief send buffer of a subscriber socket in bytes
+ */
+#define STREAM_SNDBUF (64 * 1024)
+/**
+ * \brief time in milliseconds a UDP subscriber stays subscribed without renewing
+ */
+#define STREAM_UDP_LEASE_MS 5000
+/**
+ * \brief slots of the command queue of a board, a power of 2
+ */
+#define CMD_QUEUE_RECORDS 256
+/**
+ * \brief acknowledgements kept for the clients of a board, a power of 2
+ */
+#define CMD_ACK_RECORDS 1024
+/**
+ * \brief commands of a board waiting for their cycle
+ */
+#define CMD_MAX_PENDING 64
+/**
+ * \brief timed valve sequences of every board
+ */
+#define SEQUENCE_FILE "sequence.csv"
+/**
+ * \brief maximum number of actions of a valve sequence
+ */
+#define SCHED_MAX_ACTIONS 16384
+/**
+ * \brief actions due within this many nanoseconds of the first one are written together
+ */
+#define SCHED_COALESCE_NS 10000
+/**
+ * \brief nanoseconds spun before a deadline instead of sleeping, 0 to only sleep
+ */
+#define SCHED_SPIN_NS 0
+/**
+ * \brief time error in nanoseconds above which an action is logged late
+ */
+#define SCHED_LATE_NS 500000
+
+// Log
+/**
+ * \brief number of records of each per-thread log ring, a power of 2
+ */
+#define LOG_RING_SIZE 1024
+/**
+ * \brief maximum number of threads writing log records
+ */
+#define LOG_MAX_THREADS 16
+/**
+ * \brief period in milliseconds of the log writer thread
+ */
+#define LOG_FLUSH_MS 20
 
 // Main
+/**
+ * \brief SCHED_FIFO priority of the cycle thread, 0 keeps the default scheduler
+ */
+#define RT_PRIORITY 80
+/**
+ * \brief CPU the cycle thread is pinned to, -1 to let the kernel choose
+ */
+#define RT_CPU -1
 /**
  * \brief delay in milliseconds at the end of the initialisation state
  * to wait for the CN to connect to the MN.
@@ -0,0 +1,299 @@
+/**
+ * \file csvReader.cpp
+ * \brief Module of the CSV reading helpers
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * The separator is ';' or ','. Empty lines, lines starting with '#' and
+ * the header line are skipped. The end of line is "\n" or "\r\n".
+ */
+
+#include "csvReader.h"
+#include <charconv>
+#include <cmath>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * \brief size of the first block of an arena, the next ones double
+ */
+static constexpr size_t ARENA_BLOCK_SIZE = 64 * 1024;
+
+static inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+
+static inline std::string_view trim(std::string_view text)
+{
+    while (!text.empty() && isBlank(text.front()))
+        text.remove_prefix(1);
+    while (!text.empty() && isBlank(text.back()))
+        text.remove_suffix(1);
+    return text;
+}
+
+CsvFile::CsvFile()
+    : data(nullptr), size(0), pos(0), lineNumber(0)
+{
+}
+
+CsvFile::~CsvFile()
+{
+    close();
+}
+
+/**
+ * \brief function to map a file. An empty file is valid and has no line.
+ *
+ * \return false when the file can't be opened or mapped, errno is set.
+ */
+bool CsvFile::open(const char *path)
+{
+    close();
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) < 0)
+    {
+        int err = errno;
+        ::close(fd);
+        errno = err;
+        return false;
+    }
+    if (st.st_size > 0)
+    {
+        void *map = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+        if (map == MAP_FAILED)
+        {
+            int err = errno;
+            ::close(fd);
+            errno = err;
+            return false;
+        }
+        madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+        data = static_cast<const char *>(map);
+        size = (size_t)st.st_size;
+    }
+    // the mapping stays valid once the descriptor is closed
+    ::close(fd);
+    return true;
+}
+
+void CsvFile::close()
+{
+    if (data)
+        munmap(const_cast<char *>(data), size);
+    data = nullptr;
+    size = 0;
+    pos = 0;
+    lineNumber = 0;
+}
+
+/**
+ * \brief function to count the lines of the file, an upper bound of its
+ * number of rows to allocate them at once.
+ */
+int CsvFile::countLines() const
+{
+    int n = 0;
+    const char *p = data;
+    const char *end = data + size;
+    while (p < end && (p = static_cast<const char *>(memchr(p, '\n', end - p))))
+    {
+        n++;
+        p++;
+    }
+    if (size && data[size - 1] != '\n')
+        n++;
+    return n;
+}
+
+/**
+ * \brief function to get the next line holding data.
+ *
+ * \param line receives the line, without its end of line
+ * \param header the first word of the header line
+ * \return false at the end of the file.
+ */
+bool CsvFile::nextLine(std::string_view &line, const char *header)
+{
+    while (pos < size)
+    {
+        const char *start = data + pos;
+        const char *nl = static_cast<const char *>(memchr(start, '\n', size - pos));
+        size_t len = nl ? (size_t)(nl - start) : size - pos;
+        pos += len + (nl ? 1 : 0);
+        lineNumber++;
+
+        std::string_view text(start, len);
+        if (!text.empty() && text.back() == '\r')
+            text.remove_suffix(1);
+        while (!text.empty() && isBlank(text.front()))
+            text.remove_prefix(1);
+        if (text.empty() || text.front() == '#' || text.starts_with(header))
+            continue;
+        line = text;
+        return true;
+    }
+    return false;
+}
+
+int CsvFile::getLineNumber() const
+{
+    return lineNumber;
+}
+
+size_t CsvFile::getSize() const
+{
+    return size;
+}
+
+CsvArena::CsvArena()
+    : head(nullptr), used(0)
+{
+}
+
+CsvArena::~CsvArena()
+{
+    while (head)
+    {
+        Block *next = head->next;
+        free(head);
+        head = next;
+    }
+}
+
+/**
+ * \brief function to allocate from the current block, or from a new block
+ * at least twice as large when it is full.
+ *
+ * \return nullptr when the memory can't be allocated.
+ */
+void *CsvArena::alloc(size_t bytes, size_t align)
+{
+    size_t offset = head ? (sizeof(Block) + used + align - 1) & ~(align - 1) : 0;
+    if (!head || offset + bytes > head->size)
+    {
+        size_t blockSize = head ? head->size * 2 : ARENA_BLOCK_SIZE;
+        size_t needed = sizeof(Block) + bytes + align;
+        if (blockSize < needed)
+            blockSize = needed;
+        Block *block = static_cast<Block *>(malloc(blockSize));
+        if (!block)
+            return nullptr;
+        block->next = head;
+        block->size = blockSize;
+        head = block;
+        used = 0;
+        offset = (sizeof(Block) + align - 1) & ~(align - 1);
+    }
+    used = offset + bytes - sizeof(Block);
+    return reinterpret_cast<char *>(head) + offset;
+}
+
+/**
+ * \brief function to free every row, the largest block is kept for the
+ * next file.
+ */
+void CsvArena::reset()
+{
+    if (!head)
+        return;
+    Block *b = head->next;
+    while (b)
+    {
+        Block *next = b->next;
+        free(b);
+        b = next;
+    }
+    head->next = nullptr;
+    used = 0;
+}
+
+/**
+ * \brief function to split a line in fields, without the surrounding spaces.
+ *
+ * \return the number of fields, maxFields + 1 when the line has more.
+ */
+int csvSplitFields(std::string_view line, std::string_view *fields, int maxFields)
+{
+    const char *p = line.data();
+    const char *end = p + line.size();
+    const char *start = p;
+    int n = 0;
+    for (;; p++)
+    {
+        if (p == end || *p == ';' || *p == ',')
+        {
+            if (n == maxFields)
+                return n + 1;
+            fields[n++] = trim(std::string_view(start, p - start));
+            if (p == end)
+                return n;
+            start = p + 1;
+        }
+    }
+}
+
+/**
+ * \brief function to convert a decimal or 0x hexadecimal field.
+ *
+ * \return false when the field is not a number.
+ */
+bool csvToInt(std::string_view text, int &value)
+{
+    // no octal : "08" is a decimal channel
+    int base = 10;
+    if (text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X'))
+    {
+        text.remove_prefix(2);
+        base = 16;
+    }
+    const char *end = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), end, value, base);
+    return ec == std::errc() && ptr == end && !text.empty();
+}
+
+/**
+ * \brief function to convert a decimal or scientific field, "1.5e-3".
+ *
+ * \return false when the field is not a finite number.
+ */
+bool csvToFloat(std::string_view text, float &value)
+{
+    const char *end = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), end, value);
+    return ec == std::errc() && ptr == end && !text.empty() && std::isfinite(value);
+}
+
+/**
+ * \brief function to copy a field in a fixed size name, with its terminating 0.
+ *
+ * \return false when the field doesn't fit, nothing is copied.
+ */
+bool csvCopy(char *dst, size_t size, std::string_view text)
+{
+    if (text.size() >= size)
+        return false;
+    memcpy(dst, text.data(), text.size());
+    dst[text.size()] = 0;
+    return true;
+}
+
+/**
+ * \brief function to report a rejected line of a CSV file on stderr,
+ * as "path:line : message (code)".
+ */
+void csvReport(const char *path, int line, statusErrDef code, const char *msg)
+{
+    fprintf(stderr, "%s:%d : %s (0x%04X)\n", path, line, msg, code);
+}
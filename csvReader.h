@@ -0,0 +1,94 @@
+/**
+ * \file csvReader.h
+ * \brief header file of the CSV reading helpers
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * Contains the helpers shared by the physical configuration and the
+ * general state readers. The files are read once at initialisation.
+ *
+ * A CSV file is mapped in memory and tokenized in place : the lines and
+ * fields are string_views into the mapping, the numbers are converted
+ * with std::from_chars, nothing is copied until a row is compiled into
+ * the board tables. The lines have no length limit. The rows of a file
+ * are allocated from a CsvArena, a few blocks for the whole file instead
+ * of one allocation per row.
+ */
+
+#ifndef CSVREADER_H
+#define CSVREADER_H
+
+#include "statusErrorDefine.h"
+#include <cstddef>
+#include <string_view>
+
+/**
+ * \brief a CSV file mapped read-only in memory.
+ * The string_views it returns are valid until close() or its destruction.
+ */
+class CsvFile
+{
+private:
+    const char *data;
+    size_t size;
+    size_t pos;     /**< start of the next line */
+    int lineNumber; /**< number of the last line returned, skipped ones included */
+
+public:
+    CsvFile();
+    ~CsvFile();
+    CsvFile(const CsvFile &) = delete;
+    CsvFile &operator=(const CsvFile &) = delete;
+
+    bool open(const char *path);
+    void close();
+    int countLines() const;
+    bool nextLine(std::string_view &line, const char *header);
+    int getLineNumber() const;
+    size_t getSize() const;
+};
+
+/**
+ * \brief bump allocator for the rows of the CSV files.
+ * Freed as a whole by reset() or its destruction.
+ */
+class CsvArena
+{
+private:
+    struct Block
+    {
+        Block *next;
+        size_t size;
+    };
+    Block *head; /**< newest and largest block */
+    size_t used; /**< bytes used in head */
+
+public:
+    CsvArena();
+    ~CsvArena();
+    CsvArena(const CsvArena &) = delete;
+    CsvArena &operator=(const CsvArena &) = delete;
+
+    void *alloc(size_t bytes, size_t align);
+    void reset();
+
+    /**
+     * \brief function to allocate n uninitialised rows.
+     *
+     * \return nullptr when the memory can't be allocated.
+     */
+    template <typename T>
+    T *alloc(size_t n)
+    {
+        return static_cast<T *>(alloc(sizeof(T) * (n ? n : 1), alignof(T)));
+    }
+};
+
+int csvSplitFields(std::string_view line, std::string_view *fields, int maxFields);
+bool csvToInt(std::string_view text, int &value);
+bool csvToFloat(std::string_view text, float &value);
+bool csvCopy(char *dst, size_t size, std::string_view text);
+void csvReport(const char *path, int line, statusErrDef code, const char *msg);
+
+#endif // CSVREADER_H
@@ -0,0 +1,187 @@
+/**
+ * \file cycle.cpp
+ * \brief Module running the control loop at a fixed period
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ */
+
+#include "cycle.h"
+#include "monotonicClock.h"
+#include "logger.h"
+#include <stdio.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <climits>
+#include <iostream>
+
+#define NSEC_PER_SEC 1000000000ll
+
+static struct timespec fromNs(int64_t ns)
+{
+    struct timespec ts;
+    ts.tv_sec = ns / NSEC_PER_SEC;
+    ts.tv_nsec = ns % NSEC_PER_SEC;
+    return ts;
+}
+
+CycleExecutive::CycleExecutive(const CycleConfig &config)
+    : config(config), stopped(false), statsSeq(0), stats{}
+{
+}
+
+/**
+ * \brief function to give the calling thread its real-time settings :
+ * locked memory, CPU affinity and SCHED_FIFO priority.
+ * A failing setting is reported and the others are still applied.
+ *
+ * \return statusErrDef that values errLockMemory, errCpuAffinity
+ * or errSchedRealTime for the last setting that failed, or noError.
+ */
+statusErrDef CycleExecutive::setupRealTime()
+{
+    statusErrDef res = noError;
+
+    if (config.lockMemory && mlockall(MCL_CURRENT | MCL_FUTURE) < 0)
+    {
+        perror("mlockall()");
+        res = errLockMemory;
+    }
+
+    if (config.cpu >= 0)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(config.cpu, &set);
+        int ret = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (ret != 0)
+        {
+            errno = ret;
+            perror("pthread_setaffinity_np()");
+            res = errCpuAffinity;
+        }
+    }
+
+    if (config.priority > 0)
+    {
+        struct sched_param param = {};
+        param.sched_priority = config.priority;
+        int ret = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (ret != 0)
+        {
+            errno = ret;
+            perror("pthread_setschedparam()");
+            res = errSchedRealTime;
+        }
+    }
+
+    return res;
+}
+
+/**
+ * \brief function to run body once per period until stop() is called.
+ *
+ * The deadlines are absolute so the period doesn't drift with the
+ * duration of body. When a cycle ends after the next deadline it is
+ * counted as an overrun and the deadlines already passed are skipped.
+ *
+ * The deadlines are the multiples of the period on CLOCK_MONOTONIC, the
+ * clock of the whole host : executives of the same period wake together,
+ * in other threads or other processes, whenever they were started.
+ *
+ * \param body the acquire, decide and actuate steps, called with the cycle number
+ * \return statusErrDef of setupRealTime(), the loop runs even when
+ * the real-time settings can't be applied.
+ */
+statusErrDef CycleExecutive::run(const std::function<void(uint64_t cycle)> &body)
+{
+    statusErrDef res = setupRealTime();
+    logRegisterThread();
+    const int64_t period = (int64_t)config.periodUs * 1000;
+    CycleStats local = {};
+    local.minJitterNs = INT64_MAX;
+
+    // the first deadline is the next multiple of the period, the common cycle clock
+    int64_t next = monotonicNs() / period * period;
+    while (!stopped.load(std::memory_order_relaxed))
+    {
+        next += period;
+        struct timespec deadline = fromNs(next);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR)
+            ;
+
+        int64_t wake = monotonicNs();
+        body(local.cycles);
+        int64_t end = monotonicNs();
+
+        int64_t jitter = wake - next;
+        int64_t latency = end - next;
+        local.cycles++;
+        local.lastJitterNs = jitter;
+        local.sumJitterNs += jitter;
+        if (jitter < local.minJitterNs)
+            local.minJitterNs = jitter;
+        if (jitter > local.maxJitterNs)
+            local.maxJitterNs = jitter;
+        if (latency > local.maxLatencyNs)
+            local.maxLatencyNs = latency;
+
+        int bucket = 0;
+        for (int64_t us = jitter / 1000; us > 0 && bucket < CYCLE_JITTER_BUCKETS - 1; us >>= 1)
+            bucket++;
+        local.jitterHisto[bucket]++;
+
+        if (end > next + period)
+        {
+            local.overruns++;
+            logEvent(logCycle, errCycleOverrun, "cycle overrun (cycle, latency us)",
+                     (int32_t)local.cycles, (int32_t)(latency / 1000));
+            // restart on the first deadline still in the future
+            int64_t late = (end - next) / period;
+            local.missed += late;
+            next += late * period;
+        }
+
+        seqlockPublish(&statsSeq, &stats, local);
+    }
+    return res;
+}
+
+/**
+ * \brief function to end run() after the current cycle. Called before
+ * run(), the loop doesn't start.
+ */
+void CycleExecutive::stop()
+{
+    stopped = true;
+}
+
+/**
+ * \brief function to copy the statistics, from any thread.
+ *
+ * \return false when no consistent copy could be made.
+ */
+bool CycleExecutive::getStats(CycleStats &out) const
+{
+    return seqlockRead(&statsSeq, &stats, out);
+}
+
+void CycleExecutive::printStats() const
+{
+    CycleStats s;
+    if (!getStats(s) || s.cycles == 0)
+    {
+        std::cout << "No cycle executed." << std::endl;
+        return;
+    }
+    printf("cycles %llu, overruns %llu, missed deadlines %llu\n",
+           (unsigned long long)s.cycles, (unsigned long long)s.overruns, (unsigned long long)s.missed);
+    printf("jitter min %.1f us, mean %.1f us, max %.1f us, worst latency %.1f us (period %ld us)\n",
+           s.minJitterNs / 1000.0, (double)s.sumJitterNs / s.cycles / 1000.0,
+           s.maxJitterNs / 1000.0, s.maxLatencyNs / 1000.0, config.periodUs);
+    for (int i = 0; i < CYCLE_JITTER_BUCKETS; i++)
+        if (s.jitterHisto[i])
+            printf("  jitter < %6d us : %llu\n", 1 << i, (unsigned long long)s.jitterHisto[i]);
+}
@@ -0,0 +1,80 @@
+/**
+ * \file cycle.h
+ * \brief header file of the cycle executive
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * Contains the class that runs the acquire, decide and actuate steps
+ * every CYCLE_LEN microseconds on absolute deadlines, and measures
+ * the jitter and the overruns of the loop.
+ */
+
+#ifndef CYCLE_H
+#define CYCLE_H
+
+#include "configDefine.h"
+#include "statusErrorDefine.h"
+#include "shmLayout.h"
+#include <cstdint>
+#include <atomic>
+#include <functional>
+#include <time.h>
+
+/**
+ * \brief number of buckets of the jitter histogram, bucket i counts
+ * the wake-ups late by [2^(i-1), 2^i[ microseconds
+ */
+#define CYCLE_JITTER_BUCKETS 16
+
+/**
+ * \brief real-time settings of the cycle thread
+ */
+struct CycleConfig
+{
+    long periodUs = CYCLE_LEN;   /**< cycle period in microseconds */
+    int priority = RT_PRIORITY;  /**< SCHED_FIFO priority, 0 for SCHED_OTHER */
+    int cpu = RT_CPU;            /**< CPU to pin the thread to, -1 for none */
+    bool lockMemory = true;      /**< mlockall() before the first cycle */
+};
+
+/**
+ * \brief timing statistics of the loop
+ */
+struct CycleStats
+{
+    uint64_t cycles;        /**< cycles executed */
+    uint64_t overruns;      /**< cycles that ended after the next deadline */
+    uint64_t missed;        /**< deadlines skipped because of overruns */
+    int64_t lastJitterNs;   /**< wake-up delay of the last cycle */
+    int64_t minJitterNs;    /**< smallest wake-up delay */
+    int64_t maxJitterNs;    /**< largest wake-up delay */
+    int64_t sumJitterNs;    /**< sum of the wake-up delays, for the mean */
+    int64_t maxLatencyNs;   /**< worst time from the deadline to the end of the cycle */
+    uint64_t jitterHisto[CYCLE_JITTER_BUCKETS];
+};
+
+/**
+ * \brief periodic executive based on clock_nanosleep(TIMER_ABSTIME).
+ *
+ * run() is called from the thread that becomes the real-time thread,
+ * the statistics can be read from any other thread with getStats().
+ */
+class CycleExecutive
+{
+private:
+    CycleConfig config;
+    std::atomic<bool> stopped; /**< set by stop(), even before run() started */
+    uint32_t statsSeq;   /**< sequence lock of stats */
+    CycleStats stats;
+
+public:
+    CycleExecutive(const CycleConfig &config = CycleConfig());
+    statusErrDef setupRealTime();
+    statusErrDef run(const std::function<void(uint64_t cycle)> &body);
+    void stop();
+    bool getStats(CycleStats &out) const;
+    void printStats() const;
+};
+
+#endif // CYCLE_H
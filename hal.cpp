@@ -0,0 +1,593 @@
+/**
+ * \file hal.cpp
+ * \brief Module of the ADC and GPIO backends, real and simulated
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * Errors :
+ * - errHalConfig : HAL_ENV names an unknown backend or key, a value is not
+ *   a number, or the waveform file is missing, empty or malformed
+ * - errGPIOPathEmpty, errOpenGPIO, errGPIOGetLine, errGPIORequestOutput :
+ *   the GPIO chip or its lines can't be requested
+ * - errGPIOSetValue : a bulk write failed, or a simulated write fault
+ *
+ * A simulated read fault returns ADC_READ_ERROR with errno set to EIO,
+ * like a failing pread() of the sysfs file.
+ */
+
+#include "hal.h"
+#include "monotonicClock.h"
+#include "sensor.h"
+#include "csvReader.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <string_view>
+
+/**
+ * \brief xorshift32, the simulated faults and noise without lock or allocation
+ */
+static uint32_t nextRandom(uint32_t &state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+/**
+ * \brief true once per million draws on average for ppm = 1
+ */
+static bool draw(uint32_t &state, uint32_t ppm)
+{
+    return ppm && nextRandom(state) % 1000000u < ppm;
+}
+
+/**
+ * \brief spins for ns, a SPI transfer or a GPIO write keeps the CPU
+ * busy the same way and is too short for a sleep.
+ */
+static void spin(uint32_t ns)
+{
+    if (!ns)
+        return;
+    uint64_t end = monotonicNs() + ns;
+    while (monotonicNs() < end)
+        ;
+}
+
+//------------------------------------------------------------------------------
+// sysfs ADC
+//------------------------------------------------------------------------------
+
+/**
+ * \brief function to open the in_voltageN_raw file of a channel, the
+ * handle is its descriptor.
+ */
+int SysfsAdc::open(int channel)
+{
+    char path[MAX_PATH_LENGTH];
+    snprintf(path, sizeof(path), "%sin_voltage%d_raw", Sensor::getIioPath(), channel);
+    return ::open(path, O_RDONLY | O_CLOEXEC);
+}
+
+/**
+ * \brief function to read the decimal text of the file from offset 0,
+ * one pread() and no lseek() per sample.
+ */
+int SysfsAdc::read(int handle)
+{
+    char buff[8];
+    ssize_t n = pread(handle, buff, sizeof(buff), 0);
+    if (n <= 0)
+    {
+        if (n == 0)
+            errno = 0;
+        return ADC_READ_ERROR;
+    }
+    return Sensor::parseAdc(buff, n);
+}
+
+int SysfsAdc::close(int handle)
+{
+    return handle >= 0 ? ::close(handle) : 0;
+}
+
+const char *SysfsAdc::getName() const
+{
+    return "sysfs";
+}
+
+//------------------------------------------------------------------------------
+// simulated ADC
+//------------------------------------------------------------------------------
+
+SimAdc::SimAdc(const SimAdcConfig &config)
+    : config(config), nbSamples(0), channels{}, nbHandles(0)
+{
+}
+
+/**
+ * \brief function to read the samples played by the channels. Each line
+ * holds the MAX_ADC channels of one sample, the lines starting with '#'
+ * and a header starting with "ch" are skipped. Called before the boards
+ * open their channels.
+ *
+ * \return errHalConfig when the file can't be read or a line is malformed.
+ */
+statusErrDef SimAdc::loadWaveform(const char *path)
+{
+    CsvFile file;
+    if (!file.open(path))
+    {
+        perror(path);
+        return errHalConfig;
+    }
+    size_t nbLines = file.countLines();
+    if (nbLines > HAL_SIM_MAX_SAMPLES)
+        nbLines = HAL_SIM_MAX_SAMPLES;
+    wave.assign(nbLines * MAX_ADC, 0);
+    nbSamples = 0;
+
+    std::string_view line;
+    while (nbSamples < nbLines && file.nextLine(line, "ch"))
+    {
+        std::string_view fields[MAX_ADC];
+        int n = csvSplitFields(line, fields, MAX_ADC);
+        if (n < 1 || n > MAX_ADC)
+        {
+            csvReport(path, file.getLineNumber(), errHalConfig, "expected 1 to MAX_ADC channel values");
+            return errHalConfig;
+        }
+        for (int c = 0; c < MAX_ADC; c++)
+        {
+            // a missing channel repeats the last one of the line
+            int value;
+            if (!csvToInt(fields[c < n ? c : n - 1], value) || value < INT16_MIN || value > INT16_MAX)
+            {
+                csvReport(path, file.getLineNumber(), errHalConfig, "channel value not an int16");
+                return errHalConfig;
+            }
+            wave[nbSamples * MAX_ADC + c] = (int16_t)value;
+        }
+        nbSamples++;
+    }
+    if (!nbSamples)
+    {
+        csvReport(path, file.getLineNumber(), errHalConfig, "no sample");
+        return errHalConfig;
+    }
+    return noError;
+}
+
+/**
+ * \brief function to give a channel its handle, at initialisation.
+ *
+ * \return -1 with errno set to ENOSPC after HAL_SIM_MAX_HANDLES channels,
+ * or to ENOENT for a channel outside of the MCP3008.
+ */
+int SimAdc::open(int channel)
+{
+    if (channel < 0 || channel >= MAX_ADC)
+    {
+        errno = ENOENT;
+        return -1;
+    }
+    int handle = nbHandles.fetch_add(1);
+    if (handle >= HAL_SIM_MAX_HANDLES)
+    {
+        nbHandles--;
+        errno = ENOSPC;
+        return -1;
+    }
+    SimChannel &ch = channels[handle];
+    ch.channel = channel;
+    // a different sequence per handle, never 0
+    ch.rng = (config.seed ^ (0x9E3779B9u * (uint32_t)(handle + 1))) | 1;
+    ch.position = 0;
+    ch.stuckLeft = 0;
+    ch.last = 512 + 64 * channel;
+    ch.nbReads = 0;
+    ch.nbFaults = 0;
+    return handle;
+}
+
+/**
+ * \brief function to produce one sample : the read latency, then a read
+ * fault, a stuck value or the next waveform sample with its noise.
+ */
+int SimAdc::read(int handle)
+{
+    if (handle < 0 || handle >= nbHandles.load(std::memory_order_relaxed))
+    {
+        errno = EBADF;
+        return ADC_READ_ERROR;
+    }
+    SimChannel &ch = channels[handle];
+    ch.nbReads++;
+    spin(config.latencyNs + (config.jitterNs ? nextRandom(ch.rng) % config.jitterNs : 0));
+
+    if (draw(ch.rng, config.faultPpm))
+    {
+        ch.nbFaults++;
+        errno = EIO;
+        return ADC_READ_ERROR;
+    }
+    if (ch.stuckLeft || draw(ch.rng, config.stuckPpm))
+    {
+        ch.stuckLeft = ch.stuckLeft ? ch.stuckLeft - 1 : HAL_SIM_STUCK_READS - 1;
+        ch.nbFaults++;
+        return ch.last;
+    }
+
+    int value = 512 + 64 * ch.channel;
+    if (nbSamples)
+    {
+        value = wave[ch.position * MAX_ADC + ch.channel];
+        if (++ch.position >= nbSamples)
+            ch.position = 0;
+    }
+    if (config.noise > 0)
+        value += (int)(nextRandom(ch.rng) % (2u * config.noise + 1)) - config.noise;
+    // the MCP3008 is a 10 bit converter
+    if (value < 0)
+        value = 0;
+    if (value > 1023)
+        value = 1023;
+    ch.last = value;
+    return value;
+}
+
+int SimAdc::close(int)
+{
+    return 0;
+}
+
+const char *SimAdc::getName() const
+{
+    return "sim";
+}
+
+/**
+ * \brief function to get the reads of every handle. Exact once the
+ * boards are stopped, an estimate while they run.
+ */
+uint64_t SimAdc::getNbReads() const
+{
+    uint64_t total = 0;
+    for (int i = 0; i < nbHandles.load(); i++)
+        total += channels[i].nbReads;
+    return total;
+}
+
+/**
+ * \brief function to get the read errors and stuck reads of every handle.
+ */
+uint64_t SimAdc::getNbFaults() const
+{
+    uint64_t total = 0;
+    for (int i = 0; i < nbHandles.load(); i++)
+        total += channels[i].nbFaults;
+    return total;
+}
+
+//------------------------------------------------------------------------------
+// libgpiod lines
+//------------------------------------------------------------------------------
+
+GpiodBackend::GpiodBackend(const char *chipPath)
+    : chipPath(chipPath), chip(nullptr)
+{
+    gpiod_line_bulk_init(&bulk);
+}
+
+GpiodBackend::~GpiodBackend()
+{
+    close();
+}
+
+/**
+ * \brief function to open the chip and request every line as an output
+ * in a single bulk request.
+ */
+statusErrDef GpiodBackend::open(const unsigned int *offsets, int nbLines, const int *values)
+{
+    if (chip)
+        return errGPIOGetLine;
+    if (strcmp(chipPath, "") == 0 || strcmp(chipPath, " ") == 0)
+    {
+        perror("Error: GPIO chip path is not set.");
+        return errGPIOPathEmpty;
+    }
+
+    chip = gpiod_chip_open(chipPath);
+    if (!chip)
+    {
+        perror("Open chip failed\n");
+        return errOpenGPIO;
+    }
+
+    gpiod_line_bulk_init(&bulk);
+    if (gpiod_chip_get_lines(chip, const_cast<unsigned int *>(offsets), nbLines, &bulk) < 0)
+    {
+        perror("Get lines failed\n");
+        gpiod_chip_close(chip);
+        chip = nullptr;
+        return errGPIOGetLine;
+    }
+
+    if (gpiod_line_request_bulk_output(&bulk, "Valve_control", values) < 0)
+    {
+        perror("Request lines as output failed\n");
+        gpiod_chip_close(chip);
+        chip = nullptr;
+        return errGPIORequestOutput;
+    }
+    return noError;
+}
+
+statusErrDef GpiodBackend::write(const int *values)
+{
+    if (!chip || gpiod_line_set_value_bulk(&bulk, values) < 0)
+        return errGPIOSetValue;
+    return noError;
+}
+
+void GpiodBackend::close()
+{
+    if (chip)
+    {
+        gpiod_line_release_bulk(&bulk);
+        gpiod_chip_close(chip);
+        chip = nullptr;
+    }
+}
+
+const char *GpiodBackend::getName() const
+{
+    return "gpiod";
+}
+
+//------------------------------------------------------------------------------
+// simulated lines
+//------------------------------------------------------------------------------
+
+SimGpio::SimGpio(const SimGpioConfig &config)
+    : config(config), nbLines(0), offsets{}, values{}, rng(config.seed | 1), nbWrites(0), nbFaults(0),
+      opened(false)
+{
+}
+
+statusErrDef SimGpio::open(const unsigned int *offsets, int nbLines, const int *values)
+{
+    if (opened || nbLines < 0 || nbLines > MAX_VALVES)
+        return errGPIOGetLine;
+    this->nbLines = nbLines;
+    for (int i = 0; i < nbLines; i++)
+    {
+        this->offsets[i] = offsets[i];
+        this->values[i] = values[i];
+    }
+    opened = true;
+    return noError;
+}
+
+/**
+ * \brief function to write the lines after the write latency, a write
+ * fault leaves every line unchanged.
+ */
+statusErrDef SimGpio::write(const int *values)
+{
+    if (!opened)
+        return errGPIOSetValue;
+    nbWrites++;
+    spin(config.latencyNs);
+    if (draw(rng, config.faultPpm))
+    {
+        nbFaults++;
+        return errGPIOSetValue;
+    }
+    for (int i = 0; i < nbLines; i++)
+        this->values[i] = values[i];
+    return noError;
+}
+
+void SimGpio::close()
+{
+    opened = false;
+}
+
+const char *SimGpio::getName() const
+{
+    return "sim";
+}
+
+/**
+ * \brief function to get the value of a line, in the order of open().
+ */
+int SimGpio::getValue(int line) const
+{
+    return (line >= 0 && line < nbLines) ? values[line] : -1;
+}
+
+/**
+ * \brief function to get the number of lines requested by open().
+ */
+int SimGpio::getNbLines() const
+{
+    return nbLines;
+}
+
+uint64_t SimGpio::getNbWrites() const
+{
+    return nbWrites;
+}
+
+uint64_t SimGpio::getNbFaults() const
+{
+    return nbFaults;
+}
+
+//------------------------------------------------------------------------------
+// selection
+//------------------------------------------------------------------------------
+
+static SysfsAdc sysfsAdc;
+static std::unique_ptr<SimAdc> simAdc;
+static AdcBackend *adc = &sysfsAdc;
+static HalConfig selected;
+
+static bool toUint(std::string_view text, uint32_t &value)
+{
+    int v;
+    if (!csvToInt(text, v) || v < 0)
+        return false;
+    value = (uint32_t)v;
+    return true;
+}
+
+/**
+ * \brief function to read a backend selection, e.g. "adc=sim,noise=4,gpio=sim".
+ * The keys are listed at the top of hal.h.
+ *
+ * \param spec the selection, nullptr or empty for the real hardware
+ * \param config receives the backends and their settings
+ * \return errHalConfig for the first unknown key or invalid value.
+ */
+statusErrDef halParse(const char *spec, HalConfig &config)
+{
+    config = HalConfig();
+    if (!spec)
+        return noError;
+
+    std::string_view rest(spec);
+    while (!rest.empty())
+    {
+        size_t comma = rest.find(',');
+        std::string_view item = rest.substr(0, comma);
+        rest = comma == std::string_view::npos ? std::string_view() : rest.substr(comma + 1);
+        if (item.empty())
+            continue;
+        size_t equal = item.find('=');
+        std::string_view key = item.substr(0, equal);
+        std::string_view value = equal == std::string_view::npos ? std::string_view() : item.substr(equal + 1);
+
+        uint32_t us = 0;
+        bool ok = true;
+        if (key == "adc")
+        {
+            ok = value == "sim" || value == "sysfs";
+            config.simAdc = value == "sim";
+        }
+        else if (key == "gpio")
+        {
+            ok = value == "sim" || value == "gpiod";
+            config.simGpio = value == "sim";
+        }
+        else if (key == "latency")
+        {
+            ok = toUint(value, us);
+            config.adc.latencyNs = us * 1000;
+        }
+        else if (key == "jitter")
+        {
+            ok = toUint(value, us);
+            config.adc.jitterNs = us * 1000;
+        }
+        else if (key == "noise")
+        {
+            uint32_t noise = 0;
+            ok = toUint(value, noise) && noise <= 1023;
+            config.adc.noise = (int)noise;
+        }
+        else if (key == "fault")
+            ok = toUint(value, config.adc.faultPpm) && config.adc.faultPpm <= 1000000;
+        else if (key == "stuck")
+            ok = toUint(value, config.adc.stuckPpm) && config.adc.stuckPpm <= 1000000;
+        else if (key == "seed")
+        {
+            ok = toUint(value, config.adc.seed);
+            config.gpio.seed = config.adc.seed;
+        }
+        else if (key == "wave")
+            ok = !value.empty() && csvCopy(config.wave, sizeof(config.wave), value);
+        else if (key == "gpiolatency")
+        {
+            ok = toUint(value, us);
+            config.gpio.latencyNs = us * 1000;
+        }
+        else if (key == "gpiofault")
+            ok = toUint(value, config.gpio.faultPpm) && config.gpio.faultPpm <= 1000000;
+        else
+            ok = false;
+
+        if (!ok)
+        {
+            fprintf(stderr, "%s : invalid \"%.*s\" in \"%s\" (0x%04X)\n", HAL_ENV, (int)item.size(), item.data(),
+                    spec, errHalConfig);
+            return errHalConfig;
+        }
+    }
+    return noError;
+}
+
+/**
+ * \brief function to select the backends, before the drivers are
+ * initialised. The sensors keep the ADC they were opened with.
+ *
+ * \return errHalConfig when the waveform can't be loaded, the real
+ * hardware stays selected.
+ */
+statusErrDef halSelect(const HalConfig &config)
+{
+    if (config.simAdc)
+    {
+        auto sim = std::make_unique<SimAdc>(config.adc);
+        if (config.wave[0] && sim->loadWaveform(config.wave) != noError)
+            return errHalConfig;
+        simAdc = std::move(sim);
+        adc = simAdc.get();
+    }
+    else
+        adc = &sysfsAdc;
+    selected = config;
+    return noError;
+}
+
+/**
+ * \brief function to select the backends of HAL_ENV, the real hardware
+ * when it is not set.
+ */
+statusErrDef halSelectFromEnv()
+{
+    HalConfig config;
+    statusErrDef res = halParse(getenv(HAL_ENV), config);
+    if (res != noError)
+        return res;
+    return halSelect(config);
+}
+
+/**
+ * \brief function to get the ADC of the type 1 sensors.
+ */
+AdcBackend &halAdc()
+{
+    return *adc;
+}
+
+/**
+ * \brief function to create the lines of a valve bank.
+ *
+ * \param chipPath GPIO chip of the real lines
+ */
+std::unique_ptr<GpioBackend> halCreateGpio(const char *chipPath)
+{
+    if (selected.simGpio)
+        return std::make_unique<SimGpio>(selected.gpio);
+    return std::make_unique<GpiodBackend>(chipPath);
+}
@@ -0,0 +1,239 @@
+/**
+ * \file hal.h
+ * \brief header file of the hardware abstraction layer
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * Contains the ADC and GPIO backends the drivers talk to instead of the
+ * hardware. The real ones read the MCP3008 through sysfs and write the
+ * valves through libgpiod. The simulated ones run anywhere : an ADC with
+ * a read latency, noise, read errors, stuck channels and the playback of
+ * a recorded waveform, and GPIO lines with a write latency and write
+ * errors, so the whole loop can be loaded and profiled on a dev machine.
+ *
+ * The backends are chosen at startup from HAL_ENV, a list of key=value :
+ * - adc=sysfs|sim : backend of the type 1 sensors (sysfs by default)
+ * - latency, jitter : read time of a simulated channel, in microseconds
+ * - noise : amplitude of the noise added to a simulated sample, in counts
+ * - fault : read errors, per million reads
+ * - stuck : stuck channels, per million reads, for HAL_SIM_STUCK_READS reads
+ * - wave : CSV file of the played samples, one line per read, one field
+ *   per MCP3008 channel, looped ; a level of 512 + 64 * channel without it
+ * - seed : seed of the simulated faults and noise
+ * - gpio=gpiod|sim : backend of the valve bank (gpiod by default)
+ * - gpiolatency : write time of the simulated lines, in microseconds
+ * - gpiofault : write errors, per million writes
+ *
+ * The IIO buffer (type 3) and the modbus bus (type 2) keep their device
+ * files, their benches already run on fake ones.
+ */
+
+#ifndef HAL_H
+#define HAL_H
+
+#include "configDefine.h"
+#include "statusErrorDefine.h"
+#include "shmLayout.h"
+#include <gpiod.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * \brief channels of an ADC, one handle per opened channel.
+ * read() is called by the cycle thread of the board owning the handle.
+ */
+class AdcBackend
+{
+public:
+    virtual ~AdcBackend() = default;
+
+    /**
+     * \brief function to prepare a channel before the first read.
+     *
+     * \return the handle of the channel, -1 when it can't be opened.
+     */
+    virtual int open(int channel) = 0;
+
+    /**
+     * \brief function to read one sample of an opened channel.
+     *
+     * \return the raw value, or ADC_READ_ERROR.
+     */
+    virtual int read(int handle) = 0;
+
+    /**
+     * \brief function to release a channel.
+     *
+     * \return -1 when it can't be released, 0 otherwise.
+     */
+    virtual int close(int handle) = 0;
+    virtual const char *getName() const = 0;
+};
+
+/**
+ * \brief the in_voltageN_raw files of the MCP3008 kernel module, one
+ * descriptor kept open per channel and read with pread().
+ */
+class SysfsAdc : public AdcBackend
+{
+public:
+    int open(int channel) override;
+    int read(int handle) override;
+    int close(int handle) override;
+    const char *getName() const override;
+};
+
+/**
+ * \brief settings of the simulated ADC
+ */
+struct SimAdcConfig
+{
+    uint32_t latencyNs = 0;    /**< time of a read, spent spinning like a SPI transfer */
+    uint32_t jitterNs = 0;     /**< random time added to latencyNs */
+    int noise = 0;             /**< the samples get a random noise in [-noise, noise] counts */
+    uint32_t faultPpm = 0;     /**< reads failing with ADC_READ_ERROR, per million */
+    uint32_t stuckPpm = 0;     /**< reads starting a stuck fault, per million */
+    uint32_t seed = 1;         /**< seed of the random generators of the channels */
+};
+
+/**
+ * \brief simulated MCP3008, each handle has its own random generator
+ * and waveform position so the boards read their channels without lock.
+ */
+class SimAdc : public AdcBackend
+{
+private:
+    /**
+     * \brief state of a handle, on its own cache line : the boards read in parallel
+     */
+    struct alignas(CACHE_LINE_SIZE) SimChannel
+    {
+        int channel;
+        uint32_t rng;        /**< xorshift32 state */
+        uint32_t position;   /**< next sample of the waveform */
+        uint32_t stuckLeft;  /**< reads left stuck at last */
+        int last;            /**< last value returned */
+        uint64_t nbReads;
+        uint64_t nbFaults;   /**< read errors and stuck reads */
+    };
+
+    SimAdcConfig config;
+    std::vector<int16_t> wave; /**< MAX_ADC values per sample */
+    uint32_t nbSamples;
+    SimChannel channels[HAL_SIM_MAX_HANDLES];
+    std::atomic<int> nbHandles;
+
+public:
+    SimAdc(const SimAdcConfig &config = SimAdcConfig());
+    statusErrDef loadWaveform(const char *path);
+    int open(int channel) override;
+    int read(int handle) override;
+    int close(int handle) override;
+    const char *getName() const override;
+    uint64_t getNbReads() const;
+    uint64_t getNbFaults() const;
+};
+
+/**
+ * \brief output lines of the valves of a bank, written all at once.
+ */
+class GpioBackend
+{
+public:
+    virtual ~GpioBackend() = default;
+
+    /**
+     * \brief function to request the lines as outputs with their initial values.
+     *
+     * \return statusErrDef of the chip or of the request, noError otherwise.
+     */
+    virtual statusErrDef open(const unsigned int *offsets, int nbLines, const int *values) = 0;
+
+    /**
+     * \brief function to write every line, values[i] to line i.
+     *
+     * \return errGPIOSetValue when the write fails, noError otherwise.
+     */
+    virtual statusErrDef write(const int *values) = 0;
+    virtual void close() = 0;
+    virtual const char *getName() const = 0;
+};
+
+/**
+ * \brief lines of a GPIO chip, requested and written in bulk with libgpiod.
+ */
+class GpiodBackend : public GpioBackend
+{
+private:
+    const char *chipPath; /**< CHIP_PATH or a gpio-sim chip */
+    gpiod_chip *chip;
+    gpiod_line_bulk bulk;
+
+public:
+    GpiodBackend(const char *chipPath = CHIP_PATH);
+    ~GpiodBackend() override;
+    statusErrDef open(const unsigned int *offsets, int nbLines, const int *values) override;
+    statusErrDef write(const int *values) override;
+    void close() override;
+    const char *getName() const override;
+};
+
+/**
+ * \brief settings of the simulated GPIO lines
+ */
+struct SimGpioConfig
+{
+    uint32_t latencyNs = 0; /**< time of a bulk write */
+    uint32_t faultPpm = 0;  /**< writes failing with errGPIOSetValue, per million */
+    uint32_t seed = 1;
+};
+
+/**
+ * \brief simulated lines : the values are kept so a bench can check them.
+ */
+class SimGpio : public GpioBackend
+{
+private:
+    SimGpioConfig config;
+    int nbLines;
+    unsigned int offsets[MAX_VALVES];
+    int values[MAX_VALVES]; /**< value of each line */
+    uint32_t rng;
+    uint64_t nbWrites;
+    uint64_t nbFaults;
+    bool opened;
+
+public:
+    SimGpio(const SimGpioConfig &config = SimGpioConfig());
+    statusErrDef open(const unsigned int *offsets, int nbLines, const int *values) override;
+    statusErrDef write(const int *values) override;
+    void close() override;
+    const char *getName() const override;
+    int getValue(int line) const;
+    int getNbLines() const;
+    uint64_t getNbWrites() const;
+    uint64_t getNbFaults() const;
+};
+
+/**
+ * \brief backends selected at startup
+ */
+struct HalConfig
+{
+    bool simAdc = false;
+    bool simGpio = false;
+    SimAdcConfig adc;
+    SimGpioConfig gpio;
+    char wave[MAX_PATH_LENGTH] = {}; /**< waveform of the simulated ADC, empty for the fixed levels */
+};
+
+statusErrDef halParse(const char *spec, HalConfig &config);
+statusErrDef halSelect(const HalConfig &config);
+statusErrDef halSelectFromEnv();
+AdcBackend &halAdc();
+std::unique_ptr<GpioBackend> halCreateGpio(const char *chipPath);
+
+#endif // HAL_H
@@ -0,0 +1,144 @@
+/**
+ * \file histogram.cpp
+ * \brief Module of the latency histogram
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ */
+
+#include "histogram.h"
+#include <cstring>
+
+LatencyHisto::LatencyHisto()
+{
+    reset();
+}
+
+void LatencyHisto::reset()
+{
+    memset(counts, 0, sizeof(counts));
+    total = 0;
+    min = UINT64_MAX;
+    max = 0;
+    sum = 0;
+}
+
+/**
+ * \brief function to find the bucket of a duration : the value itself
+ * below 2^HISTO_SUB_BITS, then the power of two and the
+ * HISTO_SUB_BITS - 1 bits that follow the leading one.
+ */
+int LatencyHisto::bucket(uint64_t ns)
+{
+    const uint64_t linear = 1ull << HISTO_SUB_BITS;
+    if (ns < linear)
+        return (int)ns;
+    int exponent = 63 - __builtin_clzll(ns);
+    int shift = exponent - (HISTO_SUB_BITS - 1);
+    int half = 1 << (HISTO_SUB_BITS - 1);
+    return (int)linear + (exponent - HISTO_SUB_BITS) * half + (int)((ns >> shift) - half);
+}
+
+/**
+ * \brief function to get the largest duration of a bucket.
+ */
+uint64_t LatencyHisto::upperBound(int index)
+{
+    const int linear = 1 << HISTO_SUB_BITS;
+    if (index < linear)
+        return (uint64_t)index;
+    int half = 1 << (HISTO_SUB_BITS - 1);
+    int exponent = (index - linear) / half + HISTO_SUB_BITS;
+    int shift = exponent - (HISTO_SUB_BITS - 1);
+    uint64_t sub = (uint64_t)((index - linear) % half + half);
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHisto::record(uint64_t ns)
+{
+    counts[bucket(ns)]++;
+    total++;
+    sum += ns;
+    if (ns < min)
+        min = ns;
+    if (ns > max)
+        max = ns;
+}
+
+/**
+ * \brief function to add the durations of another histogram, e.g. the
+ * histograms of several boards or threads.
+ */
+void LatencyHisto::merge(const LatencyHisto &other)
+{
+    for (int i = 0; i < HISTO_BUCKETS; i++)
+        counts[i] += other.counts[i];
+    total += other.total;
+    sum += other.sum;
+    if (other.total && other.min < min)
+        min = other.min;
+    if (other.max > max)
+        max = other.max;
+}
+
+/**
+ * \brief function to get a percentile, the largest duration of its
+ * bucket, never above the largest duration recorded.
+ *
+ * \param p the percentile, 50 for the median, 99.9 for p99.9
+ * \return 0 when nothing is recorded.
+ */
+uint64_t LatencyHisto::percentile(double p) const
+{
+    if (!total)
+        return 0;
+    uint64_t rank = (uint64_t)(p / 100.0 * (double)total + 0.5);
+    if (rank < 1)
+        rank = 1;
+    if (rank > total)
+        rank = total;
+    uint64_t seen = 0;
+    for (int i = 0; i < HISTO_BUCKETS; i++)
+    {
+        seen += counts[i];
+        if (seen >= rank)
+        {
+            uint64_t bound = upperBound(i);
+            return bound < max ? bound : max;
+        }
+    }
+    return max;
+}
+
+uint64_t LatencyHisto::getCount() const
+{
+    return total;
+}
+
+uint64_t LatencyHisto::getMin() const
+{
+    return total ? min : 0;
+}
+
+uint64_t LatencyHisto::getMax() const
+{
+    return max;
+}
+
+double LatencyHisto::getMean() const
+{
+    return total ? (double)sum / (double)total : 0.0;
+}
+
+/**
+ * \brief function to write the summary as a JSON object, in nanoseconds.
+ */
+void LatencyHisto::printJson(FILE *f) const
+{
+    fprintf(f,
+            "{\"count\": %llu, \"min\": %llu, \"mean\": %.1f, \"p50\": %llu, \"p90\": %llu, \"p99\": %llu, "
+            "\"p999\": %llu, \"max\": %llu}",
+            (unsigned long long)total, (unsigned long long)getMin(), getMean(),
+            (unsigned long long)percentile(50), (unsigned long long)percentile(90),
+            (unsigned long long)percentile(99), (unsigned long long)percentile(99.9), (unsigned long long)max);
+}
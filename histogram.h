@@ -0,0 +1,59 @@
+/**
+ * \file histogram.h
+ * \brief header file of the latency histogram
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * Contains a log-linear histogram of durations in nanoseconds, in the
+ * manner of HdrHistogram : exact below 2^HISTO_SUB_BITS ns, then
+ * 2^(HISTO_SUB_BITS-1) buckets per power of two, so every percentile is
+ * known within 1 / 2^(HISTO_SUB_BITS-1) of its value whatever the range.
+ * record() is a few instructions without allocation, it can run in the
+ * control loop ; the percentiles are computed by the reader.
+ */
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <cstdint>
+#include <cstdio>
+
+/**
+ * \brief the values below 2^HISTO_SUB_BITS are exact, the others within 1.6 %
+ */
+#define HISTO_SUB_BITS 7
+/**
+ * \brief buckets of the 64 bit range
+ */
+#define HISTO_BUCKETS ((1 << HISTO_SUB_BITS) + (64 - HISTO_SUB_BITS) * (1 << (HISTO_SUB_BITS - 1)))
+
+/**
+ * \brief distribution of durations in nanoseconds.
+ */
+class LatencyHisto
+{
+private:
+    uint64_t counts[HISTO_BUCKETS];
+    uint64_t total;
+    uint64_t min;
+    uint64_t max;
+    uint64_t sum;
+
+    static int bucket(uint64_t ns);
+    static uint64_t upperBound(int index);
+
+public:
+    LatencyHisto();
+    void reset();
+    void record(uint64_t ns);
+    void merge(const LatencyHisto &other);
+    uint64_t percentile(double p) const;
+    uint64_t getCount() const;
+    uint64_t getMin() const;
+    uint64_t getMax() const;
+    double getMean() const;
+    void printJson(FILE *f) const;
+};
+
+#endif // HISTOGRAM_H
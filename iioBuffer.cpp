@@ -0,0 +1,347 @@
+/**
+ * \file iioBuffer.cpp
+ * \brief Module to read the MCP3008 channels through the IIO triggered buffer
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * The scan records follow the IIO buffer format : the enabled channels are
+ * stored in scan index order, each one aligned on its own storage size,
+ * and the record is padded to the largest storage size.
+ */
+
+#include "iioBuffer.h"
+#include <dirent.h>
+#include <unistd.h>
+#include <algorithm>
+
+/**
+ * \brief function to write a value in a sysfs attribute.
+ *
+ * \param dir the iio:deviceN directory
+ * \param attr the attribute path relative to dir
+ * \param value the text to write
+ * \return statusErrDef that values errOpenAdc when the attribute can't be
+ * opened, errWriteAdc when it can't be written, or noError.
+ */
+static statusErrDef writeAttr(const char *dir, const char *attr, const char *value)
+{
+    char path[MAX_PATH_LENGTH];
+    if (snprintf(path, sizeof(path), "%s%s", dir, attr) >= (int)sizeof(path))
+    {
+        logEvent(logIio, errOpenAdc, "attribute path too long");
+        return errOpenAdc;
+    }
+    int fd = open(path, O_WRONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        logEvent(logIio, errOpenAdc, "attribute open() failed (errno)", errno);
+        return errOpenAdc;
+    }
+    ssize_t len = (ssize_t)strlen(value);
+    statusErrDef res = noError;
+    if (write(fd, value, len) != len)
+    {
+        logEvent(logIio, errWriteAdc, "attribute write() failed (errno)", errno);
+        res = errWriteAdc;
+    }
+    close(fd);
+    return res;
+}
+
+/**
+ * \brief function to read a sysfs attribute.
+ *
+ * \return statusErrDef that values errOpenAdc when the attribute can't be
+ * opened, errReadAdc when it is empty or can't be read, or noError.
+ */
+static statusErrDef readAttr(const char *dir, const char *attr, char *value, size_t len)
+{
+    char path[MAX_PATH_LENGTH];
+    if (snprintf(path, sizeof(path), "%s%s", dir, attr) >= (int)sizeof(path))
+    {
+        logEvent(logIio, errOpenAdc, "attribute path too long");
+        return errOpenAdc;
+    }
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        logEvent(logIio, errOpenAdc, "attribute open() failed (errno)", errno);
+        return errOpenAdc;
+    }
+    ssize_t n = read(fd, value, len - 1);
+    int err = errno;
+    close(fd);
+    if (n <= 0)
+    {
+        logEvent(logIio, errReadAdc, "attribute read() failed (bytes, errno)", (int32_t)n, n < 0 ? err : 0);
+        return errReadAdc;
+    }
+    value[n] = 0;
+    return noError;
+}
+
+IioBuffer::IioBuffer(const char *sysPath, const char *devPath)
+    : sysPath(sysPath), devPath(devPath), fd(-1), nbElements(0), scanSize(0), pending(0), nbScans(0)
+{
+}
+
+IioBuffer::~IioBuffer()
+{
+    disable();
+}
+
+/**
+ * \brief function to add a sensor to the scan.
+ * Must be called before enable().
+ *
+ * \param sensor an MCP3008 sensor
+ * \return statusErrDef that values errOpenAdc when the channel
+ * is out of range or the scan is full, or noError.
+ */
+statusErrDef IioBuffer::addSensor(Sensor *sensor)
+{
+    if (nbElements >= MAX_ADC || sensor->getChannel() < 0 || sensor->getChannel() >= MAX_ADC)
+        return errOpenAdc;
+
+    IioScanElement &elem = elements[nbElements];
+    elem.channel = sensor->getChannel();
+    elem.sensor = sensor;
+    nbElements++;
+    return noError;
+}
+
+/**
+ * \brief function to read the scan index and the type of a channel,
+ * e.g. "be:u10/16>>0".
+ *
+ * \return statusErrDef that values errOpenAdc or errReadAdc when the
+ * attributes can't be read, errReadAdc when the type is malformed, or noError.
+ */
+statusErrDef IioBuffer::parseElement(IioScanElement &elem)
+{
+    char attr[64];
+    char text[64];
+
+    snprintf(attr, sizeof(attr), "scan_elements/in_voltage%d_index", elem.channel);
+    statusErrDef res = readAttr(sysPath, attr, text, sizeof(text));
+    if (res != noError)
+        return res;
+    elem.index = atoi(text);
+
+    snprintf(attr, sizeof(attr), "scan_elements/in_voltage%d_type", elem.channel);
+    res = readAttr(sysPath, attr, text, sizeof(text));
+    if (res != noError)
+        return res;
+
+    char endian[3] = {0};
+    char sign = 0;
+    unsigned storage = 0;
+    elem.shift = 0;
+    if (sscanf(text, "%2c:%c%u/%u>>%u", endian, &sign, &elem.bits, &storage, &elem.shift) < 4)
+        return errReadAdc;
+    if (storage != 8 && storage != 16 && storage != 32)
+        return errReadAdc;
+    if (elem.bits == 0 || elem.bits > storage || elem.shift >= storage)
+        return errReadAdc;
+
+    elem.bigEndian = (endian[0] == 'b');
+    elem.isSigned = (sign == 's');
+    elem.storageBytes = storage / 8;
+    return noError;
+}
+
+/**
+ * \brief function to configure and start the triggered buffer :
+ * scan_elements/ *_en, buffer/length then buffer/enable.
+ *
+ * \param length number of scans held by the kernel buffer
+ * \return statusErrDef that values errOpenAdc when an attribute
+ * or the character device can't be opened, errWriteAdc when an
+ * attribute can't be written, errReadAdc when a scan type can't be
+ * read or is malformed, or noError.
+ */
+statusErrDef IioBuffer::enable(unsigned length)
+{
+    statusErrDef res = noError;
+    char value[16];
+
+    if (nbElements == 0)
+        return errOpenAdc;
+
+    // the scan configuration can only change while the buffer is off
+    writeAttr(sysPath, "buffer/enable", "0");
+
+    // only the channels of the sensors are enabled
+    char dirPath[MAX_PATH_LENGTH];
+    snprintf(dirPath, sizeof(dirPath), "%sscan_elements", sysPath);
+    DIR *dir = opendir(dirPath);
+    if (!dir)
+    {
+        logEvent(logIio, errOpenAdc, "scan_elements opendir() failed (errno)", errno);
+        return errOpenAdc;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr)
+    {
+        size_t len = strlen(entry->d_name);
+        if (len < 3 || strcmp(entry->d_name + len - 3, "_en") != 0)
+            continue;
+        int channel = -1;
+        bool wanted = false;
+        if (sscanf(entry->d_name, "in_voltage%d_en", &channel) == 1)
+            for (int i = 0; i < nbElements; i++)
+                wanted |= (elements[i].channel == channel);
+        char attr[300];
+        snprintf(attr, sizeof(attr), "scan_elements/%s", entry->d_name);
+        statusErrDef attrRes = writeAttr(sysPath, attr, wanted ? "1" : "0");
+        if (attrRes != noError && wanted)
+            res = attrRes;
+    }
+    closedir(dir);
+    if (res != noError)
+        return res;
+
+    for (int i = 0; i < nbElements; i++)
+    {
+        res = parseElement(elements[i]);
+        if (res != noError)
+            return res;
+    }
+
+    // records are stored by scan index, each element aligned on its size
+    std::sort(elements, elements + nbElements,
+              [](const IioScanElement &a, const IioScanElement &b)
+              { return a.index < b.index; });
+    size_t offset = 0;
+    size_t align = 1;
+    for (int i = 0; i < nbElements; i++)
+    {
+        size_t sz = elements[i].storageBytes;
+        offset = (offset + sz - 1) / sz * sz;
+        elements[i].offset = offset;
+        offset += sz;
+        align = std::max(align, sz);
+    }
+    scanSize = (offset + align - 1) / align * align;
+
+    snprintf(value, sizeof(value), "%u", length);
+    res = writeAttr(sysPath, "buffer/length", value);
+    if (res != noError)
+        return res;
+    res = writeAttr(sysPath, "buffer/enable", "1");
+    if (res != noError)
+        return res;
+
+    // non blocking so an empty buffer never stalls the cycle
+    fd = open(devPath, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0)
+    {
+        logEvent(logIio, errOpenAdc, "buffer device open() failed (errno)", errno);
+        writeAttr(sysPath, "buffer/enable", "0");
+        return errOpenAdc;
+    }
+    pending = 0;
+    return noError;
+}
+
+/**
+ * \brief function to stop the triggered buffer and close the device.
+ *
+ * \return statusErrDef that values errCloseAdc when the device
+ * fails to close, or noError.
+ */
+statusErrDef IioBuffer::disable()
+{
+    statusErrDef res = noError;
+    if (fd >= 0)
+    {
+        if (close(fd) < 0)
+            res = errCloseAdc;
+        fd = -1;
+        writeAttr(sysPath, "buffer/enable", "0");
+    }
+    return res;
+}
+
+/**
+ * \brief function to extract a channel value from a scan record.
+ */
+int16_t IioBuffer::extract(const IioScanElement &elem, const uint8_t *scan) const
+{
+    const uint8_t *p = scan + elem.offset;
+    uint32_t raw = 0;
+    for (unsigned b = 0; b < elem.storageBytes; b++)
+    {
+        unsigned pos = elem.bigEndian ? b : elem.storageBytes - 1 - b;
+        raw = (raw << 8) | p[pos];
+    }
+    // a malformed scan type gives 0 rather than an undefined shift
+    if (elem.bits == 0 || elem.shift >= 32)
+        return 0;
+    raw >>= elem.shift;
+    uint32_t mask = (elem.bits >= 32) ? 0xFFFFFFFFu : ((1u << elem.bits) - 1u);
+    raw &= mask;
+    if (elem.isSigned && elem.bits < 32 && (raw & (1u << (elem.bits - 1))))
+        return (int16_t)(int32_t)(raw | ~mask);
+    return (int16_t)raw;
+}
+
+/**
+ * \brief function to read every available scan with a single read()
+ * and demultiplex them. The sensors receive the values of the latest scan.
+ *
+ * \param rows optional array receiving maxRows rows of one value per
+ * sensor, in scan index order, for high-rate logging
+ * \param maxRows number of rows available in rows
+ * \return the number of scans read, 0 when no scan is available
+ * or -1 when the read fails.
+ */
+int IioBuffer::readScans(int16_t *rows, int maxRows)
+{
+    if (fd < 0 || scanSize == 0)
+        return -1;
+
+    ssize_t n = read(fd, buff + pending, sizeof(buff) - pending);
+    if (n < 0)
+    {
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return 0;
+        logEvent(logIio, errReadAdc, "read() failed (errno)", errno);
+        return -1;
+    }
+
+    size_t avail = pending + (size_t)n;
+    int scans = (int)(avail / scanSize);
+    for (int s = 0; s < scans; s++)
+    {
+        const uint8_t *scan = buff + s * scanSize;
+        bool last = (s == scans - 1);
+        for (int i = 0; i < nbElements; i++)
+        {
+            int16_t v = extract(elements[i], scan);
+            if (rows && s < maxRows)
+                rows[s * nbElements + i] = v;
+            if (last)
+                elements[i].sensor->setValue(v);
+        }
+    }
+
+    // an incomplete record (FIFO) is kept for the next read
+    pending = avail - scans * scanSize;
+    if (pending)
+        memmove(buff, buff + scans * scanSize, pending);
+
+    nbScans += scans;
+    return scans;
+}
+
+size_t IioBuffer::getScanSize() const
+{
+    return scanSize;
+}
+
+uint64_t IioBuffer::getNbScans() const
+{
+    return nbScans;
+}
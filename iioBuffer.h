@@ -0,0 +1,73 @@
+/**
+ * \file iioBuffer.h
+ * \brief header file of the IIO buffered capture module
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * Contains the class that configures the triggered buffer of the MCP3008
+ * IIO driver (scan_elements, buffer/length, buffer/enable) and reads packed
+ * multi-channel scans from /dev/iio:deviceN in bulk.
+ */
+
+#ifndef IIOBUFFER_H
+#define IIOBUFFER_H
+
+#include "configDefine.h"
+#include "statusErrorDefine.h"
+#include "sensor.h"
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * \brief layout of one channel inside a scan record,
+ * taken from scan_elements/in_voltageN_type and _index.
+ */
+struct IioScanElement
+{
+    int channel;           /**< MCP3008 channel number */
+    int index;             /**< scan index, gives the order inside the record */
+    bool bigEndian;        /**< be or le storage */
+    bool isSigned;         /**< s or u */
+    unsigned bits;         /**< real bits of the value */
+    unsigned storageBytes; /**< storage bits / 8 */
+    unsigned shift;        /**< right shift to apply to the storage */
+    unsigned offset;       /**< byte offset in the scan record */
+    Sensor *sensor;        /**< sensor receiving the value */
+};
+
+/**
+ * \brief IIO triggered buffer reader for the MCP3008.
+ *
+ * One read() returns every enabled channel for as many cycles as the
+ * kernel buffered, and the scans are demultiplexed into the sensors
+ * in a single pass.
+ */
+class IioBuffer
+{
+private:
+    const char *sysPath;   /**< iio:deviceN sysfs directory, with a trailing '/' */
+    const char *devPath;   /**< character device delivering the scans */
+    int fd;                /**< character device descriptor */
+    IioScanElement elements[MAX_ADC];
+    int nbElements;
+    size_t scanSize;       /**< bytes per scan record, padded */
+    uint8_t buff[IIO_BUFFER_LENGTH * MAX_ADC * 8];
+    size_t pending;        /**< bytes of an incomplete record kept for the next read */
+    uint64_t nbScans;      /**< total number of scans demultiplexed */
+
+    statusErrDef parseElement(IioScanElement &elem);
+    int16_t extract(const IioScanElement &elem, const uint8_t *scan) const;
+
+public:
+    IioBuffer(const char *sysPath = IIOSYSPATH, const char *devPath = IIODEVPATH);
+    ~IioBuffer();
+    statusErrDef addSensor(Sensor *sensor);
+    statusErrDef enable(unsigned length = IIO_BUFFER_LENGTH);
+    statusErrDef disable();
+    int readScans(int16_t *rows = nullptr, int maxRows = 0);
+    size_t getScanSize() const;
+    uint64_t getNbScans() const;
+};
+
+#endif // IIOBUFFER_H
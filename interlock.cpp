@@ -0,0 +1,286 @@
+/**
+ * \file interlock.cpp
+ * \brief Module compiling and evaluating the valve interlock rules
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * Errors of load(), reported with the file and line, the first one is returned :
+ * - errOpenActivationFile : activation.csv missing, line malformed, condition
+ *   unknown, threshold missing or outside of int16, valve required both
+ *   open and closed
+ * - errDependOutsideOfRange : the valve, or the valve or sensor it depends
+ *   on, is not on the board, or a valve depends on itself
+ * - errAllocDataActivation : rows can't be allocated, or more than
+ *   MAX_INTERLOCK_CONDS distinct sensor conditions
+ *
+ * Results of filter() :
+ * - infoNoDepend : the board has no rule, the commands are unchanged
+ * - infoVerifDependSucess : every commanded valve may be open
+ * - infoAllDependNotActivated : valves are held closed, their dependencies are not met
+ * - errGPIODependValue : valves are held closed, a sensor they depend on is in error
+ */
+
+#include "interlock.h"
+#include "csvReader.h"
+#include "logger.h"
+#include <stdio.h>
+#include <string.h>
+
+Interlock::Interlock()
+    : needOpen{}, needClosed{}, needConds{}, condSlot{}, condThreshold{}, condAbove{},
+      nbConds(0), nbValves(0), nbRules(0), locked(0), refused(0)
+{
+}
+
+/**
+ * \brief function to find or add a sensor condition.
+ *
+ * \return the index of the condition, -1 when MAX_INTERLOCK_CONDS are used.
+ */
+int Interlock::condition(uint8_t slot, int16_t threshold, uint8_t above)
+{
+    for (int k = 0; k < nbConds; k++)
+        if (condSlot[k] == slot && condThreshold[k] == threshold && condAbove[k] == above)
+            return k;
+    if (nbConds >= MAX_INTERLOCK_CONDS)
+        return -1;
+    condSlot[nbConds] = slot;
+    condThreshold[nbConds] = threshold;
+    condAbove[nbConds] = above;
+    return nbConds++;
+}
+
+/**
+ * \brief function to read activation.csv and compile the rules of a
+ * board, once, before the control loop starts.
+ *
+ * \param board the valve and sensor slots of the board
+ * \param path the rule file
+ * \return statusErrDef of the first invalid file or line, or noError.
+ */
+statusErrDef Interlock::load(const BoardConfig &board, const char *path)
+{
+    memset(needOpen, 0, sizeof(needOpen));
+    memset(needClosed, 0, sizeof(needClosed));
+    memset(needConds, 0, sizeof(needConds));
+    nbConds = 0;
+    nbValves = board.nbValves;
+    nbRules = 0;
+    locked = 0;
+    refused = 0;
+
+    CsvFile file;
+    if (!file.open(path))
+    {
+        perror(path);
+        return errOpenActivationFile;
+    }
+
+    CsvArena arena;
+    LigneActivation *rows = arena.alloc<LigneActivation>(file.countLines());
+    if (!rows)
+        return errAllocDataActivation;
+
+    // a malformed line is kept without condition, its valve is locked below
+    statusErrDef res = noError;
+    std::string_view line;
+    int nbRows = 0;
+    while (file.nextLine(line, "board"))
+    {
+        std::string_view fields[5];
+        int n = csvSplitFields(line, fields, 5);
+        LigneActivation &row = rows[nbRows++];
+        row.board = fields[0];
+        row.valve = n > 1 ? fields[1] : std::string_view();
+        row.condition = n > 2 ? fields[2] : std::string_view();
+        row.target = n > 3 ? fields[3] : std::string_view();
+        row.threshold = 0;
+        row.line = file.getLineNumber();
+
+        bool sensor = row.condition == "below" || row.condition == "above";
+        bool valve = row.condition == "open" || row.condition == "closed";
+        const char *msg = nullptr;
+        if (n < 4 || n > 5 || (!sensor && !valve))
+            msg = "expected board;valve;open|closed|below|above;target;threshold";
+        else if (sensor && (n != 5 || !csvToInt(fields[4], row.threshold) || row.threshold < INT16_MIN ||
+                            row.threshold > INT16_MAX))
+            msg = "below and above need a threshold in int16";
+        else if (valve && n == 5 && !fields[4].empty())
+            msg = "open and closed take no threshold";
+        if (msg)
+        {
+            csvReport(path, row.line, errOpenActivationFile, msg);
+            if (res == noError)
+                res = errOpenActivationFile;
+            row.condition = std::string_view();
+        }
+    }
+
+    std::string_view boardName(board.name);
+    for (int r = 0; r < nbRows; r++)
+    {
+        const LigneActivation &row = rows[r];
+        if (row.board != boardName)
+            continue;
+        nbRules++;
+
+        int slot = -1;
+        for (int v = 0; v < board.nbValves && slot < 0; v++)
+            if (row.valve == board.valves[v].name)
+                slot = v;
+        if (slot < 0)
+        {
+            csvReport(path, row.line, errDependOutsideOfRange, "valve not on the board");
+            if (res == noError)
+                res = errDependOutsideOfRange;
+            continue;
+        }
+
+        statusErrDef err = row.condition.empty() ? errOpenActivationFile : noError;
+        const char *msg = nullptr;
+        if (row.condition == "open" || row.condition == "closed")
+        {
+            int target = -1;
+            for (int v = 0; v < board.nbValves && target < 0; v++)
+                if (row.target == board.valves[v].name)
+                    target = v;
+            if (target < 0 || target == slot)
+            {
+                err = errDependOutsideOfRange;
+                msg = target < 0 ? "dependency not among the valves of the board" : "valve depends on itself";
+            }
+            else
+            {
+                (row.condition == "open" ? needOpen : needClosed)[slot] |= 1u << target;
+                if (needOpen[slot] & needClosed[slot])
+                {
+                    err = errOpenActivationFile;
+                    msg = "valve required both open and closed";
+                }
+            }
+        }
+        else if (!row.condition.empty())
+        {
+            int target = -1;
+            for (int s = 0; s < board.nbSensors && target < 0; s++)
+                if (row.target == board.sensors[s].name)
+                    target = s;
+            int k = target < 0 ? -1 : condition((uint8_t)target, (int16_t)row.threshold, row.condition == "above");
+            if (target < 0)
+            {
+                err = errDependOutsideOfRange;
+                msg = "sensor not on the board";
+            }
+            else if (k < 0)
+            {
+                err = errAllocDataActivation;
+                msg = "more than MAX_INTERLOCK_CONDS sensor conditions";
+            }
+            else
+                needConds[slot] |= 1u << k;
+        }
+        if (err != noError)
+        {
+            // a valve whose rules are incomplete is never opened
+            locked |= 1u << slot;
+            if (msg)
+                csvReport(path, row.line, err, msg);
+            if (res == noError)
+                res = err;
+        }
+    }
+
+    logEvent(logValve, res != noError ? res : nbRules ? infoVerifDependSucess : infoNoDepend,
+             "interlock rules loaded (rules, conditions, locked)", nbRules, nbConds, (int32_t)locked);
+    return res;
+}
+
+/**
+ * \brief function to remove from the commanded mask the valves whose
+ * dependencies are not met. Called by the control loop before the bulk
+ * GPIO write, without allocation or file access.
+ *
+ * Each pass evaluates every valve with three mask comparisons. Removing a
+ * valve can break the dependencies of another one, the passes stop when
+ * the mask is stable, once in the usual case.
+ *
+ * \param commanded bit i set when valve i is commanded open
+ * \param applied bit i set when valve i is open on its GPIO line
+ * \param sensors the last acquisition, a sensor in error fails its conditions
+ * \param allowed receives the valves that may be open
+ * \return statusErrDef, see the results at the top of the file.
+ */
+statusErrDef Interlock::filter(uint32_t commanded, uint32_t applied, const SensorFrame &sensors, uint32_t &allowed)
+{
+    return check(commanded, applied, sensors, allowed, refused);
+}
+
+/**
+ * \brief function to filter a commanded mask like filter(), without
+ * keeping the refused valves, so other threads than the control loop can
+ * check their writes, e.g. the valve sequences.
+ *
+ * \param held receives the valves commanded open and not allowed
+ * \return statusErrDef, see the results at the top of the file.
+ */
+statusErrDef Interlock::check(uint32_t commanded, uint32_t applied, const SensorFrame &sensors, uint32_t &allowed,
+                              uint32_t &held) const
+{
+    allowed = commanded;
+    if (!nbRules)
+    {
+        held = 0;
+        return infoNoDepend;
+    }
+
+    uint32_t conds = 0;
+    uint32_t unread = 0;
+    for (int k = 0; k < nbConds; k++)
+    {
+        const SensorSample &s = sensors.sensors[condSlot[k]];
+        uint32_t valid = s.status == noError;
+        uint32_t above = s.value > condThreshold[k];
+        uint32_t below = s.value < condThreshold[k];
+        uint32_t holds = (above & condAbove[k]) | (below & (condAbove[k] ^ 1u));
+        conds |= (holds & valid) << k;
+        unread |= (valid ^ 1u) << k;
+    }
+
+    allowed &= ~locked;
+    for (int pass = 0; pass <= nbValves; pass++)
+    {
+        uint32_t openNow = applied & allowed;
+        uint32_t anyOpen = applied | allowed;
+        uint32_t ok = 0;
+        // over MAX_VALVES so the loop unrolls, the slots past nbValves have no rule
+        for (int i = 0; i < MAX_VALVES; i++)
+            ok |= (uint32_t)(((openNow & needOpen[i]) == needOpen[i]) & ((anyOpen & needClosed[i]) == 0) &
+                             ((conds & needConds[i]) == needConds[i])) << i;
+        uint32_t next = allowed & ok;
+        if (next == allowed)
+            break;
+        allowed = next;
+    }
+
+    held = commanded & ~allowed;
+    if (!held)
+        return infoVerifDependSucess;
+    for (int i = 0; i < nbValves; i++)
+        if ((held >> i) & 1 && (needConds[i] & unread))
+            return errGPIODependValue;
+    return infoAllDependNotActivated;
+}
+
+/**
+ * \brief function to get the valves held closed by the last filter().
+ */
+uint32_t Interlock::getRefusedMask() const
+{
+    return refused;
+}
+
+int Interlock::getNbRules() const
+{
+    return nbRules;
+}
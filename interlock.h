@@ -0,0 +1,81 @@
+/**
+ * \file interlock.h
+ * \brief header file of the valve interlock module
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * Contains the dependency rules of the valves of a board. activation.csv
+ * is read once at initialisation and compiled into bitmasks : for each
+ * valve the valves that must be open, the valves that must be closed and
+ * the sensor conditions that must hold. A sensor condition is a slot,
+ * a threshold and a direction, shared by every valve using it.
+ *
+ * activation.csv : board;valve;condition;target;threshold
+ * - open / closed : the valve target must be open / closed, no threshold
+ * - below / above : the sensor target must read below / above threshold
+ * The lines of a valve are all required. A valve without line has no rule.
+ *
+ * The rules hold continuously : every cycle the commanded mask is
+ * filtered before the bulk GPIO write. An opening is refused while a
+ * dependency is not met, an open valve is closed when one is lost.
+ * A valve dependency counts as open only when it is open and stays open,
+ * so a valve and its dependency commanded together open one cycle apart.
+ * Closing a valve is never refused. A valve with an invalid line is
+ * kept closed.
+ */
+
+#ifndef INTERLOCK_H
+#define INTERLOCK_H
+
+#include "configDefine.h"
+#include "statusErrorDefine.h"
+#include "physicalConfig.h"
+#include "shmLayout.h"
+#include <cstdint>
+#include <string_view>
+
+/**
+ * \brief one line of activation.csv, the names point into the mapped file
+ */
+struct LigneActivation
+{
+    std::string_view board;
+    std::string_view valve;
+    std::string_view condition;
+    std::string_view target;
+    int threshold;
+    int line;
+};
+
+/**
+ * \brief compiled interlock rules of one board.
+ */
+class Interlock
+{
+private:
+    uint32_t needOpen[MAX_VALVES];   /**< valves that must be open for valve i to be open */
+    uint32_t needClosed[MAX_VALVES]; /**< valves that must be closed for valve i to be open */
+    uint32_t needConds[MAX_VALVES];  /**< sensor conditions that must hold for valve i to be open */
+    uint8_t condSlot[MAX_INTERLOCK_CONDS];       /**< sensor slot of condition k */
+    int16_t condThreshold[MAX_INTERLOCK_CONDS];  /**< threshold of condition k, raw ADC counts */
+    uint8_t condAbove[MAX_INTERLOCK_CONDS];      /**< 1 when condition k is value > threshold, 0 for value < threshold */
+    int nbConds;
+    int nbValves;
+    int nbRules;      /**< lines of the board in activation.csv */
+    uint32_t locked;  /**< valves with an invalid rule, never opened */
+    uint32_t refused; /**< valves held closed by the last filter() */
+
+    int condition(uint8_t slot, int16_t threshold, uint8_t above);
+
+public:
+    Interlock();
+    statusErrDef load(const BoardConfig &board, const char *path = ACTIVATION_FILE);
+    statusErrDef filter(uint32_t commanded, uint32_t applied, const SensorFrame &sensors, uint32_t &allowed);
+    statusErrDef check(uint32_t commanded, uint32_t applied, const SensorFrame &sensors, uint32_t &allowed,
+                       uint32_t &held) const;
+    uint32_t getRefusedMask() const;
+    int getNbRules() const;
+};
+
+#endif // INTERLOCK_H
@@ -0,0 +1,308 @@
+/**
+ * \file logger.cpp
+ * \brief Module of asynchronous logging for the control threads
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * Each producer thread owns a single-producer single-consumer ring.
+ * Pushing a record is a clock read, a few stores and one release store,
+ * without lock, allocation or syscall once the thread is registered.
+ */
+
+#include "logger.h"
+#include "monotonicClock.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <time.h>
+
+/**
+ * \brief single-producer single-consumer ring of log records
+ */
+struct LogRing
+{
+    alignas(64) uint32_t head;    /**< next record to write, producer only */
+    alignas(64) uint32_t tail;    /**< next record to format, writer thread only */
+    alignas(64) uint64_t dropped; /**< records lost because the ring was full */
+    uint64_t reported;            /**< dropped records already reported */
+    bool closed;                  /**< the thread has exited, set under drainMutex */
+    LogRecord records[LOG_RING_SIZE];
+};
+
+/**
+ * \brief rings of the registered threads, a null slot is free. The ring
+ * of an exited thread is freed by the drain that writes its last records.
+ */
+static std::atomic<LogRing *> rings[LOG_MAX_THREADS];
+/**
+ * \brief increased by logStop() when it frees the rings, a thread holding
+ * an older ring registers again
+ */
+static std::atomic<uint32_t> generation(0);
+static thread_local LogRing *ring = nullptr;
+static thread_local uint32_t ringGeneration = 0; /**< generation of ring, or of the refusal */
+static thread_local bool refused = false;        /**< no ring : all slots taken or thread exiting, push() drops */
+/**
+ * \brief records lost because LOG_MAX_THREADS threads are already registered
+ */
+static std::atomic<uint64_t> droppedNoRing(0);
+/**
+ * \brief records dropped by the rings already freed
+ */
+static std::atomic<uint64_t> droppedFreed(0);
+
+static std::thread writer;
+static std::atomic<bool> writerRunning(false);
+static std::mutex drainMutex;
+static FILE *output = stderr;
+
+static void drain();
+
+/**
+ * \brief owner of the ring of a thread : its destructor, run when the
+ * thread exits, hands the ring over to the writer to be freed.
+ */
+struct LogRingOwner
+{
+    LogRing *ring = nullptr;
+    uint32_t generation = 0;
+
+    ~LogRingOwner()
+    {
+        std::lock_guard<std::mutex> lock(drainMutex);
+        // a ring of an older generation was already freed by logStop()
+        if (ring && generation == ::generation.load(std::memory_order_relaxed))
+            ring->closed = true;
+        // the thread_local objects destroyed after this one drop their records
+        ::ring = nullptr;
+        refused = true;
+        ringGeneration = ::generation.load(std::memory_order_relaxed);
+    }
+};
+static thread_local LogRingOwner owner;
+
+static const char *componentNames[logNbComponents] = {"main", "sensor", "valve", "cac", "cycle", "iio", "telem", "csv", "opl"};
+
+/**
+ * \brief function to put a ring in the first free slot.
+ *
+ * \return false when every slot is taken.
+ */
+static bool claimSlot(LogRing *r)
+{
+    for (int i = 0; i < LOG_MAX_THREADS; i++)
+    {
+        LogRing *expected = nullptr;
+        if (rings[i].compare_exchange_strong(expected, r, std::memory_order_acq_rel))
+            return true;
+    }
+    return false;
+}
+
+/**
+ * \brief function to give the calling thread its log ring.
+ * Called by the first logEvent() of a thread, real-time threads
+ * should call it before their loop to keep the allocation out of it.
+ *
+ * \return false when LOG_MAX_THREADS threads are already registered.
+ */
+bool logRegisterThread()
+{
+    uint32_t gen = generation.load(std::memory_order_acquire);
+    if (ringGeneration == gen && (ring || refused))
+        return ring != nullptr;
+    ring = nullptr;
+    refused = false;
+    ringGeneration = gen;
+
+    LogRing *r = new LogRing();
+    // the slots of the exited threads are freed by the next drain
+    if (!claimSlot(r))
+    {
+        drain();
+        if (!claimSlot(r))
+        {
+            delete r;
+            refused = true;
+            return false;
+        }
+    }
+    ring = r;
+    owner.ring = r;
+    owner.generation = gen;
+    return true;
+}
+
+static inline void push(logComponent component, statusErrDef code, const char *msg,
+                        uint8_t nbArgs, int32_t arg0, int32_t arg1, int32_t arg2)
+{
+    // a refused thread drops without trying again until logStop()
+    if ((!ring || ringGeneration != generation.load(std::memory_order_relaxed)) && !logRegisterThread())
+    {
+        droppedNoRing.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    uint32_t head = ring->head;
+    if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= LOG_RING_SIZE)
+    {
+        __atomic_store_n(&ring->dropped, ring->dropped + 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    LogRecord &rec = ring->records[head & (LOG_RING_SIZE - 1)];
+    rec.timestamp = monotonicNs();
+    rec.msg = msg;
+    rec.code = (uint16_t)code;
+    rec.component = (uint8_t)component;
+    rec.nbArgs = nbArgs;
+    rec.args[0] = arg0;
+    rec.args[1] = arg1;
+    rec.args[2] = arg2;
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * \brief function to log an event from any thread, never blocks.
+ *
+ * \param component the module emitting the event
+ * \param code the statusErrDef of the event
+ * \param msg a static text
+ */
+void logEvent(logComponent component, statusErrDef code, const char *msg)
+{
+    push(component, code, msg, 0, 0, 0, 0);
+}
+
+void logEvent(logComponent component, statusErrDef code, const char *msg, int32_t arg0)
+{
+    push(component, code, msg, 1, arg0, 0, 0);
+}
+
+void logEvent(logComponent component, statusErrDef code, const char *msg, int32_t arg0, int32_t arg1)
+{
+    push(component, code, msg, 2, arg0, arg1, 0);
+}
+
+void logEvent(logComponent component, statusErrDef code, const char *msg, int32_t arg0, int32_t arg1, int32_t arg2)
+{
+    push(component, code, msg, 3, arg0, arg1, arg2);
+}
+
+/**
+ * \brief function to format and write every pending record, then to
+ * free the rings of the exited threads.
+ */
+static void drain()
+{
+    std::lock_guard<std::mutex> lock(drainMutex);
+    for (int i = 0; i < LOG_MAX_THREADS; i++)
+    {
+        LogRing *r = rings[i].load(std::memory_order_acquire);
+        if (!r)
+            continue;
+
+        uint32_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+        for (uint32_t tail = r->tail; tail != head; tail++)
+        {
+            const LogRecord &rec = r->records[tail & (LOG_RING_SIZE - 1)];
+            const char *comp = rec.component < logNbComponents ? componentNames[rec.component] : "?";
+            fprintf(output, "[%12.6f] %-6s 0x%04X %s", rec.timestamp / 1e9, comp, rec.code, rec.msg ? rec.msg : "");
+            for (int a = 0; a < rec.nbArgs && a < 3; a++)
+                fprintf(output, " %d", rec.args[a]);
+            fputc('\n', output);
+        }
+        __atomic_store_n(&r->tail, head, __ATOMIC_RELEASE);
+
+        uint64_t dropped = __atomic_load_n(&r->dropped, __ATOMIC_RELAXED);
+        if (dropped != r->reported)
+        {
+            fprintf(output, "[log] 0x%04X %llu records dropped by thread %d\n", infoLogDropped,
+                    (unsigned long long)(dropped - r->reported), i);
+            r->reported = dropped;
+        }
+
+        // the thread is gone, its last records are written : the slot is free
+        if (r->closed)
+        {
+            droppedFreed.fetch_add(dropped, std::memory_order_relaxed);
+            rings[i].store(nullptr, std::memory_order_release);
+            delete r;
+        }
+    }
+    fflush(output);
+}
+
+/**
+ * \brief function to start the thread that writes the records.
+ *
+ * \param out the stream receiving the formatted records
+ * \return noError.
+ */
+statusErrDef logStart(FILE *out)
+{
+    if (writerRunning.exchange(true))
+        return noError;
+
+    output = out;
+    writer = std::thread([]()
+                         {
+        while (writerRunning.load(std::memory_order_relaxed))
+        {
+            drain();
+            std::this_thread::sleep_for(std::chrono::milliseconds(LOG_FLUSH_MS));
+        }
+        drain(); });
+    return noError;
+}
+
+/**
+ * \brief function to stop the writer thread after a last drain, then to
+ * free the rings. No other thread may log meanwhile : the control
+ * threads are stopped first. A thread logging afterwards registers again.
+ */
+void logStop()
+{
+    if (writerRunning.exchange(false))
+        writer.join();
+    // the records pushed since the last drain are written before their ring is freed
+    drain();
+
+    std::lock_guard<std::mutex> lock(drainMutex);
+    for (int i = 0; i < LOG_MAX_THREADS; i++)
+    {
+        LogRing *r = rings[i].exchange(nullptr, std::memory_order_acq_rel);
+        if (!r)
+            continue;
+        droppedFreed.fetch_add(__atomic_load_n(&r->dropped, __ATOMIC_RELAXED), std::memory_order_relaxed);
+        delete r;
+    }
+    generation.fetch_add(1, std::memory_order_release);
+}
+
+/**
+ * \brief function to write the pending records from the calling thread.
+ */
+void logFlush()
+{
+    drain();
+}
+
+/**
+ * \brief function to get the number of records dropped since the start.
+ */
+uint64_t logDropped()
+{
+    // under the lock so a ring isn't freed meanwhile, its drops counted twice or missed
+    std::lock_guard<std::mutex> lock(drainMutex);
+    uint64_t total = droppedNoRing.load(std::memory_order_relaxed) + droppedFreed.load(std::memory_order_relaxed);
+    for (int i = 0; i < LOG_MAX_THREADS; i++)
+    {
+        LogRing *r = rings[i].load(std::memory_order_acquire);
+        if (r)
+            total += __atomic_load_n(&r->dropped, __ATOMIC_RELAXED);
+    }
+    return total;
+}
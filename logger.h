@@ -0,0 +1,66 @@
+/**
+ * \file logger.h
+ * \brief header file of the asynchronous log module
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * The control threads never write to stdout or stderr themselves : they
+ * push fixed-size binary records in a ring of their own, and a background
+ * thread formats and writes them. When a ring is full the record is
+ * dropped and counted, the producer never waits.
+ */
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include "configDefine.h"
+#include "statusErrorDefine.h"
+#include <cstdint>
+#include <cstdio>
+
+/**
+ * \enum logComponent
+ * \brief the module that emitted a record
+ */
+typedef enum
+{
+    logMain,   /**< main program and console */
+    logSensor, /**< sensor module */
+    logValve,  /**< valve module and valve bank */
+    logCAC,    /**< CAC board */
+    logCycle,  /**< cycle executive */
+    logIio,    /**< IIO buffered capture */
+    logTelem,  /**< telemetry recorder */
+    logCSV,    /**< general state tables */
+    logOpl,    /**< POWERLINK process image */
+    logNbComponents,
+} logComponent;
+
+/**
+ * \brief one log record, 32 bytes
+ */
+struct LogRecord
+{
+    uint64_t timestamp; /**< CLOCK_MONOTONIC time in ns */
+    const char *msg;    /**< static text, never a temporary buffer */
+    uint16_t code;      /**< statusErrDef */
+    uint8_t component;  /**< logComponent */
+    uint8_t nbArgs;     /**< number of valid args */
+    int32_t args[3];
+};
+
+static_assert(sizeof(LogRecord) == 32);
+static_assert((LOG_RING_SIZE & (LOG_RING_SIZE - 1)) == 0, "LOG_RING_SIZE must be a power of 2");
+
+void logEvent(logComponent component, statusErrDef code, const char *msg);
+void logEvent(logComponent component, statusErrDef code, const char *msg, int32_t arg0);
+void logEvent(logComponent component, statusErrDef code, const char *msg, int32_t arg0, int32_t arg1);
+void logEvent(logComponent component, statusErrDef code, const char *msg, int32_t arg0, int32_t arg1, int32_t arg2);
+bool logRegisterThread();
+statusErrDef logStart(FILE *out = stderr);
+void logStop();
+void logFlush();
+uint64_t logDropped();
+
+#endif // LOGGER_H
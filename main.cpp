@@ -1,115 +1,285 @@
-/* compilation :
-g++ -std=c++20 main.cpp valve.cpp sensor.cpp cac.cpp -o main_exe $(pkg-config --cflags --libs libgpiod)
+/* usage : [CAC_HAL=adc=sim,gpio=sim,...] [CAC_STREAM_UDP=port] main_exe [board[:cpu][,board[:cpu]...] | all] [MN address]
+compilation :
+g++ -std=c++20 main.cpp valve.cpp valveBank.cpp sensor.cpp iioBuffer.cpp modbusBus.cpp physicalConfig.cpp csvReader.cpp hal.cpp sequencer.cpp interlock.cpp conditioning.cpp sensorHealth.cpp alarm.cpp processImage.cpp cac.cpp cycle.cpp orchestrator.cpp logger.cpp telemetry.cpp telemServer.cpp commandQueue.cpp valveScheduler.cpp -o main_exe $(pkg-config --cflags --libs libgpiod)
 */
 #include <iostream>
 #include <thread>
-#include <semaphore>
+#include <atomic>
 #include <chrono>
+#include <algorithm>
+#include <vector>
 #include <gpiod.h>
 #include "sensor.h"
 #include "valve.h"
 #include "cac.h"
+#include "logger.h"
+#include "physicalConfig.h"
+#include "orchestrator.h"
+#include "hal.h"
 #include "configCAC.h"
+#include "monotonicClock.h"
 #include <fcntl.h>    // For O_* constants
 #include <sys/mman.h> // For shared memory
 #include <sys/stat.h> // For mode constants
 
-// Semaphore initialization: max value = 0 (thread2 is blocked initially)
-std::counting_semaphore<1> sem_sensor(0); // A semaphore with initial count of 0
-std::counting_semaphore<1> sem_sensor_ready(0);
-std::counting_semaphore<1> sem_vanne(0); // A semaphore with initial count of 0
+/**
+ * \brief mode of a board driven without BoardWorker, each worker has its own
+ */
+Mode mode = manual;
 
-void process_sensor()
+/**
+ * \brief function to add the boards of the command line to the rig.
+ *
+ * \param list board names separated by ',', each one optionally followed by
+ * ':' and the CPU of its cycle thread, or "all" for every board of the physical CSV files
+ */
+static void addBoards(Orchestrator &rig, const char *list, const PhysicalConfig &config, bool configOk,
+                      const char *mnAddress, TelemetryServer *stream)
 {
-    // Ouvrir SHM Sensor
-    int shm_fd_sensor = shm_open(SHM_Sensor, O_CREAT | O_RDWR, 0666);
-    if (shm_fd_sensor == -1)
+    WorkerConfig worker;
+    worker.mnAddress = mnAddress;
+    worker.stream = stream;
+    if (strcmp(list, "all") == 0)
     {
-        std::cerr << "Failed to open shared memory!" << std::endl;
-        exit(EXIT_FAILURE);
+        for (int i = 0; configOk && i < config.getNbBoards(); i++)
+        {
+            const BoardConfig *board = config.getBoard(i);
+            rig.add(board->name, board->id, board, worker);
+        }
+        return;
     }
-    SensorData *espace_sensors = (SensorData *)mmap(0, sizeof(SensorData), PROT_WRITE | PROT_READ, MAP_SHARED, shm_fd_sensor, 0);
 
-    while (true)
+    std::string names(list);
+    size_t pos = 0;
+    while (pos <= names.size())
     {
-        sem_sensor.acquire(); // Wait for the semaphore signal
+        size_t comma = names.find(',', pos);
+        std::string item = names.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+        pos = comma == std::string::npos ? names.size() + 1 : comma + 1;
+        size_t colon = item.find(':');
+        worker.cpu = colon == std::string::npos ? RT_CPU : atoi(item.c_str() + colon + 1);
+        std::string name = item.substr(0, colon);
+        if (name.empty())
+            continue;
 
-        for (int i = 0; i < NCapteur; i++)
+        // the board comes from the physical CSV files, CACMO can fall back on its compiled-in table
+        const BoardConfig *board = configOk ? config.getBoard(name.c_str()) : nullptr;
+        if (board)
+            rig.add(board->name, board->id, board, worker);
+        else if (name == CAC_name)
         {
-            if (espace_sensors->sensors[i].readChannel() != noError)
-            {
-                std::cerr << "Erreur lors de la lecture du canal." << std::endl;
-            }
+            std::cerr << "Physical configuration of " << name << " not usable, using the compiled-in table"
+                      << std::endl;
+            rig.add(CAC_name, 1, nullptr, worker);
         }
-
-        sem_sensor_ready.release();
+        else
+            std::cerr << "Board " << name << " not in the physical configuration" << std::endl;
     }
 }
 
-void process_vanne()
+/**
+ * \brief function to print the time errors of the last run of a valve sequence.
+ */
+static void printSequence(const std::string &name, const ValveScheduler &scheduler)
 {
-    // Ouvrir SHM Vanne
-    int shm_fd_vanne = shm_open(SHM_Vanne, O_CREAT | O_RDWR, 0666);
-    if (shm_fd_vanne == -1)
+    const SchedulerStats &s = scheduler.getStats();
+    std::vector<int64_t> errors;
+    for (int i = 0; i < scheduler.getNbActions(); i++)
     {
-        std::cerr << "Failed to open shared memory!" << std::endl;
-        exit(EXIT_FAILURE);
+        statusErrDef status = scheduler.getReport(i).status;
+        if (status != infoSequenceAborted && status != infoActionPending)
+            errors.push_back(scheduler.getReport(i).errorNs);
     }
-    VanneData *espace_vannes = (VanneData *)mmap(0, sizeof(VanneData), PROT_READ, MAP_SHARED, shm_fd_vanne, 0);
-
-    while (true)
-    {
-        sem_vanne.acquire(); // Wait for the semaphore signal
+    std::sort(errors.begin(), errors.end());
+    std::cout << name << " : " << s.nbWritten << "/" << s.nbActions << " actions in " << s.nbBatches
+              << " bulk writes, " << s.nbLate << " late, " << s.nbInterlocked << " held by the interlock";
+    if (!errors.empty())
+        std::cout << ", time error p50 " << errors[errors.size() / 2] / 1000.0 << " us, p99 "
+                  << errors[errors.size() * 99 / 100] / 1000.0 << " us, max " << errors.back() / 1000.0 << " us";
+    std::cout << std::endl;
+}
 
-        for (int i = 0; i < NVanne; ++i)
-        {
-            espace_vannes->vannes[i].apply_change();
-        }
-    }
+/**
+ * \brief function to print the figures of the telemetry server.
+ */
+static void printStream(const TelemetryServer &stream)
+{
+    StreamStats s;
+    stream.getStats(s);
+    std::cout << "telemetry : " << s.subscribers << " subscribers, " << s.frames << " frames, " << s.records
+              << " records sent, " << s.missed << " frames missed, " << s.clientsDropped << " subscribers dropped, "
+              << s.ringDropped << " records dropped" << std::endl;
 }
 
-int main()
+int main(int argc, char *argv[])
 {
-    CAC cac = CAC("CACMO", 1);
-    cac.init(dict_CACMO);
+    logStart();
+
+    // the boards are chosen at startup, their components come from the physical CSV files,
+    // the MN address is optional, the boards run from the console without it
+    const char *boards = (argc > 1) ? argv[1] : CAC_name;
+    const char *mnAddress = (argc > 2) ? argv[2] : nullptr;
+    // the hardware or its simulation, before any driver is opened
+    statusErrDef halRes = halSelectFromEnv();
+    if (halRes != noError)
+        std::cerr << HAL_ENV << " not usable (0x" << std::hex << halRes << std::dec << "), using the hardware"
+                  << std::endl;
+
+    PhysicalConfig config;
+    statusErrDef configRes = config.load();
+    if (configRes != noError)
+        std::cerr << "Physical configuration not usable (0x" << std::hex << configRes << std::dec << ")" << std::endl;
+
+    // every cycle is published on STREAM_SOCKET_PATH, and on a localhost UDP port when one is given
+    const char *udp = getenv(STREAM_UDP_ENV);
+    TelemetryServer stream(STREAM_SOCKET_PATH, udp ? (uint16_t)atoi(udp) : 0);
 
-    // Create threads
-    std::thread t1(process_sensor);
-    std::thread t2(process_vanne);
+    // each board has its segments, its rules and its cycle thread, on the common cycle clock
+    Orchestrator rig;
+    addBoards(rig, boards, config, configRes == noError, mnAddress, &stream);
+    if (rig.getNbBoards() == 0)
+    {
+        std::cerr << "No board to run" << std::endl;
+        logStop();
+        return EXIT_FAILURE;
+    }
+    statusErrDef streamRes = stream.start();
+    if (streamRes != noError)
+        std::cerr << "Telemetry not published (0x" << std::hex << streamRes << std::dec << ")" << std::endl;
+    rig.start();
 
+    // the console is a non real-time side channel, it acts on every board
     char userInput;
-    while (true)
+    uint32_t consoleCommand = 0;
+    while (std::cin)
     {
-        std::cout << "Enter 'S' to trigger Process sensor, 'L' to trigger Process led : ";
+        std::cout << "Enter 'S' to show sensors, 'L' to toggle valves, 'E' to select a general state, 'T' for cycle timings, 'H' for sensor health, 'A' for alarms, 'P' to run the valve sequence, 'Q' to quit : ";
         std::cin >> userInput;
 
         if (userInput == 'S')
         {
-            sem_sensor.release(); // Release the semaphore to allow process 2 to run
-
-            sem_sensor_ready.acquire();
-            std::cout << "Data of sensor receive : ";
-            // Affichage de la valeur lue
-            for (int i = 0; i < NCapteur; ++i)
+            for (int b = 0; b < rig.getNbBoards(); b++)
             {
-                cac.tab_sensors->sensors[i].print_value();
+                CAC &cac = rig.getBoard(b).getCac();
+                SensorFrame frame;
+                if (!cac.tab_sensors || !seqlockRead(&cac.tab_sensors->seq, &cac.tab_sensors->frame, frame))
+                    continue;
+
+                std::cout << "Data of sensor receive from " << cac.getName() << " (cycle " << frame.cycle << ", faulty 0x"
+                          << std::hex << frame.faulty << std::dec << ") : " << std::endl;
+                // Affichage de la valeur lue
+                for (size_t i = 0; i < cac.sensors.size(); ++i)
+                {
+                    std::cout << "La valeur du " << cac.sensors[i].getName() << " est : " << frame.sensors[i].value
+                              << " (" << frame.values[i] << " " << cac.tab_sensors->units[i] << ")" << std::endl;
+                }
             }
         }
         else if (userInput == 'L')
         {
-            for (int i = 0; i < NVanne; ++i)
+            // every valve is toggled through the command queue of its board,
+            // which leaves the automatic mode ; the console is its client 0
+            for (int b = 0; b < rig.getNbBoards(); b++)
             {
-                int etat = cac.tab_vannes->vannes[i].state;
-                cac.tab_vannes->vannes[i].state = 1 - etat;
+                CAC &cac = rig.getBoard(b).getCac();
+                CommandQueue &queue = rig.getBoard(b).getCommands();
+                ValveFrame frame;
+                if (cac.vannes.empty() || !seqlockRead(&cac.tab_vannes->seq, &cac.tab_vannes->frame, frame))
+                    continue;
+                uint32_t all = (uint32_t)((1ull << cac.vannes.size()) - 1);
+                uint32_t applied = 0;
+                for (size_t i = 0; i < cac.vannes.size(); ++i)
+                    applied |= (uint32_t)frame.vannes[i].state << i;
+                uint32_t position = queue.getAckHead();
+                if (!queue.submit(0, ++consoleCommand, CMD_VALVES, all, ~applied & all))
+                {
+                    std::cout << cac.getName() << " : command queue full" << std::endl;
+                    continue;
+                }
+                CommandAck ack = {};
+                bool acked = false;
+                for (int t = 0; t < 100 && !acked; t++)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    while (!acked && queue.readAck(position, ack))
+                        acked = ack.client == 0 && ack.id == consoleCommand;
+                }
+                if (acked)
+                    std::cout << cac.getName() << " : valves 0x" << std::hex << ack.applied << " (status 0x"
+                              << ack.status << std::dec << ") on cycle " << ack.cycle << ", "
+                              << (ack.appliedNs - ack.submitNs) / 1000 << " us after the command" << std::endl;
+                else
+                    std::cout << cac.getName() << " : command not acknowledged" << std::endl;
             }
-
-            sem_vanne.release(); // Release the semaphore to allow process 2 to run
+        }
+        else if (userInput == 'E')
+        {
+            std::cout << "General state (hexadecimal, 7777 for manual mode) : ";
+            unsigned int eg;
+            if (std::cin >> std::hex >> eg >> std::dec)
+                for (int b = 0; b < rig.getNbBoards(); b++)
+                    if (rig.getBoard(b).getCac().tab_vannes)
+                        __atomic_store_n(&rig.getBoard(b).getCac().tab_vannes->generalState, (uint16_t)eg,
+                                         __ATOMIC_RELEASE);
+        }
+        else if (userInput == 'T')
+        {
+            rig.printStats();
+            printStream(stream);
+        }
+        else if (userInput == 'H')
+        {
+            for (int b = 0; b < rig.getNbBoards(); b++)
+            {
+                CAC &cac = rig.getBoard(b).getCac();
+                std::cout << "-- " << cac.getName() << std::endl;
+                cac.getHealth().printStats(cac.getConfig());
+            }
+        }
+        else if (userInput == 'A')
+        {
+            for (int b = 0; b < rig.getNbBoards(); b++)
+            {
+                std::cout << "-- " << rig.getBoard(b).getName() << std::endl;
+                rig.getBoard(b).getAlarms().printStatus();
+            }
+        }
+        else if (userInput == 'P')
+        {
+            // every board runs its sequence from the same T0, far enough for
+            // the threads to be ready ; the cycle threads take the valves
+            // back once their sequence is done
+            uint64_t t0 = monotonicNs() + 100000000ull;
+            for (int b = 0; b < rig.getNbBoards(); b++)
+            {
+                ValveScheduler &scheduler = rig.getBoard(b).getScheduler();
+                statusErrDef res = scheduler.getNbActions() ? scheduler.start(t0) : errOpenSequenceFile;
+                if (res != noError)
+                    std::cout << rig.getBoard(b).getName() << " : no valve sequence started (0x" << std::hex << res
+                              << std::dec << ")" << std::endl;
+            }
+            for (int b = 0; b < rig.getNbBoards(); b++)
+            {
+                ValveScheduler &scheduler = rig.getBoard(b).getScheduler();
+                if (!scheduler.getNbActions())
+                    continue;
+                while (!scheduler.isDone())
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                scheduler.wait();
+                printSequence(rig.getBoard(b).getName(), scheduler);
+            }
+        }
+        else if (userInput == 'Q')
+        {
+            break;
         }
     }
 
     // Wait for threads to finish
-    t1.join();
-    t2.join();
-    cac.~CAC();
+    rig.stop();
+    stream.stop();
+    rig.printStats();
+    printStream(stream);
+    logStop();
     return 0;
 }
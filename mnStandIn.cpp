@@ -0,0 +1,133 @@
+/* compilation :
+g++ -std=c++20 mnStandIn.cpp -o mnStandIn
+*/
+/**
+ * \file mnStandIn.cpp
+ * \brief stand-in POWERLINK MN exchanging the process images over UDP
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * usage : mnStandIn node [EG] [valve mask] [port]
+ *
+ * Sends the RPDO of the node every CYCLE_LEN with the general state and
+ * the valve command bits (hexadecimal), to the address its TPDO come
+ * from, and prints the TPDO once a second. Lets the board exchange its
+ * process image without the POWERLINK network.
+ */
+
+#include "processImage.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+static volatile sig_atomic_t running = 1;
+
+static void stop(int)
+{
+    running = 0;
+}
+
+static uint64_t nowUs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage : %s node [EG] [valve mask] [port]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    uint8_t node = (uint8_t)atoi(argv[1]);
+    PiOut image = {};
+    image.generalState = argc > 2 ? (uint16_t)strtol(argv[2], nullptr, 16) : 0;
+    image.valveCommands = argc > 3 ? (uint16_t)strtol(argv[3], nullptr, 16) : 0;
+    uint16_t port = argc > 4 ? (uint16_t)atoi(argv[4]) : OPL_UDP_PORT;
+
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    sockaddr_in local = {};
+    local.sin_family = AF_INET;
+    local.sin_port = htons(port);
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (fd < 0 || bind(fd, (const sockaddr *)&local, sizeof(local)) < 0)
+    {
+        perror("MN socket");
+        return EXIT_FAILURE;
+    }
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+
+    sockaddr_in cn = {};
+    bool cnKnown = false;
+    uint32_t seq = 0;
+    uint64_t nbIn = 0;
+    PiIn last = {};
+    uint64_t next = nowUs();
+    uint64_t nextPrint = next + 1000000;
+    while (running)
+    {
+        // TPDO until the next cycle
+        pollfd p = {fd, POLLIN, 0};
+        uint64_t now = nowUs();
+        int timeout = next > now ? (int)((next - now) / 1000) : 0;
+        if (poll(&p, 1, timeout) > 0)
+        {
+            OplFrameHeader header;
+            PiIn in;
+            iovec rx[2] = {{&header, sizeof(header)}, {&in, sizeof(in)}};
+            msghdr msg = {};
+            sockaddr_in from = {};
+            msg.msg_name = &from;
+            msg.msg_namelen = sizeof(from);
+            msg.msg_iov = rx;
+            msg.msg_iovlen = 2;
+            ssize_t n = recvmsg(fd, &msg, 0);
+            if (n == (ssize_t)(sizeof(header) + sizeof(in)) && header.magic == OPL_FRAME_MAGIC &&
+                header.kind == OPL_FRAME_IN && header.node == node)
+            {
+                last = in;
+                cn = from;
+                cnKnown = true;
+                nbIn++;
+            }
+            continue;
+        }
+
+        // RPDO every cycle once the CN is known
+        next += CYCLE_LEN;
+        if (cnKnown)
+        {
+            OplFrameHeader header = {OPL_FRAME_MAGIC, node, OPL_FRAME_OUT, OPL_PI_OUT_WORDS, ++seq};
+            iovec tx[2] = {{&header, sizeof(header)}, {&image, sizeof(image)}};
+            msghdr msg = {};
+            msg.msg_name = &cn;
+            msg.msg_namelen = sizeof(cn);
+            msg.msg_iov = tx;
+            msg.msg_iovlen = 2;
+            if (sendmsg(fd, &msg, 0) < 0)
+                perror("RPDO");
+        }
+        if (nowUs() >= nextPrint)
+        {
+            nextPrint += 1000000;
+            printf("node %u : %lu TPDO, valves 0x%03X, sensors", node, (unsigned long)nbIn, last.valveStates);
+            for (int i = 0; i < MAX_SENSORS; i++)
+                printf(" %d", last.sensors[i]);
+            printf("\n");
+            fflush(stdout);
+        }
+    }
+    close(fd);
+    return EXIT_SUCCESS;
+}
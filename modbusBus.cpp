@@ -0,0 +1,348 @@
+/**
+ * \file modbusBus.cpp
+ * \brief Module to read the Modbus RTU sensors with coalesced multi-register requests
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * The channel of a type 2 sensor gives its slave address and its input
+ * register : channel = slave * MODBUS_SLAVE_STRIDE + register. The sensors
+ * of a slave are sorted by register and merged in spans of at most
+ * MODBUS_MAX_REGS registers, each span is read with one request.
+ */
+
+#include "modbusBus.h"
+#include "monotonicClock.h"
+#include <unistd.h>
+#include <termios.h>
+#include <time.h>
+#include <algorithm>
+
+static speed_t toSpeed(int baudrate)
+{
+    switch (baudrate)
+    {
+    case 1200:
+        return B1200;
+    case 2400:
+        return B2400;
+    case 4800:
+        return B4800;
+    case 19200:
+        return B19200;
+    case 38400:
+        return B38400;
+    case 57600:
+        return B57600;
+    case 115200:
+        return B115200;
+    default:
+        return B9600;
+    }
+}
+
+/**
+ * \brief Constructor for the ModbusBus class.
+ *
+ * \param devPath the serial device of the bus, or the slave side of a pty
+ * \param baudrate the serial speed
+ * \param coalesce false to send one request per sensor, for comparison
+ */
+ModbusBus::ModbusBus(const char *devPath, int baudrate, bool coalesce)
+    : devPath(devPath), baudrate(baudrate), coalesce(coalesce), fd(-1), nbPending(0), nbRequests(0),
+      current(-1), next(0), rxLen(0), expected(0), sentNs(0), idleNs(0), silenceNs(0),
+      nbTransactions(0), nbErrors(0), bytesTx(0), bytesRx(0)
+{
+    // 3.5 characters of 11 bits, fixed to 1750 us above 19200 bauds by the RTU specification
+    silenceNs = baudrate > 19200 ? 1750000 : (int64_t)35 * 11 * 100000000 / baudrate;
+}
+
+ModbusBus::~ModbusBus()
+{
+    close();
+}
+
+/**
+ * \brief function to add a type 2 sensor. Must be called before open().
+ *
+ * \return errOpenModbus when the bus is already open or full, noError otherwise.
+ */
+statusErrDef ModbusBus::addSensor(Sensor *sensor)
+{
+    if (fd >= 0 || nbPending >= MAX_SENSORS)
+        return errOpenModbus;
+    pending[nbPending++] = sensor;
+    return noError;
+}
+
+/**
+ * \brief function to compute the Modbus CRC-16 (polynomial 0xA001, init 0xFFFF).
+ */
+uint16_t ModbusBus::crc16(const uint8_t *data, size_t len)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++)
+            crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+    }
+    return crc;
+}
+
+/**
+ * \brief function to group the sensors by slave and register span
+ * and to build the request frames once.
+ */
+void ModbusBus::buildRequests()
+{
+    std::sort(pending, pending + nbPending, [](const Sensor *a, const Sensor *b)
+              { return a->getChannel() < b->getChannel(); });
+
+    nbRequests = 0;
+    for (int i = 0; i < nbPending; i++)
+    {
+        int slave = pending[i]->getChannel() / MODBUS_SLAVE_STRIDE;
+        int reg = pending[i]->getChannel() % MODBUS_SLAVE_STRIDE;
+
+        ModbusRequest *req = nbRequests ? &requests[nbRequests - 1] : nullptr;
+        if (!coalesce || !req || req->slave != slave || reg + MODBUS_NBREG - req->first > MODBUS_MAX_REGS)
+        {
+            req = &requests[nbRequests++];
+            req->slave = (uint8_t)slave;
+            req->first = (uint16_t)reg;
+            req->count = 0;
+            req->nbSensors = 0;
+            // a value is never valid before the slave has answered once
+            req->status = errModbusTimeout;
+        }
+        req->sensors[req->nbSensors] = pending[i];
+        req->offsets[req->nbSensors] = (uint16_t)(reg - req->first);
+        req->nbSensors++;
+        req->count = std::max<uint16_t>(req->count, (uint16_t)(reg - req->first + MODBUS_NBREG));
+    }
+
+    for (int r = 0; r < nbRequests; r++)
+    {
+        ModbusRequest &req = requests[r];
+        req.frame[0] = req.slave;
+        req.frame[1] = MODBUS_FUNCTION;
+        req.frame[2] = req.first >> 8;
+        req.frame[3] = req.first & 0xFF;
+        req.frame[4] = req.count >> 8;
+        req.frame[5] = req.count & 0xFF;
+        uint16_t crc = crc16(req.frame, 6);
+        req.frame[6] = crc & 0xFF;
+        req.frame[7] = crc >> 8;
+    }
+}
+
+/**
+ * \brief function to open and configure the serial device in raw
+ * non-blocking mode, and to build the requests.
+ *
+ * \return errOpenModbus when the device can't be opened or configured.
+ */
+statusErrDef ModbusBus::open()
+{
+    if (fd >= 0)
+        return noError;
+
+    fd = ::open(devPath, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0)
+    {
+        perror("open modbus device");
+        logEvent(logSensor, errOpenModbus, "open() of the modbus device failed (errno)", errno);
+        return errOpenModbus;
+    }
+
+    struct termios tio;
+    if (tcgetattr(fd, &tio) < 0)
+    {
+        perror("tcgetattr()");
+        ::close(fd);
+        fd = -1;
+        return errOpenModbus;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~(CSTOPB | PARENB);
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    cfsetispeed(&tio, toSpeed(baudrate));
+    cfsetospeed(&tio, toSpeed(baudrate));
+    if (tcsetattr(fd, TCSANOW, &tio) < 0)
+    {
+        perror("tcsetattr()");
+        ::close(fd);
+        fd = -1;
+        return errOpenModbus;
+    }
+    tcflush(fd, TCIOFLUSH);
+
+    buildRequests();
+    current = -1;
+    next = 0;
+    return noError;
+}
+
+/**
+ * \brief function to close the serial device.
+ */
+void ModbusBus::close()
+{
+    if (fd >= 0)
+    {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+/**
+ * \brief function to check the answer of the request in flight
+ * and to give the register values to its sensors.
+ *
+ * \return errModbusFrame when the answer is an exception or is corrupted.
+ */
+statusErrDef ModbusBus::parseAnswer()
+{
+    const ModbusRequest &req = requests[current];
+    size_t len = (rx[1] & 0x80) ? 5 : expected;
+    uint16_t crc = crc16(rx, len - 2);
+    if (rx[0] != req.slave || (rx[1] & 0x7F) != MODBUS_FUNCTION ||
+        rx[len - 2] != (crc & 0xFF) || rx[len - 1] != (crc >> 8))
+        return errModbusFrame;
+    if (rx[1] & 0x80)
+    {
+        logEvent(logSensor, errModbusFrame, "modbus exception (slave, code)", req.slave, rx[2]);
+        return errModbusFrame;
+    }
+    if (rx[2] != 2 * req.count)
+        return errModbusFrame;
+
+    for (int i = 0; i < req.nbSensors; i++)
+    {
+        const uint8_t *reg = rx + 3 + 2 * req.offsets[i];
+        req.sensors[i]->setValue((int16_t)((reg[0] << 8) | reg[1]));
+    }
+    return noError;
+}
+
+/**
+ * \brief function to end the transaction in flight.
+ */
+void ModbusBus::finish(statusErrDef status, int64_t now)
+{
+    ModbusRequest &req = requests[current];
+    if (status != noError)
+    {
+        nbErrors++;
+        if (req.status != status)
+            logEvent(logSensor, status, "modbus read failed (slave, first register)", req.slave, req.first);
+        // drop the rest of a late or corrupted answer
+        tcflush(fd, TCIFLUSH);
+    }
+    req.status = status;
+    nbTransactions++;
+    current = -1;
+    idleNs = now + silenceNs;
+}
+
+/**
+ * \brief function to step the bus, called once per cycle. Never blocks.
+ *
+ * \return statusErrDef that values errOpenModbus when the device is not
+ * open, or the first error among the last transactions of each request,
+ * or noError when every request was last answered correctly.
+ */
+statusErrDef ModbusBus::poll()
+{
+    if (fd < 0)
+        return errOpenModbus;
+
+    int64_t now = monotonicNs();
+    if (current >= 0)
+    {
+        ssize_t n = read(fd, rx + rxLen, sizeof(rx) - rxLen);
+        if (n > 0)
+        {
+            rxLen += n;
+            bytesRx += n;
+        }
+
+        if (rxLen >= 5 && (rx[1] & 0x80))
+            finish(parseAnswer(), now);
+        else if (rxLen >= expected)
+            finish(parseAnswer(), now);
+        else if (now - sentNs > (int64_t)MODBUS_TIMEOUT_MS * 1000000)
+            finish(errModbusTimeout, now);
+    }
+
+    if (current < 0 && nbRequests > 0 && now >= idleNs)
+    {
+        ModbusRequest &req = requests[next];
+        ssize_t n = write(fd, req.frame, sizeof(req.frame));
+        if (n == (ssize_t)sizeof(req.frame))
+        {
+            bytesTx += n;
+            current = next;
+            rxLen = 0;
+            expected = 5 + 2 * req.count;
+            sentNs = now;
+        }
+        else if (req.status != errModbusTimeout)
+        {
+            logEvent(logSensor, errModbusTimeout, "modbus request not written (slave, errno)", req.slave, n < 0 ? errno : 0);
+            req.status = errModbusTimeout;
+        }
+        next = (next + 1) % nbRequests;
+    }
+
+    for (int r = 0; r < nbRequests; r++)
+        if (requests[r].status != noError)
+            return requests[r].status;
+    return noError;
+}
+
+/**
+ * \brief function to get the result of the last transaction of the request
+ * reading a sensor, its value is the last one answered.
+ *
+ * \return statusErrDef that values errOpenModbus when the device is not
+ * open or the sensor is not on the bus, the status of its request otherwise.
+ */
+statusErrDef ModbusBus::getStatus(const Sensor *sensor) const
+{
+    if (fd < 0)
+        return errOpenModbus;
+    for (int r = 0; r < nbRequests; r++)
+        for (int i = 0; i < requests[r].nbSensors; i++)
+            if (requests[r].sensors[i] == sensor)
+                return requests[r].status;
+    return errOpenModbus;
+}
+
+int ModbusBus::getNbRequests() const
+{
+    return nbRequests;
+}
+
+uint64_t ModbusBus::getNbTransactions() const
+{
+    return nbTransactions;
+}
+
+uint64_t ModbusBus::getNbErrors() const
+{
+    return nbErrors;
+}
+
+uint64_t ModbusBus::getBytesTx() const
+{
+    return bytesTx;
+}
+
+uint64_t ModbusBus::getBytesRx() const
+{
+    return bytesRx;
+}
@@ -0,0 +1,89 @@
+/**
+ * \file modbusBus.h
+ * \brief header file of the Modbus RTU sensor module
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * Contains the class reading the type 2 sensors on a rs485 Modbus RTU bus.
+ * The sensors of the same slave are read with one multi-register request,
+ * and the serial device is driven by a non-blocking state machine stepped
+ * once per cycle so a slow slave never delays the ADC channels.
+ */
+
+#ifndef MODBUSBUS_H
+#define MODBUSBUS_H
+
+#include "configDefine.h"
+#include "statusErrorDefine.h"
+#include "sensor.h"
+#include <cstdint>
+
+/**
+ * \brief one read request : a register span of one slave
+ * covering one or more sensors.
+ */
+struct ModbusRequest
+{
+    uint8_t slave;
+    uint16_t first;                 /**< first register of the span */
+    uint16_t count;                 /**< registers in the span */
+    int nbSensors;
+    Sensor *sensors[MAX_SENSORS];
+    uint16_t offsets[MAX_SENSORS];  /**< register of each sensor relative to first */
+    uint8_t frame[8];               /**< request frame with its CRC, built once */
+    statusErrDef status;            /**< result of the last transaction, errModbusTimeout until the first answer */
+};
+
+/**
+ * \brief Modbus RTU master for the type 2 sensors of a board.
+ *
+ * poll() never waits : it takes the bytes already received, completes or
+ * abandons the transaction in flight, then sends the next request when
+ * the bus is idle. The requests are sent in turn, one at a time.
+ */
+class ModbusBus
+{
+private:
+    const char *devPath;
+    int baudrate;
+    bool coalesce;          /**< one request per slave, or one per sensor */
+    int fd;
+    Sensor *pending[MAX_SENSORS];
+    int nbPending;          /**< sensors added and not yet grouped */
+    ModbusRequest requests[MAX_SENSORS];
+    int nbRequests;
+    int current;            /**< request in flight, -1 when the bus is idle */
+    int next;               /**< next request to send */
+    uint8_t rx[5 + 2 * MODBUS_MAX_REGS + 8];
+    size_t rxLen;
+    size_t expected;        /**< length of the normal answer of current */
+    int64_t sentNs;         /**< time the request in flight was written */
+    int64_t idleNs;         /**< end of the silence after the last frame */
+    int64_t silenceNs;      /**< 3.5 characters at baudrate */
+    uint64_t nbTransactions;
+    uint64_t nbErrors;
+    uint64_t bytesTx;
+    uint64_t bytesRx;
+
+    void buildRequests();
+    void finish(statusErrDef status, int64_t now);
+    statusErrDef parseAnswer();
+
+public:
+    ModbusBus(const char *devPath = MODBUS_DEVICELOC, int baudrate = MODBUS_BAUDRATE, bool coalesce = true);
+    ~ModbusBus();
+    statusErrDef addSensor(Sensor *sensor);
+    statusErrDef open();
+    void close();
+    statusErrDef poll();
+    statusErrDef getStatus(const Sensor *sensor) const;
+    int getNbRequests() const;
+    uint64_t getNbTransactions() const;
+    uint64_t getNbErrors() const;
+    uint64_t getBytesTx() const;
+    uint64_t getBytesRx() const;
+    static uint16_t crc16(const uint8_t *data, size_t len);
+};
+
+#endif // MODBUSBUS_H
@@ -0,0 +1,30 @@
+/**
+ * \file monotonicClock.h
+ * \brief header file of the clock shared by every module
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * Every time of the program is read on CLOCK_MONOTONIC in nanoseconds :
+ * the published timestamps, the deadlines of the cycles and of the valve
+ * sequences, the timeouts. The call goes through the vDSO, no syscall.
+ */
+
+#ifndef MONOTONICCLOCK_H
+#define MONOTONICCLOCK_H
+
+#include <cstdint>
+#include <time.h>
+
+/**
+ * \brief CLOCK_MONOTONIC time in nanoseconds. A difference of two times
+ * is converted to int64_t when it can be negative.
+ */
+inline uint64_t monotonicNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+#endif // MONOTONICCLOCK_H
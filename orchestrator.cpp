@@ -0,0 +1,446 @@
+/**
+ * \file orchestrator.cpp
+ * \brief Module running the boards of a rig, one cycle thread per board
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * init() reports the first error of the board, it still runs without the
+ * parts that failed : the compiled-in CACMO table without physical
+ * configuration, the console commands without general states, no valve
+ * opened without valid interlock rules, no alarm without alarms.csv, no
+ * sequence without sequence.csv, no exchange without MN.
+ */
+
+#include "orchestrator.h"
+#include "monotonicClock.h"
+#include "configCAC.h"
+#include "logger.h"
+#include <stdio.h>
+#include <time.h>
+#include <iostream>
+
+BoardWorker::BoardWorker(const std::string &name, uint8_t id, const WorkerConfig &config)
+    : config(config), cac(name, id),
+      scheduler(cac.getValveBank(), SchedulerConfig{config.priority, config.cpu, SCHED_SPIN_NS, SCHED_COALESCE_NS}),
+      transport(id, config.mnAddress ? config.mnAddress : ""),
+      executive(CycleConfig{config.periodUs, config.priority, config.cpu, config.lockMemory}), mode(manual),
+      imageLinked(false), telemEnabled(false), commandsEnabled(false), streamBoard(-1), lastRead(noError), lastLink(noError), lastAlarm(infoNoAlarm), lastEG(0),
+      sequenceRuns(0), phases{}
+{
+}
+
+BoardWorker::~BoardWorker()
+{
+    stop();
+    join();
+    if (telem)
+        telem->stop();
+}
+
+/**
+ * \brief function to build the board : segments and drivers, general
+ * states, interlock rules, calibration, alarms, command queue, valve
+ * sequence, process image and telemetry, before its cycle thread starts.
+ *
+ * \param board the board from the physical CSV files, nullptr for the compiled-in dict_CACMO
+ * \return statusErrDef of the first part that failed, or noError.
+ */
+statusErrDef BoardWorker::init(const BoardConfig *board)
+{
+    const std::string &name = cac.getName();
+    statusErrDef res = board ? cac.init(*board) : cac.init(dict_CACMO);
+    if (res != noError)
+        std::cerr << name << " : drivers not all initialised (0x" << std::hex << res << std::dec << ")" << std::endl;
+
+    // the general states are compiled before the loop starts
+    statusErrDef seqRes = sequencer.load(cac.getConfig(), config.csvDir);
+    if (seqRes != noError)
+        std::cerr << name << " : general states not all loaded (0x" << std::hex << seqRes << std::dec << "), "
+                  << sequencer.getNbStates() << " usable" << std::endl;
+
+    // the interlock rules too, a valve with an invalid rule stays closed
+    char path[MAX_PATH_LENGTH];
+    snprintf(path, sizeof(path), "%s%s", config.csvDir, ACTIVATION_FILE);
+    statusErrDef lockRes = interlock.load(cac.getConfig(), path);
+    if (lockRes != noError)
+        std::cerr << name << " : interlock rules not all loaded (0x" << std::hex << lockRes << std::dec << ")"
+                  << std::endl;
+    cac.setInterlock(&interlock);
+
+    // and the calibration, a sensor with an invalid line publishes its counts
+    snprintf(path, sizeof(path), "%s%s", config.csvDir, CALIBRATION_FILE);
+    statusErrDef condRes = conditioner.load(cac.getConfig(), path);
+    if (condRes != noError)
+        std::cerr << name << " : calibration not all loaded (0x" << std::hex << condRes << std::dec << ")"
+                  << std::endl;
+    cac.setConditioner(&conditioner);
+
+    // and the alarms, an invalid line is skipped
+    snprintf(path, sizeof(path), "%s%s", config.csvDir, ALARM_FILE);
+    statusErrDef alarmRes = alarms.load(cac.getConfig(), path);
+    if (alarmRes != noError)
+        std::cerr << name << " : alarms not all loaded (0x" << std::hex << alarmRes << std::dec << "), "
+                  << alarms.getNbRules() << " rules" << std::endl;
+
+    // the command queue of the clients, the board runs without it
+    statusErrDef cmdRes = commands.create(name, cac.getId(), cac.vannes.size());
+    commandsEnabled = cmdRes == noError;
+    if (!commandsEnabled)
+        std::cerr << name << " : valve commands not received (0x" << std::hex << cmdRes << std::dec << ")"
+                  << std::endl;
+
+    // the valve sequence, started on request ; an invalid line is skipped
+    snprintf(path, sizeof(path), "%s%s", config.csvDir, SEQUENCE_FILE);
+    statusErrDef schedRes = scheduler.load(cac.getConfig(), path);
+    scheduler.setInterlock(&interlock, cac.tab_sensors);
+    if (schedRes != noError)
+        std::cerr << name << " : valve sequence not all loaded (0x" << std::hex << schedRes << std::dec << "), "
+                  << scheduler.getNbActions() << " actions" << std::endl;
+
+    // the process image is exchanged over UDP with a stand-in MN until the POWERLINK stack is on the board
+    statusErrDef linkRes = noError;
+    if (config.mnAddress)
+    {
+        linkRes = image.link(cac.tab_sensors, cac.sensors.size(), cac.tab_vannes, cac.vannes.size(), &transport,
+                             &mode);
+        imageLinked = linkRes == noError;
+        if (!imageLinked)
+            std::cerr << name << " : process image not exchanged (0x" << std::hex << linkRes << std::dec << ")"
+                      << std::endl;
+    }
+
+    statusErrDef telemRes = noError;
+    if (config.telemetry)
+    {
+        telem = std::make_unique<TelemetryRecorder>(name, cac.sensors.size(), cac.vannes.size());
+        telemRes = telem->start();
+        telemEnabled = telemRes == noError;
+        if (!telemEnabled)
+            std::cerr << name << " : telemetry not recorded (0x" << std::hex << telemRes << std::dec << ")"
+                      << std::endl;
+    }
+
+    // the ring of the board in the telemetry server, added before the server starts
+    if (config.stream)
+    {
+        streamBoard = config.stream->addBoard(cac.getId(), cac.sensors.size(), cac.vannes.size());
+        if (streamBoard < 0)
+            std::cerr << name << " : not published to the telemetry subscribers" << std::endl;
+    }
+
+    for (statusErrDef part : {res, seqRes, lockRes, condRes, alarmRes, cmdRes, schedRes, linkRes, telemRes})
+        if (part != noError)
+            return part;
+    return noError;
+}
+
+/**
+ * \brief function to run one cycle of the board : acquire, exchange,
+ * decide, actuate and record. Called by the cycle thread, or directly by
+ * a bench driving the board without executive. With config.phaseTiming
+ * each phase is timed, a vDSO clock_gettime() between two of them.
+ */
+void BoardWorker::step()
+{
+    // a board without its segments has no component, init() reported it
+    if (!cac.tab_sensors || !cac.tab_vannes)
+        return;
+
+    const bool timed = config.phaseTiming;
+    uint64_t t0 = timed ? monotonicNs() : 0;
+
+    // acquire, the errors are reported when they appear
+    statusErrDef read = cac.acquire();
+    if (read != noError && read != lastRead)
+        logEvent(logMain, read, "Erreur lors de la lecture du canal (board)", cac.getId());
+    lastRead = read;
+    uint64_t t1 = timed ? monotonicNs() : 0;
+
+    // exchange : the MN gets this acquisition and gives the EG and the manual commands
+    if (imageLinked)
+    {
+        statusErrDef link = image.sync();
+        if (link != noError && link != lastLink)
+            logEvent(logOpl, link, "process image exchange failed (board)", cac.getId());
+        lastLink = link;
+    }
+    uint64_t t2 = timed ? monotonicNs() : 0;
+
+    // commands : every command of the clients due on this actuation, in
+    // the order of submission ; a valve commanded by hand leaves the
+    // automatic mode, like the console
+    int nbCommands = commandsEnabled ? commands.drain(cac.tab_vannes->frame.cycle + 1) : 0;
+    for (int k = 0; k < nbCommands; k++)
+    {
+        const ValveCommand &cmd = commands.getCommand(k);
+        if (cmd.op == CMD_VALVES)
+        {
+            cac.setCommands(cmd.values, cmd.mask);
+            __atomic_store_n(&cac.tab_vannes->generalState, (uint16_t)infoStateToManualMode, __ATOMIC_RELEASE);
+        }
+        else
+        {
+            // applied again even when it is the current EG, like a safe state
+            lastEG = 0;
+            __atomic_store_n(&cac.tab_vannes->generalState, (uint16_t)cmd.values, __ATOMIC_RELEASE);
+        }
+    }
+
+    // a finished sequence hands its valves back with their last written
+    // states as commands, like a command of a client ; an aborted one has
+    // already handed them back
+    uint32_t runs = scheduler.getRuns();
+    if (runs != sequenceRuns && scheduler.isDone())
+    {
+        uint32_t held = cac.getValveBank().getReservedMask();
+        if (held)
+        {
+            cac.setCommands(cac.getValveBank().getAppliedMask(), held);
+            cac.getValveBank().unreserve();
+            __atomic_store_n(&cac.tab_vannes->generalState, (uint16_t)infoStateToManualMode, __ATOMIC_RELEASE);
+        }
+        const SchedulerStats &s = scheduler.getStats();
+        if (s.nbDropped)
+            logEvent(logValve, infoSequenceAborted, "valve sequence aborted (board, actions written, dropped)",
+                     cac.getId(), (int32_t)s.nbWritten, (int32_t)s.nbDropped);
+        else
+            logEvent(logValve, infoSequenceDone, "valve sequence done (board, actions, bulk writes)", cac.getId(),
+                     (int32_t)s.nbWritten, (int32_t)s.nbBatches);
+        if (s.nbLate)
+            logEvent(logValve, errActionLate, "valve sequence late (board, actions, max error us)", cac.getId(),
+                     (int32_t)s.nbLate, (int32_t)(s.maxErrorNs / 1000));
+        if (s.nbInterlocked)
+            logEvent(logValve, errActionInterlocked, "valve sequence held by the interlock (board, actions)",
+                     cac.getId(), (int32_t)s.nbInterlocked);
+        sequenceRuns = runs;
+    }
+
+    // decide : a raised alarm requests its safe state like the MN requests
+    // an EG, so it is applied below in this cycle, after aborting the
+    // running sequence ; close commands every valve closed in manual mode
+    uint16_t safe;
+    statusErrDef alarm = alarms.evaluate(cac.tab_sensors->frame, safe);
+    if (alarm != lastAlarm && alarm != infoNoAlarm)
+        logEvent(logMain, alarm, "alarm active (board)", cac.getId());
+    lastAlarm = alarm;
+    if (safe)
+    {
+        scheduler.abort();
+        if (safe == infoStateToManualMode)
+            cac.setCommands(0);
+        // applied again even when it is the current EG, the commands may have changed since
+        lastEG = 0;
+        __atomic_store_n(&cac.tab_vannes->generalState, safe, __ATOMIC_RELEASE);
+        logEvent(logMain, errAlarmSafeState, "safe state requested by an alarm (board, EG)", cac.getId(), safe);
+    }
+
+    // a new general state gives every valve command at once, otherwise
+    // the commands of SHM_Vanne are kept
+    uint16_t eg = __atomic_load_n(&cac.tab_vannes->generalState, __ATOMIC_ACQUIRE);
+    statusErrDef sel = noError;
+    if (eg != lastEG)
+    {
+        uint32_t mask;
+        sel = sequencer.select(eg, mask);
+        if (sel == infoCSVChanged || sel == infoEGNotChanged)
+        {
+            cac.setCommands(mask);
+            __atomic_store_n(&mode, automatic, __ATOMIC_RELAXED);
+            logEvent(logCSV, infoCSVChanged, "general state applied (board, EG, valves)", cac.getId(), eg,
+                     (int32_t)mask);
+        }
+        else if (eg == infoStateToManualMode || eg == 0)
+        {
+            __atomic_store_n(&mode, manual, __ATOMIC_RELAXED);
+            logEvent(logCSV, infoStateToManualMode, "manual mode (board, EG)", cac.getId(), eg);
+        }
+        else
+            logEvent(logCSV, errEGNotFoundInFile, "EG not in liaisonEGEtat.csv, commands kept (board, EG)",
+                     cac.getId(), eg);
+        lastEG = eg;
+    }
+    uint64_t t3 = timed ? monotonicNs() : 0;
+
+    // actuate : only the changed valves are written, then every command
+    // applied is acknowledged with this actuation
+    cac.actuate();
+    if (nbCommands)
+        commands.acknowledge(cac.tab_vannes->frame.cycle, cac.tab_vannes->frame.timestamp, cac.getValveMask(), eg,
+                             sel);
+    uint64_t t4 = timed ? monotonicNs() : 0;
+
+    // record : this thread is the only writer of the frame, no seqlock needed
+    if (telemEnabled)
+        telem->record(cac.tab_sensors->frame, cac.getValveMask());
+    if (streamBoard >= 0)
+        config.stream->publish(streamBoard, cac.tab_sensors->frame, cac.getValveMask());
+
+    if (timed)
+    {
+        uint64_t t5 = monotonicNs();
+        phases = CyclePhases{(uint32_t)(t1 - t0), (uint32_t)(t2 - t1), (uint32_t)(t3 - t2), (uint32_t)(t4 - t3),
+                             (uint32_t)(t5 - t4)};
+    }
+}
+
+/**
+ * \brief body of the cycle thread of the board.
+ */
+void BoardWorker::run()
+{
+    statusErrDef res = executive.run([this](uint64_t)
+                                     { step(); });
+    if (res != noError)
+        std::cerr << cac.getName() << " : cycle running without real-time settings (0x" << std::hex << res
+                  << std::dec << ")" << std::endl;
+}
+
+/**
+ * \brief function to start the cycle thread, it runs until stop().
+ */
+void BoardWorker::start()
+{
+    if (!thread.joinable())
+        thread = std::thread(&BoardWorker::run, this);
+}
+
+/**
+ * \brief function to end the cycle thread after its current cycle.
+ */
+void BoardWorker::stop()
+{
+    executive.stop();
+}
+
+void BoardWorker::join()
+{
+    if (thread.joinable())
+        thread.join();
+}
+
+CAC &BoardWorker::getCac()
+{
+    return cac;
+}
+
+const std::string &BoardWorker::getName() const
+{
+    return cac.getName();
+}
+
+Mode BoardWorker::getMode() const
+{
+    return __atomic_load_n(&mode, __ATOMIC_RELAXED);
+}
+
+const CycleExecutive &BoardWorker::getExecutive() const
+{
+    return executive;
+}
+
+/**
+ * \brief function to get the telemetry records lost by the board.
+ */
+uint64_t BoardWorker::getTelemDropped() const
+{
+    return telem ? telem->getDropped() : 0;
+}
+
+/**
+ * \brief function to get the phases of the last cycle, from the cycle
+ * thread (a bench calling step()) or once the board is stopped.
+ */
+const CyclePhases &BoardWorker::getPhases() const
+{
+    return phases;
+}
+
+/**
+ * \brief function to get the alarm rules of the board, their status can be
+ * read from any thread.
+ */
+const AlarmEngine &BoardWorker::getAlarms() const
+{
+    return alarms;
+}
+
+/**
+ * \brief function to get the command queue of the board, to submit
+ * commands from this process.
+ */
+CommandQueue &BoardWorker::getCommands()
+{
+    return commands;
+}
+
+/**
+ * \brief function to get the valve sequence of the board, to start it
+ * from this process ; the cycle thread aborts it on an alarm safe state
+ * and takes its valves back once it is done.
+ */
+ValveScheduler &BoardWorker::getScheduler()
+{
+    return scheduler;
+}
+
+/**
+ * \brief function to add a board to the rig and build it, before start().
+ * The board is kept when init() fails, it runs without the failing parts.
+ *
+ * \param name board name, part of the segment names
+ * \param id board id, node of the process image
+ * \param board the board from the physical CSV files, nullptr for the compiled-in dict_CACMO
+ * \param config CPU, period, MN and directories of the board
+ * \return statusErrDef of BoardWorker::init().
+ */
+statusErrDef Orchestrator::add(const std::string &name, uint8_t id, const BoardConfig *board,
+                               const WorkerConfig &config)
+{
+    workers.push_back(std::make_unique<BoardWorker>(name, id, config));
+    return workers.back()->init(board);
+}
+
+/**
+ * \brief function to start the cycle thread of every board. The threads
+ * take their first deadline on the common cycle clock, the boards started
+ * last simply join at the next period.
+ */
+void Orchestrator::start()
+{
+    for (auto &worker : workers)
+        worker->start();
+}
+
+/**
+ * \brief function to stop every board, then wait for all of them, so the
+ * boards stop within one cycle of each other.
+ */
+void Orchestrator::stop()
+{
+    for (auto &worker : workers)
+        worker->stop();
+    for (auto &worker : workers)
+        worker->join();
+}
+
+int Orchestrator::getNbBoards() const
+{
+    return (int)workers.size();
+}
+
+BoardWorker &Orchestrator::getBoard(int index)
+{
+    return *workers[index];
+}
+
+void Orchestrator::printStats() const
+{
+    for (const auto &worker : workers)
+    {
+        std::cout << "-- " << worker->getName() << std::endl;
+        worker->getExecutive().printStats();
+        if (worker->getTelemDropped())
+            std::cout << worker->getTelemDropped() << " telemetry records dropped" << std::endl;
+    }
+}
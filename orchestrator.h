@@ -0,0 +1,142 @@
+/**
+ * \file orchestrator.h
+ * \brief header file of the rig orchestrator
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * Contains the worker running one board and the orchestrator running the
+ * boards of a rig. Each worker owns everything of its board : the CAC and
+ * its segments /sensor_shm_<name> and /vanne_shm_<name>, the general
+ * states, the interlock rules, the conditioning, the alarms, the process
+ * image, the telemetry, its ring in the telemetry server, its command
+ * queue, its valve sequence and its mode. Nothing is shared between the workers
+ * but the logger, so each cycle thread is pinned to its own CPU and the
+ * rig runs as many boards in parallel as it has cores.
+ *
+ * Every executive wakes on the multiples of its period on CLOCK_MONOTONIC,
+ * the boards of one process and the boards of other processes started
+ * with the same period acquire in the same cycle.
+ */
+
+#ifndef ORCHESTRATOR_H
+#define ORCHESTRATOR_H
+
+#include "configDefine.h"
+#include "statusErrorDefine.h"
+#include "cac.h"
+#include "cycle.h"
+#include "sequencer.h"
+#include "interlock.h"
+#include "conditioning.h"
+#include "alarm.h"
+#include "processImage.h"
+#include "telemetry.h"
+#include "telemServer.h"
+#include "commandQueue.h"
+#include "valveScheduler.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * \brief settings of the worker of one board
+ */
+struct WorkerConfig
+{
+    long periodUs = CYCLE_LEN;        /**< cycle period, the same for every board of the rig */
+    int priority = RT_PRIORITY;       /**< SCHED_FIFO priority of the cycle thread, 0 for SCHED_OTHER */
+    int cpu = RT_CPU;                 /**< CPU of the cycle thread, -1 for none */
+    bool lockMemory = true;           /**< mlockall() before the first cycle */
+    const char *mnAddress = nullptr;  /**< stand-in MN, nullptr to run the board from the console */
+    const char *csvDir = CSV_DIR;     /**< liaisonEGEtat.csv, the state files, activation.csv, calibration.csv, alarms.csv and sequence.csv */
+    bool telemetry = true;            /**< record every cycle in TELEM_DIR */
+    bool phaseTiming = false;         /**< time the phases of every cycle, for the benches */
+    TelemetryServer *stream = nullptr; /**< server publishing every cycle to the subscribers, nullptr for none */
+};
+
+/**
+ * \brief duration of each phase of the last cycle, in nanoseconds
+ */
+struct CyclePhases
+{
+    uint32_t acquireNs;
+    uint32_t exchangeNs;
+    uint32_t decideNs;
+    uint32_t actuateNs;
+    uint32_t recordNs;
+};
+
+/**
+ * \brief one board and its cycle thread : acquire, exchange, decide,
+ * actuate and record every period.
+ */
+class BoardWorker
+{
+private:
+    WorkerConfig config;
+    CAC cac;
+    Sequencer sequencer;
+    Interlock interlock;
+    Conditioner conditioner;
+    AlarmEngine alarms;
+    CommandQueue commands;
+    ValveScheduler scheduler;
+    UdpTransport transport;
+    ProcessImage image;
+    std::unique_ptr<TelemetryRecorder> telem;
+    CycleExecutive executive;
+    std::thread thread;
+    Mode mode;             /**< mode of this board, written by step() */
+    bool imageLinked;
+    bool telemEnabled;
+    bool commandsEnabled;
+    int streamBoard;       /**< ring of the board in config.stream, -1 for none */
+    statusErrDef lastRead; /**< the errors are logged when they appear */
+    statusErrDef lastLink;
+    statusErrDef lastAlarm;
+    uint16_t lastEG;
+    uint32_t sequenceRuns; /**< runs of the valve sequence whose end has been handled */
+    CyclePhases phases;    /**< written by step() when config.phaseTiming */
+
+    void run();
+
+public:
+    BoardWorker(const std::string &name, uint8_t id, const WorkerConfig &config);
+    ~BoardWorker();
+    statusErrDef init(const BoardConfig *board);
+    void step();
+    void start();
+    void stop();
+    void join();
+    CAC &getCac();
+    const std::string &getName() const;
+    Mode getMode() const;
+    const CycleExecutive &getExecutive() const;
+    uint64_t getTelemDropped() const;
+    const CyclePhases &getPhases() const;
+    const AlarmEngine &getAlarms() const;
+    CommandQueue &getCommands();
+    ValveScheduler &getScheduler();
+};
+
+/**
+ * \brief the boards of a rig, started and stopped together.
+ */
+class Orchestrator
+{
+private:
+    std::vector<std::unique_ptr<BoardWorker>> workers;
+
+public:
+    statusErrDef add(const std::string &name, uint8_t id, const BoardConfig *board, const WorkerConfig &config);
+    void start();
+    void stop();
+    int getNbBoards() const;
+    BoardWorker &getBoard(int index);
+    void printStats() const;
+};
+
+#endif // ORCHESTRATOR_H
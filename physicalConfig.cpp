@@ -0,0 +1,290 @@
+/**
+ * \file physicalConfig.cpp
+ * \brief Module to read the physical CSV files into per-board component tables
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * Every line is read and checked before the tables are filled, and every
+ * invalid line is reported, the first error is returned :
+ * - errOpenPhysValvesFile, errOpenPhysSensorsFile : file missing, line malformed,
+ *   name empty or too long, duplicate id, board id not matching the board name,
+ *   sensor type unknown
+ * - errAllocDataPhysValves, errAllocDataPhysSensors : rows can't be allocated,
+ *   or more than MAX_VALVES / MAX_SENSORS / MAX_BOARDS components
+ * - errGPIOGetLine : a GPIO line used by two valves of a board
+ * - errOpenAdc : an ADC channel outside of MAX_ADC or used by two sensors of a board
+ */
+
+#include "physicalConfig.h"
+#include "csvReader.h"
+#include <stdio.h>
+#include <string.h>
+
+PhysicalConfig::PhysicalConfig()
+    : nbBoards(0)
+{
+}
+
+/**
+ * \brief function to find or add the table of a board.
+ *
+ * \param res set to errOpenPhysValvesFile when the name is known with another id,
+ * or errAllocDataPhysValves when MAX_BOARDS boards are already defined
+ * \return the board, nullptr on error.
+ */
+BoardConfig *PhysicalConfig::board(std::string_view name, uint8_t id, statusErrDef &res)
+{
+    for (int b = 0; b < nbBoards; b++)
+    {
+        if (name == boards[b].name)
+        {
+            if (boards[b].id != id)
+            {
+                res = errOpenPhysValvesFile;
+                return nullptr;
+            }
+            return &boards[b];
+        }
+    }
+    if (nbBoards >= MAX_BOARDS)
+    {
+        res = errAllocDataPhysValves;
+        return nullptr;
+    }
+    BoardConfig &b = boards[nbBoards++];
+    memset(&b, 0, sizeof(b));
+    csvCopy(b.name, SHM_NAME_LENGTH, name);
+    b.id = id;
+    return &b;
+}
+
+/**
+ * \brief function to read physicalCONFIG_valves.csv into the board tables.
+ */
+statusErrDef PhysicalConfig::readValves(const char *path)
+{
+    CsvFile file;
+    if (!file.open(path))
+    {
+        perror(path);
+        return errOpenPhysValvesFile;
+    }
+
+    CsvArena arena;
+    LigneVannes *rows = arena.alloc<LigneVannes>(file.countLines());
+    if (!rows)
+        return errAllocDataPhysValves;
+
+    // read and check the syntax of every line
+    statusErrDef res = noError;
+    std::string_view line;
+    int nbRows = 0;
+    while (file.nextLine(line, "board"))
+    {
+        std::string_view fields[5];
+        LigneVannes &row = rows[nbRows];
+        int boardId, id;
+        const char *msg = nullptr;
+        if (csvSplitFields(line, fields, 5) != 5 || !csvToInt(fields[1], boardId) || !csvToInt(fields[2], id) ||
+            !csvToInt(fields[4], row.pin) || boardId < 0 || boardId > 255 || id < 0 || id > 127 || row.pin < 0)
+            msg = "expected board;boardId;id;name;pin";
+        else if (fields[0].empty() || fields[0].size() >= SHM_NAME_LENGTH || fields[3].size() >= PHYS_NAME_LENGTH)
+            msg = "board or valve name empty or too long";
+        if (msg)
+        {
+            csvReport(path, file.getLineNumber(), errOpenPhysValvesFile, msg);
+            if (res == noError)
+                res = errOpenPhysValvesFile;
+            continue;
+        }
+        row.board = fields[0];
+        row.name = fields[3];
+        row.boardId = (uint8_t)boardId;
+        row.id = (uint8_t)id;
+        row.line = file.getLineNumber();
+        nbRows++;
+    }
+
+    // compile the rows into the board slots
+    for (int r = 0; r < nbRows; r++)
+    {
+        const LigneVannes &row = rows[r];
+        statusErrDef err = noError;
+        const char *msg = nullptr;
+        BoardConfig *b = board(row.board, row.boardId, err);
+        if (!b)
+            msg = err == errOpenPhysValvesFile ? "board id differs from a previous line" : "too many boards";
+        else if (b->nbValves >= MAX_VALVES)
+        {
+            err = errAllocDataPhysValves;
+            msg = "too many valves on the board";
+        }
+        for (int v = 0; b && !msg && v < b->nbValves; v++)
+        {
+            if (b->valves[v].pin == row.pin)
+            {
+                err = errGPIOGetLine;
+                msg = "GPIO line already used by a valve of the board";
+            }
+            else if (b->valves[v].id == row.id)
+            {
+                err = errOpenPhysValvesFile;
+                msg = "valve id already used on the board";
+            }
+        }
+        if (msg)
+        {
+            csvReport(path, row.line, err, msg);
+            if (res == noError)
+                res = err;
+            continue;
+        }
+
+        ValveSlot &slot = b->valves[b->nbValves++];
+        csvCopy(slot.name, PHYS_NAME_LENGTH, row.name);
+        slot.id = row.id;
+        slot.pin = row.pin;
+    }
+    return res;
+}
+
+/**
+ * \brief function to read physicalCONFIG_sensors.csv into the board tables.
+ */
+statusErrDef PhysicalConfig::readSensors(const char *path)
+{
+    CsvFile file;
+    if (!file.open(path))
+    {
+        perror(path);
+        return errOpenPhysSensorsFile;
+    }
+
+    CsvArena arena;
+    LigneSensors *rows = arena.alloc<LigneSensors>(file.countLines());
+    if (!rows)
+        return errAllocDataPhysSensors;
+
+    statusErrDef res = noError;
+    std::string_view line;
+    int nbRows = 0;
+    while (file.nextLine(line, "board"))
+    {
+        std::string_view fields[6];
+        LigneSensors &row = rows[nbRows];
+        int boardId, id;
+        const char *msg = nullptr;
+        if (csvSplitFields(line, fields, 6) != 6 || !csvToInt(fields[1], boardId) || !csvToInt(fields[2], id) ||
+            !csvToInt(fields[4], row.type) || !csvToInt(fields[5], row.channel) ||
+            boardId < 0 || boardId > 255 || id < 0 || id > 255 || row.channel < 0)
+            msg = "expected board;boardId;id;name;type;channel";
+        else if (row.type < 1 || row.type > 3)
+            msg = "type must be 1 (sysfs), 2 (modbus) or 3 (IIO buffer)";
+        else if (fields[0].empty() || fields[0].size() >= SHM_NAME_LENGTH || fields[3].size() >= PHYS_NAME_LENGTH)
+            msg = "board or sensor name empty or too long";
+        if (msg)
+        {
+            csvReport(path, file.getLineNumber(), errOpenPhysSensorsFile, msg);
+            if (res == noError)
+                res = errOpenPhysSensorsFile;
+            continue;
+        }
+        row.board = fields[0];
+        row.name = fields[3];
+        row.boardId = (uint8_t)boardId;
+        row.id = (uint8_t)id;
+        row.line = file.getLineNumber();
+        nbRows++;
+    }
+
+    for (int r = 0; r < nbRows; r++)
+    {
+        const LigneSensors &row = rows[r];
+        bool adc = row.type != 2;
+        statusErrDef err = noError;
+        const char *msg = nullptr;
+        BoardConfig *b = board(row.board, row.boardId, err);
+        if (!b)
+        {
+            err = err == errOpenPhysValvesFile ? errOpenPhysSensorsFile : errAllocDataPhysSensors;
+            msg = err == errOpenPhysSensorsFile ? "board id differs from a previous line" : "too many boards";
+        }
+        else if (b->nbSensors >= MAX_SENSORS)
+        {
+            err = errAllocDataPhysSensors;
+            msg = "too many sensors on the board";
+        }
+        else if (adc && row.channel >= MAX_ADC)
+        {
+            err = errOpenAdc;
+            msg = "ADC channel outside of the MCP3008";
+        }
+        for (int s = 0; b && !msg && s < b->nbSensors; s++)
+        {
+            const SensorSlot &other = b->sensors[s];
+            if (other.channel == row.channel && (other.type != 2) == adc)
+            {
+                err = adc ? errOpenAdc : errOpenPhysSensorsFile;
+                msg = "channel already used by a sensor of the board";
+            }
+            else if (other.id == row.id)
+            {
+                err = errOpenPhysSensorsFile;
+                msg = "sensor id already used on the board";
+            }
+        }
+        if (msg)
+        {
+            csvReport(path, row.line, err, msg);
+            if (res == noError)
+                res = err;
+            continue;
+        }
+
+        SensorSlot &slot = b->sensors[b->nbSensors++];
+        csvCopy(slot.name, PHYS_NAME_LENGTH, row.name);
+        slot.id = row.id;
+        slot.type = row.type;
+        slot.channel = row.channel;
+    }
+    return res;
+}
+
+/**
+ * \brief function to read both physical CSV files. Called once at startup.
+ *
+ * \return statusErrDef of the first invalid file or line, or noError.
+ */
+statusErrDef PhysicalConfig::load(const char *valvesPath, const char *sensorsPath)
+{
+    nbBoards = 0;
+    statusErrDef res = readValves(valvesPath);
+    statusErrDef sensorsRes = readSensors(sensorsPath);
+    if (res == noError)
+        res = sensorsRes;
+    return res;
+}
+
+/**
+ * \brief function to get the table of a board by name.
+ *
+ * \return nullptr when the board is not defined.
+ */
+const BoardConfig *PhysicalConfig::getBoard(const char *name) const
+{
+    for (int b = 0; b < nbBoards; b++)
+        if (strncmp(boards[b].name, name, SHM_NAME_LENGTH) == 0)
+            return &boards[b];
+    return nullptr;
+}
+
+const BoardConfig *PhysicalConfig::getBoard(int index) const
+{
+    return (index >= 0 && index < nbBoards) ? &boards[index] : nullptr;
+}
+
+int PhysicalConfig::getNbBoards() const
+{
+    return nbBoards;
+}
@@ -0,0 +1,113 @@
+/**
+ * \file physicalConfig.h
+ * \brief header file of the physical configuration module
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * Contains the rows of the physical CSV files and the per-board tables
+ * they are compiled into at startup. A board table holds its valves and
+ * sensors in contiguous arrays indexed by slot, the slot being the index
+ * used in the shared memory frames.
+ *
+ * physicalCONFIG_valves.csv  : board;boardId;id;name;pin
+ * physicalCONFIG_sensors.csv : board;boardId;id;name;type;channel
+ *
+ * The separator is ';' or ','. Empty lines, lines starting with '#' and
+ * a header line starting with "board" are skipped. The slots of a board
+ * follow the order of its lines.
+ */
+
+#ifndef PHYSICALCONFIG_H
+#define PHYSICALCONFIG_H
+
+#include "configDefine.h"
+#include "statusErrorDefine.h"
+#include "shmLayout.h"
+#include <cstdint>
+#include <string_view>
+
+/**
+ * \brief one line of physicalCONFIG_valves.csv, the names point into the
+ * mapped file
+ */
+struct LigneVannes
+{
+    std::string_view board;
+    uint8_t boardId;
+    uint8_t id;
+    std::string_view name;
+    int pin;
+    int line; /**< line number in the file, for the error messages */
+};
+
+/**
+ * \brief one line of physicalCONFIG_sensors.csv
+ */
+struct LigneSensors
+{
+    std::string_view board;
+    uint8_t boardId;
+    uint8_t id;
+    std::string_view name;
+    int type;
+    int channel;
+    int line;
+};
+
+/**
+ * \brief valve of a board slot
+ */
+struct ValveSlot
+{
+    char name[PHYS_NAME_LENGTH];
+    uint8_t id;
+    int pin;
+};
+
+/**
+ * \brief sensor of a board slot
+ */
+struct SensorSlot
+{
+    char name[PHYS_NAME_LENGTH];
+    uint8_t id;
+    int type;
+    int channel;
+};
+
+/**
+ * \brief dense component table of one board
+ */
+struct BoardConfig
+{
+    char name[SHM_NAME_LENGTH];
+    uint8_t id;
+    int nbValves;
+    int nbSensors;
+    ValveSlot valves[MAX_VALVES];
+    SensorSlot sensors[MAX_SENSORS];
+};
+
+/**
+ * \brief boards read from the physical CSV files.
+ */
+class PhysicalConfig
+{
+private:
+    BoardConfig boards[MAX_BOARDS];
+    int nbBoards;
+
+    BoardConfig *board(std::string_view name, uint8_t id, statusErrDef &res);
+    statusErrDef readValves(const char *path);
+    statusErrDef readSensors(const char *path);
+
+public:
+    PhysicalConfig();
+    statusErrDef load(const char *valvesPath = PHYS_VALVES_FILE, const char *sensorsPath = PHYS_SENSORS_FILE);
+    const BoardConfig *getBoard(const char *name) const;
+    const BoardConfig *getBoard(int index) const;
+    int getNbBoards() const;
+};
+
+#endif // PHYSICALCONFIG_H
@@ -0,0 +1,304 @@
+/**
+ * \file processImage.cpp
+ * \brief Module of the POWERLINK process image and its transports
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * Errors :
+ * - errLinkPDOout : more sensors than TPDO slots
+ * - errLinkPDOin : more valves than RPDO bits
+ * - errLinkPDOEGin : no SHM_Vanne to receive the general state
+ * - errOplkAllocProcessImage : sync() before link()
+ * - errOplkInit, errSelNetInterface : UDP socket or MN address not usable
+ * - errOplKernelStackDown : the UDP socket failed during an exchange
+ *
+ * The MN is lost after OPL_MN_TIMEOUT_CYCLES cycles without RPDO : the
+ * general state is set to 0 (infoEGsetToZero), so the board falls back
+ * to manual mode with the commands it has.
+ */
+
+#include "processImage.h"
+#include "logger.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+LoopbackTransport::LoopbackTransport()
+    : mnIn{}, mnOut{}, mnWritten(false)
+{
+}
+
+statusErrDef LoopbackTransport::open()
+{
+    return noError;
+}
+
+/**
+ * \brief function to exchange the images with the MN of the process,
+ * PI_OUT is fresh when the MN wrote it since the last exchange.
+ */
+statusErrDef LoopbackTransport::exchange(const PiIn &in, PiOut &out, bool &fresh)
+{
+    mnIn = in;
+    fresh = mnWritten;
+    if (mnWritten)
+        out = mnOut;
+    mnWritten = false;
+    return noError;
+}
+
+void LoopbackTransport::close()
+{
+}
+
+void LoopbackTransport::setOut(const PiOut &out)
+{
+    mnOut = out;
+    mnWritten = true;
+}
+
+const PiIn &LoopbackTransport::getIn() const
+{
+    return mnIn;
+}
+
+UdpTransport::UdpTransport(uint8_t node, const char *mnAddress, uint16_t port)
+    : node(node), mn{}, fd(-1), seq(0), nbSent(0), nbReceived(0), nbInvalid(0)
+{
+    mn.sin_family = AF_INET;
+    mn.sin_port = htons(port);
+    if (inet_pton(AF_INET, mnAddress, &mn.sin_addr) != 1)
+        mn.sin_family = AF_UNSPEC;
+}
+
+UdpTransport::~UdpTransport()
+{
+    close();
+}
+
+/**
+ * \brief function to open a non-blocking socket connected to the MN,
+ * only its datagrams are received.
+ */
+statusErrDef UdpTransport::open()
+{
+    if (mn.sin_family != AF_INET)
+    {
+        fprintf(stderr, "MN address is not an IPv4 address\n");
+        return errSelNetInterface;
+    }
+    fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, (const sockaddr *)&mn, sizeof(mn)) < 0)
+    {
+        perror("MN socket");
+        close();
+        return errOplkInit;
+    }
+    return noError;
+}
+
+/**
+ * \brief function to read every datagram waiting, the last valid PI_OUT
+ * wins, then send PI_IN. Two or three syscalls, none of them waits.
+ */
+statusErrDef UdpTransport::exchange(const PiIn &in, PiOut &out, bool &fresh)
+{
+    fresh = false;
+    if (fd < 0)
+        return errOplKernelStackDown;
+
+    OplFrameHeader header;
+    PiOut image;
+    iovec rx[2] = {{&header, sizeof(header)}, {&image, sizeof(image)}};
+    while (true)
+    {
+        ssize_t n = readv(fd, rx, 2);
+        if (n < 0)
+        {
+            // ECONNREFUSED : no MN listening yet, the next cycle retries
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ECONNREFUSED || errno == EINTR)
+                break;
+            return errOplKernelStackDown;
+        }
+        if ((size_t)n != sizeof(header) + sizeof(image) || header.magic != OPL_FRAME_MAGIC ||
+            header.kind != OPL_FRAME_OUT || header.node != node || header.words != OPL_PI_OUT_WORDS)
+        {
+            nbInvalid++;
+            continue;
+        }
+        out = image;
+        fresh = true;
+        nbReceived++;
+    }
+
+    // the image is sent from where it is, after the header
+    header = {OPL_FRAME_MAGIC, node, OPL_FRAME_IN, OPL_PI_IN_WORDS, ++seq};
+    iovec tx[2] = {{&header, sizeof(header)}, {const_cast<PiIn *>(&in), sizeof(in)}};
+    if (writev(fd, tx, 2) < 0)
+    {
+        if (errno != ECONNREFUSED && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            return errOplKernelStackDown;
+    }
+    else
+        nbSent++;
+    return noError;
+}
+
+void UdpTransport::close()
+{
+    if (fd >= 0)
+        ::close(fd);
+    fd = -1;
+}
+
+uint64_t UdpTransport::getNbSent() const
+{
+    return nbSent;
+}
+
+uint64_t UdpTransport::getNbReceived() const
+{
+    return nbReceived;
+}
+
+uint64_t UdpTransport::getNbInvalid() const
+{
+    return nbInvalid;
+}
+
+ProcessImage::ProcessImage()
+    : in{}, out{}, tpdo{}, valveStates{}, nbTpdo(0), nbRpdo(0), vannes(nullptr), transport(nullptr),
+      boardMode(&mode), lastEG(0), lastCommands(OPL_NO_COMMANDS), missed(0), mnPresent(false), nbExchanges(0), nbFresh(0)
+{
+}
+
+/**
+ * \brief function to compile the PDO map of the board. Called once at init.
+ *
+ * \param sensors SHM_Sensor, slot i is TPDO word i
+ * \param vannes SHM_Vanne, slot i is bit i of the RPDO commands and of the TPDO states
+ * \param transport exchange with the MN, opened here
+ * \param boardMode mode of the board, the global mode of a process running one board
+ * \return statusErrDef of the first link or transport error, or noError.
+ */
+statusErrDef ProcessImage::link(SensorData *sensors, int nbSensors, VanneData *vannes, int nbValves,
+                                PdoTransport *transport, const Mode *boardMode)
+{
+    this->vannes = nullptr;
+    this->transport = nullptr;
+    if (!sensors || nbSensors < 0 || nbSensors > MAX_SENSORS)
+        return errLinkPDOout;
+    if (nbValves < 0 || nbValves > MAX_VALVES)
+        return errLinkPDOin;
+    if (!vannes)
+        return errLinkPDOEGin;
+
+    for (int i = 0; i < nbSensors; i++)
+        tpdo[i] = &sensors->frame.sensors[i].value;
+    for (int i = 0; i < nbValves; i++)
+        valveStates[i] = &vannes->frame.vannes[i].state;
+    nbTpdo = nbSensors;
+    nbRpdo = nbValves;
+    memset(&in, 0, sizeof(in));
+    memset(&out, 0, sizeof(out));
+
+    statusErrDef res = transport ? transport->open() : errOplkInit;
+    if (res != noError)
+        return res;
+    this->vannes = vannes;
+    this->transport = transport;
+    this->boardMode = boardMode;
+    logEvent(logOpl, infoInitOPL, "process image linked (TPDO words, RPDO bits)", nbTpdo + 1, nbRpdo);
+    return noError;
+}
+
+/**
+ * \brief function to exchange the process image, once per cycle in the
+ * control thread, between the acquisition and the decision.
+ *
+ * The RPDO general state is stored in SHM_Vanne when it changes, the
+ * decision step selects it. The RPDO valve bits are the commands in
+ * manual mode, written when they change or when the board enters manual
+ * mode, so the console still toggles valves between two MN changes.
+ */
+statusErrDef ProcessImage::sync()
+{
+    if (!transport)
+        return errOplkAllocProcessImage;
+
+    for (int i = 0; i < nbTpdo; i++)
+        in.sensors[i] = *tpdo[i];
+    uint16_t states = 0;
+    for (int i = 0; i < nbRpdo; i++)
+        states |= (uint16_t)((*valveStates[i] & 1) << i);
+    in.valveStates = states;
+
+    bool fresh = false;
+    statusErrDef res = transport->exchange(in, out, fresh);
+    nbExchanges++;
+    if (!fresh)
+    {
+        if (mnPresent && ++missed >= OPL_MN_TIMEOUT_CYCLES)
+        {
+            mnPresent = false;
+            lastEG = 0;
+            __atomic_store_n(&vannes->generalState, (uint16_t)0, __ATOMIC_RELEASE);
+            logEvent(logOpl, infoEGsetToZero, "MN lost, EG set to 0 (cycles without RPDO)", missed);
+        }
+        return res;
+    }
+
+    nbFresh++;
+    missed = 0;
+    if (!mnPresent)
+    {
+        mnPresent = true;
+        logEvent(logOpl, infoInitOPL, "MN present (EG)", out.generalState);
+    }
+    if (out.generalState != lastEG)
+    {
+        lastEG = out.generalState;
+        __atomic_store_n(&vannes->generalState, lastEG, __ATOMIC_RELEASE);
+    }
+
+    uint16_t commands = out.valveCommands & (uint16_t)((1u << nbRpdo) - 1);
+    if (__atomic_load_n(boardMode, __ATOMIC_RELAXED) != manual)
+        lastCommands = OPL_NO_COMMANDS;
+    else if (commands != lastCommands)
+    {
+        for (int i = 0; i < nbRpdo; i++)
+            __atomic_store_n(&vannes->commands[i], (uint8_t)((commands >> i) & 1), __ATOMIC_RELAXED);
+        lastCommands = commands;
+    }
+    return res;
+}
+
+const PiIn &ProcessImage::getIn() const
+{
+    return in;
+}
+
+const PiOut &ProcessImage::getOut() const
+{
+    return out;
+}
+
+bool ProcessImage::isMnPresent() const
+{
+    return mnPresent;
+}
+
+uint64_t ProcessImage::getNbExchanges() const
+{
+    return nbExchanges;
+}
+
+uint64_t ProcessImage::getNbFresh() const
+{
+    return nbFresh;
+}
@@ -0,0 +1,177 @@
+/**
+ * \file processImage.h
+ * \brief header file of the POWERLINK process image module
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * Contains the process image of the board as a POWERLINK CN and the
+ * transports exchanging it with the MN.
+ *
+ * PI_IN (TPDO, CN to MN, OPL_PI_IN_WORDS words) :
+ *   the value of every sensor slot, then the applied valve bits
+ * PI_OUT (RPDO, MN to CN, OPL_PI_OUT_WORDS words) :
+ *   the general state, then the valve command bits, bit i for valve slot i
+ *
+ * The PDO map is compiled once by link() : each TPDO slot points at the
+ * value of its sensor published in SHM_Sensor, each RPDO bit is the
+ * command of a valve of SHM_Vanne. The cyclic sync() fills PI_IN from
+ * those pointers, exchanges the images and stores the RPDO in SHM_Vanne,
+ * nothing else is copied or looked up. It runs in the control thread,
+ * the only writer of both segments, so no sequence lock is taken.
+ *
+ * The transport is what the openPOWERLINK stack does on the board
+ * (oplk_exchangeProcessImageIn/Out on images linked with
+ * oplk_linkProcessImageObject at the same offsets). Without the stack,
+ * LoopbackTransport stands in for the MN in the same process and
+ * UdpTransport exchanges the images with a stand-in MN (mnStandIn.cpp).
+ */
+
+#ifndef PROCESSIMAGE_H
+#define PROCESSIMAGE_H
+
+#include "configDefine.h"
+#include "statusErrorDefine.h"
+#include "shmLayout.h"
+#include <cstdint>
+#include <netinet/in.h>
+
+/**
+ * \brief TPDO of one CN, sent to the MN every cycle
+ */
+struct PiIn
+{
+    int16_t sensors[MAX_SENSORS]; /**< raw value of each sensor slot */
+    uint16_t valveStates;         /**< bit i set when valve slot i is open */
+};
+
+/**
+ * \brief RPDO of one CN, received from the MN every cycle
+ */
+struct PiOut
+{
+    uint16_t generalState;  /**< requested EG, 0x7777 or 0 for manual mode */
+    uint16_t valveCommands; /**< bit i to open valve slot i, applied in manual mode */
+    int16_t reserved[OPL_PI_OUT_WORDS - 2];
+};
+
+static_assert(sizeof(PiIn) == OPL_PI_IN_WORDS * sizeof(int16_t), "PI_IN must match SIZE_IN / NB_NODES");
+static_assert(sizeof(PiOut) == OPL_PI_OUT_WORDS * sizeof(int16_t), "PI_OUT must match SIZE_OUT / NB_NODES");
+static_assert(MAX_VALVES <= 16, "the valve bits are one int16 word");
+
+/**
+ * \brief header of the UDP frames, the images follow in little endian
+ */
+struct OplFrameHeader
+{
+    uint32_t magic; /**< OPL_FRAME_MAGIC */
+    uint8_t node;   /**< board id of the CN */
+    uint8_t kind;   /**< OPL_FRAME_IN or OPL_FRAME_OUT */
+    uint16_t words; /**< int16 words of the image */
+    uint32_t seq;   /**< frame counter of the sender */
+};
+
+#define OPL_FRAME_MAGIC 0x4C504F43 // "COPL"
+#define OPL_FRAME_IN 1
+#define OPL_FRAME_OUT 2
+#define OPL_NO_COMMANDS 0xFFFF
+
+/**
+ * \brief exchange of the process images with the MN, once per cycle.
+ */
+class PdoTransport
+{
+public:
+    virtual ~PdoTransport() = default;
+    virtual statusErrDef open() = 0;
+
+    /**
+     * \brief function to send PI_IN and get the last PI_OUT of the MN.
+     *
+     * \param fresh set when out received a new image this cycle
+     */
+    virtual statusErrDef exchange(const PiIn &in, PiOut &out, bool &fresh) = 0;
+    virtual void close() = 0;
+};
+
+/**
+ * \brief MN in the same process : the bench or a test writes PI_OUT and
+ * reads PI_IN directly.
+ */
+class LoopbackTransport : public PdoTransport
+{
+private:
+    PiIn mnIn;
+    PiOut mnOut;
+    bool mnWritten; /**< PI_OUT written since the last exchange */
+
+public:
+    LoopbackTransport();
+    statusErrDef open() override;
+    statusErrDef exchange(const PiIn &in, PiOut &out, bool &fresh) override;
+    void close() override;
+    void setOut(const PiOut &out);
+    const PiIn &getIn() const;
+};
+
+/**
+ * \brief images carried in UDP datagrams to and from a stand-in MN.
+ * Non-blocking : the last PI_OUT received wins, a cycle never waits.
+ */
+class UdpTransport : public PdoTransport
+{
+private:
+    uint8_t node;
+    sockaddr_in mn;
+    int fd;
+    uint32_t seq;
+    uint64_t nbSent;
+    uint64_t nbReceived;
+    uint64_t nbInvalid;
+
+public:
+    UdpTransport(uint8_t node, const char *mnAddress, uint16_t port = OPL_UDP_PORT);
+    ~UdpTransport() override;
+    statusErrDef open() override;
+    statusErrDef exchange(const PiIn &in, PiOut &out, bool &fresh) override;
+    void close() override;
+    uint64_t getNbSent() const;
+    uint64_t getNbReceived() const;
+    uint64_t getNbInvalid() const;
+};
+
+/**
+ * \brief process image of the board and its PDO map.
+ */
+class ProcessImage
+{
+private:
+    PiIn in;
+    PiOut out;
+    const int16_t *tpdo[MAX_SENSORS];    /**< published value of each sensor slot */
+    const uint8_t *valveStates[MAX_VALVES]; /**< published state of each valve slot */
+    int nbTpdo;
+    int nbRpdo;
+    VanneData *vannes;
+    PdoTransport *transport;
+    const Mode *boardMode; /**< mode of the board, the RPDO valve bits apply in manual mode */
+    uint16_t lastEG;
+    uint16_t lastCommands; /**< RPDO valve bits last applied, OPL_NO_COMMANDS outside of manual mode */
+    int missed;           /**< cycles since the last RPDO */
+    bool mnPresent;
+    uint64_t nbExchanges;
+    uint64_t nbFresh;
+
+public:
+    ProcessImage();
+    statusErrDef link(SensorData *sensors, int nbSensors, VanneData *vannes, int nbValves, PdoTransport *transport,
+                      const Mode *boardMode = &mode);
+    statusErrDef sync();
+    const PiIn &getIn() const;
+    const PiOut &getOut() const;
+    bool isMnPresent() const;
+    uint64_t getNbExchanges() const;
+    uint64_t getNbFresh() const;
+};
+
+#endif // PROCESSIMAGE_H
@@ -6,18 +6,17 @@
  */
 
 #include "sensor.h"
+#include "hal.h"
+
+#include <unistd.h>
 
 /**
- * \brief sysfs channel file array
- */
-static int fd;
-/**
- * \brief sensor values array
+ * \brief sysfs MCP3008 files path, IIOSYSPATH unless overridden
  */
-int16_t valSensor;
+static const char *iioPath = IIOSYSPATH;
 
 Sensor::Sensor(const std::string &name, uint8_t id, int type, int channel)
-    : name(name), id(id), type(type), channel(channel), value(0)
+    : name(name), id(id), type(type), channel(channel), value(0), fd(-1), adc(nullptr)
 {
 }
 
@@ -39,9 +38,21 @@ statusErrDef Sensor::initSensor()
     switch (type)
     { // étape importante pour le modbus
     case 1:
+        // the channel is opened once and kept for every sample
+        if (fd < 0)
+        {
+            fd = openAdc();
+            if (fd == ADC_READ_ERROR)
+            {
+                fd = -1;
+                return errOpenAdc;
+            }
+        }
         break;
-    case 2: // modbus
-        break;
+    case 2: // modbus, the registers are read by ModbusBus
+        return noError;
+    case 3: // MCP3008 through the IIO triggered buffer, filled by IioBuffer
+        return noError;
     default:
         break;
     }
@@ -67,44 +78,32 @@ statusErrDef Sensor::extinctSensor()
 }
 
 /**
- * \brief function the read the channels of the
- * MCP3008 by opening, reading and closing the sysfs files.
+ * \brief function to read the channel of the
+ * MCP3008 opened by initSensor(), on the ADC backend.
  *
  * \return statusErrDef that values errOpenAdc
- * when a sysfs file of the MCP3008 fails to open
+ * when the sysfs file of the MCP3008 is not open
  * or errReadAdc when a sysfs file read of the MCP3008 fails
  * or noError when the function exits successfully.
  */
 statusErrDef Sensor::readChannel()
 {
-    statusErrDef res = noError;
-    fd = 0;
-    valSensor = 0;
-    // we open the sysfs files of the MCP3008 channels
-    fd = openAdc();
-    if (fd == ADC_READ_ERROR)
-    {
-        res = errOpenAdc;
-        return res;
-    }
+    // buffered channels are demultiplexed by IioBuffer::readScans()
+    // and the modbus registers are read by ModbusBus::poll()
+    if (type == 2 || type == 3)
+        return noError;
 
-    // we read the values inside those files
-    valSensor = readAdc(fd);
+    if (fd < 0)
+        return errOpenAdc;
 
-    // reset for next read
-    lseek(fd, 0, SEEK_SET);
+    // one read of the backend per sample, a pread() on sysfs
+    int val = readAdc(fd);
+    if (val == ADC_READ_ERROR)
+        return errReadAdc;
 
-    if (valSensor == ADC_READ_ERROR)
-    {
-        res = errReadAdc;
-        return res;
-    }
     // up to date the value
-    value = valSensor;
-
-    // we close them for the next read
-    closeAdc();
-    return res;
+    value = val;
+    return noError;
 }
 
 /**
@@ -119,13 +118,14 @@ statusErrDef Sensor::closeAdc()
 {
     statusErrDef res = noError;
     int ret = 0;
-    if (fd > 0)
+    if (fd >= 0 && adc)
     {
-        ret = close(fd);
+        ret = adc->close(fd);
         if (ret < 0)
         {
             res = errCloseAdc;
         }
+        fd = -1;
     }
 
     return res;
@@ -133,49 +133,58 @@ statusErrDef Sensor::closeAdc()
 
 /**
  * \brief function to read the value of a sensor
- * from a sysfs file of the MCP3008 kernel module.
+ * from its channel of the ADC backend.
  *
- * \param fd the file location
- * \return ADC_READ_ERROR when the file reading fails
+ * \param fd the handle of the channel
+ * \return ADC_READ_ERROR when the reading fails
  * or the value of a sensor.
  */
 int Sensor::readAdc(int fd)
 {
-    char buff[8];
-    buff[7] = 0;
-
-    int val = ADC_READ_ERROR;
+    int val = adc->read(fd);
+    if (val == ADC_READ_ERROR)
+        logEvent(logSensor, errReadAdc, "read failed (channel, errno)", channel, errno);
+    return val;
+}
 
-    memset(buff, 0, sizeof(buff));
+/**
+ * \brief function to parse the decimal text of an in_voltageN_raw file.
+ *
+ * \param buff the text, not null terminated
+ * \param n the number of bytes of buff
+ * \return ADC_READ_ERROR when the text is not a number
+ * or the value of the sensor.
+ */
+int Sensor::parseAdc(const char *buff, ssize_t n)
+{
+    int i = 0;
+    bool neg = (n > 0 && buff[0] == '-');
+    if (neg)
+        i = 1;
+    if (i >= n || buff[i] < '0' || buff[i] > '9')
+        return ADC_READ_ERROR;
 
-    // read a specific length and convert it to an integer
-    if (read(fd, buff, 8) < 0)
-        perror("read()");
-    else
-        val = atoi(buff);
+    int val = 0;
+    for (; i < n && buff[i] >= '0' && buff[i] <= '9'; i++)
+        val = val * 10 + (buff[i] - '0');
 
-    return val;
+    return neg ? -val : val;
 }
 
 /**
- * \brief function to open a sysfs file
- * of the MCP3008 kernel module.
+ * \brief function to open the channel on the ADC backend
+ * selected at startup, sysfs or simulated.
  *
- * \param adc the MCP3008 channel number
- * \return ADC_READ_ERROR when the file opening fails
- * or the file location.
+ * \return ADC_READ_ERROR when the channel opening fails
+ * or the handle of the channel.
  */
 int Sensor::openAdc()
 {
-    char path[128];
-
-    // a specific channel sysfs file path
-    sprintf(path, "%sin_voltage%d_raw", IIOSYSPATH, channel);
-    int fd = open(path, O_RDONLY);
+    adc = &halAdc();
+    int fd = adc->open(channel);
     if (fd < 0)
     {
-        perror("open()");
-        printf("%s\n", path);
+        logEvent(logSensor, errOpenAdc, "open() failed (channel, errno)", channel, errno);
         return ADC_READ_ERROR;
     }
 
@@ -186,3 +195,45 @@ void Sensor::print_value() const
 {
     std::cout << "La valeur du " << name << " est : " << value << std::endl;
 }
+
+/**
+ * \brief function to change the directory holding the
+ * in_voltageN_raw files of the sysfs backend, e.g. a fake sysfs tree for benchmarks.
+ * Must be called before initSensor().
+ *
+ * \param path the directory, with a trailing '/'
+ */
+void Sensor::setIioPath(const char *path)
+{
+    iioPath = path;
+}
+
+const char *Sensor::getIioPath()
+{
+    return iioPath;
+}
+
+const std::string &Sensor::getName() const
+{
+    return name;
+}
+
+int Sensor::getChannel() const
+{
+    return channel;
+}
+
+int Sensor::getType() const
+{
+    return type;
+}
+
+int16_t Sensor::getValue() const
+{
+    return value;
+}
+
+void Sensor::setValue(int16_t val)
+{
+    value = val;
+}
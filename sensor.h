@@ -19,6 +19,7 @@
 
 #include "configDefine.h"
 #include "statusErrorDefine.h"
+#include "logger.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <fcntl.h>
@@ -51,6 +52,8 @@ extern "C"
 }
 #endif
 
+class AdcBackend;
+
 /**
  * \brief sensor module class.
  *
@@ -58,11 +61,13 @@ extern "C"
 class Sensor
 {
 private:
-    std::string name; /**< Valve name */
+    std::string name; /**< Sensor name */
     uint8_t id;
     int16_t value;
     int type;
     int channel;
+    int fd; /**< handle of the channel in adc, kept open between samples */
+    AdcBackend *adc; /**< ADC of the channel, the one selected at startup */
 
 public:
     Sensor(const std::string &name, uint8_t id, int type, int channel);
@@ -72,8 +77,16 @@ public:
     statusErrDef readChannel();
     statusErrDef closeAdc();
     int readAdc(int fd);
+    static int parseAdc(const char *buff, ssize_t n);
     int openAdc();
     void print_value() const;
+    const std::string &getName() const;
+    int getChannel() const;
+    int getType() const;
+    int16_t getValue() const;
+    void setValue(int16_t val);
+    static void setIioPath(const char *path);
+    static const char *getIioPath();
 };
 
 #endif // SENSOR_H
@@ -0,0 +1,184 @@
+/**
+ * \file sensorHealth.cpp
+ * \brief Module of the sensor health engine
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * The changes of the health word of a channel are logged with the code
+ * of its most severe fault : errReadAdc, errSensorDisconnected,
+ * errSensorStuck, errSensorSaturated, errSensorStep, errSensorNoisy, or
+ * infoReadChannels once the channel is healthy again.
+ */
+
+#include "sensorHealth.h"
+#include "logger.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+SensorHealth::SensorHealth()
+    : nbSensors(0), boardId(0), statsSeq(0)
+{
+    BoardConfig none = {};
+    init(none);
+}
+
+/**
+ * \brief function to reset the statistics and the detectors of the
+ * sensors of a board, before the first acquisition.
+ */
+void SensorHealth::init(const BoardConfig &board)
+{
+    nbSensors = board.nbSensors;
+    boardId = board.id;
+    for (int s = 0; s < MAX_SENSORS; s++)
+    {
+        // the modbus registers use the whole int16 range, they have no rail
+        bool mcp = s < board.nbSensors && board.sensors[s].type != 2;
+        railLow[s] = mcp ? 0 : INT16_MIN;
+        railHigh[s] = mcp ? ADC_MAX_COUNT : INT16_MAX;
+        last[s] = 0;
+        sameRun[s] = 0;
+        railRun[s] = 0;
+        errorRun[s] = 0;
+        diffMsd[s] = 0.0f;
+        work.count[s] = 0;
+        work.errors[s] = 0;
+        work.mean[s] = 0.0;
+        work.m2[s] = 0.0;
+        work.min[s] = INT16_MAX;
+        work.max[s] = INT16_MIN;
+        work.health[s] = 0;
+    }
+    seqlockPublish(&statsSeq, &stats, work);
+}
+
+/**
+ * \brief function to get the code of the most severe fault of a health
+ * word, infoReadChannels for a healthy channel.
+ */
+statusErrDef SensorHealth::faultCode(uint16_t health)
+{
+    if (health & SENSOR_HEALTH_DISCONNECTED)
+        return errSensorDisconnected;
+    if (health & SENSOR_HEALTH_ERROR)
+        return errReadAdc;
+    if (health & SENSOR_HEALTH_STUCK)
+        return errSensorStuck;
+    if (health & SENSOR_HEALTH_SATURATED)
+        return errSensorSaturated;
+    if (health & SENSOR_HEALTH_STEP)
+        return errSensorStep;
+    if (health & SENSOR_HEALTH_NOISY)
+        return errSensorNoisy;
+    return infoReadChannels;
+}
+
+/**
+ * \brief function to update the statistics and the detectors with the
+ * samples of one acquisition. Called by the control loop, without
+ * allocation or pass over past samples.
+ *
+ * \param values the value of each slot, a failed read or ADC_READ_ERROR
+ * is replaced by the last good value of the slot
+ * \param valid bit i set when values[i] was read without error, cleared
+ * for the slots whose health makes the sample unusable
+ * \param health receives the SENSOR_HEALTH_* word of each slot
+ * \return the mask of the slots whose health word is not 0.
+ */
+uint32_t SensorHealth::update(int16_t *values, uint32_t &valid, uint16_t *health)
+{
+    const float noiseAlpha = 1.0f / HEALTH_NOISE_SAMPLES;
+    const float noiseHigh = 2.0f * HEALTH_NOISE_COUNTS * HEALTH_NOISE_COUNTS;
+    const float noiseLow = noiseHigh / 4.0f;
+    uint32_t faulty = 0;
+    uint32_t usable = 0;
+
+    for (int s = 0; s < nbSensors; s++)
+    {
+        uint16_t word = work.health[s] & SENSOR_HEALTH_NOISY;
+        int16_t v = values[s];
+        if (!((valid >> s) & 1) || v == ADC_READ_ERROR)
+        {
+            word |= SENSOR_HEALTH_ERROR;
+            work.errors[s]++;
+            if (++errorRun[s] >= HEALTH_DISCONNECT_ERRORS)
+                word |= SENSOR_HEALTH_DISCONNECTED;
+            // the stuck and saturation runs are kept, the value is the last good one
+            word |= (sameRun[s] >= HEALTH_STUCK_SAMPLES ? SENSOR_HEALTH_STUCK : 0) |
+                    (railRun[s] >= HEALTH_SATURATED_SAMPLES ? SENSOR_HEALTH_SATURATED : 0);
+            values[s] = last[s];
+        }
+        else
+        {
+            errorRun[s] = 0;
+            uint64_t n = ++work.count[s];
+            if (n > 1)
+            {
+                int diff = v - last[s];
+                sameRun[s] = diff == 0 ? sameRun[s] + 1 : 1;
+                if (diff > HEALTH_MAX_STEP || diff < -HEALTH_MAX_STEP)
+                    word |= SENSOR_HEALTH_STEP;
+                diffMsd[s] += noiseAlpha * ((float)diff * diff - diffMsd[s]);
+            }
+            else
+                sameRun[s] = 1;
+            railRun[s] = (v <= railLow[s] || v >= railHigh[s]) ? railRun[s] + 1 : 0;
+
+            // Welford
+            double delta = v - work.mean[s];
+            work.mean[s] += delta / (double)n;
+            work.m2[s] += delta * (v - work.mean[s]);
+            if (v < work.min[s])
+                work.min[s] = v;
+            if (v > work.max[s])
+                work.max[s] = v;
+            last[s] = v;
+
+            if (sameRun[s] >= HEALTH_STUCK_SAMPLES)
+                word |= SENSOR_HEALTH_STUCK;
+            if (railRun[s] >= HEALTH_SATURATED_SAMPLES)
+                word |= SENSOR_HEALTH_SATURATED;
+            // hysteresis : raised above noiseHigh, cleared below noiseLow
+            if (diffMsd[s] > noiseHigh)
+                word |= SENSOR_HEALTH_NOISY;
+            else if (diffMsd[s] < noiseLow)
+                word &= ~SENSOR_HEALTH_NOISY;
+        }
+
+        if (word != work.health[s])
+            logEvent(logSensor, faultCode(word), "sensor health changed (board, slot, health)", boardId, s, word);
+        work.health[s] = word;
+        health[s] = word;
+        faulty |= (uint32_t)(word != 0) << s;
+        usable |= (uint32_t)((word & SENSOR_HEALTH_UNUSABLE) == 0) << s;
+    }
+    valid &= usable;
+    seqlockPublish(&statsSeq, &stats, work);
+    return faulty;
+}
+
+/**
+ * \brief function to copy the statistics, from any thread.
+ *
+ * \return false when no consistent copy could be made.
+ */
+bool SensorHealth::getStats(HealthStats &out) const
+{
+    return seqlockRead(&statsSeq, &stats, out);
+}
+
+void SensorHealth::printStats(const BoardConfig &board) const
+{
+    HealthStats s;
+    if (!getStats(s))
+        return;
+    for (int i = 0; i < nbSensors && i < board.nbSensors; i++)
+    {
+        double sd = s.count[i] > 1 ? sqrt(s.m2[i] / (double)(s.count[i] - 1)) : 0.0;
+        printf("  %-10s %10llu samples, mean %8.2f, sd %7.2f, min %6d, max %6d, %llu errors, health 0x%04X\n",
+               board.sensors[i].name, (unsigned long long)s.count[i], s.mean[i], sd, s.count[i] ? s.min[i] : 0,
+               s.count[i] ? s.max[i] : 0, (unsigned long long)s.errors[i], s.health[i]);
+    }
+}
@@ -0,0 +1,88 @@
+/**
+ * \file sensorHealth.h
+ * \brief header file of the sensor health engine
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * Contains the running statistics and the fault detection of the
+ * channels of a board, updated once per acquisition in O(1) per channel :
+ * no history is kept, every detector is a counter or a running moment.
+ *
+ * - statistics : count, Welford mean and variance, min, max, read errors
+ * - SENSOR_HEALTH_ERROR : the read of this cycle failed, or returned
+ *   ADC_READ_ERROR as a value ; the last good value is published instead
+ * - SENSOR_HEALTH_DISCONNECTED : HEALTH_DISCONNECT_ERRORS reads in a row failed
+ * - SENSOR_HEALTH_STUCK : HEALTH_STUCK_SAMPLES identical values in a row
+ * - SENSOR_HEALTH_SATURATED : HEALTH_SATURATED_SAMPLES values in a row on
+ *   a rail of the MCP3008 (0 or ADC_MAX_COUNT), types 1 and 3 only
+ * - SENSOR_HEALTH_STEP : the value moved by more than HEALTH_MAX_STEP
+ *   counts since the previous good sample
+ * - SENSOR_HEALTH_NOISY : the rms of the sample to sample differences,
+ *   averaged over about HEALTH_NOISE_SAMPLES samples, is above
+ *   HEALTH_NOISE_COUNTS * sqrt(2) ; cleared below half of it
+ *
+ * ERROR, DISCONNECTED and SATURATED make the sample unusable
+ * (SENSOR_HEALTH_UNUSABLE). STUCK, STEP and NOISY are warnings : a calm
+ * process can hold one count for seconds.
+ *
+ * The health word of every channel and the mask of the faulty channels
+ * are published with the frame, the statistics under their own sequence
+ * lock. A change of the health word of a channel is logged once.
+ */
+
+#ifndef SENSORHEALTH_H
+#define SENSORHEALTH_H
+
+#include "configDefine.h"
+#include "statusErrorDefine.h"
+#include "shmLayout.h"
+#include "physicalConfig.h"
+#include <cstdint>
+
+/**
+ * \brief running statistics of the channels, one lane per slot
+ */
+struct HealthStats
+{
+    uint64_t count[MAX_SENSORS];  /**< good samples */
+    uint64_t errors[MAX_SENSORS]; /**< failed reads */
+    double mean[MAX_SENSORS];     /**< Welford mean of the good samples */
+    double m2[MAX_SENSORS];       /**< Welford sum of the squared deviations */
+    int16_t min[MAX_SENSORS];
+    int16_t max[MAX_SENSORS];
+    uint16_t health[MAX_SENSORS]; /**< SENSOR_HEALTH_* of the last sample */
+};
+
+/**
+ * \brief health engine of the sensors of one board.
+ *
+ * update() is called by the cycle thread, the statistics can be read
+ * from any other thread with getStats().
+ */
+class SensorHealth
+{
+private:
+    int nbSensors;
+    uint8_t boardId;
+    int16_t railHigh[MAX_SENSORS]; /**< saturation rails, INT16_MAX/INT16_MIN to disable */
+    int16_t railLow[MAX_SENSORS];
+    int16_t last[MAX_SENSORS];     /**< last good value */
+    uint32_t sameRun[MAX_SENSORS]; /**< identical values in a row */
+    uint32_t railRun[MAX_SENSORS]; /**< values on a rail in a row */
+    uint32_t errorRun[MAX_SENSORS]; /**< failed reads in a row */
+    float diffMsd[MAX_SENSORS];    /**< mean of the squared sample to sample differences */
+    HealthStats work;              /**< statistics updated by the cycle thread */
+    uint32_t statsSeq;             /**< sequence lock of stats */
+    HealthStats stats;             /**< copy of work published every cycle */
+
+public:
+    SensorHealth();
+    void init(const BoardConfig &board);
+    uint32_t update(int16_t *values, uint32_t &valid, uint16_t *health);
+    bool getStats(HealthStats &out) const;
+    void printStats(const BoardConfig &board) const;
+    static statusErrDef faultCode(uint16_t health);
+};
+
+#endif // SENSORHEALTH_H
@@ -0,0 +1,246 @@
+/**
+ * \file sequencer.cpp
+ * \brief Module compiling the general state CSV files into valve bitmasks
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * Errors, reported with the file and line, the first one is returned :
+ * - errOpenEGFile : liaisonEGEtat.csv missing, line malformed, EG outside
+ *   of EG_MIN..EG_MAX, linked twice or path longer than MAX_PATH_LENGTH
+ * - errOpenEtatsFile : a general state file missing, line malformed or
+ *   naming a valve the board doesn't have
+ * - errValueIsNotBinary : a valve value other than 0 or 1
+ * - errAllocDataEG, errAllocDataEtats : rows or table can't be allocated
+ * An EG whose state file is invalid is left unlinked.
+ */
+
+#include "sequencer.h"
+#include "csvReader.h"
+#include "logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+Sequencer::Sequencer()
+    : stateOfEG{}, masks(nullptr), nbStates(0), current(0)
+{
+}
+
+Sequencer::~Sequencer()
+{
+    free(masks);
+}
+
+/**
+ * \brief function to compile a general state file into a valve bitmask.
+ *
+ * \param board the valve slots of the board
+ * \param path the general state file
+ * \param arena the rows of the file, reset first
+ * \param mask receives bit i set when valve slot i is open in the state
+ */
+statusErrDef Sequencer::readState(const BoardConfig &board, const char *path, CsvArena &arena, uint32_t &mask)
+{
+    CsvFile file;
+    if (!file.open(path))
+    {
+        perror(path);
+        return errOpenEtatsFile;
+    }
+
+    arena.reset();
+    LigneCSV *rows = arena.alloc<LigneCSV>(file.countLines());
+    if (!rows)
+        return errAllocDataEtats;
+
+    statusErrDef res = noError;
+    std::string_view line;
+    int nbRows = 0;
+    while (file.nextLine(line, "board"))
+    {
+        std::string_view fields[3];
+        LigneCSV &row = rows[nbRows];
+        if (csvSplitFields(line, fields, 3) != 3 || !csvToInt(fields[2], row.value))
+        {
+            csvReport(path, file.getLineNumber(), errOpenEtatsFile, "expected board;valve;value");
+            if (res == noError)
+                res = errOpenEtatsFile;
+            continue;
+        }
+        row.board = fields[0];
+        row.valve = fields[1];
+        row.line = file.getLineNumber();
+        nbRows++;
+    }
+
+    // the valve names are resolved to slots here, never in the control loop
+    std::string_view boardName(board.name);
+    std::string_view valveNames[MAX_VALVES];
+    for (int v = 0; v < board.nbValves; v++)
+        valveNames[v] = board.valves[v].name;
+    mask = 0;
+    for (int r = 0; r < nbRows; r++)
+    {
+        const LigneCSV &row = rows[r];
+        if (row.board != boardName)
+            continue;
+        int slot = -1;
+        for (int v = 0; v < board.nbValves && slot < 0; v++)
+            if (valveNames[v] == row.valve)
+                slot = v;
+        statusErrDef err = noError;
+        if (slot < 0)
+        {
+            err = errOpenEtatsFile;
+            csvReport(path, row.line, err, "valve not on the board");
+        }
+        else if (row.value != 0 && row.value != 1)
+        {
+            err = errValueIsNotBinary;
+            csvReport(path, row.line, err, "valve value must be 0 or 1");
+        }
+        if (err != noError)
+        {
+            if (res == noError)
+                res = err;
+            continue;
+        }
+        if (row.value)
+            mask |= 1u << slot;
+    }
+    return res;
+}
+
+/**
+ * \brief function to read liaisonEGEtat.csv and every general state file
+ * it links, once, before the control loop starts.
+ *
+ * \param board the valve slots of the board
+ * \param dir the directory of the CSV files, with a trailing '/'
+ * \return statusErrDef of the first invalid file or line, or noError.
+ */
+statusErrDef Sequencer::load(const BoardConfig &board, const char *dir)
+{
+    free(masks);
+    masks = nullptr;
+    nbStates = 0;
+    current = 0;
+    memset(stateOfEG, 0, sizeof(stateOfEG));
+
+    char path[MAX_PATH_LENGTH];
+    snprintf(path, sizeof(path), "%s%s", dir, EG_LINK_FILE);
+    CsvFile file;
+    if (!file.open(path))
+    {
+        perror(path);
+        return errOpenEGFile;
+    }
+
+    CsvArena arena;
+    int nbLines = file.countLines();
+    LigneEG *rows = arena.alloc<LigneEG>(nbLines);
+    int *stateOfRow = arena.alloc<int>(nbLines);
+    if (!rows || !stateOfRow)
+        return errAllocDataEG;
+
+    statusErrDef res = noError;
+    std::string_view line;
+    int nbRows = 0;
+    while (file.nextLine(line, "EG"))
+    {
+        std::string_view fields[2];
+        int eg;
+        if (csvSplitFields(line, fields, 2) != 2 || !csvToInt(fields[0], eg) || eg < EG_MIN || eg > EG_MAX ||
+            fields[1].empty())
+        {
+            csvReport(path, file.getLineNumber(), errOpenEGFile, "expected EG;file with EG_MIN <= EG <= EG_MAX");
+            if (res == noError)
+                res = errOpenEGFile;
+            continue;
+        }
+        LigneEG &row = rows[nbRows++];
+        row.eg = (uint16_t)eg;
+        row.file = fields[1];
+        row.line = file.getLineNumber();
+    }
+
+    masks = (uint32_t *)malloc(sizeof(uint32_t) * (nbRows ? nbRows : 1));
+    if (!masks)
+        return errAllocDataEtats;
+
+    // one arena for the rows of every state file, reset between files
+    CsvArena stateArena;
+    for (int r = 0; r < nbRows; r++)
+    {
+        const LigneEG &row = rows[r];
+        stateOfRow[r] = -1;
+        if (stateOfEG[row.eg - EG_MIN])
+        {
+            csvReport(path, row.line, errOpenEGFile, "EG already linked");
+            if (res == noError)
+                res = errOpenEGFile;
+            continue;
+        }
+
+        // a state file shared by several EG is read once
+        for (int p = 0; p < r && stateOfRow[r] < 0; p++)
+            if (stateOfRow[p] >= 0 && rows[p].file == row.file)
+                stateOfRow[r] = stateOfRow[p];
+        if (stateOfRow[r] < 0)
+        {
+            char statePath[MAX_PATH_LENGTH];
+            int len = snprintf(statePath, sizeof(statePath), "%s%.*s", dir, (int)row.file.size(), row.file.data());
+            uint32_t mask;
+            statusErrDef err = errOpenEGFile;
+            if (len >= (int)sizeof(statePath))
+                csvReport(path, row.line, err, "path longer than MAX_PATH_LENGTH");
+            else
+                err = readState(board, statePath, stateArena, mask);
+            if (err != noError)
+            {
+                if (res == noError)
+                    res = err;
+                continue;
+            }
+            masks[nbStates] = mask;
+            stateOfRow[r] = nbStates++;
+        }
+        stateOfEG[row.eg - EG_MIN] = (uint16_t)(stateOfRow[r] + 1);
+    }
+
+    logEvent(logCSV, res == noError ? infoInitCSV : res, "general states loaded (states, EG lines)", nbStates, nbRows);
+    return res;
+}
+
+/**
+ * \brief function to get the valve bitmask of a general state, O(1),
+ * without file access. Called by the control loop.
+ *
+ * \param eg the general state code
+ * \param mask receives the valve bitmask when the EG is linked
+ * \return statusErrDef that values errEGNotFoundInFile when the EG is
+ * not linked, infoEGNotChanged when it is the current EG,
+ * infoCSVChanged when it becomes the current EG.
+ */
+statusErrDef Sequencer::select(uint16_t eg, uint32_t &mask)
+{
+    if (eg < EG_MIN || eg > EG_MAX || !stateOfEG[eg - EG_MIN])
+        return errEGNotFoundInFile;
+
+    mask = masks[stateOfEG[eg - EG_MIN] - 1];
+    if (eg == current)
+        return infoEGNotChanged;
+    current = eg;
+    return infoCSVChanged;
+}
+
+int Sequencer::getNbStates() const
+{
+    return nbStates;
+}
+
+uint16_t Sequencer::getCurrent() const
+{
+    return current;
+}
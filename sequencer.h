@@ -0,0 +1,72 @@
+/**
+ * \file sequencer.h
+ * \brief header file of the automatic sequencing module
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * Contains the general state table of a board. liaisonEGEtat.csv and the
+ * general state CSV files are read once at initialisation and compiled
+ * into one valve bitmask per state, so a change of general state in the
+ * control loop is an array lookup followed by one bulk valve write.
+ *
+ * liaisonEGEtat.csv : EG;file, the EG in hexadecimal (0x1001) or decimal
+ * general state file : board;valve;value, value 0 (closed) or 1 (open)
+ *
+ * The valves of the board missing from a state file are closed in that state.
+ */
+
+#ifndef SEQUENCER_H
+#define SEQUENCER_H
+
+#include "configDefine.h"
+#include "statusErrorDefine.h"
+#include "physicalConfig.h"
+#include "csvReader.h"
+#include <cstdint>
+#include <string_view>
+
+/**
+ * \brief one line of liaisonEGEtat.csv, the file name points into the mapped file
+ */
+struct LigneEG
+{
+    uint16_t eg;
+    std::string_view file;
+    int line;
+};
+
+/**
+ * \brief one line of a general state file, the names point into the mapped file
+ */
+struct LigneCSV
+{
+    std::string_view board;
+    std::string_view valve;
+    int value;
+    int line;
+};
+
+/**
+ * \brief general state table of one board.
+ */
+class Sequencer
+{
+private:
+    uint16_t stateOfEG[EG_MAX - EG_MIN + 1]; /**< state index + 1 of each EG, 0 when not linked */
+    uint32_t *masks;                         /**< valve bitmask of each state, bit i for valve slot i */
+    int nbStates;
+    uint16_t current;                        /**< last selected EG, 0 before the first one */
+
+    statusErrDef readState(const BoardConfig &board, const char *path, CsvArena &arena, uint32_t &mask);
+
+public:
+    Sequencer();
+    ~Sequencer();
+    statusErrDef load(const BoardConfig &board, const char *dir = CSV_DIR);
+    statusErrDef select(uint16_t eg, uint32_t &mask);
+    int getNbStates() const;
+    uint16_t getCurrent() const;
+};
+
+#endif // SEQUENCER_H
@@ -0,0 +1,275 @@
+/**
+ * \file shmLayout.h
+ * \brief layout of the shared memory segments of a CAC board
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * The segments behind SHM_Sensor and SHM_Vanne only hold values,
+ * timestamps, sequence numbers and status codes so any process can map
+ * them and read them in place. The Sensor and Valve driver objects stay
+ * in the process that owns the board.
+ *
+ * The segments are named after the board, SHM_Sensor "_" name and
+ * SHM_Vanne "_" name (e.g. /sensor_shm_CACMO), so the boards of a rig run
+ * on one host, in one process or in several.
+ *
+ * A sensor sample holds the raw counts of the channel, the frame also
+ * holds the values conditioned by the Conditioner of the board, in the
+ * units listed once in the segment, and the health word of each channel
+ * from its SensorHealth. A sample never holds ADC_READ_ERROR : a failed
+ * read keeps the last good value, with its status and health word set.
+ *
+ * Each segment publishes a frame protected by a sequence lock : the
+ * writer never waits, and readers, in this process or another one,
+ * retry until they copied a frame that was not modified meanwhile.
+ *
+ * The segment SHM_Command "_" name carries the valve commands of any
+ * number of clients to the cycle thread of the board, and their
+ * acknowledgements back, see commandQueue.h.
+ *
+ * Any change of the structures below must increase SHM_LAYOUT_VERSION.
+ */
+
+#ifndef SHMLAYOUT_H
+#define SHMLAYOUT_H
+
+#include "configDefine.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * \brief "CAC1" in little endian, first word of every segment
+ */
+#define SHM_LAYOUT_MAGIC 0x31434143
+/**
+ * \brief version of the structures of this file
+ */
+#define SHM_LAYOUT_VERSION 7
+/**
+ * \brief cache line size of the targets (Raspberry Pi and x86)
+ */
+#define CACHE_LINE_SIZE 64
+/**
+ * \brief maximum length of the board name, '\0' included
+ */
+#define SHM_NAME_LENGTH 16
+
+/**
+ * \brief header of a segment, written once by CAC::init()
+ */
+struct alignas(CACHE_LINE_SIZE) ShmHeader
+{
+    uint32_t magic;                  /**< SHM_LAYOUT_MAGIC once the segment is ready */
+    uint16_t version;                /**< SHM_LAYOUT_VERSION */
+    uint16_t headerSize;             /**< sizeof(ShmHeader) */
+    uint32_t totalSize;              /**< size of the whole segment */
+    uint8_t boardId;                 /**< CAC board id */
+    uint8_t count;                   /**< number of valid entries */
+    uint16_t reserved;
+    char boardName[SHM_NAME_LENGTH]; /**< CAC board name */
+};
+
+/**
+ * \brief bits of the health word of a channel, see sensorHealth.h
+ */
+#define SENSOR_HEALTH_ERROR 0x0001        /**< the read of this cycle failed */
+#define SENSOR_HEALTH_DISCONNECTED 0x0002 /**< the reads fail in a row */
+#define SENSOR_HEALTH_STUCK 0x0004        /**< the value doesn't change anymore */
+#define SENSOR_HEALTH_SATURATED 0x0008    /**< the value stays on a rail of the ADC */
+#define SENSOR_HEALTH_STEP 0x0010         /**< the value jumped since the previous sample */
+#define SENSOR_HEALTH_NOISY 0x0020        /**< the noise is above HEALTH_NOISE_COUNTS */
+/**
+ * \brief health bits that make a sample unusable : its status is set to
+ * the fault, so the interlock conditions on the channel are not met
+ */
+#define SENSOR_HEALTH_UNUSABLE (SENSOR_HEALTH_ERROR | SENSOR_HEALTH_DISCONNECTED | SENSOR_HEALTH_SATURATED)
+
+/**
+ * \brief last sample of a sensor
+ */
+struct SensorSample
+{
+    int16_t value;      /**< raw ADC counts */
+    uint16_t status;    /**< statusErrDef of the last read */
+    uint32_t seq;       /**< cycle that produced the value */
+    uint64_t timestamp; /**< CLOCK_MONOTONIC time of the read in ns */
+};
+
+/**
+ * \brief applied state of a valve
+ */
+struct ValveSample
+{
+    uint8_t state;      /**< state applied to the GPIO line (1 open, 0 closed) */
+    uint8_t reserved;
+    uint16_t status;    /**< statusErrDef of the last actuation */
+    uint32_t seq;         /**< cycle of the last actuation */
+    uint64_t timestamp;   /**< CLOCK_MONOTONIC time of the last actuation in ns */
+    uint64_t transitions; /**< real state changes since init, for solenoid wear */
+    uint64_t reserved2;
+};
+
+/**
+ * \brief channel vector published at the end of an acquisition
+ */
+struct SensorFrame
+{
+    uint64_t cycle;     /**< acquisition cycle */
+    uint64_t timestamp; /**< CLOCK_MONOTONIC end of the cycle in ns */
+    SensorSample sensors[MAX_SENSORS];
+    float values[MAX_SENSORS]; /**< conditioned values in the units of SensorData, NaN before the first sample */
+    uint16_t health[MAX_SENSORS]; /**< SENSOR_HEALTH_* of each channel, 0 when healthy */
+    uint32_t faulty;              /**< bit i set when health[i] is not 0 */
+};
+
+/**
+ * \brief valve states published at the end of an actuation
+ */
+struct ValveFrame
+{
+    uint64_t cycle;     /**< actuation cycle */
+    uint64_t timestamp; /**< CLOCK_MONOTONIC end of the actuation in ns */
+    ValveSample vannes[MAX_VALVES];
+};
+
+/**
+ * \brief segment SHM_Sensor
+ */
+struct alignas(CACHE_LINE_SIZE) SensorData
+{
+    ShmHeader header;
+    alignas(CACHE_LINE_SIZE) uint32_t seq; /**< sequence lock of frame, odd while written */
+    alignas(CACHE_LINE_SIZE) SensorFrame frame;
+    alignas(CACHE_LINE_SIZE) char units[MAX_SENSORS][COND_UNIT_LENGTH]; /**< unit of each value, written before the first cycle */
+};
+
+/**
+ * \brief segment SHM_Vanne
+ */
+struct alignas(CACHE_LINE_SIZE) VanneData
+{
+    ShmHeader header;
+    alignas(CACHE_LINE_SIZE) uint8_t commands[MAX_VALVES]; /**< states requested by the operator */
+    uint16_t generalState;                                 /**< EG requested, 0x7777 for manual mode */
+    alignas(CACHE_LINE_SIZE) uint32_t seq;                 /**< sequence lock of frame, odd while written */
+    alignas(CACHE_LINE_SIZE) ValveFrame frame;
+};
+
+/**
+ * \brief operations of a ValveCommand
+ */
+#define CMD_VALVES 1 /**< the valves of mask take the states of values, the board leaves the automatic mode */
+#define CMD_STATE 2  /**< the general state values is requested, like the MN does */
+
+/**
+ * \brief slot of the command queue, written by a client
+ */
+struct ValveCommand
+{
+    uint32_t turn;     /**< position + 1 once written, position + CMD_QUEUE_RECORDS once free */
+    uint16_t client;   /**< id given by CommandQueue::attach() */
+    uint8_t op;        /**< CMD_VALVES or CMD_STATE */
+    uint8_t reserved;
+    uint32_t id;       /**< number chosen by the client, returned in its acknowledgement */
+    uint32_t mask;     /**< valves concerned, bit i for valve i */
+    uint32_t values;   /**< states of the valves of mask, or the EG */
+    uint32_t reserved2;
+    uint64_t submitNs; /**< CLOCK_MONOTONIC time of the submission */
+    uint64_t cycle;    /**< actuation cycle to take effect on, 0 for the next one */
+};
+
+/**
+ * \brief acknowledgement of a command, written by the cycle thread
+ */
+struct CommandAck
+{
+    uint16_t client;
+    uint16_t status;    /**< infoCommandApplied, errCommandOverridden, errCommandInvalid, errCommandQueueFull */
+    uint32_t id;
+    uint64_t cycle;     /**< actuation cycle the command took effect on, as ValveFrame::cycle */
+    uint64_t submitNs;
+    uint64_t appliedNs; /**< end of the GPIO write of that actuation, 0 when refused */
+    uint32_t applied;   /**< valve states after that actuation */
+    uint32_t reserved;
+};
+
+/**
+ * \brief segment SHM_Command
+ */
+struct alignas(CACHE_LINE_SIZE) CommandData
+{
+    ShmHeader header;
+    alignas(CACHE_LINE_SIZE) uint32_t enqueue; /**< next slot claimed by a client */
+    uint32_t nextClient;                       /**< next client id */
+    alignas(CACHE_LINE_SIZE) uint32_t dequeue; /**< next slot drained by the cycle thread */
+    alignas(CACHE_LINE_SIZE) uint32_t ackHead; /**< acknowledgements written */
+    alignas(CACHE_LINE_SIZE) ValveCommand commands[CMD_QUEUE_RECORDS];
+    alignas(CACHE_LINE_SIZE) CommandAck acks[CMD_ACK_RECORDS];
+};
+
+// the segments are mapped by other processes : values only, fixed offsets
+static_assert(std::is_trivially_copyable_v<SensorData> && std::is_standard_layout_v<SensorData>);
+static_assert(std::is_trivially_copyable_v<VanneData> && std::is_standard_layout_v<VanneData>);
+static_assert(std::is_trivially_copyable_v<CommandData> && std::is_standard_layout_v<CommandData>);
+static_assert(sizeof(ValveCommand) == 40 && sizeof(CommandAck) == 40);
+static_assert(offsetof(CommandData, enqueue) == 64 && offsetof(CommandData, dequeue) == 128 &&
+              offsetof(CommandData, ackHead) == 192 && offsetof(CommandData, commands) == 256);
+static_assert((CMD_QUEUE_RECORDS & (CMD_QUEUE_RECORDS - 1)) == 0 && (CMD_ACK_RECORDS & (CMD_ACK_RECORDS - 1)) == 0,
+              "CMD_QUEUE_RECORDS and CMD_ACK_RECORDS must be powers of 2");
+static_assert(sizeof(ShmHeader) == CACHE_LINE_SIZE);
+static_assert(sizeof(SensorSample) == 16 && sizeof(ValveSample) == 32);
+static_assert(offsetof(SensorData, seq) == 64 && offsetof(SensorData, frame) == 128);
+static_assert(offsetof(SensorFrame, values) == 16 + 16 * MAX_SENSORS);
+static_assert(offsetof(VanneData, commands) == 64 && offsetof(VanneData, seq) == 128 && offsetof(VanneData, frame) == 192);
+static_assert(offsetof(VanneData, generalState) == 64 + MAX_VALVES);
+static_assert(sizeof(SensorData) % CACHE_LINE_SIZE == 0 && sizeof(VanneData) % CACHE_LINE_SIZE == 0);
+static_assert(__atomic_always_lock_free(sizeof(uint32_t), 0));
+
+/**
+ * \brief function to publish a frame under a sequence lock.
+ * Only one writer per lock is allowed, it never waits.
+ *
+ * \param seq the sequence counter of the segment
+ * \param dst the frame in the segment
+ * \param src the complete frame to publish
+ */
+template <class T>
+inline void seqlockPublish(uint32_t *seq, T *dst, const T &src)
+{
+    uint32_t s = __atomic_load_n(seq, __ATOMIC_RELAXED);
+    __atomic_store_n(seq, s + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy((void *)dst, &src, sizeof(T));
+    __atomic_store_n(seq, s + 2, __ATOMIC_RELEASE);
+}
+
+/**
+ * \brief function to copy a consistent frame protected by a sequence lock.
+ * No syscall and no lock : the copy is retried while the writer is active.
+ *
+ * \param seq the sequence counter of the segment
+ * \param src the frame in the segment
+ * \param dst the local copy
+ * \param maxRetries number of attempts before giving up
+ * \return false when no consistent copy was made in maxRetries attempts.
+ */
+template <class T>
+inline bool seqlockRead(const uint32_t *seq, const T *src, T &dst, int maxRetries = 1000)
+{
+    for (int i = 0; i < maxRetries; i++)
+    {
+        uint32_t s1 = __atomic_load_n(seq, __ATOMIC_ACQUIRE);
+        if (s1 & 1)
+            continue;
+        memcpy(&dst, (const void *)src, sizeof(T));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(seq, __ATOMIC_RELAXED) == s1)
+            return true;
+    }
+    return false;
+}
+
+#endif // SHMLAYOUT_H
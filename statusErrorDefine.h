@@ -42,6 +42,11 @@ typedef enum
 	infoNoDepend				= 0x0303, /**< There is no dependances for this valve. */
 	infoValveAlreadyActivated	= 0x0304, /**< The valve is already activated. */
 	infoAllDependNotActivated	= 0x0305, /**< All the valve dependances are not yet activated. */
+	infoValveStateChanged		= 0x0306, /**< A valve line has been written with a new state. */
+	infoCommandApplied			= 0x0307, /**< A valve command has taken effect on the GPIO lines. */
+	infoSequenceDone			= 0x0308, /**< Every action of a valve sequence has been written. */
+	infoSequenceAborted			= 0x0309, /**< A valve sequence has been stopped before its end. */
+	infoActionPending			= 0x030A, /**< A sequence action has not been written yet. */
 	infoShutdownValve			= 0x03FF, /**< The valve module has successfully shutdown. */
 
 	// Sensor (from 0x0400 to 0x04FF)
@@ -51,6 +56,17 @@ typedef enum
 	
 	// EG codes (from 0x1000 to 0x6FFF)
 
+	// Log (from 0x0500 to 0x05FF)
+	infoLogDropped				= 0x0501, /**< Log records have been dropped because a ring was full. */
+
+	// Alarm (from 0x0600 to 0x06FF)
+	infoNoAlarm					= 0x0601, /**< No alarm of the board is active. */
+	infoAlarmCleared			= 0x0602, /**< An alarm condition is no longer met. */
+
+	// Telemetry (from 0x0700 to 0x07FF)
+	infoTelemSubscribed			= 0x0701, /**< A subscriber has joined the telemetry server. */
+	infoTelemUnsubscribed		= 0x0702, /**< A subscriber has left the telemetry server. */
+
 	// Main state (from 0x7000 to 0x7FFF)
 	infoStateToInit				= 0x7001, /**< The main state has been changed to initialisation. */
 	infoStateToControl			= 0x7002, /**< The main state has been changed to acquisition and control. */
@@ -61,6 +77,8 @@ typedef enum
 	// Sensor (from 0xE000 to 0xE0FF)
 	errOpenTelemFile			= 0xE001, /**< Opening the telemetry file has failed. */
 	errTestWriteFile			= 0xE002, /**< Writing in the telemetry file has failed. */
+	errOpenTelemSocket			= 0xE003, /**< A socket of the telemetry server can't be created or bound. */
+	errTelemClientDropped		= 0xE004, /**< A telemetry subscriber too slow to take its frames has been dropped. */
 	errCloseTelemFile			= 0xE0FF, /**< Closing the telemetry file has failed. */
 
 	// CSV (from 0xE100 to 0xE1FF)
@@ -75,6 +93,12 @@ typedef enum
 	errOpenPhysValvesFile		= 0xE109, /**< The "physicalCONFIG_valves.csv" CSV file has failed to open. */
 	errOpenPhysSensorsFile		= 0xE10A, /**< The "physicalCONFIG_sensors.csv" CSV file has failed to open. */
 	errOpenActivationFile		= 0xE10B, /**< The "activation.csv" CSV file has failed to open. */
+	errOpenCalibrationFile		= 0xE10C, /**< A line of "calibration.csv" is malformed or its coefficients are invalid. */
+	errAllocDataCalibration		= 0xE10D, /**< Memory allocation failure for the structure LigneCalibration. */
+	errOpenAlarmFile			= 0xE10E, /**< A line of "alarms.csv" is malformed or its limits are invalid. */
+	errAllocDataAlarm			= 0xE10F, /**< Memory allocation failure for the structure LigneAlarm, or more than MAX_ALARMS rules. */
+	errOpenSequenceFile			= 0xE110, /**< A line of "sequence.csv" is malformed or its valve is not on the board. */
+	errAllocDataSequence		= 0xE111, /**< More than SCHED_MAX_ACTIONS actions in a valve sequence. */
 
 	// OPL (from 0xE200 to 0xE2FF)
 	errOPLSystemInit			= 0xE201, /**< OpenPOWERLINK fails to set the correct configuration for the current operating system. */
@@ -104,13 +128,44 @@ typedef enum
 	errDependOutsideOfRange		= 0xE30A, /**< A dependance is not among the valves of the same board. */
 	errValueIsNotBinary			= 0xE30B, /**< A valve value is not 0 or 1. */
 	errGPIOSetValue				= 0xE30C, /**< The valve value has not been set to the gpio line. */
+	errCommandQueueFull			= 0xE30D, /**< A valve command has been refused because the queue or the pending commands are full. */
+	errCommandInvalid			= 0xE30E, /**< A valve command has an unknown operation or valves that are not on the board. */
+	errCommandOverridden		= 0xE30F, /**< A valve command has been applied but the interlock or an alarm holds other states. */
+	errOpenCommandShm			= 0xE310, /**< The command segment of a board can't be created or mapped. */
+	errActionLate				= 0xE311, /**< A sequence action has been written later than SCHED_LATE_NS after its deadline. */
+	errSchedulerRunning			= 0xE312, /**< A valve sequence is running, its actions can't be changed. */
+	errActionInterlocked		= 0xE313, /**< A sequence action has been held closed by the interlock rules. */
+	errOpenValveShm				= 0xE314, /**< The valve segment of a board can't be created or mapped. */
 	errGPIORelease				= 0xE3FF, /**< A gpio line fails to be released. */
 
 	// Sensor (from 0xE400 to 0xE4FF)
 	errOpenAdc					= 0xE401, /**< A sysfs file of the MCP3008 fails to open. */
 	errReadAdc					= 0xE402, /**< A sysfs file read of the MCP3008 fails. */
+	errOpenModbus				= 0xE403, /**< The modbus serial device fails to open or to be configured. */
+	errModbusTimeout			= 0xE404, /**< A modbus slave has not answered a read request in time. */
+	errModbusFrame				= 0xE405, /**< A modbus answer has a bad CRC, address or length, or is an exception. */
+	errSensorDisconnected		= 0xE406, /**< The reads of a channel fail in a row, the sensor is disconnected. */
+	errSensorStuck				= 0xE407, /**< A channel returns the same value for too long. */
+	errSensorSaturated			= 0xE408, /**< A channel stays on a rail of the ADC. */
+	errSensorNoisy				= 0xE409, /**< The noise of a channel is above its limit. */
+	errSensorStep				= 0xE40A, /**< A channel jumped by more than a plausible change. */
+	errOpenSensorShm			= 0xE40B, /**< The sensor segment of a board can't be created or mapped. */
+	errWriteAdc					= 0xE40C, /**< A sysfs attribute of the MCP3008 fails to be written. */
 	errCloseAdc					= 0xE4FF, /**< A sysfs file of the MCP3008 fails to close. */
 
+	// Alarm (from 0xE500 to 0xE5FF)
+	errAlarmHigh				= 0xE501, /**< A channel stays above its alarm limit. */
+	errAlarmLow					= 0xE502, /**< A channel stays below its alarm limit. */
+	errAlarmRate				= 0xE503, /**< A channel changes faster than its alarm rate. */
+	errAlarmSafeState			= 0xE504, /**< An alarm has commanded the safe state of the valves. */
+
+	// Main (from 0xE700 to 0xE7FF)
+	errSchedRealTime			= 0xE701, /**< The SCHED_FIFO priority can't be set (missing CAP_SYS_NICE). */
+	errCpuAffinity				= 0xE702, /**< The cycle thread can't be pinned to the requested CPU. */
+	errLockMemory				= 0xE703, /**< mlockall() fails, the cycle can be delayed by page faults. */
+	errCycleOverrun				= 0xE704, /**< A cycle has not finished before the next deadline. */
+	errHalConfig				= 0xE705, /**< The backends of HAL_ENV are unknown, their settings or the waveform file are invalid. */
+
 
 } statusErrDef;
 
@@ -134,7 +189,7 @@ typedef enum
 {
     init, 								/**< Initialize all modules with status and error telemetry. */
 	controlAndAcquisition, 				/**< Activate valves and read sensors values. */
-    shutdown, 							/**< Shutdown all modules with status and error telemetry. */
+    shutdownModules, 					/**< Shutdown all modules with status and error telemetry. */
     ending, 							/**< Stop the program. */
 } stateDef;
 
@@ -0,0 +1,195 @@
+/* compilation :
+g++ -std=c++20 telemClient.cpp histogram.cpp -o telemClient
+*/
+/**
+ * \file telemClient.cpp
+ * \brief load-test client of the telemetry server
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * usage : telemClient [subscribers] [stalled] [decimation] [seconds] [UDP port]
+ *
+ * Opens the subscribers on STREAM_SOCKET_PATH, or on the localhost UDP
+ * port when one is given, and reads them all from one thread for the
+ * given time ; the stalled subscribers subscribe and never read, the
+ * server must drop them without slowing the others. Prints the frames and
+ * records received per second, the sequence gaps, the records the server
+ * dropped and the latency from the end of the acquisition to the
+ * reception, both on CLOCK_MONOTONIC.
+ */
+
+#include "telemServer.h"
+#include "histogram.h"
+#include "monotonicClock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <vector>
+
+static volatile sig_atomic_t running = 1;
+
+static void stop(int)
+{
+    running = 0;
+}
+
+/**
+ * \brief a subscriber of the test and what it received
+ */
+struct Client
+{
+    int fd;
+    bool started;       /**< a frame has been received */
+    uint32_t sequence;  /**< next frame expected */
+    uint64_t frames;
+    uint64_t records;
+    uint64_t gaps;      /**< frames lost, from the sequence numbers */
+    uint32_t dropped;   /**< records dropped by the server, from the last header */
+};
+
+static int openClient(uint16_t udpPort, const StreamSubscribe &msg, sockaddr_in &server)
+{
+    if (udpPort)
+    {
+        int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        int size = 4 * 1024 * 1024;
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+        if (fd < 0 || sendto(fd, &msg, sizeof(msg), 0, (const sockaddr *)&server, sizeof(server)) < 0)
+        {
+            perror("telemetry UDP port");
+            return -1;
+        }
+        return fd;
+    }
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, STREAM_SOCKET_PATH, sizeof(addr.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, (const sockaddr *)&addr, sizeof(addr)) < 0 || send(fd, &msg, sizeof(msg), 0) < 0)
+    {
+        perror(STREAM_SOCKET_PATH);
+        return -1;
+    }
+    return fd;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && (argv[1][0] < '0' || argv[1][0] > '9'))
+    {
+        fprintf(stderr, "usage : %s [subscribers] [stalled] [decimation] [seconds] [UDP port]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    int nbClients = argc > 1 ? atoi(argv[1]) : 1;
+    int nbStalled = argc > 2 ? atoi(argv[2]) : 0;
+    StreamSubscribe msg = {STREAM_MAGIC, (uint16_t)(argc > 3 ? atoi(argv[3]) : 1), 0, 0};
+    int seconds = argc > 4 ? atoi(argv[4]) : 10;
+    uint16_t udpPort = argc > 5 ? (uint16_t)atoi(argv[5]) : 0;
+    if (msg.decimation == 0)
+        msg.decimation = 1;
+
+    sockaddr_in server = {};
+    server.sin_family = AF_INET;
+    server.sin_port = htons(udpPort);
+    server.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    std::vector<Client> clients;
+    std::vector<int> stalled;
+    for (int i = 0; i < nbClients + nbStalled; i++)
+    {
+        int fd = openClient(udpPort, msg, server);
+        if (fd < 0)
+            return EXIT_FAILURE;
+        if (i < nbClients)
+            clients.push_back(Client{fd, false, 0, 0, 0, 0, 0});
+        else
+            stalled.push_back(fd);
+    }
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+
+    std::vector<pollfd> fds(clients.size());
+    for (size_t i = 0; i < clients.size(); i++)
+        fds[i] = pollfd{clients[i].fd, POLLIN, 0};
+    LatencyHisto latency;
+    static uint8_t frame[sizeof(StreamFrameHeader) + STREAM_BATCH_RECORDS * sizeof(StreamRecord)];
+    const StreamFrameHeader *h = (const StreamFrameHeader *)frame;
+    const StreamRecord *records = (const StreamRecord *)(frame + sizeof(StreamFrameHeader));
+
+    uint64_t start = monotonicNs();
+    uint64_t end = start + (uint64_t)seconds * 1000000000ull;
+    uint64_t nextLease = start + STREAM_UDP_LEASE_MS * 500000ull;
+    uint64_t closed = 0;
+    while (running && monotonicNs() < end)
+    {
+        // the UDP subscriptions are renewed within their lease, the stalled ones too
+        if (udpPort && monotonicNs() >= nextLease)
+        {
+            for (const Client &c : clients)
+                sendto(c.fd, &msg, sizeof(msg), 0, (const sockaddr *)&server, sizeof(server));
+            for (int fd : stalled)
+                sendto(fd, &msg, sizeof(msg), 0, (const sockaddr *)&server, sizeof(server));
+            nextLease += STREAM_UDP_LEASE_MS * 500000ull;
+        }
+        if (poll(fds.data(), fds.size(), 100) <= 0)
+            continue;
+        for (size_t i = 0; i < fds.size(); i++)
+        {
+            if (!fds[i].revents)
+                continue;
+            Client &c = clients[i];
+            ssize_t n = recv(c.fd, frame, sizeof(frame), MSG_DONTWAIT);
+            if (n == 0 || (fds[i].revents & (POLLHUP | POLLERR)))
+            {
+                // closed by the server, the subscriber is not read any more
+                fds[i].fd = -1;
+                closed++;
+                continue;
+            }
+            if (n < (ssize_t)sizeof(StreamFrameHeader) || h->magic != STREAM_MAGIC ||
+                h->recordSize != sizeof(StreamRecord) ||
+                n != (ssize_t)(sizeof(StreamFrameHeader) + h->nbRecords * sizeof(StreamRecord)))
+                continue;
+            uint64_t now = monotonicNs();
+            if (c.started && h->sequence != c.sequence)
+                c.gaps += h->sequence - c.sequence;
+            c.started = true;
+            c.sequence = h->sequence + 1;
+            c.dropped = h->dropped;
+            c.frames++;
+            c.records += h->nbRecords;
+            for (int r = 0; r < h->nbRecords; r++)
+                latency.record(now > records[r].timestamp ? now - records[r].timestamp : 0);
+        }
+    }
+    double elapsed = (monotonicNs() - start) / 1e9;
+
+    uint64_t frames = 0, nbRecords = 0, gaps = 0, dropped = 0;
+    for (const Client &c : clients)
+    {
+        frames += c.frames;
+        nbRecords += c.records;
+        gaps += c.gaps;
+        dropped += c.dropped;
+        close(c.fd);
+    }
+    for (int fd : stalled)
+        close(fd);
+    printf("%zu subscribers (%zu stalled, decimation %u, %s) for %.1f s\n", clients.size(), stalled.size(),
+           msg.decimation, udpPort ? "UDP" : "Unix socket", elapsed);
+    printf("  %.0f frames/s, %.0f records/s, %.0f records/s per subscriber\n", frames / elapsed, nbRecords / elapsed,
+           clients.empty() ? 0.0 : nbRecords / elapsed / clients.size());
+    printf("  %llu frames lost, %llu records dropped by the server, %llu subscribers closed by the server\n",
+           (unsigned long long)gaps, (unsigned long long)dropped, (unsigned long long)closed);
+    printf("  latency p50 %.1f us, p99 %.1f us, p99.9 %.1f us, max %.1f us\n", latency.percentile(50) / 1e3,
+           latency.percentile(99) / 1e3, latency.percentile(99.9) / 1e3, latency.getMax() / 1e3);
+    return 0;
+}
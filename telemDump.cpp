@@ -0,0 +1,155 @@
+/* compilation :
+g++ -std=c++20 telemDump.cpp -o telemDump
+*/
+/**
+ * \file telemDump.cpp
+ * \brief offline tool converting telemetry segment files to CSV
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * usage : telemDump [directory | segment files...] > telemetry.csv
+ *
+ * The segments are written in the order of their sequence number, so
+ * the files reused in turn by the recorder come out in time order.
+ */
+
+#include "telemetry.h"
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct Segment
+{
+    std::string path;
+    uint64_t sequence;
+};
+
+/**
+ * \brief function to read the header of a segment file.
+ *
+ * \return false when the file isn't a telemetry segment.
+ */
+static bool readHeader(const std::string &path, TelemSegmentHeader &h)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    bool ok = pread(fd, &h, sizeof(h), 0) == (ssize_t)sizeof(h) &&
+              h.magic == TELEM_MAGIC && h.version == TELEM_VERSION && h.recordSize == sizeof(TelemRecord);
+    close(fd);
+    return ok;
+}
+
+static void listDirectory(const std::string &dir, std::vector<std::string> &paths)
+{
+    DIR *d = opendir(dir.c_str());
+    if (!d)
+    {
+        perror(dir.c_str());
+        return;
+    }
+    while (struct dirent *e = readdir(d))
+    {
+        std::string name = e->d_name;
+        if (name.rfind("telem_", 0) == 0 && name.size() > 4 && name.compare(name.size() - 4, 4, ".bin") == 0)
+            paths.push_back(dir + "/" + name);
+    }
+    closedir(d);
+}
+
+static statusErrDef dumpSegment(const std::string &path, bool &headerDone)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        perror(path.c_str());
+        return errOpenTelemFile;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(TelemSegmentHeader))
+    {
+        close(fd);
+        return errOpenTelemFile;
+    }
+    void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        perror(path.c_str());
+        return errOpenTelemFile;
+    }
+
+    const TelemSegmentHeader &h = *(const TelemSegmentHeader *)map;
+    const TelemRecord *records = (const TelemRecord *)((const char *)map + sizeof(TelemSegmentHeader));
+    size_t maxCount = (st.st_size - sizeof(TelemSegmentHeader)) / sizeof(TelemRecord);
+    size_t count = std::min<size_t>(h.count, maxCount);
+    // records written after the last sync of a segment left by a crash
+    while (count < maxCount && records[count].timestamp != 0)
+        count++;
+    int nbChannels = std::min<int>(h.nbChannels, MAX_SENSORS);
+
+    if (!headerDone)
+    {
+        printf("board,timestamp_ns,cycle,valves,errors");
+        for (int c = 0; c < nbChannels; c++)
+            printf(",ch%d", c);
+        printf("\n");
+        headerDone = true;
+    }
+
+    char board[SHM_NAME_LENGTH + 1] = {};
+    memcpy(board, h.boardName, SHM_NAME_LENGTH);
+    for (size_t i = 0; i < count; i++)
+    {
+        const TelemRecord &r = records[i];
+        printf("%s,%llu,%u,0x%04X,0x%04X", board, (unsigned long long)r.timestamp, r.cycle, r.valveMask, r.errorMask);
+        for (int c = 0; c < nbChannels; c++)
+            printf(",%d", r.values[c]);
+        printf("\n");
+    }
+    munmap(map, st.st_size);
+    return noError;
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<std::string> paths;
+    if (argc < 2)
+        listDirectory(TELEM_DIR, paths);
+    for (int i = 1; i < argc; i++)
+    {
+        struct stat st;
+        if (stat(argv[i], &st) == 0 && S_ISDIR(st.st_mode))
+            listDirectory(argv[i], paths);
+        else
+            paths.push_back(argv[i]);
+    }
+
+    std::vector<Segment> segments;
+    for (const std::string &p : paths)
+    {
+        TelemSegmentHeader h;
+        if (readHeader(p, h))
+            segments.push_back({p, h.sequence});
+        else
+            fprintf(stderr, "%s : not a telemetry segment (0x%04X)\n", p.c_str(), errOpenTelemFile);
+    }
+    std::sort(segments.begin(), segments.end(),
+              [](const Segment &a, const Segment &b)
+              { return a.sequence < b.sequence; });
+
+    bool headerDone = false;
+    int res = 0;
+    for (const Segment &s : segments)
+        if (dumpSegment(s.path, headerDone) != noError)
+            res = 1;
+    return res;
+}
@@ -0,0 +1,455 @@
+/**
+ * \file telemServer.cpp
+ * \brief Module publishing the cycles of the boards to local subscribers
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * publish() runs in the control loop : it copies the cycle in the ring of
+ * the board, never waits and drops the record when the ring is full.
+ * The publisher thread accepts the subscribers, reads their
+ * subscriptions and sends the rings every period with non-blocking sends.
+ *
+ * Results of start() :
+ * - errOpenTelemSocket : the Unix socket or the UDP port can't be bound
+ * Events logged by the publisher thread :
+ * - infoTelemSubscribed, infoTelemUnsubscribed : a subscriber joins or leaves
+ * - errTelemClientDropped : a subscriber missed STREAM_MAX_MISSED frames in a row
+ */
+
+#include "telemServer.h"
+#include "monotonicClock.h"
+#include "logger.h"
+#include <stdio.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <cstring>
+
+/**
+ * \brief Constructor for the TelemetryServer class.
+ *
+ * \param path Unix socket of the subscribers, empty for none
+ * \param udpPort localhost UDP port of the subscribers, 0 for none
+ * \param periodMs period of the publisher thread
+ */
+TelemetryServer::TelemetryServer(const std::string &path, uint16_t udpPort, int periodMs)
+    : path(path), udpPort(udpPort), periodMs(periodMs), listenFd(-1), udpFd(-1), rings{}, nbBoards(0), frames(0),
+      records(0), missed(0), clientsDropped(0), nbSubscribers(0), running(false)
+{
+    for (StreamSubscriber &sub : subscribers)
+        sub.fd = -2;
+}
+
+TelemetryServer::~TelemetryServer()
+{
+    stop();
+    for (int b = 0; b < nbBoards; b++)
+        delete rings[b];
+}
+
+/**
+ * \brief function to add the ring of a board, before start().
+ *
+ * \return the index of the board for publish(), -1 when MAX_BOARDS are
+ * used or the server runs.
+ */
+int TelemetryServer::addBoard(uint8_t boardId, uint8_t nbChannels, uint8_t nbValves)
+{
+    if (nbBoards >= MAX_BOARDS || running)
+        return -1;
+    StreamRing *ring = new StreamRing();
+    ring->head.store(0, std::memory_order_relaxed);
+    ring->tail.store(0, std::memory_order_relaxed);
+    ring->dropped.store(0, std::memory_order_relaxed);
+    ring->boardId = boardId;
+    ring->nbChannels = nbChannels;
+    ring->nbValves = nbValves;
+    rings[nbBoards] = ring;
+    return nbBoards++;
+}
+
+/**
+ * \brief function to bind the sockets and start the publisher thread.
+ *
+ * \return errOpenTelemSocket when a socket can't be created or bound.
+ */
+statusErrDef TelemetryServer::start()
+{
+    if (running)
+        return noError;
+
+    if (!path.empty())
+    {
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path))
+            return errOpenTelemSocket;
+        strcpy(addr.sun_path, path.c_str());
+        listenFd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        // a socket file left by a previous run is replaced
+        unlink(path.c_str());
+        if (listenFd < 0 || bind(listenFd, (sockaddr *)&addr, sizeof(addr)) < 0 ||
+            listen(listenFd, STREAM_MAX_SUBSCRIBERS) < 0)
+        {
+            perror(path.c_str());
+            logEvent(logTelem, errOpenTelemSocket, "telemetry socket not bound (errno)", errno);
+            stop();
+            return errOpenTelemSocket;
+        }
+    }
+
+    if (udpPort)
+    {
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(udpPort);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        udpFd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (udpFd < 0 || bind(udpFd, (sockaddr *)&addr, sizeof(addr)) < 0)
+        {
+            perror("telemetry UDP port");
+            logEvent(logTelem, errOpenTelemSocket, "telemetry UDP port not bound (port, errno)", udpPort, errno);
+            stop();
+            return errOpenTelemSocket;
+        }
+    }
+
+    running = true;
+    worker = std::thread(&TelemetryServer::work, this);
+    return noError;
+}
+
+/**
+ * \brief function to stop the publisher thread and close every socket.
+ */
+void TelemetryServer::stop()
+{
+    if (running.exchange(false))
+        worker.join();
+    for (int i = 0; i < STREAM_MAX_SUBSCRIBERS; i++)
+        if (subscribers[i].fd != -2)
+            remove(i, infoTelemUnsubscribed);
+    if (listenFd >= 0)
+    {
+        close(listenFd);
+        unlink(path.c_str());
+        listenFd = -1;
+    }
+    if (udpFd >= 0)
+        close(udpFd);
+    udpFd = -1;
+}
+
+/**
+ * \brief function to copy a cycle in the ring of a board, from the
+ * control loop, without system call, allocation or lock.
+ *
+ * \param board index returned by addBoard()
+ * \param frame the sensor frame of the cycle
+ * \param valveMask the applied valve states, bit i for valve i
+ * \return false when the record was dropped because the ring was full.
+ */
+bool TelemetryServer::publish(int board, const SensorFrame &frame, uint32_t valveMask)
+{
+    StreamRing &ring = *rings[board];
+    uint32_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) >= STREAM_RING_RECORDS)
+    {
+        ring.dropped.store(ring.dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return false;
+    }
+
+    StreamRecord &rec = ring.records[head & (STREAM_RING_RECORDS - 1)];
+    rec.timestamp = frame.timestamp;
+    rec.cycle = (uint32_t)frame.cycle;
+    rec.valveMask = (uint16_t)valveMask;
+    rec.faulty = (uint16_t)frame.faulty;
+    for (int i = 0; i < MAX_SENSORS; i++)
+    {
+        rec.values[i] = frame.values[i];
+        rec.counts[i] = frame.sensors[i].value;
+        rec.status[i] = frame.sensors[i].status;
+    }
+    ring.head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+/**
+ * \brief function to accept the pending subscribers on the Unix socket,
+ * every cycle of every board until they send a StreamSubscribe.
+ */
+void TelemetryServer::accept()
+{
+    int fd;
+    while ((fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+    {
+        int index = -1;
+        for (int i = 0; i < STREAM_MAX_SUBSCRIBERS && index < 0; i++)
+            if (subscribers[i].fd == -2)
+                index = i;
+        if (index < 0)
+        {
+            close(fd);
+            logEvent(logTelem, errTelemClientDropped, "telemetry subscriber refused, STREAM_MAX_SUBSCRIBERS reached");
+            continue;
+        }
+        int size = STREAM_SNDBUF;
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+        StreamSubscriber &sub = subscribers[index];
+        sub = StreamSubscriber{};
+        sub.fd = fd;
+        sub.decimation = 1;
+        nbSubscribers.fetch_add(1, std::memory_order_relaxed);
+        logEvent(logTelem, infoTelemSubscribed, "telemetry subscriber joined (slot)", index);
+    }
+}
+
+/**
+ * \brief function to read the subscription of a Unix subscriber, or
+ * remove it when it has left.
+ */
+void TelemetryServer::receive(int index)
+{
+    StreamSubscriber &sub = subscribers[index];
+    StreamSubscribe msg;
+    ssize_t ret;
+    while ((ret = recv(sub.fd, &msg, sizeof(msg), MSG_DONTWAIT)) > 0)
+    {
+        if (ret != (ssize_t)sizeof(msg) || msg.magic != STREAM_MAGIC)
+            continue;
+        if (msg.decimation == 0)
+        {
+            remove(index, infoTelemUnsubscribed);
+            return;
+        }
+        sub.decimation = msg.decimation;
+        sub.boardMask = msg.boardMask;
+    }
+    if (ret == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+        remove(index, infoTelemUnsubscribed);
+}
+
+/**
+ * \brief function to read the subscriptions sent to the UDP port, a new
+ * address is added, a known one renews its lease.
+ */
+void TelemetryServer::receiveUdp()
+{
+    StreamSubscribe msg;
+    sockaddr_in from;
+    socklen_t len = sizeof(from);
+    ssize_t ret;
+    while ((ret = recvfrom(udpFd, &msg, sizeof(msg), MSG_DONTWAIT, (sockaddr *)&from, &len)) >= 0)
+    {
+        len = sizeof(from);
+        if (ret != (ssize_t)sizeof(msg) || msg.magic != STREAM_MAGIC)
+            continue;
+        int index = -1, freeIndex = -1;
+        for (int i = 0; i < STREAM_MAX_SUBSCRIBERS; i++)
+        {
+            const StreamSubscriber &sub = subscribers[i];
+            if (sub.fd == -1 && sub.addr.sin_port == from.sin_port && sub.addr.sin_addr.s_addr == from.sin_addr.s_addr)
+                index = i;
+            else if (sub.fd == -2 && freeIndex < 0)
+                freeIndex = i;
+        }
+        if (index >= 0 && msg.decimation == 0)
+        {
+            remove(index, infoTelemUnsubscribed);
+            continue;
+        }
+        if (index < 0 && (msg.decimation == 0 || freeIndex < 0))
+            continue;
+        if (index < 0)
+        {
+            index = freeIndex;
+            subscribers[index] = StreamSubscriber{};
+            subscribers[index].fd = -1;
+            subscribers[index].addr = from;
+            nbSubscribers.fetch_add(1, std::memory_order_relaxed);
+            logEvent(logTelem, infoTelemSubscribed, "telemetry UDP subscriber joined (slot, port)", index,
+                     ntohs(from.sin_port));
+        }
+        StreamSubscriber &sub = subscribers[index];
+        sub.decimation = msg.decimation;
+        sub.boardMask = msg.boardMask;
+        sub.leaseNs = monotonicNs() + STREAM_UDP_LEASE_MS * 1000000ull;
+    }
+}
+
+/**
+ * \brief function to close a subscriber and free its entry.
+ *
+ * \param reason infoTelemUnsubscribed when it has left, errTelemClientDropped when it was too slow
+ */
+void TelemetryServer::remove(int index, statusErrDef reason)
+{
+    StreamSubscriber &sub = subscribers[index];
+    if (sub.fd >= 0)
+        close(sub.fd);
+    sub.fd = -2;
+    nbSubscribers.fetch_sub(1, std::memory_order_relaxed);
+    if (reason == errTelemClientDropped)
+        clientsDropped.fetch_add(1, std::memory_order_relaxed);
+    logEvent(logTelem, reason, "telemetry subscriber removed (slot, records lost)", index, (int32_t)sub.dropped);
+}
+
+/**
+ * \brief function to send a frame to a subscriber without waiting. A frame
+ * it can't take is counted, the subscriber is dropped after
+ * STREAM_MAX_MISSED of them in a row.
+ */
+void TelemetryServer::send(StreamSubscriber &sub, const void *frame, size_t size, int nbRecords)
+{
+    StreamFrameHeader *h = (StreamFrameHeader *)frame;
+    h->sequence = sub.sequence++;
+    h->dropped = sub.dropped;
+    ssize_t ret = sub.fd >= 0 ? ::send(sub.fd, frame, size, MSG_DONTWAIT | MSG_NOSIGNAL)
+                              : sendto(udpFd, frame, size, MSG_DONTWAIT, (const sockaddr *)&sub.addr, sizeof(sub.addr));
+    if (ret == (ssize_t)size)
+    {
+        sub.missed = 0;
+        frames.fetch_add(1, std::memory_order_relaxed);
+        records.fetch_add(nbRecords, std::memory_order_relaxed);
+        return;
+    }
+
+    int index = (int)(&sub - subscribers);
+    if (ret < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != ENOBUFS)
+    {
+        remove(index, infoTelemUnsubscribed);
+        return;
+    }
+    sub.dropped += nbRecords;
+    missed.fetch_add(1, std::memory_order_relaxed);
+    if (++sub.missed >= STREAM_MAX_MISSED)
+        remove(index, errTelemClientDropped);
+}
+
+/**
+ * \brief function to send the records of a ring to every subscriber of
+ * its board, STREAM_BATCH_RECORDS records per frame at most, then free them.
+ */
+void TelemetryServer::flush(StreamRing &ring, uint64_t now)
+{
+    uint32_t tail = ring.tail.load(std::memory_order_relaxed);
+    uint32_t head = ring.head.load(std::memory_order_acquire);
+    if (head == tail)
+        return;
+
+    alignas(8) uint8_t frame[sizeof(StreamFrameHeader) + STREAM_BATCH_RECORDS * sizeof(StreamRecord)];
+    StreamFrameHeader *h = (StreamFrameHeader *)frame;
+    StreamRecord *out = (StreamRecord *)(frame + sizeof(StreamFrameHeader));
+    for (StreamSubscriber &sub : subscribers)
+    {
+        if (sub.fd == -2 || (sub.boardMask && (ring.boardId >= 32 || !((sub.boardMask >> ring.boardId) & 1))))
+            continue;
+        if (sub.fd == -1 && now > sub.leaseNs)
+        {
+            remove((int)(&sub - subscribers), infoTelemUnsubscribed);
+            continue;
+        }
+        *h = StreamFrameHeader{STREAM_MAGIC, STREAM_VERSION, sizeof(StreamRecord), 0, 0, ring.boardId,
+                               ring.nbChannels, ring.nbValves, 0, 0};
+        int n = 0;
+        for (uint32_t t = tail; t != head && sub.fd != -2; t++)
+        {
+            const StreamRecord &rec = ring.records[t & (STREAM_RING_RECORDS - 1)];
+            if (rec.cycle % sub.decimation)
+                continue;
+            out[n++] = rec;
+            if (n == STREAM_BATCH_RECORDS)
+            {
+                h->nbRecords = (uint8_t)n;
+                send(sub, frame, sizeof(StreamFrameHeader) + n * sizeof(StreamRecord), n);
+                n = 0;
+            }
+        }
+        if (n && sub.fd != -2)
+        {
+            h->nbRecords = (uint8_t)n;
+            send(sub, frame, sizeof(StreamFrameHeader) + n * sizeof(StreamRecord), n);
+        }
+    }
+    ring.tail.store(head, std::memory_order_release);
+}
+
+/**
+ * \brief loop of the publisher thread : wait for the subscribers until
+ * the next period, then send the rings.
+ */
+void TelemetryServer::work()
+{
+    pollfd fds[2 + STREAM_MAX_SUBSCRIBERS];
+    int owner[2 + STREAM_MAX_SUBSCRIBERS];
+    const uint64_t period = (uint64_t)periodMs * 1000000ull;
+    uint64_t next = monotonicNs() + period;
+
+    while (running.load(std::memory_order_relaxed))
+    {
+        int n = 0;
+        if (listenFd >= 0)
+        {
+            fds[n] = pollfd{listenFd, POLLIN, 0};
+            owner[n++] = -1;
+        }
+        if (udpFd >= 0)
+        {
+            fds[n] = pollfd{udpFd, POLLIN, 0};
+            owner[n++] = -2;
+        }
+        for (int i = 0; i < STREAM_MAX_SUBSCRIBERS; i++)
+        {
+            if (subscribers[i].fd < 0)
+                continue;
+            fds[n] = pollfd{subscribers[i].fd, POLLIN, 0};
+            owner[n++] = i;
+        }
+
+        uint64_t now = monotonicNs();
+        int timeout = now >= next ? 0 : (int)((next - now + 999999) / 1000000);
+        if (poll(fds, n, timeout) > 0)
+        {
+            for (int k = 0; k < n; k++)
+            {
+                if (!fds[k].revents)
+                    continue;
+                if (owner[k] == -1)
+                    accept();
+                else if (owner[k] == -2)
+                    receiveUdp();
+                else if (subscribers[owner[k]].fd == fds[k].fd)
+                    receive(owner[k]);
+            }
+        }
+
+        now = monotonicNs();
+        if (now < next)
+            continue;
+        for (int b = 0; b < nbBoards; b++)
+            flush(*rings[b], now);
+        next += period;
+        if (next <= now)
+            next = now + period;
+    }
+}
+
+/**
+ * \brief function to get the figures of the server, from any thread.
+ */
+void TelemetryServer::getStats(StreamStats &out) const
+{
+    out.frames = frames.load(std::memory_order_relaxed);
+    out.records = records.load(std::memory_order_relaxed);
+    out.missed = missed.load(std::memory_order_relaxed);
+    out.ringDropped = 0;
+    for (int b = 0; b < nbBoards; b++)
+        out.ringDropped += rings[b]->dropped.load(std::memory_order_relaxed);
+    out.clientsDropped = clientsDropped.load(std::memory_order_relaxed);
+    out.subscribers = nbSubscribers.load(std::memory_order_relaxed);
+}
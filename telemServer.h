@@ -0,0 +1,178 @@
+/**
+ * \file telemServer.h
+ * \brief header file of the telemetry server
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * Contains the wire format of the telemetry stream and the server
+ * publishing the cycles of the boards to local subscribers.
+ *
+ * The cycle thread of each board only copies a record in a ring, a
+ * publisher thread outside of the real-time path sends the rings every
+ * STREAM_BATCH_MS to the subscribers, several cycles per frame :
+ * - Unix domain socket STREAM_SOCKET_PATH, SOCK_SEQPACKET, one frame per
+ *   message ; a subscriber may send a StreamSubscribe at any time
+ * - localhost UDP, optional : a subscriber sends a StreamSubscribe to the
+ *   port and renews it within STREAM_UDP_LEASE_MS
+ *
+ * A frame holds the records of one board, after a StreamFrameHeader.
+ * Each subscriber has its decimation (cycles whose number is a multiple
+ * of it) and its boards. A frame a subscriber can't take without waiting
+ * is not sent and counted in its dropped records ; after STREAM_MAX_MISSED
+ * frames in a row the subscriber is dropped, so a stalled client only
+ * loses its own data.
+ */
+
+#ifndef TELEMSERVER_H
+#define TELEMSERVER_H
+
+#include "configDefine.h"
+#include "statusErrorDefine.h"
+#include "shmLayout.h"
+#include <cstdint>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <netinet/in.h>
+
+/**
+ * \brief "CACS" in little endian, first word of a frame or a subscription
+ */
+#define STREAM_MAGIC 0x53434143
+/**
+ * \brief version of the wire format
+ */
+#define STREAM_VERSION 1
+
+/**
+ * \brief subscription, sent by a subscriber
+ */
+struct StreamSubscribe
+{
+    uint32_t magic;      /**< STREAM_MAGIC */
+    uint16_t decimation; /**< one cycle out of decimation, 0 to unsubscribe (UDP) */
+    uint16_t reserved;
+    uint32_t boardMask;  /**< bit i for the board id i, 0 for every board */
+};
+
+/**
+ * \brief header of a frame, followed by nbRecords StreamRecord
+ */
+struct StreamFrameHeader
+{
+    uint32_t magic;      /**< STREAM_MAGIC */
+    uint16_t version;    /**< STREAM_VERSION */
+    uint16_t recordSize; /**< sizeof(StreamRecord) */
+    uint32_t sequence;   /**< frames sent to this subscriber, a gap is a frame it lost */
+    uint32_t dropped;    /**< records this subscriber lost since it subscribed */
+    uint8_t boardId;     /**< CAC board id */
+    uint8_t nbChannels;  /**< valid entries of the channel arrays */
+    uint8_t nbValves;    /**< valid bits of valveMask */
+    uint8_t nbRecords;
+    uint32_t reserved;
+};
+
+/**
+ * \brief one cycle of a board
+ */
+struct StreamRecord
+{
+    uint64_t timestamp;            /**< CLOCK_MONOTONIC end of the acquisition in ns */
+    uint32_t cycle;                /**< acquisition cycle */
+    uint16_t valveMask;            /**< bit i set when valve i is open */
+    uint16_t faulty;               /**< bit i set when channel i has a SENSOR_HEALTH_* flag */
+    float values[MAX_SENSORS];     /**< conditioned values, NaN before the first sample */
+    int16_t counts[MAX_SENSORS];   /**< raw ADC counts */
+    uint16_t status[MAX_SENSORS];  /**< statusErrDef of each sample */
+};
+
+static_assert(sizeof(StreamFrameHeader) == 24);
+static_assert(sizeof(StreamRecord) == 16 + 8 * MAX_SENSORS);
+static_assert(STREAM_BATCH_RECORDS <= 255, "nbRecords is a uint8_t");
+static_assert((STREAM_RING_RECORDS & (STREAM_RING_RECORDS - 1)) == 0, "STREAM_RING_RECORDS must be a power of 2");
+
+/**
+ * \brief ring between the cycle thread of a board and the publisher thread
+ */
+struct StreamRing
+{
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> head; /**< next record written by publish() */
+    std::atomic<uint64_t> dropped;                       /**< records lost because the ring was full */
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> tail; /**< next record sent by the publisher */
+    uint8_t boardId;
+    uint8_t nbChannels;
+    uint8_t nbValves;
+    StreamRecord records[STREAM_RING_RECORDS];
+};
+
+/**
+ * \brief a subscriber of the server
+ */
+struct StreamSubscriber
+{
+    int fd;              /**< Unix socket, -1 for a UDP subscriber, -2 for a free entry */
+    sockaddr_in addr;    /**< address of a UDP subscriber */
+    uint16_t decimation;
+    uint32_t boardMask;
+    uint32_t sequence;
+    uint32_t dropped;
+    uint32_t missed;     /**< frames in a row not taken */
+    uint64_t leaseNs;    /**< end of the subscription of a UDP subscriber */
+};
+
+/**
+ * \brief figures of the server, readable from any thread
+ */
+struct StreamStats
+{
+    uint64_t frames;         /**< frames sent */
+    uint64_t records;        /**< records sent, counted once per subscriber */
+    uint64_t missed;         /**< frames not taken by a subscriber */
+    uint64_t ringDropped;    /**< records lost by the rings */
+    uint32_t clientsDropped; /**< subscribers dropped for being too slow */
+    uint32_t subscribers;
+};
+
+/**
+ * \brief publisher of the cycles of the boards of a process.
+ */
+class TelemetryServer
+{
+private:
+    std::string path;
+    uint16_t udpPort;
+    int periodMs;
+    int listenFd;
+    int udpFd;
+    StreamRing *rings[MAX_BOARDS];
+    int nbBoards;
+    StreamSubscriber subscribers[STREAM_MAX_SUBSCRIBERS];
+    std::atomic<uint64_t> frames;
+    std::atomic<uint64_t> records;
+    std::atomic<uint64_t> missed;
+    std::atomic<uint32_t> clientsDropped;
+    std::atomic<uint32_t> nbSubscribers;
+    std::atomic<bool> running;
+    std::thread worker;
+
+    void accept();
+    void receive(int index);
+    void receiveUdp();
+    void remove(int index, statusErrDef reason);
+    void send(StreamSubscriber &sub, const void *frame, size_t size, int nbRecords);
+    void flush(StreamRing &ring, uint64_t now);
+    void work();
+
+public:
+    TelemetryServer(const std::string &path = STREAM_SOCKET_PATH, uint16_t udpPort = 0,
+                    int periodMs = STREAM_BATCH_MS);
+    ~TelemetryServer();
+    int addBoard(uint8_t boardId, uint8_t nbChannels, uint8_t nbValves);
+    statusErrDef start();
+    void stop();
+    bool publish(int board, const SensorFrame &frame, uint32_t valveMask);
+    void getStats(StreamStats &out) const;
+};
+
+#endif // TELEMSERVER_H
@@ -0,0 +1,314 @@
+/**
+ * \file telemetry.cpp
+ * \brief Module recording one binary record per cycle in memory-mapped segment files
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * record() runs in the control loop : it copies the frame in the mapping
+ * of the active segment and publishes the new record count.
+ * Opening, preallocating, zeroing, syncing and closing the files is done
+ * by the sync thread, which keeps one segment prepared in advance. When no
+ * segment is ready the record is dropped and counted, record() never waits.
+ */
+
+#include "telemetry.h"
+#include "logger.h"
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cstring>
+#include <chrono>
+
+static const size_t segmentSize = sizeof(TelemSegmentHeader) + (size_t)TELEM_SEGMENT_RECORDS * sizeof(TelemRecord);
+
+/**
+ * \brief Constructor for the TelemetryRecorder class.
+ *
+ * \param boardName name of the CAC board, part of the file names
+ * \param nbChannels number of sensors recorded
+ * \param nbValves number of valves recorded
+ * \param dir directory of the segment files, ending with '/'
+ */
+TelemetryRecorder::TelemetryRecorder(const std::string &boardName, uint8_t nbChannels, uint8_t nbValves,
+                                     const std::string &dir)
+    : dir(dir), boardName(boardName), nbChannels(nbChannels), nbValves(nbValves),
+      active(nullptr), nextSequence(0), dropped(0), running(false)
+{
+    for (TelemSegment &seg : segments)
+    {
+        seg.state = segFree;
+        seg.fd = -1;
+        seg.header = nullptr;
+        seg.records = nullptr;
+        seg.count = 0;
+        seg.synced = 0;
+    }
+}
+
+/**
+ * \brief function to open, preallocate and map the next segment file.
+ * Every page is written once so record() doesn't fault on a new block.
+ *
+ * \return errOpenTelemFile when the file can't be opened, allocated or mapped.
+ */
+statusErrDef TelemetryRecorder::prepare(TelemSegment &seg)
+{
+    char path[256];
+    snprintf(path, sizeof(path), "%stelem_%s_%03u.bin", dir.c_str(), boardName.c_str(),
+             (unsigned)(nextSequence % TELEM_MAX_SEGMENTS));
+
+    seg.fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (seg.fd < 0)
+    {
+        perror("open telemetry segment");
+        logEvent(logTelem, errOpenTelemFile, "open telemetry segment failed (errno)", errno);
+        return errOpenTelemFile;
+    }
+
+    int ret = posix_fallocate(seg.fd, 0, segmentSize);
+    if (ret != 0)
+    {
+        logEvent(logTelem, errOpenTelemFile, "preallocate telemetry segment failed (errno)", ret);
+        close(seg.fd);
+        seg.fd = -1;
+        return errOpenTelemFile;
+    }
+
+    void *map = mmap(nullptr, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, seg.fd, 0);
+    if (map == MAP_FAILED)
+    {
+        logEvent(logTelem, errOpenTelemFile, "map telemetry segment failed (errno)", errno);
+        close(seg.fd);
+        seg.fd = -1;
+        return errOpenTelemFile;
+    }
+    // a failing mlock only costs page faults, the segment is still usable
+    mlock(map, segmentSize);
+    memset(map, 0, segmentSize);
+
+    seg.header = (TelemSegmentHeader *)map;
+    seg.records = (TelemRecord *)((char *)map + sizeof(TelemSegmentHeader));
+    seg.count.store(0, std::memory_order_relaxed);
+    seg.synced = 0;
+
+    TelemSegmentHeader &h = *seg.header;
+    h.magic = TELEM_MAGIC;
+    h.version = TELEM_VERSION;
+    h.recordSize = sizeof(TelemRecord);
+    h.capacity = TELEM_SEGMENT_RECORDS;
+    h.count = 0;
+    h.sequence = nextSequence++;
+    h.nbChannels = nbChannels;
+    h.nbValves = nbValves;
+    strncpy(h.boardName, boardName.c_str(), SHM_NAME_LENGTH - 1);
+
+    seg.state.store(segPrepared, std::memory_order_release);
+    return noError;
+}
+
+/**
+ * \brief function to write back the records added since the last sync,
+ * then the header holding their count.
+ *
+ * \param seg the segment to sync
+ * \param last true when record() doesn't use the segment anymore, the
+ * page holding the last record is then synced too
+ * \return errTestWriteFile when msync fails.
+ */
+statusErrDef TelemetryRecorder::sync(TelemSegment &seg, bool last)
+{
+    static const size_t pageSize = sysconf(_SC_PAGESIZE);
+    uint32_t count = seg.count.load(std::memory_order_acquire);
+    size_t end = sizeof(TelemSegmentHeader) + (size_t)count * sizeof(TelemRecord);
+    if (!last)
+    {
+        // leave the page being written, msync would make record() wait on its writeback
+        end -= end % pageSize;
+        count = (end - sizeof(TelemSegmentHeader)) / sizeof(TelemRecord);
+    }
+    if (count <= seg.synced)
+        return noError;
+
+    size_t begin = sizeof(TelemSegmentHeader) + (size_t)seg.synced * sizeof(TelemRecord);
+    begin -= begin % pageSize;
+
+    statusErrDef res = noError;
+    if (msync((char *)seg.header + begin, end - begin, MS_SYNC) < 0)
+        res = errTestWriteFile;
+    seg.header->count = count;
+    if (msync(seg.header, sizeof(TelemSegmentHeader), MS_SYNC) < 0)
+        res = errTestWriteFile;
+    if (res != noError)
+        logEvent(logTelem, errTestWriteFile, "sync telemetry segment failed (errno)", errno);
+    seg.synced = count;
+    return res;
+}
+
+/**
+ * \brief function to sync, unmap and close a segment left by record().
+ *
+ * \return errTestWriteFile or errCloseTelemFile when a step fails.
+ */
+statusErrDef TelemetryRecorder::retire(TelemSegment &seg)
+{
+    statusErrDef res = sync(seg, true);
+    munmap(seg.header, segmentSize);
+    seg.header = nullptr;
+    seg.records = nullptr;
+    if (close(seg.fd) < 0)
+    {
+        logEvent(logTelem, errCloseTelemFile, "close telemetry segment failed (errno)", errno);
+        res = errCloseTelemFile;
+    }
+    seg.fd = -1;
+    seg.state.store(segFree, std::memory_order_release);
+    return res;
+}
+
+/**
+ * \brief loop of the sync thread : retire the full segments, sync the
+ * active one and keep one segment prepared.
+ */
+void TelemetryRecorder::work()
+{
+    while (running.load(std::memory_order_relaxed))
+    {
+        bool prepared = false;
+        TelemSegment *freeSeg = nullptr;
+        for (TelemSegment &seg : segments)
+        {
+            int state = seg.state.load(std::memory_order_acquire);
+            if (state == segFull)
+                retire(seg);
+            else if (state == segActive)
+                sync(seg, false);
+            state = seg.state.load(std::memory_order_acquire);
+            if (state == segPrepared)
+                prepared = true;
+            else if (state == segFree && !freeSeg)
+                freeSeg = &seg;
+        }
+        if (!prepared && freeSeg)
+            prepare(*freeSeg);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(TELEM_SYNC_MS));
+    }
+}
+
+/**
+ * \brief function to prepare the first segment and start the sync thread.
+ *
+ * \return errOpenTelemFile when the first segment can't be prepared.
+ */
+statusErrDef TelemetryRecorder::start()
+{
+    if (running)
+        return noError;
+
+    mkdir(dir.c_str(), 0755);
+    // continue the numbering of the files left by a previous run
+    for (int i = 0; i < TELEM_MAX_SEGMENTS; i++)
+    {
+        char path[256];
+        snprintf(path, sizeof(path), "%stelem_%s_%03d.bin", dir.c_str(), boardName.c_str(), i);
+        int fd = open(path, O_RDONLY);
+        if (fd < 0)
+            continue;
+        TelemSegmentHeader h;
+        if (pread(fd, &h, sizeof(h), 0) == (ssize_t)sizeof(h) && h.magic == TELEM_MAGIC && h.sequence >= nextSequence)
+            nextSequence = h.sequence + 1;
+        close(fd);
+    }
+
+    statusErrDef res = prepare(segments[0]);
+    if (res != noError)
+        return res;
+
+    running = true;
+    worker = std::thread(&TelemetryRecorder::work, this);
+    return noError;
+}
+
+/**
+ * \brief function to stop the sync thread and close every segment.
+ * Must be called once the control loop doesn't call record() anymore.
+ */
+void TelemetryRecorder::stop()
+{
+    if (running.exchange(false))
+        worker.join();
+
+    active = nullptr;
+    for (TelemSegment &seg : segments)
+        if (seg.state.load(std::memory_order_acquire) != segFree)
+            retire(seg);
+}
+
+/**
+ * \brief function to append one cycle to the active segment, from the
+ * control loop. Switches to the prepared segment when the active one is full.
+ *
+ * \param frame the sensor frame of the cycle
+ * \param valveMask the applied valve states, bit i for valve i
+ * \return false when the record was dropped because no segment was ready.
+ */
+bool TelemetryRecorder::record(const SensorFrame &frame, uint32_t valveMask)
+{
+    uint32_t n = active ? active->count.load(std::memory_order_relaxed) : 0;
+    if (!active || n >= TELEM_SEGMENT_RECORDS)
+    {
+        if (active)
+            active->state.store(segFull, std::memory_order_release);
+        active = nullptr;
+        for (TelemSegment &seg : segments)
+        {
+            if (seg.state.load(std::memory_order_acquire) == segPrepared)
+            {
+                seg.state.store(segActive, std::memory_order_relaxed);
+                active = &seg;
+                n = 0;
+                break;
+            }
+        }
+        if (!active)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    TelemRecord &rec = active->records[n];
+    rec.timestamp = frame.timestamp;
+    rec.cycle = (uint32_t)frame.cycle;
+    rec.valveMask = (uint16_t)valveMask;
+    uint16_t errors = 0;
+    for (int i = 0; i < nbChannels; i++)
+    {
+        rec.values[i] = frame.sensors[i].value;
+        if (frame.sensors[i].status != noError)
+            errors |= 1 << i;
+    }
+    rec.errorMask = errors;
+    active->count.store(n + 1, std::memory_order_release);
+    return true;
+}
+
+/**
+ * \brief function to get the number of records dropped since the start.
+ */
+uint64_t TelemetryRecorder::getDropped() const
+{
+    return dropped.load(std::memory_order_relaxed);
+}
+
+/**
+ * \brief Destructor for the TelemetryRecorder class.
+ */
+TelemetryRecorder::~TelemetryRecorder()
+{
+    stop();
+}
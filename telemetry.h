@@ -0,0 +1,135 @@
+/**
+ * \file telemetry.h
+ * \brief header file of the telemetry recorder
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * Contains the binary layout of the telemetry segment files and the
+ * recorder that appends one record per cycle to them.
+ *
+ * The segments are preallocated and memory-mapped by a background thread,
+ * the control loop only copies a record in the mapping. The background
+ * thread syncs the written records in batches, closes the full segments
+ * and prepares the next ones. TELEM_MAX_SEGMENTS files are reused in turn.
+ *
+ * A record is never written in a page being synced : the sync stops at
+ * the page holding the last record, and the header count only covers the
+ * synced records. Records written after the last sync are still in the
+ * file after a crash of the program, the dump tool finds them by their
+ * non-zero timestamp.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "configDefine.h"
+#include "statusErrorDefine.h"
+#include "shmLayout.h"
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <string>
+
+/**
+ * \brief "CACT" in little endian, first word of a segment file
+ */
+#define TELEM_MAGIC 0x54434143
+/**
+ * \brief version of the segment file layout
+ */
+#define TELEM_VERSION 1
+
+/**
+ * \brief header of a segment file, followed by TELEM_SEGMENT_RECORDS records
+ */
+struct alignas(CACHE_LINE_SIZE) TelemSegmentHeader
+{
+    uint32_t magic;                  /**< TELEM_MAGIC */
+    uint16_t version;                /**< TELEM_VERSION */
+    uint16_t recordSize;             /**< sizeof(TelemRecord) */
+    uint32_t capacity;               /**< records the file can hold */
+    uint32_t count;                  /**< records synced to the file */
+    uint64_t sequence;               /**< segment number since the recorder started */
+    uint8_t nbChannels;              /**< valid entries of TelemRecord::values */
+    uint8_t nbValves;                /**< valid bits of TelemRecord::valveMask */
+    uint16_t reserved;
+    char boardName[SHM_NAME_LENGTH]; /**< CAC board name */
+};
+
+/**
+ * \brief one cycle : timestamped channel vector and valve states
+ */
+struct TelemRecord
+{
+    uint64_t timestamp;               /**< CLOCK_MONOTONIC end of the acquisition in ns */
+    uint32_t cycle;                   /**< acquisition cycle */
+    uint16_t valveMask;               /**< bit i set when valve i is open */
+    uint16_t errorMask;               /**< bit i set when sensor i was not read correctly */
+    int16_t values[MAX_SENSORS];      /**< raw ADC counts */
+};
+
+static_assert(sizeof(TelemSegmentHeader) == CACHE_LINE_SIZE);
+static_assert(sizeof(TelemRecord) == 40);
+static_assert(MAX_SENSORS <= 16 && MAX_VALVES <= 16, "the telemetry masks are 16 bits wide");
+
+/**
+ * \enum telemSegmentState
+ * \brief owner of a segment : the sync thread (free, prepared, full)
+ * or the control loop (active)
+ */
+typedef enum
+{
+    segFree,     /**< not mapped */
+    segPrepared, /**< mapped and zeroed, ready to be written */
+    segActive,   /**< written by record() */
+    segFull,     /**< full or left by record(), to be synced and closed */
+} telemSegmentState;
+
+/**
+ * \brief a mapped segment file and its hand-over state
+ */
+struct TelemSegment
+{
+    std::atomic<int> state;     /**< telemSegmentState */
+    int fd;
+    TelemSegmentHeader *header; /**< start of the mapping */
+    TelemRecord *records;       /**< records after the header */
+    std::atomic<uint32_t> count; /**< records written by record() */
+    uint32_t synced;             /**< records already synced */
+};
+
+/**
+ * \brief appends cycle records to memory-mapped segment files
+ * without allocation, lock or blocking I/O in record().
+ */
+class TelemetryRecorder
+{
+private:
+    std::string dir;
+    std::string boardName;
+    uint8_t nbChannels;
+    uint8_t nbValves;
+    TelemSegment segments[3]; /**< active, prepared and retiring segments */
+    TelemSegment *active;     /**< segment written by record(), control loop only */
+    uint64_t nextSequence;    /**< sequence of the next prepared segment */
+    std::atomic<uint64_t> dropped;
+    std::atomic<bool> running;
+    std::thread worker;
+
+    statusErrDef prepare(TelemSegment &seg);
+    statusErrDef sync(TelemSegment &seg, bool last);
+    statusErrDef retire(TelemSegment &seg);
+    void work();
+
+public:
+    TelemetryRecorder(const std::string &boardName, uint8_t nbChannels, uint8_t nbValves,
+                      const std::string &dir = TELEM_DIR);
+    ~TelemetryRecorder();
+    statusErrDef start();
+    void stop();
+    bool record(const SensorFrame &frame, uint32_t valveMask);
+    uint64_t getDropped() const;
+};
+
+#endif // TELEMETRY_H
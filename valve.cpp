@@ -21,7 +21,7 @@
  */
 
 Valve::Valve(const std::string &name, int8_t id_v, int gpio_pin)
-    : name(name), id_v(id_v), state(0), gpio_pin(gpio_pin), chip(nullptr), line(nullptr) {}
+    : name(name), id_v(id_v), state(0), gpio_pin(gpio_pin), chip(nullptr), line(nullptr), applied(-1) {}
 
 /**
  * \brief Initializes the GPIO line for the valve control.
@@ -66,15 +66,22 @@ statusErrDef Valve::init()
         gpiod_chip_close(chip);
         return errGPIORequestOutput;
     }
+    applied = 0;
     return res;
 }
 
+/**
+ * \brief Writes the state to the GPIO line when it differs
+ * from the last written value.
+ */
+
 void Valve::apply_change()
 {
-    if (line)
+    if (line && state != applied)
     {
         gpiod_line_set_value(line, state);
-        std::cout << name << " change state to " << state << std::endl;
+        applied = state;
+        logEvent(logValve, infoValveStateChanged, "change state (id, pin, state)", id_v, gpio_pin, state);
     }
 }
 
@@ -82,7 +89,8 @@ void Valve::apply_change()
  * \brief Activates the valve.
  *
  * Sets the GPIO line value to 1, indicating that the valve is enabled.
- * An acknowledgment message is printed to the console.
+ * A record is pushed to the log ; the commands of the clients are
+ * acknowledged by CommandQueue::acknowledge() with their actuation cycle.
  */
 
 void Valve::activate()
@@ -91,7 +99,7 @@ void Valve::activate()
     {
         state = 1;
         apply_change();
-        std::cout << name << " enabled." << std::endl; // Il faudra envoyer l'acquitement
+        logEvent(logValve, noError, "enabled (id)", id_v);
     }
 }
 
@@ -99,7 +107,7 @@ void Valve::activate()
  * \brief Deactivates the valve.
  *
  * Sets the GPIO line value to 0, indicating that the valve is disabled.
- * An acknowledgment message is printed to the console.
+ * An acknowledgment record is pushed to the log.
  */
 
 void Valve::desactivate()
@@ -108,7 +116,7 @@ void Valve::desactivate()
     {
         state = 0;
         apply_change();
-        std::cout << name << " disabled." << std::endl;
+        logEvent(logValve, noError, "disabled (id)", id_v);
     }
 }
 
@@ -123,6 +131,28 @@ int Valve::getstate() const
     return state;
 }
 
+/**
+ * \brief Gets the GPIO pin controlling the valve.
+ *
+ * \return The GPIO line offset on CHIP_PATH.
+ */
+
+int Valve::getPin() const
+{
+    return gpio_pin;
+}
+
+/**
+ * \brief Gets the name of the valve.
+ *
+ * \return The valve name.
+ */
+
+const std::string &Valve::getName() const
+{
+    return name;
+}
+
 /**
  * \brief Destructor for the Valve class.
  *
@@ -6,6 +6,7 @@
 #include <cstring>
 #include <cstdint>
 #include "statusErrorDefine.h"
+#include "logger.h"
 
 #define CHIP_PATH "/dev/gpiochip0"
 
@@ -26,6 +27,7 @@ private:
     int gpio_pin;     /**< GPIO pin controlling the Valve */
     gpiod_chip *chip; /**< Pointer to the GPIO chip */
     gpiod_line *line; /**< Pointer to the GPIO line */
+    int applied;      /**< Last value written to the line, -1 before init */
 
 public:
     int8_t id_v;
@@ -36,6 +38,8 @@ public:
     void activate();
     void desactivate();
     int getstate() const;
+    int getPin() const;
+    const std::string &getName() const;
     ~Valve();
 };
 
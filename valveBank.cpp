@@ -0,0 +1,270 @@
+/**
+ * \file valveBank.cpp
+ * \brief Module to drive the valves of a CAC Board with bulk GPIO requests
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ */
+
+#include "valveBank.h"
+
+/**
+ * \brief Constructor for the ValveBank class.
+ *
+ * \param chipPath The GPIO chip holding the valve lines, when the real lines are selected.
+ */
+
+ValveBank::ValveBank(const char *chipPath)
+    : chipPath(chipPath), nbValves(0), opened(false), applied(0), reserved(0), dirty(0), transitions{}, nbWrites(0)
+{
+    busy.clear();
+}
+
+/**
+ * \brief Adds a valve to the bank. Must be called before init().
+ *
+ * \param valve The valve, it must stay at the same address while the bank is used.
+ * \return errGPIOGetLine when the bank is full or already initialized, noError otherwise.
+ */
+
+statusErrDef ValveBank::addValve(Valve *valve)
+{
+    if (opened || nbValves >= MAX_VALVES)
+        return errGPIOGetLine;
+
+    valves[nbValves++] = valve;
+    return noError;
+}
+
+/**
+ * \brief Creates the GPIO backend selected at startup and requests every
+ * valve line as an output in a single bulk request, with the current
+ * valve states as initial values.
+ *
+ * \return errGPIOPathEmpty, errOpenGPIO, errGPIOGetLine or errGPIORequestOutput
+ * when a step fails, noError otherwise.
+ */
+
+statusErrDef ValveBank::init()
+{
+    if (opened)
+        return errGPIOGetLine;
+
+    unsigned int offsets[MAX_VALVES];
+    uint32_t initial = 0;
+    for (int i = 0; i < nbValves; i++)
+    {
+        offsets[i] = valves[i]->getPin();
+        values[i] = valves[i]->getstate() ? 1 : 0;
+        initial |= (uint32_t)values[i] << i;
+    }
+    applied.store(initial, std::memory_order_relaxed);
+
+    gpio = halCreateGpio(chipPath);
+    statusErrDef res = gpio->open(offsets, nbValves, values);
+    if (res != noError)
+    {
+        gpio.reset();
+        return res;
+    }
+    opened = true;
+    return noError;
+}
+
+/**
+ * \brief Writes the valves whose commanded state differs from the last
+ * applied one. The changed valves are written with a single bulk call,
+ * so they switch at the same time, and nothing is written when no
+ * command changed. The reserved valves keep their last written state.
+ *
+ * \return errValueIsNotBinary when a state is not 0 or 1,
+ * errGPIOSetValue when the write fails, noError otherwise.
+ */
+
+statusErrDef ValveBank::apply()
+{
+    if (!opened)
+        return errGPIOSetValue;
+
+    uint32_t commanded = 0;
+    for (int i = 0; i < nbValves; i++)
+    {
+        int state = valves[i]->getstate();
+        if (state != 0 && state != 1)
+            return errValueIsNotBinary;
+        commanded |= (uint32_t)state << i;
+    }
+
+    while (busy.test_and_set(std::memory_order_acquire))
+        ;
+    uint32_t last = applied.load(std::memory_order_relaxed);
+    uint32_t kept = reserved.load(std::memory_order_relaxed);
+    statusErrDef res = writeLocked((commanded & ~kept) | (last & kept));
+    busy.clear(std::memory_order_release);
+    return res;
+}
+
+/**
+ * \brief Writes the given valves with a single bulk call, between the
+ * cycles. Only the valves reserved with reserve() are written, the
+ * others stay under apply().
+ *
+ * \param mask The valves to write, bit i for valve i.
+ * \param states Their states, bit i for valve i.
+ * \param written Receives the valves still reserved, so taken by the write, nullptr to ignore.
+ * \return errGPIOSetValue when the write fails, noError otherwise.
+ */
+
+statusErrDef ValveBank::write(uint32_t mask, uint32_t states, uint32_t *written)
+{
+    if (!opened)
+        return errGPIOSetValue;
+
+    while (busy.test_and_set(std::memory_order_acquire))
+        ;
+    uint32_t last = applied.load(std::memory_order_relaxed);
+    mask &= reserved.load(std::memory_order_relaxed);
+    statusErrDef res = writeLocked((last & ~mask) | (states & mask));
+    busy.clear(std::memory_order_release);
+    if (written)
+        *written = mask;
+    return res;
+}
+
+/**
+ * \brief Writes the lines to the given states when they differ from the
+ * applied ones. The caller holds busy.
+ */
+
+statusErrDef ValveBank::writeLocked(uint32_t commanded)
+{
+    dirty = commanded ^ applied.load(std::memory_order_relaxed);
+    if (!dirty)
+        return noError;
+
+    // a bulk write covers the whole request, unchanged lines keep their value
+    for (int i = 0; i < nbValves; i++)
+        values[i] = (commanded >> i) & 1;
+    nbWrites++;
+    if (gpio->write(values) != noError)
+        return errGPIOSetValue;
+
+    for (uint32_t d = dirty; d; d &= d - 1)
+        transitions[__builtin_ctz(d)]++;
+    applied.store(commanded, std::memory_order_release);
+    return noError;
+}
+
+/**
+ * \brief Hands valves over to write() : apply() leaves them at their last
+ * written state until unreserve().
+ *
+ * \param mask The valves, bit i for valve i.
+ */
+
+void ValveBank::reserve(uint32_t mask)
+{
+    reserved.fetch_or(mask, std::memory_order_release);
+}
+
+/**
+ * \brief Returns every reserved valve to apply(), which writes their
+ * commanded state at its next call. Taken between two writes, a write()
+ * after it leaves the lines untouched.
+ */
+
+void ValveBank::unreserve()
+{
+    while (busy.test_and_set(std::memory_order_acquire))
+        ;
+    reserved.store(0, std::memory_order_release);
+    busy.clear(std::memory_order_release);
+}
+
+/**
+ * \brief Releases the lines and the GPIO backend.
+ */
+
+void ValveBank::release()
+{
+    if (opened)
+    {
+        gpio->close();
+        gpio.reset();
+        opened = false;
+    }
+}
+
+/**
+ * \brief Gets the GPIO backend of the bank, nullptr before init().
+ */
+
+GpioBackend *ValveBank::getBackend() const
+{
+    return gpio.get();
+}
+
+/**
+ * \brief Gets the number of valves of the bank.
+ */
+
+int ValveBank::size() const
+{
+    return nbValves;
+}
+
+/**
+ * \brief Gets the last applied states, bit i for valve i.
+ */
+
+uint32_t ValveBank::getAppliedMask() const
+{
+    return applied.load(std::memory_order_acquire);
+}
+
+/**
+ * \brief Gets the valves written by the last apply(), bit i for valve i.
+ */
+
+uint32_t ValveBank::getDirtyMask() const
+{
+    return dirty;
+}
+
+/**
+ * \brief Gets the valves reserved for write(), bit i for valve i.
+ */
+
+uint32_t ValveBank::getReservedMask() const
+{
+    return reserved.load(std::memory_order_acquire);
+}
+
+/**
+ * \brief Gets the number of real state changes of a valve, for wear monitoring.
+ *
+ * \param index The valve index, in the order of addValve().
+ */
+
+uint64_t ValveBank::getTransitions(int index) const
+{
+    return (index >= 0 && index < nbValves) ? transitions[index] : 0;
+}
+
+/**
+ * \brief Gets the number of bulk writes issued to the GPIO chip.
+ */
+
+uint64_t ValveBank::getNbWrites() const
+{
+    return nbWrites;
+}
+
+/**
+ * \brief Destructor for the ValveBank class.
+ */
+
+ValveBank::~ValveBank()
+{
+    release();
+}
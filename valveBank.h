@@ -0,0 +1,71 @@
+#ifndef VALVEBANK_H
+#define VALVEBANK_H
+
+#include <gpiod.h>
+#include <cstdint>
+#include "configDefine.h"
+#include "statusErrorDefine.h"
+#include "valve.h"
+#include "hal.h"
+#include <memory>
+#include <atomic>
+
+static_assert(MAX_VALVES <= 32, "the valve masks are 32 bits wide");
+
+/**
+ * \file valveBank.h
+ * \brief Header file of the valve bank that drives every valve of a CAC board at once
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * The bank opens the GPIO backend once, requests the lines of all its valves
+ * in a single bulk request, and writes every state with one bulk write
+ * (gpiod_line_set_value_bulk() on the real chip) so the valves switch simultaneously.
+ *
+ * The last applied states are kept as a bitmask : the lines are only
+ * written when a commanded state differs, so an idle cycle costs no syscall.
+ *
+ * The valves reserved by a ValveScheduler are written by its thread with
+ * write(), between the cycles : apply() leaves them at their last written
+ * state until unreserve(). A spinlock serializes the two writers, it is
+ * only held for the bulk write itself.
+ */
+class ValveBank
+{
+private:
+    const char *chipPath;        /**< GPIO chip, CHIP_PATH or a gpio-sim chip */
+    std::unique_ptr<GpioBackend> gpio; /**< Lines of the valves, in the order of valves */
+    Valve *valves[MAX_VALVES];   /**< Valves driven by the bank */
+    int values[MAX_VALVES];      /**< Values written to the lines */
+    int nbValves;
+    bool opened;                 /**< Lines requested by init() */
+    std::atomic<uint32_t> applied; /**< Bit i set when valve i was last written open */
+    std::atomic<uint32_t> reserved; /**< Valves written by write() only */
+    std::atomic_flag busy;       /**< Held while the lines are written */
+    uint32_t dirty;              /**< Valves whose command differed at the last apply() */
+    uint64_t transitions[MAX_VALVES]; /**< Real state changes per valve */
+    uint64_t nbWrites;           /**< Bulk writes issued to the chip */
+
+    statusErrDef writeLocked(uint32_t commanded);
+
+public:
+    ValveBank(const char *chipPath = CHIP_PATH);
+    statusErrDef addValve(Valve *valve);
+    statusErrDef init();
+    statusErrDef apply();
+    statusErrDef write(uint32_t mask, uint32_t states, uint32_t *written = nullptr);
+    void reserve(uint32_t mask);
+    void unreserve();
+    void release();
+    int size() const;
+    uint32_t getAppliedMask() const;
+    uint32_t getDirtyMask() const;
+    uint32_t getReservedMask() const;
+    uint64_t getTransitions(int index) const;
+    uint64_t getNbWrites() const;
+    GpioBackend *getBackend() const;
+    ~ValveBank();
+};
+
+#endif
@@ -0,0 +1,451 @@
+/**
+ * \file valveScheduler.cpp
+ * \brief Module writing the actions of a valve sequence at their deadline
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * Errors of load(), reported with the file and line, the first one is returned :
+ * - errOpenSequenceFile : line malformed, time not a positive number of
+ *   milliseconds, state not 0 or 1, valve not on the board
+ * - errAllocDataSequence : more than SCHED_MAX_ACTIONS actions
+ * A missing sequence.csv is not an error, the board has no sequence.
+ *
+ * A min-heap rather than a timer wheel : the sequences hold a few
+ * thousand actions at most and their deadlines are arbitrary
+ * nanoseconds, a wheel would need a slot per resolution step over the
+ * whole sequence, while a pop costs log2(SCHED_MAX_ACTIONS) compares.
+ * Everything is allocated before start(), the thread itself never
+ * allocates.
+ */
+
+#include "valveScheduler.h"
+#include "monotonicClock.h"
+#include "csvReader.h"
+#include "logger.h"
+#include <algorithm>
+#include <stdio.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/prctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#define NSEC_PER_SEC 1000000000ll
+
+/**
+ * \brief longest sleep of the thread, so abort() is noticed
+ */
+#define SCHED_MAX_SLEEP_NS ((int64_t)100000000)
+
+static struct timespec fromNs(int64_t ns)
+{
+    struct timespec ts;
+    ts.tv_sec = ns / NSEC_PER_SEC;
+    ts.tv_nsec = ns % NSEC_PER_SEC;
+    return ts;
+}
+
+/**
+ * \brief function to read a time in milliseconds, with up to 6 decimals,
+ * without the rounding of a float.
+ */
+static bool parseMs(std::string_view text, uint64_t &ns)
+{
+    uint64_t ms = 0, frac = 0;
+    size_t i = 0;
+    for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; i++)
+        if ((ms = ms * 10 + (text[i] - '0')) > 86400000ull)
+            return false;
+    if (i == 0)
+        return false;
+    int decimals = 0;
+    if (i < text.size() && text[i] == '.')
+        for (i++; i < text.size() && text[i] >= '0' && text[i] <= '9' && decimals < 6; i++, decimals++)
+            frac = frac * 10 + (text[i] - '0');
+    if (i != text.size())
+        return false;
+    for (; decimals < 6; decimals++)
+        frac *= 10;
+    ns = ms * 1000000ull + frac;
+    return true;
+}
+
+/**
+ * \brief the earliest deadline at the front of the heap, the earliest
+ * scheduled first on equal deadlines.
+ */
+static bool later(const ValveAction &a, const ValveAction &b)
+{
+    return a.deadlineNs != b.deadlineNs ? a.deadlineNs > b.deadlineNs : a.index > b.index;
+}
+
+ValveScheduler::ValveScheduler(ValveBank &bank, const SchedulerConfig &config)
+    : bank(bank), config(config), reservedMask(0), rules(nullptr), sensors(nullptr), frame{}, stats{},
+      result(noError), stopped(false), done(true), runs(0)
+{
+}
+
+ValveScheduler::~ValveScheduler()
+{
+    abort();
+    wait();
+}
+
+/**
+ * \brief function to filter the writes of the sequence with the interlock
+ * rules of the board, before start().
+ *
+ * \param rules the interlock rules, nullptr for none
+ * \param sensors the sensor segment giving the conditions of the rules,
+ * nullptr to hold every opening with a sensor condition closed
+ */
+void ValveScheduler::setInterlock(const Interlock *rules, const SensorData *sensors)
+{
+    this->rules = rules;
+    this->sensors = sensors;
+}
+
+/**
+ * \brief function to remove every action, before start() or once the
+ * sequence is done.
+ */
+void ValveScheduler::clear()
+{
+    actions.clear();
+    reservedMask = 0;
+}
+
+/**
+ * \brief function to add an action, before start().
+ *
+ * \param offsetNs deadline from T0
+ * \param mask valves written, bit i for valve i of the bank
+ * \param values their states, bit i for valve i of the bank
+ * \return errAllocDataSequence when SCHED_MAX_ACTIONS actions are already
+ * scheduled, errDependOutsideOfRange for a valve not in the bank,
+ * errSchedulerRunning while a sequence runs, noError otherwise.
+ */
+statusErrDef ValveScheduler::schedule(uint64_t offsetNs, uint32_t mask, uint32_t values)
+{
+    if (!isDone())
+        return errSchedulerRunning;
+    if (actions.size() >= SCHED_MAX_ACTIONS)
+        return errAllocDataSequence;
+    if (bank.size() < 32 && (mask >> bank.size()) != 0)
+        return errDependOutsideOfRange;
+
+    // allocated once, the runs never grow the vectors
+    if (actions.capacity() < SCHED_MAX_ACTIONS)
+    {
+        actions.reserve(SCHED_MAX_ACTIONS);
+        heap.reserve(SCHED_MAX_ACTIONS);
+        batch.reserve(SCHED_MAX_ACTIONS);
+        reports.reserve(SCHED_MAX_ACTIONS);
+    }
+    actions.push_back(ValveAction{offsetNs, mask, values & mask, (uint32_t)actions.size()});
+    reservedMask |= mask;
+    return noError;
+}
+
+/**
+ * \brief function to read sequence.csv and schedule the actions of a
+ * board, in addition to the actions already scheduled.
+ *
+ * Each line is board;time;valve;state, time in milliseconds from T0
+ * with up to 6 decimals, state 0 or 1.
+ *
+ * \param board the valve slots of the board, in the order of the bank
+ * \param path the sequence file
+ * \return statusErrDef of the first invalid line, or noError.
+ */
+statusErrDef ValveScheduler::load(const BoardConfig &board, const char *path)
+{
+    if (!isDone())
+        return errSchedulerRunning;
+    if (access(path, F_OK) != 0)
+        return noError;
+    CsvFile file;
+    if (!file.open(path))
+    {
+        perror(path);
+        return errOpenSequenceFile;
+    }
+
+    statusErrDef res = noError;
+    std::string_view boardName(board.name);
+    std::string_view line;
+    int nbLines = 0;
+    while (file.nextLine(line, "board"))
+    {
+        std::string_view fields[4];
+        int n = csvSplitFields(line, fields, 4);
+        if (fields[0] != boardName)
+            continue;
+        nbLines++;
+
+        uint64_t offsetNs = 0;
+        int state = 0;
+        int slot = -1;
+        for (int v = 0; n > 2 && v < board.nbValves && slot < 0; v++)
+            if (fields[2] == board.valves[v].name)
+                slot = v;
+        statusErrDef err = errOpenSequenceFile;
+        const char *msg = nullptr;
+        if (n < 4)
+            msg = "expected board;time;valve;state";
+        else if (!parseMs(fields[1], offsetNs))
+            msg = "time not a number of milliseconds";
+        else if (!csvToInt(fields[3], state) || (state != 0 && state != 1))
+            msg = "state 0 or 1";
+        else if (slot < 0)
+            msg = "valve not on the board";
+        else
+        {
+            err = schedule(offsetNs, 1u << slot, (uint32_t)state << slot);
+            if (err == errAllocDataSequence)
+                msg = "more than SCHED_MAX_ACTIONS actions";
+        }
+        if (err != noError)
+        {
+            csvReport(path, file.getLineNumber(), err, msg ? msg : "action refused");
+            if (res == noError)
+                res = err;
+        }
+    }
+
+    logEvent(logValve, res, "valve sequence loaded (board, lines, actions)", board.id, nbLines,
+             (int32_t)actions.size());
+    return res;
+}
+
+/**
+ * \brief function to reserve the valves of the sequence in the bank and
+ * start its thread. The deadlines are taken from T0 on CLOCK_MONOTONIC.
+ *
+ * \param t0Ns T0 on CLOCK_MONOTONIC, the actions already passed are written at once
+ * \return errSchedulerRunning while a sequence runs, noError otherwise.
+ */
+statusErrDef ValveScheduler::start(uint64_t t0Ns)
+{
+    if (!isDone())
+        return errSchedulerRunning;
+    if (thread.joinable())
+        thread.join();
+
+    heap.clear();
+    reports.clear();
+    for (const ValveAction &a : actions)
+    {
+        heap.push_back(ValveAction{t0Ns + a.deadlineNs, a.mask, a.values, a.index});
+        reports.push_back(ActionReport{t0Ns + a.deadlineNs, 0, 0, 0, infoActionPending});
+    }
+    std::make_heap(heap.begin(), heap.end(), later);
+    stats = SchedulerStats{(uint32_t)actions.size(), 0, 0, 0, 0, 0, 0};
+    result = noError;
+    // until a frame is read, every sensor condition fails
+    frame = SensorFrame{};
+    for (int s = 0; s < MAX_SENSORS; s++)
+        frame.sensors[s].status = errReadAdc;
+
+    // running before reserved, a reserved valve is never seen with a done sequence
+    stopped.store(false, std::memory_order_relaxed);
+    done.store(false, std::memory_order_relaxed);
+    bank.reserve(reservedMask);
+    runs.fetch_add(1, std::memory_order_release);
+    thread = std::thread(&ValveScheduler::run, this);
+    return noError;
+}
+
+/**
+ * \brief body of the thread : sleep until the earliest deadline, write
+ * every action due with it, until the heap is empty or abort(). It
+ * doesn't log, a thread per run would take a log ring per run : the end
+ * is logged by the owner of the sequence, from getStats().
+ */
+void ValveScheduler::run()
+{
+    if (config.cpu >= 0)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(config.cpu, &set);
+        int ret = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (ret != 0)
+        {
+            errno = ret;
+            perror("pthread_setaffinity_np()");
+            result = errCpuAffinity;
+        }
+    }
+    // the default slack of 50 us of SCHED_OTHER would delay every wake-up
+    prctl(PR_SET_TIMERSLACK, 1ul, 0ul, 0ul, 0ul);
+    if (config.priority > 0)
+    {
+        struct sched_param param = {};
+        param.sched_priority = config.priority;
+        int ret = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (ret != 0)
+        {
+            errno = ret;
+            perror("pthread_setschedparam()");
+            result = errSchedRealTime;
+        }
+    }
+
+    while (!heap.empty() && !stopped.load(std::memory_order_relaxed))
+    {
+        // sleep on absolute deadlines, in slices so abort() is noticed
+        const int64_t first = (int64_t)heap.front().deadlineNs;
+        int64_t now = monotonicNs();
+        while (now < first - config.spinNs && !stopped.load(std::memory_order_relaxed))
+        {
+            struct timespec deadline = fromNs(std::min(first - config.spinNs, now + SCHED_MAX_SLEEP_NS));
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR)
+                ;
+            now = monotonicNs();
+        }
+        if (stopped.load(std::memory_order_relaxed))
+            break;
+        while (now < first)
+            now = monotonicNs();
+
+        // every action due with the first one, or already passed, in one
+        // bulk write ; the later action wins on a valve written twice
+        const int64_t limit = std::max(first + config.coalesceNs, now);
+        uint32_t mask = 0, values = 0;
+        batch.clear();
+        while (!heap.empty() && (int64_t)heap.front().deadlineNs <= limit)
+        {
+            std::pop_heap(heap.begin(), heap.end(), later);
+            const ValveAction &a = heap.back();
+            values = (values & ~a.mask) | a.values;
+            mask |= a.mask;
+            batch.push_back(a.index);
+            heap.pop_back();
+        }
+
+        // the interlock rules on the valves after the write, like in the
+        // cycle : an opening refused is held closed, a valve of the
+        // sequence whose dependencies are lost is closed with the write
+        uint32_t held = 0;
+        if (rules)
+        {
+            SensorFrame last;
+            if (sensors && seqlockRead(&sensors->seq, &sensors->frame, last))
+                frame = last;
+            uint32_t applied = bank.getAppliedMask();
+            uint32_t allowed;
+            rules->check((applied & ~mask) | values, applied, frame, allowed, held);
+            held &= mask;
+            mask |= applied & ~allowed & reservedMask;
+            values &= allowed;
+        }
+
+        int64_t w0 = monotonicNs();
+        uint32_t written = 0;
+        statusErrDef res = bank.write(mask, values, &written);
+        int64_t w1 = monotonicNs();
+        uint32_t nbWritten = 0;
+        for (uint32_t index : batch)
+        {
+            ActionReport &r = reports[index];
+            const ValveAction &a = actions[index];
+            if (a.mask & ~written)
+            {
+                // the valves were handed back by abort() before the write
+                r.status = infoSequenceAborted;
+                stats.nbDropped++;
+                continue;
+            }
+            r.errorNs = w0 - (int64_t)r.deadlineNs;
+            r.writeNs = (uint32_t)(w1 - w0);
+            r.batch = stats.nbBatches;
+            r.status = res != noError              ? res
+                       : (a.values & held)         ? errActionInterlocked
+                       : r.errorNs > SCHED_LATE_NS ? errActionLate
+                                                   : noError;
+            stats.nbInterlocked += r.status == errActionInterlocked;
+            stats.nbLate += r.errorNs > SCHED_LATE_NS;
+            stats.maxErrorNs = std::max(stats.maxErrorNs, r.errorNs);
+            nbWritten++;
+        }
+        if (res != noError && result == noError)
+            result = res;
+        stats.nbWritten += nbWritten;
+        stats.nbBatches += nbWritten != 0;
+    }
+
+    for (const ValveAction &a : heap)
+        reports[a.index].status = infoSequenceAborted;
+    stats.nbDropped += (uint32_t)heap.size();
+    done.store(true, std::memory_order_release);
+}
+
+/**
+ * \brief function to stop the sequence and hand its valves back to the
+ * cycle at once, with their commands, without waiting for the thread :
+ * the actions not written yet are dropped, getStats().nbDropped counts
+ * them once the thread is done. Safe from the cycle thread.
+ */
+void ValveScheduler::abort()
+{
+    stopped.store(true, std::memory_order_relaxed);
+    bank.unreserve();
+}
+
+/**
+ * \brief function to wait for the end of the thread.
+ *
+ * \return the first error of the run : errCpuAffinity or errSchedRealTime
+ * when the real-time settings can't be applied, errGPIOSetValue when a
+ * write failed, or noError.
+ */
+statusErrDef ValveScheduler::wait()
+{
+    if (thread.joinable())
+        thread.join();
+    return result;
+}
+
+/**
+ * \brief function to know whether the thread has written or dropped
+ * every action, the valves may still be reserved.
+ */
+bool ValveScheduler::isDone() const
+{
+    return done.load(std::memory_order_acquire);
+}
+
+/**
+ * \brief function to get the number of runs started, so the owner
+ * notices the end of each one with isDone().
+ */
+uint32_t ValveScheduler::getRuns() const
+{
+    return runs.load(std::memory_order_acquire);
+}
+
+int ValveScheduler::getNbActions() const
+{
+    return (int)actions.size();
+}
+
+/**
+ * \brief function to get what happened to an action, once the sequence is done.
+ *
+ * \param index the action, in the order of schedule()
+ */
+const ActionReport &ValveScheduler::getReport(int index) const
+{
+    return reports[index];
+}
+
+/**
+ * \brief function to get the figures of the last run, once the sequence is done.
+ */
+const SchedulerStats &ValveScheduler::getStats() const
+{
+    return stats;
+}
@@ -0,0 +1,132 @@
+/**
+ * \file valveScheduler.h
+ * \brief header file of the time-triggered valve sequence scheduler
+ * \author Jiajin LU
+ * \version 1.0
+ * \date 17/10/2026
+ *
+ * Contains the scheduler writing the actions of a valve sequence at their
+ * own deadline, finer than the cycle : e.g. open VCE at T0 + 120 ms, close
+ * VCo at T0 + 135.5 ms. The actions are kept in a binary min-heap on
+ * their deadline ; the thread of the scheduler sleeps with
+ * clock_nanosleep(TIMER_ABSTIME) until the earliest one, optionally spins
+ * the last SCHED_SPIN_NS, and writes every action due within
+ * SCHED_COALESCE_NS of it with a single bulk write. The time error of
+ * each action, from its deadline to its write, is reported.
+ *
+ * The valves of the sequence are reserved in the ValveBank from start()
+ * until the board hands them back : the cycle no longer commands them.
+ * Every bulk write is still filtered by the interlock rules of the board,
+ * on the last sensor frame read through its seqlock : an opening refused
+ * is held closed and its action reported errActionInterlocked, and the
+ * cycle closes a reserved valve whose dependencies are lost between two
+ * writes. An alarm safe state aborts the sequence.
+ */
+
+#ifndef VALVESCHEDULER_H
+#define VALVESCHEDULER_H
+
+#include "configDefine.h"
+#include "statusErrorDefine.h"
+#include "physicalConfig.h"
+#include "shmLayout.h"
+#include "interlock.h"
+#include "valveBank.h"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+/**
+ * \brief real-time settings of the scheduler thread
+ */
+struct SchedulerConfig
+{
+    int priority = RT_PRIORITY;            /**< SCHED_FIFO priority, 0 for SCHED_OTHER */
+    int cpu = RT_CPU;                      /**< CPU to pin the thread to, -1 for none */
+    int64_t spinNs = SCHED_SPIN_NS;        /**< spun before each deadline, 0 to only sleep */
+    int64_t coalesceNs = SCHED_COALESCE_NS; /**< actions this close to the first due are written together */
+};
+
+/**
+ * \brief one action of a sequence
+ */
+struct ValveAction
+{
+    uint64_t deadlineNs; /**< from T0 until start(), then on CLOCK_MONOTONIC */
+    uint32_t mask;       /**< valves written, bit i for valve i */
+    uint32_t values;     /**< their states, bit i for valve i */
+    uint32_t index;      /**< order of schedule(), the later of two actions due together wins */
+};
+
+/**
+ * \brief what happened to one action, in the order of schedule()
+ */
+struct ActionReport
+{
+    uint64_t deadlineNs; /**< on CLOCK_MONOTONIC */
+    int64_t errorNs;     /**< start of the write minus the deadline, 0 until written */
+    uint32_t writeNs;    /**< duration of the bulk write */
+    uint32_t batch;      /**< number of the bulk write, actions written together share it */
+    statusErrDef status; /**< infoActionPending until written, then noError, errActionLate,
+                              errActionInterlocked or errGPIOSetValue ; infoSequenceAborted when dropped */
+};
+
+/**
+ * \brief figures of the last run
+ */
+struct SchedulerStats
+{
+    uint32_t nbActions; /**< actions scheduled */
+    uint32_t nbWritten; /**< actions written */
+    uint32_t nbBatches; /**< bulk writes */
+    uint32_t nbLate;    /**< actions written more than SCHED_LATE_NS after their deadline */
+    uint32_t nbInterlocked; /**< actions held closed by the interlock rules */
+    uint32_t nbDropped; /**< actions not written because of abort() */
+    int64_t maxErrorNs; /**< largest time error */
+};
+
+/**
+ * \brief sequence of timed actions on the valves of one bank, run by its
+ * own thread.
+ */
+class ValveScheduler
+{
+private:
+    ValveBank &bank;
+    SchedulerConfig config;
+    std::vector<ValveAction> actions; /**< in the order of schedule() */
+    std::vector<ValveAction> heap;    /**< actions not written yet, earliest deadline first */
+    std::vector<uint32_t> batch;      /**< actions of the current bulk write */
+    std::vector<ActionReport> reports;
+    uint32_t reservedMask;            /**< every valve of the sequence */
+    const Interlock *rules;           /**< interlock rules of the board, nullptr for none */
+    const SensorData *sensors;        /**< sensor segment of the board, read through its seqlock */
+    SensorFrame frame;                /**< last sensor frame read */
+    SchedulerStats stats;
+    statusErrDef result;
+    std::atomic<bool> stopped;
+    std::atomic<bool> done;
+    std::atomic<uint32_t> runs;       /**< runs started */
+    std::thread thread;
+
+    void run();
+
+public:
+    ValveScheduler(ValveBank &bank, const SchedulerConfig &config = SchedulerConfig());
+    ~ValveScheduler();
+    void setInterlock(const Interlock *rules, const SensorData *sensors);
+    void clear();
+    statusErrDef schedule(uint64_t offsetNs, uint32_t mask, uint32_t values);
+    statusErrDef load(const BoardConfig &board, const char *path);
+    statusErrDef start(uint64_t t0Ns);
+    void abort();
+    statusErrDef wait();
+    bool isDone() const;
+    uint32_t getRuns() const;
+    int getNbActions() const;
+    const ActionReport &getReport(int index) const;
+    const SchedulerStats &getStats() const;
+};
+
+#endif // VALVESCHEDULER_H